@@ -0,0 +1,150 @@
+/**
+ * @file elementwise_benchmark.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+/* ELEMENTWISE MICROBENCHMARK
+ * Times the HOST elementwise kernels used by the compute graph against the equivalent loop written with
+ * Tensor::get/set, which is how several of these operations used to be implemented.
+ *
+ * usage: elementwise_benchmark [size] [repetitions] */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "magmadnn.h"
+
+#include "compute/add/geadd_internal.h"
+#include "compute/div/div_internal.h"
+#include "compute/log/log_internal.h"
+#include "compute/negative/negative_internal.h"
+#include "compute/pow/pow_internal.h"
+#include "compute/product/product_internal.h"
+#include "compute/relu/relu_internal.h"
+#include "compute/sigmoid/sigmoid_internal.h"
+#include "compute/sum/sum_internal.h"
+#include "compute/tanh/tanh_internal.h"
+
+using namespace magmadnn;
+
+/* returns the mean time of one call in milliseconds */
+double time_ms(const std::function<void()> &f, unsigned int repetitions) {
+    f(); /* warm up */
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (unsigned int i = 0; i < repetitions; i++) f();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+void report(const char *name, const std::function<void()> &reference, const std::function<void()> &kernel,
+            unsigned int size, unsigned int repetitions) {
+    double ref_ms = time_ms(reference, repetitions);
+    double kernel_ms = time_ms(kernel, repetitions);
+
+    std::printf("%-12s %12.4f %12.4f %10.2fx %10.2f\n", name, ref_ms, kernel_ms, ref_ms / kernel_ms,
+                (double) size / (kernel_ms * 1e6));
+}
+
+int main(int argc, char **argv) {
+    magmadnn_init();
+
+    unsigned int size = (argc > 1) ? std::atoi(argv[1]) : (1 << 20);
+    unsigned int repetitions = (argc > 2) ? std::atoi(argv[2]) : 20;
+
+    Tensor<float> a({size}, {UNIFORM, {0.5f, 2.0f}}, HOST);
+    Tensor<float> b({size}, {UNIFORM, {0.5f, 2.0f}}, HOST);
+    Tensor<float> c({size}, {UNIFORM, {0.5f, 2.0f}}, HOST);
+    Tensor<float> out({size}, {NONE, {}}, HOST);
+
+    /* geadd expects matrices */
+    Tensor<float> a2({size / 64, 64}, {UNIFORM, {0.5f, 2.0f}}, HOST);
+    Tensor<float> b2({size / 64, 64}, {UNIFORM, {0.5f, 2.0f}}, HOST);
+    Tensor<float> out2({size / 64, 64}, {NONE, {}}, HOST);
+
+    std::vector<Tensor<float> *> vals = {&a, &b, &c};
+
+    std::printf("elements: %u, repetitions: %u\n", size, repetitions);
+    std::printf("%-12s %12s %12s %11s %10s\n", "op", "get/set(ms)", "kernel(ms)", "speedup", "Gelem/s");
+
+    report(
+        "relu",
+        [&]() {
+            for (unsigned int i = 0; i < size; i++) out.set(i, (a.get(i) < 0) ? 0.0f : a.get(i));
+        },
+        [&]() { internal::relu_full(&a, &out); }, size, repetitions);
+
+    report(
+        "sigmoid",
+        [&]() {
+            for (unsigned int i = 0; i < size; i++) out.set(i, 1 / (1 + std::exp(-a.get(i))));
+        },
+        [&]() { internal::sigmoid_full(&a, &out, false); }, size, repetitions);
+
+    report(
+        "tanh",
+        [&]() {
+            for (unsigned int i = 0; i < size; i++) out.set(i, std::tanh(a.get(i)));
+        },
+        [&]() { internal::tanh_full(&a, &out); }, size, repetitions);
+
+    report(
+        "negative",
+        [&]() {
+            for (unsigned int i = 0; i < size; i++) out.set(i, -a.get(i));
+        },
+        [&]() { internal::negative_full(&a, &out); }, size, repetitions);
+
+    report(
+        "pow_grad",
+        [&]() {
+            for (unsigned int i = 0; i < size; i++) out.set(i, b.get(i) * 2.0f * std::pow(a.get(i), 1.0f));
+        },
+        [&]() { internal::pow_grad(&a, 2, &b, &out); }, size, repetitions);
+
+    report(
+        "log",
+        [&]() {
+            for (unsigned int i = 0; i < size; i++) out.set(i, std::log(a.get(i) + 1E-8f));
+        },
+        [&]() { internal::log_full(&a, &out, true); }, size, repetitions);
+
+    report(
+        "div",
+        [&]() {
+            for (unsigned int i = 0; i < size; i++) out.set(i, a.get(i) / b.get(i));
+        },
+        [&]() { internal::tensor_div_tensor_full(&a, &b, &out); }, size, repetitions);
+
+    report(
+        "product",
+        [&]() {
+            for (unsigned int i = 0; i < size; i++) out.set(i, a.get(i) * b.get(i));
+        },
+        [&]() { internal::product_full(1.0f, &a, &b, &out); }, size, repetitions);
+
+    report(
+        "sum",
+        [&]() {
+            for (unsigned int i = 0; i < size; i++) out.set(i, a.get(i) + b.get(i) + c.get(i));
+        },
+        [&]() { internal::sum_full(vals, out); }, size, repetitions);
+
+    report(
+        "geadd",
+        [&]() {
+            for (unsigned int i = 0; i < a2.get_size(); i++) out2.set(i, 2.0f * a2.get(i) + 3.0f * b2.get(i));
+        },
+        [&]() { internal::geadd_full(2.0f, &a2, 3.0f, &b2, &out2); }, a2.get_size(), repetitions);
+
+    magmadnn_finalize();
+    return 0;
+}
@@ -31,6 +31,8 @@ class AddOp : public Operation<T> {
 
     std::string to_string() { return "(" + a->to_string() + " + " + b->to_string() + ")"; }
 
+    bool passes_grad_through() const { return true; }
+
    protected:
     Tensor<T> *_eval(bool recompute = true);
     Tensor<T> *_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad);
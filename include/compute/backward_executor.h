@@ -0,0 +1,135 @@
+/**
+ * @file backward_executor.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#include <functional>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "compute/gradtable.h"
+#include "compute/operation.h"
+#include "magmadnn/types.h"
+#include "tensor/tensor.h"
+
+namespace magmadnn {
+namespace op {
+
+/** Computes the gradients of a compute graph without recursion.
+ *
+ * The first run on a graph orders every operation between the variables and the graph head so that each
+ * operation comes after all of its consumers. That order is kept and reused for as long as the graph is unchanged.
+ * The graph is pruned to the operations that are both descendants of a variable and ancestors of the head. Branches
+ * that do not lead to the head (other heads, metrics) or that no variable feeds (frozen layers) are never visited.
+ * A variable that is a leaf of the pruned graph, like a weight, is scheduled right after its last consumer, so its
+ * gradient is done as early as the pass allows instead of after every path the other variables start.
+ * A run then walks the order iteratively. Each operation's gradient is the sum of the partial gradients of its
+ * consumers.
+ *
+ * Every gradient tensor is reference counted by the number of inputs that still have to read it. When the count
+ * drops to zero, the tensor is released from the operation that owns it, unless it is the gradient of a requested
+ * variable. At any point only the gradients on the current frontier of the backward pass are alive, and not every
+ * intermediate gradient of the graph. Released entries are also removed from the GradTable. Tensors whose memory is
+ * not their own (see MemoryPlanner) are left alone.
+ * @tparam T numeric
+ */
+template <typename T>
+class BackwardExecutor {
+   public:
+    BackwardExecutor();
+    ~BackwardExecutor();
+
+    BackwardExecutor(const BackwardExecutor &) = delete;
+    BackwardExecutor &operator=(const BackwardExecutor &) = delete;
+
+    /** Fills table with the gradient of graph w.r.t. each of vars.
+     * @param vars variables to differentiate with respect to
+     * @param graph head of the compute graph
+     * @param table GradTable to put the gradients in
+     * @return magmadnn_error_t non-zero on error
+     */
+    magmadnn_error_t run(const std::vector<Operation<T> *> &vars, Operation<T> *graph, GradTable<T> &table);
+
+    /** Builds the schedule for graph and vars unless the current one is still valid. run does this itself.
+     * @param vars
+     * @param graph
+     * @return magmadnn_error_t non-zero on error, 2 if graph does not depend on one of vars
+     */
+    magmadnn_error_t prepare(const std::vector<Operation<T> *> &vars, Operation<T> *graph);
+
+    /** Whether intermediate gradients are freed as soon as they are dead, and erased from the table. Defaults to
+     * false, which keeps every gradient allocated (and in the table) until the operations are destroyed. The
+     * optimizers turn it on, since they only read the gradients of the weights.
+     * @param release
+     */
+    void set_release_buffers(bool release) { this->release_buffers = release; }
+    bool get_release_buffers() const { return this->release_buffers; }
+
+    /** The schedule used by the last run (or prepare), consumers first.
+     * @return const std::vector<Operation<T> *>&
+     */
+    const std::vector<Operation<T> *> &get_order() const { return this->order; }
+
+    /** Number of intermediate gradient tensors freed by the last run.
+     * @return unsigned int
+     */
+    unsigned int get_num_released() const { return this->n_released; }
+
+    /** Called by run as soon as the gradient of one of the requested variables is complete, with the variable and
+     * its gradient, in the order in which the backward pass finishes them. The rest of the pass has not run yet, so
+     * work on that gradient (e.g. communicating it) can overlap with it. The gradient of a variable that has inputs
+     * is still read by the rest of the pass. On the device, the kernels producing it may still be queued.
+     * @param callback an empty function to turn it off
+     */
+    void set_grad_ready_callback(const std::function<void(Operation<T> *, Tensor<T> *)> &callback) {
+        this->grad_ready_callback = callback;
+    }
+
+   protected:
+    /** true if the cached order was built for this graph and vars and no operation has gained or lost a consumer
+     * since */
+    bool plan_is_valid(const std::vector<Operation<T> *> &vars, Operation<T> *graph);
+
+    magmadnn_error_t build_plan(const std::vector<Operation<T> *> &vars, Operation<T> *graph);
+
+    /** decrements the pending reads of grad and frees it once no reader is left */
+    void consume(Tensor<T> *grad, GradTable<T> &table);
+
+    void release(Tensor<T> *grad, GradTable<T> &table);
+
+    /* who owns a gradient tensor: the grad cache entry for wrt in op, or op's accumulator when wrt is NULL */
+    struct grad_owner {
+        Operation<T> *op;
+        Operation<T> *wrt;
+    };
+
+    /* plan */
+    Operation<T> *plan_graph;
+    std::vector<Operation<T> *> plan_vars;
+    std::set<Operation<T> *> plan_var_set;
+    std::vector<Operation<T> *> order;
+    std::vector<unsigned int> n_consumers; /* consumer count of order[i] when the plan was built */
+    std::vector<std::vector<Operation<T> *>> plan_consumers; /* consumers of order[i] that are in the plan */
+    std::map<Operation<T> *, unsigned int> n_reads; /* inputs that read an operation's gradient */
+
+    /* state of one run */
+    std::map<Tensor<T> *, unsigned int> pending_reads;
+    std::map<Tensor<T> *, grad_owner> owners;
+    std::map<Tensor<T> *, std::vector<Operation<T> *>> holders; /* table entries pointing to a tensor */
+    std::set<Tensor<T> *> kept;                                 /* never freed (variable gradients, grad_loss) */
+    std::vector<Tensor<T> *> bprops;
+    std::vector<Tensor<T> *> consumer_grads;
+
+    Tensor<T> *grad_loss;
+    std::function<void(Operation<T> *, Tensor<T> *)> grad_ready_callback;
+    bool release_buffers;
+    unsigned int n_released;
+};
+
+}  // namespace op
+}  // namespace magmadnn
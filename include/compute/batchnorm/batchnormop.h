@@ -22,6 +22,12 @@ class BatchNormOp : public Operation<T> {
 
     std::string to_string() { return "BatchNorm(" + input->to_string() + ")"; }
 
+    /** In training mode (the default) the output is normalized with the batch statistics and the running
+     * statistics are updated. Otherwise the running statistics are used and left untouched.
+     */
+    void set_training(bool training) { this->training = training; }
+    bool is_training() const { return this->training; }
+
    protected:
     Tensor<T> *_eval(bool recompute);
     Tensor<T> *_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad);
@@ -39,12 +45,14 @@ class BatchNormOp : public Operation<T> {
     Tensor<T> *saved_mean;
     Tensor<T> *saved_variance;
 
-#if defined(MAGMADNN_HAVE_CUDA)
     void init_settings();
 
+    math::batchnorm_cpu_settings cpu_settings;
+#if defined(MAGMADNN_HAVE_CUDA)
     math::cudnn_batchnorm_settings_t settings;
 #endif
 
+    bool training;
     bool copy;
 };
 
@@ -35,6 +35,10 @@ class Conv2DForwardOp : public Operation<T> {
 
     void init_settings();
 
+#if !defined(MAGMADNN_HAVE_MKLDNN)
+    void cpu_init_settings();
+#endif
+
 #if defined(MAGMADNN_HAVE_MKLDNN)
     void onednn_backward_data(Tensor<T> *grad, Tensor<T> *out);
 
@@ -51,6 +55,10 @@ class Conv2DForwardOp : public Operation<T> {
     int pad_h, pad_w, vertical_stride, horizontal_stride, dilation_h, dilation_w;
     bool use_cross_correlation;
 
+#if !defined(MAGMADNN_HAVE_MKLDNN)
+    ::magmadnn::math::conv2d_cpu_settings cpu_settings;
+#endif
+
 #if defined(MAGMADNN_HAVE_CUDA)
     ::magmadnn::math::conv2d_cudnn_settings cudnn_settings;
 #endif
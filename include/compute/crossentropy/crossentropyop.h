@@ -21,6 +21,8 @@ class CrossEntropyOp : public Operation<T> {
 
     std::string to_string() { return "CrossEntropy(Softmax(" + x->to_string() + "), " + y->to_string() + ")"; }
 
+    bool passes_grad_through() const { return true; }
+
    protected:
     Tensor<T> *_eval(bool recompute = true);
     Tensor<T> *_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad);
@@ -0,0 +1,60 @@
+/**
+ * @file softmaxcrossentropyop.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#include <string>
+
+#include "compute/operation.h"
+#include "math/crossentropy.h"
+#include "tensor/tensor.h"
+
+namespace magmadnn {
+namespace op {
+
+/** Mean cross entropy of softmax(logits) against labels, computed from the logits with log-sum-exp. The softmax is
+ * kept from the forward pass, so the gradient w.r.t. the logits is just (softmax - labels) / n_samples. Labels are
+ * either class indices (one per sample) or one-hot rows. HOST only: the constructor throws a magmadnn::Error for
+ * logits in any other memory, and evaluation throws one for a class index outside [0, n_classes).
+ * @tparam T
+ */
+template <typename T>
+class SoftmaxCrossEntropyOp : public Operation<T> {
+   public:
+    SoftmaxCrossEntropyOp(Operation<T> *labels, Operation<T> *logits, bool needs_grad = true);
+    virtual ~SoftmaxCrossEntropyOp();
+
+    std::string to_string() {
+        return "SoftmaxCrossEntropy(" + logits->to_string() + ", " + labels->to_string() + ")";
+    }
+
+    /** softmax of the logits from the last evaluation
+     * @return Tensor<T>*
+     */
+    Tensor<T> *get_softmax() { return softmax; }
+
+   protected:
+    Tensor<T> *_eval(bool recompute = true);
+    Tensor<T> *_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad);
+
+    Operation<T> *labels, *logits;
+    Tensor<T> *labels_tensor, *logits_tensor, *softmax;
+};
+
+/** Cross entropy between labels and softmax(logits) as one operation. Equivalent to
+ * crossentropy(one_hot(labels), softmax(logits)), but numerically stable and without the separate softmax.
+ * @tparam T int, float, double
+ * @param labels n_samples class indices, or n_samples x n_classes one-hot rows
+ * @param logits n_samples x n_classes scores before the softmax
+ * @param needs_grad
+ * @return SoftmaxCrossEntropyOp<T>* an operation with output size = {1}
+ */
+template <typename T>
+SoftmaxCrossEntropyOp<T> *softmax_crossentropy(Operation<T> *labels, Operation<T> *logits, bool needs_grad = true);
+
+}  // namespace op
+}  // namespace magmadnn
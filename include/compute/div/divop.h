@@ -27,6 +27,8 @@ class DivOp : public Operation<T> {
 
     std::string to_string() { return "( " + a->to_string() + " / " + b->to_string() + " )"; }
 
+    bool passes_grad_through() const { return true; }
+
    protected:
     Tensor<T> *_eval(bool recompute = true);
     Tensor<T> *_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad);
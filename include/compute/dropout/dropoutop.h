@@ -22,6 +22,12 @@ class DropoutOp : public Operation<T> {
 
     std::string to_string() { return "Dropout(" + input->to_string() + ")"; }
 
+    /** In training mode (the default) values are dropped at random. Otherwise the output is a copy of the input,
+     * which has the same expected value since kept values are scaled by 1/(1-dropout_rate) in training.
+     */
+    void set_training(bool training) { this->training = training; }
+    bool is_training() const { return this->training; }
+
    protected:
     Tensor<T> *_eval(bool recompute);
     Tensor<T> *_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad);
@@ -43,6 +49,7 @@ class DropoutOp : public Operation<T> {
 #endif
 
     bool copy;
+    bool training;
 };
 
 template <typename T>
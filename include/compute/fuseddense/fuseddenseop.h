@@ -0,0 +1,125 @@
+/**
+ * @file fuseddenseop.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+
+#if defined(MAGMADNN_CMAKE_BUILD)
+#include "magmadnn/config.h"
+#endif
+#include "compute/linearforward/linearforwardop.h"
+#include "compute/operation.h"
+#include "math/bias_activation.h"
+#include "math/matmul.h"
+#include "math/reduce_sum.h"
+#include "tensor/tensor.h"
+
+#if defined(MAGMADNN_HAVE_MKLDNN)
+#include "dnnl.hpp"
+#endif
+
+namespace magmadnn {
+namespace op {
+
+/** Dense layer with its activation: activation(input * weights + bias) where, like LinearForwardOp, bias holds one
+ * value per row. The bias and the activation are applied in a single pass over the GEMM output (with MKLDNN, as
+ * oneDNN post-ops of the inner product), so the pre-activation tensor is never written out and read back. The
+ * backward pass computes grad * activation'(output) once and derives the gradients w.r.t. input, weights and bias
+ * from it. HOST only: the constructor throws a magmadnn::Error for inputs in any other memory.
+ * @tparam T
+ */
+template <typename T>
+class FusedDenseOp : public Operation<T> {
+   public:
+    /**
+     * @param input matrix
+     * @param weights matrix
+     * @param bias vector with a value per row of input, or NULL for none
+     * @param activation
+     * @param output tensor to write the result to, such as that of an operation this one replaces; not owned.
+     * Allocated if NULL
+     * @param needs_grad
+     */
+    FusedDenseOp(Operation<T> *input, Operation<T> *weights, Operation<T> *bias, math::fused_activation_t activation,
+                 Tensor<T> *output = NULL, bool needs_grad = true);
+    virtual ~FusedDenseOp();
+
+    std::string to_string() {
+        return "FusedDense(" + input->to_string() + ", " + weights->to_string() + ")";
+    }
+
+    Operation<T> *get_input() { return input; }
+    Operation<T> *get_weights() { return weights; }
+    /* NULL without bias */
+    Operation<T> *get_bias() { return bias; }
+    math::fused_activation_t get_activation() const { return activation; }
+
+   protected:
+    Tensor<T> *_eval(bool recompute);
+    Tensor<T> *_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad);
+
+    /* grad * activation'(output), computed once per backward pass and shared by the three gradients */
+    Tensor<T> *get_activation_grad(Tensor<T> *grad);
+
+    /* a new gradient tensor for var of the given shape, or the cached one */
+    Tensor<T> *get_grad_out(Operation<T> *var, const std::vector<unsigned int> &shape);
+
+#if defined(MAGMADNN_HAVE_MKLDNN)
+    void init_dnnl_settings();
+#endif
+
+    Operation<T> *input, *weights, *bias;
+    Tensor<T> *input_tensor, *weights_tensor, *bias_tensor, *bias_ones;
+
+    math::fused_activation_t activation;
+
+    Tensor<T> *activation_grad;         /* grad * activation'(output) */
+    Tensor<T> *activation_grad_source;  /* the grad it was computed from */
+    unsigned long n_evals;              /* forward passes so far */
+    unsigned long activation_grad_eval; /* forward pass activation_grad belongs to */
+
+#if defined(MAGMADNN_HAVE_MKLDNN)
+    dnnl::engine dnnl_cpu_engine_;
+
+    // Inner product with the activation as post-op
+    std::unique_ptr<dnnl::inner_product_forward::primitive_desc> dnnl_fwd_pdesc_;
+    std::unique_ptr<dnnl::inner_product_forward> dnnl_fwd_;
+#endif
+};
+
+/** Dense layer followed by activation as one operation. @see FusedDenseOp
+ * @tparam T
+ * @param input
+ * @param weights
+ * @param bias vector with a value per row of input, or NULL for none
+ * @param activation
+ * @param needs_grad
+ * @return FusedDenseOp<T>*
+ */
+template <typename T>
+FusedDenseOp<T> *fuseddense(Operation<T> *input, Operation<T> *weights, Operation<T> *bias,
+                            math::fused_activation_t activation, bool needs_grad = true);
+
+/** Graph rewrite of activation(linear) into one FusedDenseOp. linear is detached from its inputs and the fused
+ * operation writes into its output tensor, which then holds the activated values. Only applies to HOST operations
+ * that nothing else consumes yet.
+ *
+ * The tensor stays owned by linear, which stays alive as the out() of its FullyConnectedLayer. linear must not be
+ * evaluated after the rewrite, as it would overwrite the activated values, nor deleted, as its inputs now belong to
+ * the fused operation. Pass fuse = false to layer::activation to keep the separate operations instead.
+ * @tparam T
+ * @param linear
+ * @param activation
+ * @return FusedDenseOp<T>* the operation to use instead of the activation, or NULL if linear cannot be fused
+ */
+template <typename T>
+FusedDenseOp<T> *fuse_dense_activation(LinearForwardOp<T> *linear, math::fused_activation_t activation);
+
+}  // namespace op
+}  // namespace magmadnn
@@ -11,6 +11,7 @@
 
 #include <vector>
 #include "compute/add/addop.h"
+#include "compute/backward_executor.h"
 #include "compute/gradtable.h"
 #include "compute/operation.h"
 #include "compute/sum/sumop.h"
@@ -19,12 +20,13 @@
 namespace magmadnn {
 namespace op {
 
-/** Given a list of vars and compute graph, fills in a GradTable.
+/** Given a list of vars and compute graph, fills in a GradTable. Only the operations on a path from one of vars to
+ * graph are differentiated.
  * @tparam T numeric
  * @param vars A list of variables whose gradients will be computed
  * @param graph Head node of compute graph that contains 'vars'
  * @param table GradTable to be filled in
- * @return magmadnn_error_t non-zero on error
+ * @return magmadnn_error_t non-zero on error, 2 if graph does not depend on one of vars
  */
 template <typename T>
 magmadnn_error_t get_grad_table(const std::vector<Operation<T> *> &vars, Operation<T> *graph, GradTable<T> &table);
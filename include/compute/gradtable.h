@@ -10,6 +10,7 @@
 
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
 #include "compute/operation.h"
 #include "compute/variable.h"
@@ -17,6 +18,9 @@
 namespace magmadnn {
 namespace op {
 
+template <typename T>
+class BackwardExecutor;
+
 /** GradTable class.
  * @tparam T Numeric
  */
@@ -44,6 +48,11 @@ class GradTable {
      */
     void set(Operation<T>* var, Tensor<T>* grad);
 
+    /** Removes var's entry, if any.
+     * @param var
+     */
+    void erase(Operation<T>* var);
+
     /** Removes all entries.
      */
     void clear();
@@ -51,9 +60,16 @@ class GradTable {
     // Zero all gradients in table.
     void zero();
 
+    /** The executor used by get_grad_table on this table. It is created on first use and keeps the backward schedule
+     * of the last graph differentiated with this table, so that it is only computed once per graph.
+     * @return BackwardExecutor<T>&
+     */
+    BackwardExecutor<T>& get_executor();
+
    protected:
     std::map<Operation<T>*, Tensor<T>*> _table;  // the underlying table to store data
     typename std::map<Operation<T>*, Tensor<T>*>::iterator tmp_map_iterator;
+    std::shared_ptr<BackwardExecutor<T>> _executor;
 };
 
 }  // namespace op
@@ -20,6 +20,11 @@ class LinearForwardOp : public Operation<T> {
 
     std::string to_string() { return "LinearForward(" + input->to_string() + ", " + weights->to_string() + ")"; }
 
+    Operation<T> *get_input() { return input; }
+    Operation<T> *get_weights() { return weights; }
+    /* NULL without bias */
+    Operation<T> *get_bias() { return bias; }
+
    protected:
     Tensor<T> *_eval(bool recompute);
     Tensor<T> *_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad);
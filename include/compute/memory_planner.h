@@ -0,0 +1,114 @@
+/**
+ * @file memory_planner.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "compute/operation.h"
+#include "magmadnn/types.h"
+#include "memory/memorymanager.h"
+#include "tensor/tensor.h"
+
+namespace magmadnn {
+namespace op {
+
+/** Static memory planner for a compute graph.
+ *
+ * plan() replays the order in which eval and the BackwardExecutor touch the graph. From that it derives the
+ * interval of steps during which each intermediate buffer is alive:
+ * - the output of every non-leaf operation;
+ * - when variables are given, the gradient buffers of the backward pass and the activations that it still reads.
+ *
+ * The buffers are then packed into one arena. Buffers whose lifetimes do not overlap share memory. Buffers are
+ * placed largest first, each at the lowest offset where it does not collide with a live one.
+ *
+ * bind() allocates the arena and points the graph's tensors into it. Activations keep their Tensor objects, so
+ * pointers to them stay valid. Gradient tensors are handed to the operations before their first backward pass.
+ * Leaves (variables and placeholders) are never planned, as they persist for the whole graph.
+ *
+ * Plan after the graph has been evaluated once, because some operations only pick their output tensor during eval.
+ * The graph must not change while bound.
+ * @tparam T numeric
+ */
+template <typename T>
+class MemoryPlanner {
+   public:
+    MemoryPlanner();
+    ~MemoryPlanner();
+
+    MemoryPlanner(const MemoryPlanner &) = delete;
+    MemoryPlanner &operator=(const MemoryPlanner &) = delete;
+
+    /** Computes lifetimes and offsets for graph. Unbinds a previous plan.
+     * @param graph head of the compute graph
+     * @param vars if not empty, the variables that will be differentiated with get_grad_table, and the plan also
+     * covers the backward pass
+     * @return magmadnn_error_t non-zero on error
+     */
+    magmadnn_error_t plan(Operation<T> *graph, const std::vector<Operation<T> *> &vars = {});
+
+    /** Allocates the arena and moves every planned buffer into it.
+     * @return magmadnn_error_t non-zero on error
+     */
+    magmadnn_error_t bind();
+
+    /** Gives every bound tensor its own memory again (keeping its contents) and frees the arena.
+     */
+    void unbind();
+
+    /** Bytes needed if every planned buffer had its own allocation, as they do without a plan.
+     * @return std::size_t
+     */
+    std::size_t get_naive_bytes() const { return this->naive_bytes; }
+
+    /** Bytes of the arena, i.e. the planned peak.
+     * @return std::size_t
+     */
+    std::size_t get_planned_bytes() const { return this->arena_size * sizeof(T); }
+
+    /** Number of planned buffers.
+     * @return unsigned int
+     */
+    unsigned int get_num_buffers() const { return this->buffers.size(); }
+
+    /** Whether the graph currently lives in the arena.
+     * @return bool
+     */
+    bool is_bound() const { return this->arena != NULL; }
+
+   protected:
+    enum buffer_kind_t { ACTIVATION, GRADIENT, ACCUMULATOR };
+
+    struct buffer_t {
+        buffer_kind_t kind;
+        Operation<T> *op;  /* owner */
+        Operation<T> *wrt; /* GRADIENT: the input the gradient is for */
+        Tensor<T> *tensor; /* ACTIVATION: the output tensor. otherwise set by bind */
+        std::vector<unsigned int> shape;
+        std::size_t size; /* elements, padded */
+        unsigned int first, last; /* steps during which the buffer is alive */
+        std::size_t offset;
+    };
+
+    /** index of the buffer for tensor, adding it if needed */
+    unsigned int activation(Tensor<T> *tensor, Operation<T> *op);
+
+    void touch(unsigned int buffer, unsigned int step);
+
+    void pack();
+
+    std::vector<buffer_t> buffers;
+    std::size_t naive_bytes;
+    std::size_t arena_size;
+    memory_t mem_type;
+    MemoryManager<T> *arena;
+};
+
+}  // namespace op
+}  // namespace magmadnn
@@ -8,6 +8,7 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <string>
@@ -68,6 +69,8 @@ class Operation {
     virtual ~Operation() {
         for (unsigned int i = 0; i < inputs.size(); i++) delete inputs[i];
 
+        if (this->grad_accumulator != NULL) delete this->grad_accumulator;
+
         /*  TODO : figure out why this peice of code caused SEGFAULTS
         if (this->output_tensor != NULL) {
             delete this->output_tensor;
@@ -148,6 +151,14 @@ class Operation {
      */
     virtual void add_consumer(Operation<T> *consumer) { this->consumers.push_back(consumer); }
 
+    /** Removes consumer, for graph rewrites that replace it by another operation.
+     * @param consumer
+     */
+    virtual void remove_consumer(Operation<T> *consumer) {
+        this->consumers.erase(std::remove(this->consumers.begin(), this->consumers.end(), consumer),
+                              this->consumers.end());
+    }
+
     /** Returns a vector of operations that need this operation as input.
      * @return std::vector<Operation<T> *> vector of consumer operations
      */
@@ -165,9 +176,86 @@ class Operation {
 
     /** Gets the current grad_tensor wrt to wrt.
      * @param wrt
+     * @return Tensor<T>* NULL if no gradient wrt wrt is cached, e.g. before the first backward pass
+     */
+    virtual Tensor<T> *get_grad_tensor(Operation<T> *wrt) {
+        typename std::map<uintptr_t, Tensor<T> *>::iterator it = this->_grad_cache.find((uintptr_t) wrt);
+
+        return (it == this->_grad_cache.end()) ? NULL : it->second;
+    }
+
+    /** Buffer that the partial gradients from this operation's consumers are summed into when there is more than
+     *  one. It is owned by the operation, allocated on first use and reused as long as shape and memory type match.
+     * @param shape shape of the gradient
+     * @param mem memory type of the gradient
+     * @return Tensor<T>*
+     */
+    virtual Tensor<T> *get_grad_accumulator(const std::vector<unsigned int> &shape, memory_t mem) {
+        if (this->grad_accumulator != NULL &&
+            (this->grad_accumulator->get_shape() != shape || this->grad_accumulator->get_memory_type() != mem)) {
+            delete this->grad_accumulator;
+            this->grad_accumulator = NULL;
+        }
+
+        if (this->grad_accumulator == NULL) {
+            this->grad_accumulator = new Tensor<T>(shape, {NONE, {}}, mem);
+#if defined(MAGMADNN_HAVE_CUDA)
+            this->grad_accumulator->set_custream(this->get_custream());
+            this->grad_accumulator->set_cublas_handle(this->get_cublas_handle());
+#endif
+        }
+
+        return this->grad_accumulator;
+    }
+
+    /** Frees the gradient tensor cached for wrt if it is grad, so that its memory can be reused before this operation
+     *  is destroyed. The next call to grad allocates it again.
+     * @param wrt the input the gradient was computed for
+     * @param grad the tensor expected in the cache
+     * @return true if the tensor was owned by this operation and has been freed
+     */
+    virtual bool release_grad_tensor(Operation<T> *wrt, Tensor<T> *grad) {
+        typename std::map<uintptr_t, Tensor<T> *>::iterator it = this->_grad_cache.find((uintptr_t) wrt);
+
+        if (it == this->_grad_cache.end() || it->second == NULL || it->second != grad) return false;
+
+        delete it->second;
+        it->second = NULL;
+        return true;
+    }
+
+    /** Frees the buffer returned by get_grad_accumulator.
+     */
+    virtual void release_grad_accumulator() {
+        if (this->grad_accumulator != NULL) delete this->grad_accumulator;
+        this->grad_accumulator = NULL;
+    }
+
+    /** The current gradient accumulator, NULL if none has been allocated.
      * @return Tensor<T>*
      */
-    virtual Tensor<T> *get_grad_tensor(Operation<T> *wrt) { return this->_grad_cache.find((uintptr_t) wrt)->second; }
+    virtual Tensor<T> *get_grad_accumulator() const { return this->grad_accumulator; }
+
+    /** Replaces the gradient accumulator. The operation takes ownership of grad.
+     * @param grad
+     */
+    virtual void set_grad_accumulator(Tensor<T> *grad) {
+        if (this->grad_accumulator != NULL && this->grad_accumulator != grad) delete this->grad_accumulator;
+        this->grad_accumulator = grad;
+    }
+
+    /** Sets the tensor _grad writes the gradient w.r.t. wrt into, so that it does not allocate one itself. The
+     *  operation takes ownership of grad, which must have the shape of wrt's output.
+     * @param wrt
+     * @param grad
+     */
+    virtual void set_grad_tensor(Operation<T> *wrt, Tensor<T> *grad) { this->_grad_cache[(uintptr_t) wrt] = grad; }
+
+    /** Whether _grad returns the incoming gradient itself rather than a tensor from _grad_cache. Such operations
+     *  need no gradient memory of their own.
+     * @return bool
+     */
+    virtual bool passes_grad_through() const { return false; }
 
     /** string form of the given operation. Expands on input.
      * @return std::string
@@ -271,6 +359,8 @@ class Operation {
 
     Tensor<T> *output_tensor; /* the return tensor */
 
+    Tensor<T> *grad_accumulator = NULL; /* sum of the consumers' gradients, see get_grad_accumulator */
+
     bool needs_grad;
     bool has_grad_been_computed;
 
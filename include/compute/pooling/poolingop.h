@@ -42,6 +42,11 @@ class PoolingOp : public Operation<T> {
     math::cudnn_pooling_settings_t settings;
 #endif
 
+#if !defined(MAGMADNN_HAVE_MKLDNN)
+    /* argmax indices recorded by the HOST forward pass are reused by _grad */
+    math::pooling_cpu_settings cpu_settings;
+#endif
+
 #if defined(MAGMADNN_HAVE_MKLDNN)
     dnnl::engine dnnl_cpu_engine_;
 
@@ -18,6 +18,8 @@ class SoftmaxOp : public Operation<T> {
 
     std::string to_string() { return "Softmax(" + input->to_string() + ")"; }
 
+    Operation<T> *get_input() { return input; }
+
    protected:
     Tensor<T> *_eval(bool recompute);
     Tensor<T> *_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad);
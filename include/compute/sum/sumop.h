@@ -24,6 +24,8 @@ class SumOp : public Operation<T> {
 
     std::string to_string();
 
+    bool passes_grad_through() const { return true; }
+
    protected:
     Tensor<T> *_eval(bool recompute = true);
     Tensor<T> *_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad);
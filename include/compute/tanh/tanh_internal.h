@@ -21,6 +21,18 @@ namespace internal {
 template <typename T>
 void tanh_full(Tensor<T> *x, Tensor<T> *out);
 
+/** Computes the gradient of tanh from its output: out = grad * (1 - output^2). A grad of size 1 is broadcast.
+ * @tparam T
+ * @param output tanh(x)
+ * @param grad
+ * @param out
+ */
+template <typename T>
+void tanh_grad_cpu(Tensor<T> *output, Tensor<T> *grad, Tensor<T> *out);
+
+template <typename T>
+void tanh_grad(Tensor<T> *output, Tensor<T> *grad, Tensor<T> *out);
+
 #if defined(MAGMADNN_HAVE_CUDA)
 /** Computes the tanh function element-wise on the tensor x
  * @tparam T
@@ -28,6 +40,12 @@ void tanh_full(Tensor<T> *x, Tensor<T> *out);
  */
 template <typename T>
 void tanh_full_device(Tensor<T> *x, Tensor<T> *out);
+
+template <typename T>
+void tanh_grad_device(Tensor<T> *output, Tensor<T> *grad, Tensor<T> *out);
+
+template <typename T>
+void tanh_grad_device(cudaStream_t custream, Tensor<T> *output, Tensor<T> *grad, Tensor<T> *out);
 #endif
 
 }  // namespace internal
@@ -21,12 +21,14 @@
 #include "reducesum/reducesumop.h"
 
 #include "crossentropy/crossentropyop.h"
+#include "crossentropy/softmaxcrossentropyop.h"
 #include "meansquarederror/meansquarederror.h"
 
 #include "transpose/transposeop.h"
 
 #include "conv2dforward/conv2dforwardop.h"
 #include "linearforward/linearforwardop.h"
+#include "fuseddense/fuseddenseop.h"
 #include "pow/powop.h"
 #include "softmax/softmaxop.h"
 
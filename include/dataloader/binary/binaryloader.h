@@ -0,0 +1,56 @@
+/**
+ * @file binaryloader.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#include <random>
+#include <vector>
+
+#include "dataloader/dataloader.h"
+#include "magmadnn/data/BinaryDataset.h"
+
+namespace magmadnn {
+namespace dataloader {
+
+/** Loads batches straight from a memory mapped binary dataset, so only the samples of each batch are ever read.
+ *
+ * Batches are full, as with LinearLoader: the samples past the last whole batch are not used. Labels are one hot with
+ * the dataset's number of classes. In order, a batch is one contiguous range of the file; when shuffling, every reset
+ * draws a new permutation and the batch gathers the samples it selects.
+ * @tparam T numeric
+ */
+template <typename T>
+class BinaryLoader : public DataLoader<T> {
+   public:
+    /**
+     * @param dataset an open dataset, which must outlive the loader
+     * @param batch_size
+     * @param shuffle draw a new order every epoch, seeded from std::random_device
+     */
+    BinaryLoader(data::BinaryDataset<T> *dataset, unsigned int batch_size, bool shuffle = false);
+
+    virtual void next(Tensor<T> *x_batch, Tensor<T> *y_batch);
+
+    virtual void reset();
+
+    virtual void set_batch_size(unsigned int size);
+
+    /** Reseeds the shuffle and draws a new order, starting over from the first batch.
+     * @param seed
+     */
+    void set_seed(unsigned int seed);
+
+   protected:
+    data::BinaryDataset<T> *dataset;
+    bool shuffle;
+    std::mt19937 generator;
+    std::vector<unsigned int> permutation;
+    unsigned int curr_index;
+};
+
+}  // namespace dataloader
+}  // namespace magmadnn
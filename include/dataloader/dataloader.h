@@ -24,7 +24,8 @@ class DataLoader {
      * @param batch_size
      */
     DataLoader(Tensor<T> *x, Tensor<T> *y, unsigned int batch_size) : x(x), y(y), batch_size(batch_size) {
-        num_batches = unsigned(x->get_shape(0) / batch_size);
+        n_samples = x->get_shape(0);
+        num_batches = unsigned(n_samples / batch_size);
         assert(num_batches > 0);
         assert(num_batches == unsigned(y->get_shape(0) / batch_size));
 
@@ -32,6 +33,8 @@ class DataLoader {
         sample_size_y = y->get_size() / y->get_shape(0);
     }
 
+    virtual ~DataLoader() {}
+
     /** Copies the next batch of inputs and outputs to x_batch and y_batch
      * @param x_batch
      * @param y_batch
@@ -45,19 +48,47 @@ class DataLoader {
     virtual unsigned int get_batch_size() const { return batch_size; }
     virtual void set_batch_size(unsigned int size) {
         batch_size = size;
-        num_batches = unsigned(x->get_shape(0) / batch_size);
+        num_batches = unsigned(n_samples / batch_size);
         assert(num_batches > 0);
-        assert(num_batches == unsigned(y->get_shape(0) / batch_size));
     }
     virtual unsigned int get_num_batches() const { return num_batches; }
 
+    /** The input features and output labels this loads batches from. NULL for loaders that do not read from
+     * tensors.
+     * @return Tensor<T>*
+     */
+    virtual Tensor<T> *get_x() const { return x; }
+    virtual Tensor<T> *get_y() const { return y; }
+
+    unsigned int get_num_samples() const { return n_samples; }
+    unsigned int get_sample_size_x() const { return sample_size_x; }
+    unsigned int get_sample_size_y() const { return sample_size_y; }
+
    protected:
+    /** Constructs a DataLoader that does not load from tensors in memory.
+     * @param n_samples
+     * @param sample_size_x elements of one input sample
+     * @param sample_size_y elements of one output sample
+     * @param batch_size
+     */
+    DataLoader(unsigned int n_samples, unsigned int sample_size_x, unsigned int sample_size_y, unsigned int batch_size)
+        : x(NULL),
+          y(NULL),
+          batch_size(batch_size),
+          sample_size_x(sample_size_x),
+          sample_size_y(sample_size_y),
+          n_samples(n_samples) {
+        num_batches = unsigned(n_samples / batch_size);
+        assert(num_batches > 0);
+    }
+
     Tensor<T> *x;
     Tensor<T> *y;
     unsigned int batch_size;
     unsigned int sample_size_x;
     unsigned int sample_size_y;
     unsigned int num_batches;
+    unsigned int n_samples;
 };
 
 }  // namespace dataloader
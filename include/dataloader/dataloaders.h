@@ -8,4 +8,7 @@
  */
 #pragma once
 
-#include "dataloader/linear/linearloader.h"
\ No newline at end of file
+#include "dataloader/binary/binaryloader.h"
+#include "dataloader/linear/linearloader.h"
+#include "dataloader/prefetch/prefetchloader.h"
+#include "dataloader/shuffle/shuffleloader.h"
@@ -0,0 +1,113 @@
+/**
+ * @file prefetchloader.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dataloader/dataloader.h"
+
+namespace magmadnn {
+namespace dataloader {
+
+/** Counters of a PrefetchLoader since construction or the last reset_stats.
+ */
+struct prefetch_stats_t {
+    unsigned int n_batches;  /**<batches handed out by next */
+    unsigned int n_stalls;   /**<calls to next that had to wait for the loading thread */
+    double stall_seconds;    /**<total time next waited */
+    double mean_queue_depth; /**<average number of ready batches when next was called */
+    unsigned int n_swapped;  /**<tensors handed over by swapping memory instead of copying */
+};
+
+/** Loads batches from another DataLoader on a background thread, ahead of time.
+ *
+ * A ring of n_buffers staging batches is kept filled by the thread in the order of the source loader. next() takes
+ * the oldest ready batch, so the source's copy (or gather) is off the training thread. The hand over is a swap of the
+ * memory of the staging tensors and x_batch and y_batch when those own memory of the same size and type. Otherwise
+ * it is one copy.
+ *
+ * The staging tensors get the shape and memory type of the x_batch and y_batch of the first next(), and are
+ * reallocated when the batch size changes. The source must not be used directly while it is wrapped.
+ * @tparam T numeric
+ */
+template <typename T>
+class PrefetchLoader : public DataLoader<T> {
+   public:
+    /** Wraps source.
+     * @param source loader to take the batches from; not owned
+     * @param n_buffers number of batches staged ahead, at least 1
+     */
+    PrefetchLoader(DataLoader<T> *source, unsigned int n_buffers = 2);
+    ~PrefetchLoader();
+
+    PrefetchLoader(const PrefetchLoader &) = delete;
+    PrefetchLoader &operator=(const PrefetchLoader &) = delete;
+
+    virtual void next(Tensor<T> *x_batch, Tensor<T> *y_batch);
+
+    /** Resets the source and starts staging the next epoch.
+     */
+    virtual void reset();
+
+    virtual void set_batch_size(unsigned int size);
+
+    /** @return unsigned int the number of staged batches that are ready right now
+     */
+    unsigned int get_queue_depth();
+
+    /** @return prefetch_stats_t
+     */
+    prefetch_stats_t get_stats();
+
+    void reset_stats();
+
+   protected:
+    /** the loading thread */
+    void produce();
+
+    /** allocates the staging ring like x_batch and y_batch and starts the loading thread */
+    void start(Tensor<T> *x_batch, Tensor<T> *y_batch);
+
+    /** joins the loading thread and frees the staging ring */
+    void stop();
+
+    void hand_over(Tensor<T> *staged, Tensor<T> *batch);
+
+    DataLoader<T> *source;
+    unsigned int n_buffers;
+
+    std::vector<Tensor<T> *> x_slots;
+    std::vector<Tensor<T> *> y_slots;
+    std::deque<unsigned int> ready;      /* filled slots, oldest first */
+    std::deque<unsigned int> free_slots; /* slots the thread may fill */
+
+    unsigned int produced; /* batches of this epoch loaded by the thread */
+    unsigned int consumed; /* batches of this epoch handed out */
+    bool running;
+    bool paused;
+    bool busy; /* the thread is in source->next */
+    bool stopping;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    prefetch_stats_t stats;
+    unsigned long queue_depth_sum;
+
+#if defined(MAGMADNN_HAVE_CUDA)
+    int device; /* the thread loads on the device that was current at start */
+#endif
+};
+
+}  // namespace dataloader
+}  // namespace magmadnn
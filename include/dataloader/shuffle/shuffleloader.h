@@ -0,0 +1,100 @@
+/**
+ * @file shuffleloader.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#include <random>
+#include <vector>
+
+#include "dataloader/dataloader.h"
+
+namespace magmadnn {
+namespace dataloader {
+
+/** Loads batches of samples in a new random order every epoch.
+ *
+ * Each reset draws a permutation of all samples, and next() gathers the rows it selects into the batch. The gather
+ * copies whole sample rows in parallel. When x lives on the host it writes straight into a HOST batch, or into a host
+ * staging batch that is then copied over in one transfer. When x is on the device it copies row by row on the device.
+ *
+ * If the number of samples is not a multiple of the batch size, the remaining samples form a last, partial batch.
+ * Its rows past get_last_batch_count() are padded with the first samples of the epoch's order, so that the batch
+ * tensor is always full. With drop_last the partial batch is skipped instead, as LinearLoader does.
+ * @tparam T numeric
+ */
+template <typename T>
+class ShuffleLoader : public DataLoader<T> {
+   public:
+    /** Shuffles with a seed drawn from std::random_device.
+     * @param x input features
+     * @param y output labels
+     * @param batch_size
+     * @param drop_last skip the last batch if it would be partial
+     */
+    ShuffleLoader(Tensor<T> *x, Tensor<T> *y, unsigned int batch_size, bool drop_last = false);
+
+    /** Shuffles reproducibly: the same seed gives the same sequence of epochs.
+     * @param x input features
+     * @param y output labels
+     * @param batch_size
+     * @param seed
+     * @param drop_last skip the last batch if it would be partial
+     */
+    ShuffleLoader(Tensor<T> *x, Tensor<T> *y, unsigned int batch_size, unsigned int seed, bool drop_last = false);
+
+    ~ShuffleLoader();
+
+    ShuffleLoader(const ShuffleLoader &) = delete;
+    ShuffleLoader &operator=(const ShuffleLoader &) = delete;
+
+    virtual void next(Tensor<T> *x_batch, Tensor<T> *y_batch);
+
+    /** Draws the order of the next epoch.
+     */
+    virtual void reset();
+
+    virtual void set_batch_size(unsigned int size);
+
+    /** Reseeds the generator and draws a new order, starting over from the first batch.
+     * @param seed
+     */
+    void set_seed(unsigned int seed);
+
+    /** Number of real samples in the batch last returned by next(); less than the batch size only for a partial
+     * batch.
+     * @return unsigned int
+     */
+    unsigned int get_last_batch_count() const { return last_batch_count; }
+
+    /** The sample order of the current epoch.
+     * @return const std::vector<unsigned int>&
+     */
+    const std::vector<unsigned int> &get_permutation() const { return permutation; }
+
+   protected:
+    void init(unsigned int seed);
+
+    /** number of batches for the current batch size, counting a partial one unless drop_last */
+    void count_batches();
+
+    /** copies row rows[i] of src (of sample_size elements) into row i of dst */
+    void gather(Tensor<T> *src, unsigned int sample_size, Tensor<T> *dst, Tensor<T> *&staging);
+
+    std::mt19937 generator;
+    std::vector<unsigned int> permutation;
+    std::vector<unsigned int> rows; /* samples of the batch being gathered */
+    unsigned int curr_index;
+    unsigned int last_batch_count;
+    bool drop_last;
+
+    /* where a batch is assembled before a single copy into a batch on another memory type */
+    Tensor<T> *x_staging;
+    Tensor<T> *y_staging;
+};
+
+}  // namespace dataloader
+}  // namespace magmadnn
@@ -20,7 +20,13 @@ enum activation_t { SIGMOID, TANH, RELU, SOFTMAX };
 template <typename T>
 class ActivationLayer : public Layer<T> {
    public:
-    ActivationLayer(op::Operation<T> *input, activation_t activation_func);
+    /**
+     * @param input
+     * @param activation_func
+     * @param fuse whether a fully connected layer feeding only this activation is fused with it into one
+     * FusedDenseOp. @see op::fuse_dense_activation
+     */
+    ActivationLayer(op::Operation<T> *input, activation_t activation_func, bool fuse = true);
     ~ActivationLayer();
 
     virtual std::vector<op::Operation<T> *> get_weights();
@@ -30,10 +36,11 @@ class ActivationLayer : public Layer<T> {
 
     /* TODO add custom activation function */
     activation_t activation_func;
+    bool fuse;
 };
 
 template <typename T>
-ActivationLayer<T> *activation(op::Operation<T> *input, activation_t activation_func);
+ActivationLayer<T> *activation(op::Operation<T> *input, activation_t activation_func, bool fuse = true);
 
 }  // namespace layer
 }  // namespace magmadnn
\ No newline at end of file
@@ -26,9 +26,11 @@
 #endif
 #include "magmadnn/exec_context.h"
 #include "magmadnn/init_finalize.h"
+#include "magmadnn/parallel.h"
 #include "magmadnn/types.h"
 #include "magmadnn/utilities_internal.h"
 
+#include "magmadnn/data/BinaryDataset.h"
 #include "magmadnn/data/CIFAR10.h"
 #include "magmadnn/data/CIFAR100.h"
 #include "magmadnn/data/Dataset.h"
@@ -38,6 +40,7 @@
 #include "magmadnn/exception.h"
 #include "magmadnn/exception_helpers.h"
 
+#include "memory/caching_allocator.h"
 #include "memory/memorymanager.h"
 #include "tensor/tensor.h"
 #include "tensor/tensor_io.h"
@@ -45,6 +48,7 @@
 #include "math/tensor_math.h"
 
 #include "compute/gradients.h"
+#include "compute/memory_planner.h"
 #include "compute/tensor_operations.h"
 #include "compute/variable.h"
 
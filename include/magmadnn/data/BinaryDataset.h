@@ -0,0 +1,169 @@
+/**
+ * @file BinaryDataset.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "magmadnn/types.h"
+#include "tensor/tensor.h"
+
+namespace magmadnn {
+namespace data {
+
+/* Element type of the samples in a binary dataset file */
+enum binary_dtype_t { BINARY_UINT8 = 0, BINARY_FLOAT16 = 1, BINARY_FLOAT32 = 2 };
+
+/* Binary dataset file layout, little endian:
+   the header below, the samples (n_samples x prod(shape) elements of dtype) at data_offset, then one uint32_t class
+   index per sample at labels_offset. Both offsets are multiples of 64. A stored value v stands for
+   v * scale + shift. */
+struct binary_dataset_header_t {
+    char magic[8]; /* "MDNNDATA" */
+    uint32_t version;
+    uint32_t dtype;
+    uint64_t n_samples;
+    uint32_t n_dims; /* dimensions of one sample, at most 4 */
+    uint32_t shape[4];
+    uint32_t n_classes;
+    float scale;
+    float shift;
+    uint64_t data_offset;
+    uint64_t labels_offset;
+};
+
+/** Writes a binary dataset from raw samples.
+ * @param file_name
+ * @param samples n_samples samples of the given shape, stored as dtype
+ * @param dtype
+ * @param sample_shape shape of one sample (at most 4 dimensions)
+ * @param labels class index of each sample
+ * @param n_samples
+ * @param n_classes
+ * @param scale value of one unit of the stored samples
+ * @param shift value of a stored 0
+ * @return magmadnn_error_t 0 on success
+ */
+magmadnn_error_t write_binary_dataset(const std::string& file_name, const void* samples, binary_dtype_t dtype,
+                                      const std::vector<uint32_t>& sample_shape, const uint32_t* labels,
+                                      uint64_t n_samples, uint32_t n_classes, float scale = 1.0f, float shift = 0.0f);
+
+/** Writes the samples x and labels y as a binary dataset. Values are stored as (value - shift) / scale in dtype,
+ * which is rounded and clamped for BINARY_UINT8.
+ * @param file_name
+ * @param x samples; the first axis indexes them
+ * @param y one hot labels {n_samples, n_classes}, or class indices {n_samples} / {n_samples, 1}
+ * @param dtype
+ * @param scale
+ * @param shift
+ * @return magmadnn_error_t 0 on success
+ */
+template <typename T>
+magmadnn_error_t write_binary_dataset(const std::string& file_name, Tensor<T>* x, Tensor<T>* y, binary_dtype_t dtype,
+                                      float scale = 1.0f, float shift = 0.0f);
+
+/** A binary dataset file mapped into memory.
+ *
+ * Opening maps the file and reads nothing else, so it takes the same time for any size. Samples are paged in by the
+ * OS as batches touch them, which lets datasets larger than RAM be used through the page cache. A batch is either a
+ * zero-copy view of the mapping (float32 data read as float, without scale or shift), or filled by one conversion
+ * pass over the selected samples.
+ * @tparam T numeric
+ */
+template <typename T>
+class BinaryDataset {
+   public:
+    /** Maps file_name. Check is_open() for errors.
+     * @param file_name
+     */
+    explicit BinaryDataset(const std::string& file_name);
+    ~BinaryDataset();
+
+    BinaryDataset(const BinaryDataset&) = delete;
+    BinaryDataset& operator=(const BinaryDataset&) = delete;
+
+    bool is_open() const { return this->base != NULL; }
+
+    uint64_t n_samples() const { return this->header.n_samples; }
+
+    uint32_t n_classes() const { return this->header.n_classes; }
+
+    binary_dtype_t dtype() const { return (binary_dtype_t) this->header.dtype; }
+
+    /** Shape of one sample
+     * @return const std::vector<unsigned int>&
+     */
+    const std::vector<unsigned int>& sample_shape() const { return this->shape; }
+
+    /** Elements in one sample
+     * @return unsigned int
+     */
+    unsigned int sample_size() const { return this->sample_elements; }
+
+    /** Class index of sample idx
+     * @param idx
+     * @return uint32_t
+     */
+    uint32_t label(uint64_t idx) const { return this->labels[idx]; }
+
+    /** Whether view() works for this file and T.
+     * @return bool
+     */
+    bool can_view() const;
+
+    /** A HOST tensor {count, sample_shape...} that reads samples [begin, begin + count) straight from the mapping. It
+     * must not be written to, and must be deleted before the dataset.
+     * @param begin
+     * @param count
+     * @return Tensor<T>* NULL unless can_view()
+     */
+    Tensor<T>* view(uint64_t begin, unsigned int count);
+
+    /** Fills x_batch with the samples at indices, converted to T, and y_batch with their labels. y_batch is one hot
+     * if it has n_classes() values per sample, and holds class indices otherwise. Batches not on the HOST are
+     * filled through a host staging batch and one copy.
+     * @param indices
+     * @param count
+     * @param x_batch at least count samples
+     * @param y_batch at least count labels, or NULL
+     * @return magmadnn_error_t 0 on success
+     */
+    magmadnn_error_t load_batch(const unsigned int* indices, unsigned int count, Tensor<T>* x_batch,
+                                Tensor<T>* y_batch);
+
+    /** load_batch for the samples [begin, begin + count)
+     */
+    magmadnn_error_t load_range(uint64_t begin, unsigned int count, Tensor<T>* x_batch, Tensor<T>* y_batch);
+
+    /** Hints the OS whether samples will be read in order (read ahead) or at random (no read ahead).
+     * @param random
+     */
+    void advise(bool random);
+
+   protected:
+    /* sample_at(i) is the i-th sample to convert */
+    template <typename F>
+    magmadnn_error_t load(F sample_at, unsigned int count, Tensor<T>* x_batch, Tensor<T>* y_batch);
+
+    binary_dataset_header_t header;
+    std::vector<unsigned int> shape;
+    unsigned int sample_elements;
+    std::size_t sample_bytes;
+
+    void* base; /* the mapping */
+    std::size_t mapped_bytes;
+    const unsigned char* samples;
+    const uint32_t* labels;
+
+    Tensor<T>* x_staging;
+    Tensor<T>* y_staging;
+};
+
+}  // namespace data
+}  // namespace magmadnn
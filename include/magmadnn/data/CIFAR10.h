@@ -1,6 +1,7 @@
 #pragma once
 
 #include "magmadnn/data/Dataset.h"
+#include "magmadnn/data/utils.h"
 #include "magmadnn/exception.h"
 
 namespace magmadnn {
@@ -11,7 +12,8 @@ class CIFAR10 : public Dataset<T> {
    public:
     explicit CIFAR10(std::string const& root, dataset_type type) : CIFAR10(root, type, 1) {}
 
-    explicit CIFAR10(std::string const& root, dataset_type type, uint32_t batch_idx);
+    explicit CIFAR10(std::string const& root, dataset_type type, uint32_t batch_idx,
+                     const pixel_normalization_t& norm = pixel_normalization_t());
 };
 
 }  // namespace data
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "magmadnn/data/Dataset.h"
+#include "magmadnn/data/utils.h"
 #include "magmadnn/exception.h"
 
 namespace magmadnn {
@@ -9,7 +10,8 @@ namespace data {
 template <typename T>
 class CIFAR100 : public Dataset<T> {
    public:
-    explicit CIFAR100(std::string const& root, dataset_type type);
+    explicit CIFAR100(std::string const& root, dataset_type type,
+                      const pixel_normalization_t& norm = pixel_normalization_t());
 
     /* Return the number of classes for this dataset
      */
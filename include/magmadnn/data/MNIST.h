@@ -1,6 +1,7 @@
 #pragma once
 
 #include "magmadnn/data/Dataset.h"
+#include "magmadnn/data/utils.h"
 #include "magmadnn/types.h"
 #include "tensor/tensor.h"
 
@@ -10,7 +11,8 @@ namespace data {
 template <typename T>
 class MNIST : public Dataset<T> {
    public:
-    explicit MNIST(std::string const& root, dataset_type type);
+    explicit MNIST(std::string const& root, dataset_type type,
+                   const pixel_normalization_t& norm = pixel_normalization_t());
 
     // Print image index `idx` from the dataset
     void print_image(uint32_t idx);
@@ -1,17 +1,50 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include "tensor/tensor.h"
 
 namespace magmadnn {
 namespace data {
 
+/* Normalization of 8 bit pixels to value = (pixel - mean) / std, in pixel units. Give one mean and std for every
+   channel, or one per channel. The default maps [0, 255] to [-1, 1). */
+struct pixel_normalization_t {
+    std::vector<float> mean;
+    std::vector<float> std;
+
+    pixel_normalization_t() : mean(1, 128.0f), std(1, 128.0f) {}
+    pixel_normalization_t(const std::vector<float>& mean, const std::vector<float>& std) : mean(mean), std(std) {}
+};
+
+/** Converts n_images images of n_channels planes of channel_size pixels to normalized floats, in parallel across
+ * images.
+ * @param src first image
+ * @param src_stride bytes from one image to the next in src
+ * @param dst n_images dense images
+ * @param n_images
+ * @param n_channels
+ * @param channel_size
+ * @param norm
+ * @return magmadnn_error_t 0 on success
+ */
+magmadnn_error_t normalize_pixels(const uint8_t* src, std::size_t src_stride, float* dst, uint32_t n_images,
+                                  uint32_t n_channels, uint32_t channel_size,
+                                  const pixel_normalization_t& norm = pixel_normalization_t());
+
 // MNIST
 
 magmadnn::Tensor<float>* read_mnist_images(const char* file_name, uint32_t& n_images, uint32_t& n_rows,
-                                           uint32_t& n_cols);
+                                           uint32_t& n_cols,
+                                           const pixel_normalization_t& norm = pixel_normalization_t());
 
 magmadnn::Tensor<float>* read_mnist_labels(const char* file_name, uint32_t& n_labels, uint32_t n_classes);
 
+/* One class index per label instead of one-hot rows, for SPARSE_CROSS_ENTROPY */
+magmadnn::Tensor<float>* read_mnist_label_indices(const char* file_name, uint32_t& n_labels);
+
 template <typename T>
 void mnist_print_image(uint32_t image_idx, magmadnn::Tensor<T>* images, magmadnn::Tensor<T>* labels, uint32_t n_rows,
                        uint32_t n_cols);
@@ -21,39 +54,44 @@ void mnist_print_image(uint32_t image_idx, magmadnn::Tensor<T>* images, magmadnn
 magmadnn::magmadnn_error_t read_cifar100(const std::string& file_name, magmadnn::Tensor<float>** data,
                                          magmadnn::Tensor<float>** labels, uint32_t n_images, uint32_t& image_width,
                                          uint32_t& image_height, uint32_t& n_channels, uint32_t& n_classes,
-                                         uint32_t& n_super_classes /*, bool normalize = true*/);
+                                         uint32_t& n_super_classes,
+                                         const pixel_normalization_t& norm = pixel_normalization_t());
 
 magmadnn::magmadnn_error_t read_cifar100_train(const std::string& file_name, magmadnn::Tensor<float>** data,
                                                magmadnn::Tensor<float>** labels, uint32_t& n_images,
                                                uint32_t& image_width, uint32_t& image_height, uint32_t& n_channels,
-                                               uint32_t& n_classes,
-                                               uint32_t& n_super_classes /*, bool normalize = true*/);
+                                               uint32_t& n_classes, uint32_t& n_super_classes,
+                                               const pixel_normalization_t& norm = pixel_normalization_t());
 
 magmadnn::magmadnn_error_t read_cifar100_test(const std::string& file_name, magmadnn::Tensor<float>** data,
                                               magmadnn::Tensor<float>** labels, uint32_t& n_images,
                                               uint32_t& image_width, uint32_t& image_height, uint32_t& n_channels,
-                                              uint32_t& n_classes,
-                                              uint32_t& n_super_classes /*, bool normalize = true*/);
+                                              uint32_t& n_classes, uint32_t& n_super_classes,
+                                              const pixel_normalization_t& norm = pixel_normalization_t());
 
 magmadnn::magmadnn_error_t load_cifar100(const std::string& cifar_root, magmadnn::Tensor<float>** data,
                                          magmadnn::Tensor<float>** labels, uint32_t& n_images, uint32_t& image_width,
                                          uint32_t& image_height, uint32_t& n_channels, uint32_t& n_classes,
-                                         uint32_t& n_super_classes /*,
-                                                                     bool normalize = true*/
-);
+                                         uint32_t& n_super_classes,
+                                         const pixel_normalization_t& norm = pixel_normalization_t());
 
 magmadnn::magmadnn_error_t read_cifar10(const std::string& file_name, magmadnn::Tensor<float>** data,
                                         magmadnn::Tensor<float>** labels, uint32_t& n_images, uint32_t& image_width,
-                                        uint32_t& image_height, uint32_t& n_channels,
-                                        uint32_t& n_classes /*, bool normalize*/);
-
-magmadnn::magmadnn_error_t load_cifar10_batch(
-      uint32_t batch_idx, const std::string& cifar_root,
-      magmadnn::Tensor<float>** data,
-      magmadnn::Tensor<float>** labels,
-      uint32_t& n_images, uint32_t& image_width,
-      uint32_t& image_height, uint32_t& n_channels, uint32_t& n_classes/*,
-                                                                         bool normalize*/);
+                                        uint32_t& image_height, uint32_t& n_channels, uint32_t& n_classes,
+                                        const pixel_normalization_t& norm = pixel_normalization_t());
+
+magmadnn::magmadnn_error_t load_cifar10_batch(uint32_t batch_idx, const std::string& cifar_root,
+                                              magmadnn::Tensor<float>** data, magmadnn::Tensor<float>** labels,
+                                              uint32_t& n_images, uint32_t& image_width, uint32_t& image_height,
+                                              uint32_t& n_channels, uint32_t& n_classes,
+                                              const pixel_normalization_t& norm = pixel_normalization_t());
+
+/* All five training batches, data_batch_1.bin to data_batch_5.bin, as one set of 50000 images */
+magmadnn::magmadnn_error_t load_cifar10_train(const std::string& cifar_root, magmadnn::Tensor<float>** data,
+                                              magmadnn::Tensor<float>** labels, uint32_t& n_images,
+                                              uint32_t& image_width, uint32_t& image_height, uint32_t& n_channels,
+                                              uint32_t& n_classes,
+                                              const pixel_normalization_t& norm = pixel_normalization_t());
 
 }  // namespace data
 }  // namespace magmadnn
@@ -22,9 +22,11 @@
 namespace magmadnn {
 
 /** Should be called at the start of every program.
+ * @param n_threads number of threads used by the HOST kernels; <= 0 uses MAGMADNN_NUM_THREADS or the OpenMP
+ * default. Has no effect without OpenMP.
  * @return magmadnn_error_t
  */
-magmadnn_error_t magmadnn_init();
+magmadnn_error_t magmadnn_init(int n_threads = 0);
 
 /** Cleanup. Should be called at the end of every program.
  * @return magmadnn_error_t
@@ -1,12 +1,19 @@
 #pragma once
 
 #include "magmadnn/optimizer/FMinSolver.h"
+#include "magmadnn/optimizer/GradBucketReducer.h"
+#include "magmadnn/optimizer/GradCompressor.h"
+#include "magmadnn/optimizer/MomentumSGD.h"
+#include "magmadnn/optimizer/MpiDatatype.h"
+#include "magmadnn/optimizer/ShardedOptimizer.h"
 #include "magmadnn/optimizer/TrainStats.h"
-
-#include <random>
+#include "tensor/flat_buffer.h"
 
 #include <mpi.h>
 
+#include <cmath>
+#include <vector>
+
 namespace magmadnn {
 namespace solver {
 
@@ -16,29 +23,119 @@ class DistMomentumSGD : public magmadnn::solver::FMinSolver<T> {
     // Momentum SGD itereration (synchronous)
     using SgdIter = MomentumSgdIter<T, false>;
 
-    DistMomentumSGD() : sgd_iter(), rank_(-1), nnodes_(-1) {
+    DistMomentumSGD()
+        : sgd_iter(),
+          rank_(-1),
+          nnodes_(-1),
+          compressor_(nullptr),
+          local_steps_(1),
+          adaptive_(false),
+          average_momentum_(false),
+          current_local_steps_(1),
+          averaging_rounds_(0),
+          sharded_(false) {
         MPI_Comm_size(MPI_COMM_WORLD, &this->nnodes_);
         MPI_Comm_rank(MPI_COMM_WORLD, &this->rank_);
     }
 
-    DistMomentumSGD(T learning_rate, T momentum) : sgd_iter(learning_rate, momentum), rank_(-1), nnodes_(-1) {
+    DistMomentumSGD(T learning_rate, T momentum)
+        : sgd_iter(learning_rate, momentum),
+          rank_(-1),
+          nnodes_(-1),
+          compressor_(nullptr),
+          local_steps_(1),
+          adaptive_(false),
+          average_momentum_(false),
+          current_local_steps_(1),
+          averaging_rounds_(0),
+          sharded_(false) {
         MPI_Comm_size(MPI_COMM_WORLD, &this->nnodes_);
         MPI_Comm_rank(MPI_COMM_WORLD, &this->rank_);
     }
 
+    ~DistMomentumSGD() { this->clear_average_views(); }
+
+    DistMomentumSGD(const DistMomentumSGD &) = delete;
+    DistMomentumSGD &operator=(const DistMomentumSGD &) = delete;
+
+    // Size in bytes of the gradient buckets that min() reduces while the backward pass runs
+    void set_bucket_size(std::size_t bucket_bytes) { this->reducer_.set_bucket_size(bucket_bytes); }
+
+    // Reducer used by min(), with the timeline of its last iteration
+    GradBucketReducer<T> const &grad_reducer() const { return this->reducer_; }
+
+    // Compressor the gradients are reduced with, not owned; nullptr (the default) reduces them in full precision.
+    // With a compressor, min() reduces the gradients after the backward pass instead of overlapping with it.
+    void set_compressor(GradCompressor<T> *compressor) { this->compressor_ = compressor; }
+    GradCompressor<T> *compressor() const { return this->compressor_; }
+
+    // Local SGD: every process takes local_steps steps with its own gradients, and then the parameters are averaged
+    // over the processes with a single allreduce. 1 (the default) sums the gradients of every step instead. With
+    // adaptive, local_steps is the number of steps of the first round, and later rounds get shorter as the loss
+    // decreases: local_steps * sqrt(loss / first loss), at least 1.
+    void set_local_steps(unsigned int local_steps, bool adaptive = false) {
+        this->local_steps_ = (local_steps > 0) ? local_steps : 1;
+        this->adaptive_ = adaptive;
+    }
+
+    // Number of local steps of the current round
+    unsigned int local_steps() const { return this->current_local_steps_; }
+
+    // Whether local SGD averages the momentum along with the parameters. Defaults to false.
+    void set_average_momentum(bool average_momentum) { this->average_momentum_ = average_momentum; }
+
+    // Number of times min() averaged the parameters in local SGD
+    unsigned int num_averaging_rounds() const { return this->averaging_rounds_; }
+
+    // Sharded mode: the momentum is partitioned over the processes, each of which updates only its shard of the
+    // parameters with the reduce-scattered gradients before the parameters are allgathered (see ShardedOptimizer).
+    // Applies to synchronous training, i.e. without local SGD, and replaces the gradient compressor. Without HOST
+    // flat buffers (nn_params_t::flat_buffers) every process also stages the whole model, which min() reports.
+    void set_sharded(bool sharded) { this->sharded_ = sharded; }
+    bool sharded() const { return this->sharded_; }
+
     void grad_reduce(std::vector<op::Operation<T> *> const &weights, op::GradTable<T> &grad_table) {
-        for (auto w = weights.begin(); w != weights.end(); ++w) {
-            op::Operation<T> *var = *w;
+        for (unsigned int i = 0; i < weights.size(); i++) {
+            Tensor<T> *grad = grad_table.get(weights[i]);
+
+            this->allreduce(grad, i);
+        }
+    }
+
+    // Reduce the gradients of the model with a single allreduce when they are in its flat gradient buffer
+    void grad_reduce(magmadnn::model::NeuralNetwork<T> &model, op::GradTable<T> &grad_table) {
+        std::vector<op::Operation<T> *> &weights = model.weights();
+        Tensor<T> *flat_grads = model.flat_gradients();
 
-            Tensor<T> *grad = grad_table.get(var);
+        bool in_place = (flat_grads != NULL);
+        if (in_place) {
+            std::vector<unsigned int> sizes, offsets;
+            for (op::Operation<T> *w : weights) sizes.push_back(w->get_output_tensor()->get_size());
+            FlatBuffer<T>::get_layout(sizes, &offsets);
 
-            // TODO use generic MPI types
-            MPI_Allreduce(MPI_IN_PLACE, grad->get_ptr(), grad->get_size(), MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
+            for (unsigned int i = 0; i < weights.size() && in_place; i++) {
+                Tensor<T> *grad = grad_table.get(weights[i]);
+                in_place = (grad != NULL && grad->get_ptr() == flat_grads->get_ptr() + offsets[i]);
+            }
         }
+
+        if (!in_place) {
+            this->grad_reduce(weights, grad_table);
+            return;
+        }
+
+        // a key of its own for the compressor, next to those of the separate gradients
+        this->allreduce(flat_grads, weights.size());
     }
 
     // Copy model parameters to every processes local model
     void model_bcast(magmadnn::model::NeuralNetwork<T> &model) {
+        Tensor<T> *flat_weights = model.flat_weights();
+        if (flat_weights != NULL) {
+            MPI_Bcast(flat_weights->get_ptr(), flat_weights->get_size(), mpi_datatype<T>(), 0, MPI_COMM_WORLD);
+            return;
+        }
+
         std::vector<layer::Layer<T> *> layers = model.get_layers();
 
         for (layer::Layer<T> *layer : layers) {
@@ -47,9 +144,62 @@ class DistMomentumSGD : public magmadnn::solver::FMinSolver<T> {
             for (magmadnn::op::Operation<T> *weight : weights) {
                 Tensor<T> *output_tensor = weight->get_output_tensor();
 
-                MPI_Bcast(output_tensor->get_ptr(), output_tensor->get_size(), MPI_FLOAT, 0, MPI_COMM_WORLD);
+                MPI_Bcast(output_tensor->get_ptr(), output_tensor->get_size(), mpi_datatype<T>(), 0, MPI_COMM_WORLD);
+            }
+        }
+    }
+
+    // Replaces the parameters of the model, and its momentum with set_average_momentum, by their mean over the
+    // processes, with a single allreduce. loss is the mean loss of this process since the last average and is
+    // averaged along.
+    void model_average(magmadnn::model::NeuralNetwork<T> &model, T &loss) {
+        std::vector<op::Operation<T> *> &weights = model.weights();
+        Tensor<T> *flat_weights = model.flat_weights();
+        T scale = static_cast<T>(1.0) / static_cast<T>(this->nnodes_);
+
+        // the flat parameter buffer is averaged in place; the loss then needs an allreduce of its own
+        if (flat_weights != NULL && flat_weights->get_memory_type() == HOST && !this->average_momentum_) {
+            T *ptr = flat_weights->get_ptr();
+            MPI_Allreduce(MPI_IN_PLACE, ptr, flat_weights->get_size(), mpi_datatype<T>(), MPI_SUM, MPI_COMM_WORLD);
+            for (unsigned int i = 0; i < flat_weights->get_size(); i++) ptr[i] *= scale;
+
+            if (this->adaptive_) {
+                MPI_Allreduce(MPI_IN_PLACE, &loss, 1, mpi_datatype<T>(), MPI_SUM, MPI_COMM_WORLD);
+                loss *= scale;
             }
+            return;
+        }
+
+        std::vector<Tensor<T> *> tensors;
+        for (op::Operation<T> *w : weights) tensors.push_back(w->get_output_tensor());
+        if (this->average_momentum_) {
+            std::vector<Tensor<T> *> momentum = this->sgd_iter.state_tensors(weights);
+            tensors.insert(tensors.end(), momentum.begin(), momentum.end());
         }
+
+        // everything packed into one host buffer, with the loss at the end
+        std::size_t count = 1;
+        for (Tensor<T> *t : tensors) count += t->get_size();
+        if (this->average_buffer_.size() != count || this->average_views_.size() != tensors.size()) {
+            this->clear_average_views();
+            this->average_buffer_.resize(count);
+
+            std::size_t offset = 0;
+            for (Tensor<T> *t : tensors) {
+                this->average_views_.push_back(
+                    new Tensor<T>(this->average_buffer_.data() + offset, {t->get_size()}, HOST));
+                offset += t->get_size();
+            }
+        }
+
+        for (unsigned int i = 0; i < tensors.size(); i++) this->average_views_[i]->copy_from(*tensors[i]);
+        this->average_buffer_[count - 1] = loss;
+
+        MPI_Allreduce(MPI_IN_PLACE, this->average_buffer_.data(), count, mpi_datatype<T>(), MPI_SUM, MPI_COMM_WORLD);
+        for (std::size_t i = 0; i < count; i++) this->average_buffer_[i] *= scale;
+
+        for (unsigned int i = 0; i < tensors.size(); i++) tensors[i]->copy_from(*this->average_views_[i]);
+        loss = this->average_buffer_[count - 1];
     }
 
     void min(
@@ -85,19 +235,14 @@ class DistMomentumSGD : public magmadnn::solver::FMinSolver<T> {
         std::vector<op::Operation<T> *> &weights = model.weights();
         op::Operation<T> *lossfun = model.lossfun();
 
-        // Initialize data loader with training set (samples and labels)
-        dataloader::LinearLoader<T> dataloader(&x, &y, batch_size);
-        unsigned int sample_size_x = x.get_size() / x.get_shape(0);
-        unsigned int sample_size_y = y.get_size() / y.get_shape(0);
-        unsigned int batch_mem_space_x = batch_size * sample_size_x;
-        unsigned int batch_mem_space_y = batch_size * sample_size_y;
+        // Initialize data loader with training set (samples and labels). Each rank draws its own sample order
+        // every epoch; partial batches are dropped since the batch tensors have a fixed size.
+        auto seed = this->rank_;
+        dataloader::ShuffleLoader<T> dataloader(&x, &y, batch_size, seed, true);
 
         // Number of batches
         auto num_batches = dataloader.get_num_batches();
-
-        auto seed = this->rank_;
-        std::default_random_engine generator(seed);
-        std::uniform_int_distribution<> distribution(0, num_batches - 1);
+        unsigned int batch_idx = 0;
 
         // GPU devid
         int devid = -1;
@@ -106,6 +251,7 @@ class DistMomentumSGD : public magmadnn::solver::FMinSolver<T> {
             std::cout << "[" << context << "] "
                       << "CPU training" << std::endl;
         } else {
+#if defined(MAGMADNN_HAVE_CUDA)
             int num_devices = -1;
             cudaError_t err;
             err = cudaGetDeviceCount(&num_devices);
@@ -116,6 +262,7 @@ class DistMomentumSGD : public magmadnn::solver::FMinSolver<T> {
                       << "GPU training (" << devid << ")" << std::endl;
             std::cout << "[" << context << "] "
                       << "Total number of devices = " << num_devices << std::endl;
+#endif
         }
 
         std::cout << "[" << context << "] "
@@ -161,6 +308,8 @@ class DistMomentumSGD : public magmadnn::solver::FMinSolver<T> {
 
         // global gradient
         op::GradTable<T> grad_table;
+        // Only the weight gradients are read back, the intermediate ones are freed during the backward pass
+        grad_table.get_executor().set_release_buffers(true);
         grad_table.clear();
         op::get_grad_table(weights, lossfun, grad_table);
 
@@ -172,17 +321,42 @@ class DistMomentumSGD : public magmadnn::solver::FMinSolver<T> {
         // Reset momentum
         sgd_iter.reset();
 
+        // Every process starts from the model of rank 0
+        this->model_bcast(model);
+
+        // Local SGD averages the parameters every few steps instead of reducing the gradients
+        bool local_sgd = (this->local_steps_ > 1 || this->adaptive_);
+        unsigned int steps_since_average = 0;
+        T round_loss = 0.0;
+        T first_loss = 0.0;
+        this->current_local_steps_ = this->local_steps_;
+        this->averaging_rounds_ = 0;
+
+        // Each process only keeps and updates its shard of the optimizer state
+        bool sharded = (!local_sgd && this->sharded_);
+        if (sharded) {
+            this->sharded_optim_.set_learning_rate(this->sgd_iter.learning_rate());
+            this->sharded_optim_.set_momentum(this->sgd_iter.momentum());
+            this->sharded_optim_.attach(model);
+        }
+
+        // Gradients are summed over the processes bucket by bucket as the backward pass completes them
+        bool overlap = (!local_sgd && !sharded && this->compressor_ == nullptr);
+        if (overlap) this->reducer_.attach(model, grad_table);
+        if (this->compressor_ != nullptr) this->compressor_->reset_stats();
+
         int iters = 0;
 
         while (iters < max_num_iters) {
             //
-            // Select a batch index randomly
+            // Load local model with the next shuffled batch, starting a new epoch when all have been seen
             //
-            int batch_idx = distribution(generator);
-
-            // Load local model with randomly selected batch
-            model.network_input_tensor()->copy_from(x, batch_idx * batch_mem_space_x, batch_mem_space_x);
-            model.ground_truth_tensor()->copy_from(y, batch_idx * batch_mem_space_y, batch_mem_space_y);
+            if (batch_idx == num_batches) {
+                dataloader.reset();
+                batch_idx = 0;
+            }
+            dataloader.next(model.network_input_tensor(), model.ground_truth_tensor());
+            ++batch_idx;
 
             //
             // Forward pass
@@ -191,11 +365,16 @@ class DistMomentumSGD : public magmadnn::solver::FMinSolver<T> {
 #if defined(MAGMADNN_HARNESS_HAVE_CUDA)
             cuda_exec_ctx.synchronize();
 #endif
+            if (local_sgd && this->adaptive_) {
+                lossfun->get_output_tensor()->get_memory_manager()->sync();
+                round_loss += lossfun->get_output_tensor()->get(0);
+            }
 
             //
             // Compute local gradient using local model which is a copy
             // of the "global" one on rank 0
             //
+            if (overlap) this->reducer_.start();
             grad_table.clear();
             magmadnn::op::get_grad_table(weights, lossfun, grad_table);
 #if defined(MAGMADNN_HARNESS_HAVE_CUDA)
@@ -203,15 +382,18 @@ class DistMomentumSGD : public magmadnn::solver::FMinSolver<T> {
 #endif
 
             // Reduce gradient computed on the different processes
-            this->grad_reduce(weights, grad_table);
-
-            // Perform SGD step
-            if (this->rank_ == 0) {
-                auto nnodes = this->nnodes_;
-                // Scaling factor for gradient step
-                // T scale = 1.0;
-                T scale = 1.0 / static_cast<T>(nnodes);
+            if (overlap) {
+                this->reducer_.finish();
+            } else if (!local_sgd && !sharded) {
+                this->grad_reduce(model, grad_table);
+            }
 
+            // Perform SGD step. Every process has the same summed gradient and takes the same step, so the models
+            // stay identical without broadcasting them; in local SGD it is this process's own gradient.
+            T scale = local_sgd ? static_cast<T>(1.0) : static_cast<T>(1.0) / static_cast<T>(this->nnodes_);
+            if (sharded) {
+                this->sharded_optim_.step(model, grad_table, scale);
+            } else {
 #if defined(MAGMADNN_HARNESS_HAVE_CUDA)
                 // Synchronous step, no need for barrier
                 sgd_iter.step(cuda_exec_ctx.stream(), weights, grad_table, scale);
@@ -221,10 +403,51 @@ class DistMomentumSGD : public magmadnn::solver::FMinSolver<T> {
 #endif
             }
 
-            // Send model to participating nodes
-            // this->model_bcast(model);
-
             ++iters;
+
+            if (local_sgd && ++steps_since_average == this->current_local_steps_) {
+                T loss = round_loss / static_cast<T>(steps_since_average);
+                this->model_average(model, loss);
+                this->averaging_rounds_++;
+
+                if (this->adaptive_ && this->averaging_rounds_ == 1) {
+                    first_loss = loss;
+                } else if (this->adaptive_ && first_loss > 0 && loss >= 0) {
+                    double h = std::ceil(this->local_steps_ * std::sqrt(static_cast<double>(loss / first_loss)));
+                    this->current_local_steps_ = (h < 1.0) ? 1 : (h > this->local_steps_) ? this->local_steps_ : h;
+                }
+
+                steps_since_average = 0;
+                round_loss = 0.0;
+            }
+        }
+
+        // the models of the processes end up the same
+        if (local_sgd && steps_since_average > 0) {
+            T loss = round_loss / static_cast<T>(steps_since_average);
+            this->model_average(model, loss);
+            this->averaging_rounds_++;
+        }
+
+        if (sharded && this->rank_ == 0) {
+            std::cout << "[" << context << "] "
+                      << "Sharded momentum: " << this->sharded_optim_.state_bytes() << " bytes per process, "
+                      << this->sharded_optim_.staging_bytes() << " of them staging, instead of "
+                      << this->sharded_optim_.size() * sizeof(T) << std::endl;
+        } else if (overlap) {
+            this->reducer_.detach();
+            if (this->rank_ == 0) {
+                this->reducer_.print_timeline(std::cout);
+                this->reducer_.print_summary(std::cout);
+            }
+        } else if (local_sgd && this->rank_ == 0) {
+            std::cout << "[" << context << "] "
+                      << "Local SGD: " << this->averaging_rounds_ << " parameter averages in " << iters
+                      << " iterations, last round of " << this->current_local_steps_ << " steps" << std::endl;
+        } else if (this->rank_ == 0) {
+            std::cout << "[" << context << "] "
+                      << "Gradient compression = " << this->compressor_->name()
+                      << ", ratio = " << this->compressor_->ratio() << std::endl;
         }
 
 #if defined(MAGMADNN_HARNESS_HAVE_CUDA)
@@ -236,9 +459,44 @@ class DistMomentumSGD : public magmadnn::solver::FMinSolver<T> {
     }
 
    private:
+    // Sums grad over the processes, through the compressor if there is one. Compressors work on host memory.
+    void allreduce(Tensor<T> *grad, unsigned int key) {
+        if (this->compressor_ == nullptr) {
+            MPI_Allreduce(MPI_IN_PLACE, grad->get_ptr(), grad->get_size(), mpi_datatype<T>(), MPI_SUM,
+                          MPI_COMM_WORLD);
+        } else if (grad->get_memory_type() == HOST) {
+            this->compressor_->allreduce(grad->get_ptr(), grad->get_size(), key, MPI_COMM_WORLD);
+        } else {
+            Tensor<T> host(grad->get_shape(), {NONE, {}}, HOST);
+            host.copy_from(*grad);
+            this->compressor_->allreduce(host.get_ptr(), host.get_size(), key, MPI_COMM_WORLD);
+            grad->copy_from(host);
+        }
+    }
+
+    void clear_average_views() {
+        for (Tensor<T> *view : this->average_views_) delete view;
+        this->average_views_.clear();
+    }
+
     int nnodes_;
     int rank_;
     SgdIter sgd_iter;
+    GradBucketReducer<T> reducer_;
+    GradCompressor<T> *compressor_;
+
+    // local SGD
+    unsigned int local_steps_;
+    bool adaptive_;
+    bool average_momentum_;
+    unsigned int current_local_steps_;
+    unsigned int averaging_rounds_;
+    std::vector<T> average_buffer_;
+    std::vector<Tensor<T> *> average_views_;  // one per averaged tensor, into average_buffer_
+
+    // sharded optimizer state
+    bool sharded_;
+    ShardedOptimizer<T> sharded_optim_;
 };
 
 }  // namespace solver
@@ -0,0 +1,429 @@
+#pragma once
+
+#include "magmadnn.h"
+#include "magmadnn/optimizer/MpiDatatype.h"
+#include "tensor/flat_buffer.h"
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <vector>
+
+namespace magmadnn {
+namespace solver {
+
+// Sums the gradients of a model over all the processes of a communicator while the backward pass is still running.
+//
+// The weights are grouped into buckets of about bucket_bytes bytes, in the order in which the backward pass
+// completes their gradients. As soon as the last gradient of a bucket is done, a non-blocking MPI_Iallreduce is
+// started on it, and the remaining backward pass runs while it is in flight. finish() then only waits for the buckets
+// that are not done yet. A bucket is reduced in place when its gradients are adjacent views of the model's HOST flat
+// gradient buffer (nn_params_t::flat_buffers), and is packed into a host staging buffer otherwise.
+//
+// Usage, for every iteration:
+//
+//     reducer.start();
+//     grad_table.clear();
+//     op::get_grad_table(model.weights(), model.lossfun(), grad_table);
+//     reducer.finish();
+//
+// after attach(model, grad_table) was called once. The reducer is hooked into the grad table's BackwardExecutor
+// until detach().
+template <typename T>
+class GradBucketReducer {
+   public:
+    // Times of one bucket in one iteration, in seconds since start()
+    struct BucketTiming {
+        unsigned int num_grads;
+        std::size_t bytes;
+        bool in_place;
+        double launch;    // all its gradients were done and the allreduce was started
+        double complete;  // the allreduce was seen to be done
+    };
+
+    // Timeline of one iteration, in seconds since start()
+    struct Timeline {
+        double backward_end;  // get_grad_table returned and finish() was called
+        double wait_end;      // finish() returned
+        std::vector<BucketTiming> buckets;
+
+        // Seconds between the start of the first allreduce and the end of the last one
+        double communication() const {
+            if (buckets.empty()) return 0.0;
+            return last_complete() - first_launch();
+        }
+
+        // Seconds of that window during which the backward pass was still running
+        double overlapped() const {
+            if (buckets.empty()) return 0.0;
+            double end = (last_complete() < backward_end) ? last_complete() : backward_end;
+            return (end > first_launch()) ? end - first_launch() : 0.0;
+        }
+
+        double first_launch() const {
+            double first = buckets[0].launch;
+            for (const BucketTiming &b : buckets) first = (b.launch < first) ? b.launch : first;
+            return first;
+        }
+
+        double last_complete() const {
+            double last = buckets[0].complete;
+            for (const BucketTiming &b : buckets) last = (b.complete > last) ? b.complete : last;
+            return last;
+        }
+    };
+
+    explicit GradBucketReducer(std::size_t bucket_bytes = 1 << 19, MPI_Comm comm = MPI_COMM_WORLD)
+        : bucket_bytes_(bucket_bytes),
+          comm_(comm),
+          grad_table_(NULL),
+          flat_grads_(NULL),
+          timeline_(),
+          start_time_(0.0),
+          iters_(0),
+          total_backward_(0.0),
+          total_wait_(0.0),
+          total_overlapped_(0.0),
+          total_communication_(0.0) {}
+
+    ~GradBucketReducer() { this->clear_buckets(); }
+
+    GradBucketReducer(const GradBucketReducer &) = delete;
+    GradBucketReducer &operator=(const GradBucketReducer &) = delete;
+
+    // Size in bytes a bucket is filled up to before it is closed; 0 gives every gradient its own bucket. Takes
+    // effect at the next attach().
+    void set_bucket_size(std::size_t bucket_bytes) { this->bucket_bytes_ = bucket_bytes; }
+    std::size_t get_bucket_size() const { return this->bucket_bytes_; }
+
+    unsigned int get_num_buckets() const { return this->buckets_.size(); }
+
+    // Builds the buckets for the weights of model and hooks into the executor of grad_table. Returns non-zero if
+    // the backward pass of the model cannot be scheduled.
+    magmadnn_error_t attach(magmadnn::model::NeuralNetwork<T> &model, op::GradTable<T> &grad_table) {
+        std::vector<op::Operation<T> *> &weights = model.weights();
+        op::BackwardExecutor<T> &executor = grad_table.get_executor();
+
+        this->detach();
+        this->clear_buckets();
+
+        magmadnn_error_t err = executor.prepare(weights, model.lossfun());
+        if (err != 0) return err;
+
+        std::map<op::Operation<T> *, unsigned int> index;
+        std::vector<unsigned int> sizes;
+        for (unsigned int i = 0; i < weights.size(); i++) {
+            index[weights[i]] = i;
+            sizes.push_back(weights[i]->get_output_tensor()->get_size());
+        }
+
+        // place of each gradient in the flat gradient buffer
+        this->flat_grads_ = (model.flat_gradients() != NULL && model.flat_gradients()->get_memory_type() == HOST)
+                                ? model.flat_gradients()
+                                : NULL;
+        FlatBuffer<T>::get_layout(sizes, &this->flat_offsets_);
+
+        // fill the buckets in the order the gradients are done
+        const std::vector<op::Operation<T> *> &order = executor.get_order();
+        Bucket *bucket = NULL;
+        for (unsigned int n = 0; n < order.size(); n++) {
+            typename std::map<op::Operation<T> *, unsigned int>::iterator it = index.find(order[n]);
+            if (it == index.end()) continue;
+
+            if (bucket == NULL) {
+                this->buckets_.push_back(new Bucket());
+                bucket = this->buckets_.back();
+            }
+
+            this->slots_[order[n]] = {(unsigned int) this->buckets_.size() - 1, (unsigned int) bucket->weights.size()};
+            bucket->weights.push_back(it->second);
+            bucket->count += sizes[it->second];
+            // its gradient is still read by the rest of the backward pass
+            if (!order[n]->get_inputs().empty()) bucket->deferred = true;
+
+            if (bucket->count * sizeof(T) < this->bucket_bytes_) continue;
+
+            // with a flat gradient buffer, a full bucket takes more gradients until it is one span of it
+            unsigned int lo = bucket->weights[0], hi = bucket->weights[0];
+            for (unsigned int i : bucket->weights) {
+                lo = (i < lo) ? i : lo;
+                hi = (i > hi) ? i : hi;
+            }
+            if (this->flat_grads_ == NULL || hi - lo + 1 == bucket->weights.size()) bucket = NULL;
+        }
+
+        for (Bucket *b : this->buckets_) {
+            b->grads.assign(b->weights.size(), NULL);
+            b->offsets.assign(b->weights.size(), 0);
+            unsigned int offset = 0;
+            for (unsigned int k = 0; k < b->weights.size(); k++) {
+                b->offsets[k] = offset;
+                offset += sizes[b->weights[k]];
+            }
+        }
+
+        this->weights_ = weights;
+        this->grad_table_ = &grad_table;
+        executor.set_grad_ready_callback(
+            [this](op::Operation<T> *var, Tensor<T> *grad) { this->on_grad_ready(var, grad); });
+
+        return (magmadnn_error_t) 0;
+    }
+
+    // Unhooks from the executor. Has to be called before the grad table or the reducer are destroyed.
+    void detach() {
+        if (this->grad_table_ == NULL) return;
+        this->grad_table_->get_executor().set_grad_ready_callback(
+            std::function<void(op::Operation<T> *, Tensor<T> *)>());
+        this->grad_table_ = NULL;
+    }
+
+    // Marks the beginning of the backward pass of an iteration
+    void start() {
+        for (Bucket *b : this->buckets_) {
+            b->pending = b->weights.size();
+            b->launched = false;
+            b->done = false;
+            b->launch_time = 0.0;
+            b->complete_time = 0.0;
+            for (unsigned int k = 0; k < b->grads.size(); k++) b->grads[k] = NULL;
+        }
+        this->start_time_ = MPI_Wtime();
+    }
+
+    // Starts the buckets that were not started during the backward pass, waits for all of them and puts the sums
+    // into the gradients of the grad table
+    void finish() {
+        double backward_end = MPI_Wtime();
+
+        for (Bucket *b : this->buckets_) {
+            if (b->launched) continue;
+
+            // gradients that did not go through the callback
+            for (unsigned int k = 0; k < b->weights.size(); k++) {
+                if (b->grads[k] == NULL) b->grads[k] = this->grad_table_->get(this->weights_[b->weights[k]]);
+            }
+            this->launch(*b);
+        }
+
+        for (Bucket *b : this->buckets_) {
+            if (!b->done) {
+                MPI_Wait(&b->request, MPI_STATUS_IGNORE);
+                b->done = true;
+                b->complete_time = MPI_Wtime();
+            }
+            if (b->staged) {
+                for (unsigned int k = 0; k < b->grads.size(); k++) {
+                    if (b->grads[k] != NULL) b->grads[k]->copy_from(*b->views[k]);
+                }
+            }
+        }
+
+        this->record(backward_end, MPI_Wtime());
+    }
+
+    // Timeline of the last iteration
+    const Timeline &get_timeline() const { return this->timeline_; }
+
+    // Prints the timeline of the last iteration: when each bucket was started and done relative to the end of the
+    // backward pass
+    void print_timeline(std::ostream &os) const {
+        const Timeline &t = this->timeline_;
+
+        os << std::fixed << std::setprecision(3);
+        os << "bucket  grads        bytes  in place  launch (ms)  done (ms)" << std::endl;
+        for (unsigned int i = 0; i < t.buckets.size(); i++) {
+            const BucketTiming &b = t.buckets[i];
+            os << std::setw(6) << i << std::setw(7) << b.num_grads << std::setw(13) << b.bytes << std::setw(10)
+               << (b.in_place ? "yes" : "no") << std::setw(13) << 1e3 * b.launch << std::setw(11)
+               << 1e3 * b.complete << std::endl;
+        }
+        os << "backward pass done at " << 1e3 * t.backward_end << " ms, allreduces done at " << 1e3 * t.wait_end
+           << " ms" << std::endl;
+    }
+
+    // Prints the overlap over all iterations since the last attach()
+    void print_summary(std::ostream &os) const {
+        double overlap = (this->total_communication_ > 0.0) ? this->total_overlapped_ / this->total_communication_
+                                                               : 0.0;
+
+        os << std::fixed << std::setprecision(3);
+        os << "Gradient allreduce: " << this->buckets_.size() << " buckets of up to " << this->bucket_bytes_
+           << " bytes, " << this->iters_ << " iterations" << std::endl;
+        if (this->iters_ == 0) return;
+        os << "  backward pass " << 1e3 * this->total_backward_ / this->iters_ << " ms, communication "
+           << 1e3 * this->total_communication_ / this->iters_ << " ms, exposed wait "
+           << 1e3 * this->total_wait_ / this->iters_ << " ms per iteration" << std::endl;
+        os << "  " << 100.0 * overlap << "% of the communication overlapped with the backward pass" << std::endl;
+    }
+
+   private:
+    struct Bucket {
+        std::vector<unsigned int> weights;  // indices into the model's weights
+        std::vector<unsigned int> offsets;  // offset of each gradient in the staging buffer
+        std::vector<Tensor<T> *> grads;     // gradients of this iteration
+        std::vector<Tensor<T> *> views;     // views of the staging buffer, one per gradient
+        std::vector<T> staging;
+        std::size_t count;
+        unsigned int pending;
+        bool deferred;
+        bool staged;
+        bool launched;
+        bool done;
+        MPI_Request request;
+        double launch_time;
+        double complete_time;
+
+        Bucket()
+            : count(0),
+              pending(0),
+              deferred(false),
+              staged(false),
+              launched(false),
+              done(false),
+              request(MPI_REQUEST_NULL),
+              launch_time(0.0),
+              complete_time(0.0) {}
+
+        ~Bucket() {
+            for (Tensor<T> *view : views) delete view;
+        }
+    };
+
+    struct Slot {
+        unsigned int bucket;
+        unsigned int pos;
+    };
+
+    void clear_buckets() {
+        for (Bucket *b : this->buckets_) delete b;
+        this->buckets_.clear();
+        this->slots_.clear();
+        this->iters_ = 0;
+        this->total_backward_ = 0.0;
+        this->total_wait_ = 0.0;
+        this->total_overlapped_ = 0.0;
+        this->total_communication_ = 0.0;
+    }
+
+    void on_grad_ready(op::Operation<T> *var, Tensor<T> *grad) {
+        typename std::map<op::Operation<T> *, Slot>::iterator it = this->slots_.find(var);
+        if (it == this->slots_.end()) return;
+
+        Bucket &b = *this->buckets_[it->second.bucket];
+        b.grads[it->second.pos] = grad;
+        if (b.pending > 0) b.pending--;
+
+        if (b.pending == 0 && !b.deferred && !b.launched) this->launch(b);
+
+        // MPI mostly progresses non-blocking collectives from inside MPI calls, so poll the started ones
+        this->poll();
+    }
+
+    // Start of the bucket in the flat gradient buffer if its gradients are adjacent views of it, otherwise NULL.
+    // count is the number of elements from the first to the last gradient, the zero gaps of the layout included.
+    T *in_place_span(Bucket &b, int &count) {
+        if (this->flat_grads_ == NULL) return NULL;
+
+        unsigned int lo = b.weights[0], hi = b.weights[0];
+        for (unsigned int k = 0; k < b.weights.size(); k++) {
+            unsigned int i = b.weights[k];
+            if (b.grads[k] == NULL || b.grads[k]->get_ptr() != this->flat_grads_->get_ptr() + this->flat_offsets_[i]) {
+                return NULL;
+            }
+            if (i < lo) lo = i;
+            if (i > hi) hi = i;
+        }
+        if (hi - lo + 1 != b.weights.size()) return NULL;
+
+        count = this->flat_offsets_[hi] + this->weights_[hi]->get_output_tensor()->get_size() - this->flat_offsets_[lo];
+        return this->flat_grads_->get_ptr() + this->flat_offsets_[lo];
+    }
+
+    void launch(Bucket &b) {
+        int count = b.count;
+        T *ptr = this->in_place_span(b, count);
+
+        b.staged = (ptr == NULL);
+        if (b.staged) {
+            if (b.views.empty()) {
+                b.staging.assign(b.count, (T) 0);
+                for (unsigned int k = 0; k < b.weights.size(); k++) {
+                    unsigned int size = this->weights_[b.weights[k]]->get_output_tensor()->get_size();
+                    b.views.push_back(new Tensor<T>(b.staging.data() + b.offsets[k], {size}, HOST));
+                }
+            }
+            // a device gradient is copied to the host here, after the kernels producing it. A weight the loss does
+            // not depend on has no gradient in the table and contributes zeros.
+            for (unsigned int k = 0; k < b.grads.size(); k++) {
+                if (b.grads[k] != NULL) {
+                    b.views[k]->copy_from(*b.grads[k]);
+                } else {
+                    std::fill(b.views[k]->get_ptr(), b.views[k]->get_ptr() + b.views[k]->get_size(), (T) 0);
+                }
+            }
+            ptr = b.staging.data();
+        }
+
+        MPI_Iallreduce(MPI_IN_PLACE, ptr, count, mpi_datatype<T>(), MPI_SUM, this->comm_, &b.request);
+        b.launched = true;
+        b.launch_time = MPI_Wtime();
+    }
+
+    void poll() {
+        for (Bucket *b : this->buckets_) {
+            if (!b->launched || b->done) continue;
+
+            int flag = 0;
+            MPI_Test(&b->request, &flag, MPI_STATUS_IGNORE);
+            if (flag) {
+                b->done = true;
+                b->complete_time = MPI_Wtime();
+            }
+        }
+    }
+
+    void record(double backward_end, double wait_end) {
+        Timeline &t = this->timeline_;
+
+        t.backward_end = backward_end - this->start_time_;
+        t.wait_end = wait_end - this->start_time_;
+        t.buckets.clear();
+        for (Bucket *b : this->buckets_) {
+            t.buckets.push_back({(unsigned int) b->weights.size(), b->count * sizeof(T), !b->staged,
+                                 b->launch_time - this->start_time_, b->complete_time - this->start_time_});
+        }
+
+        this->iters_++;
+        this->total_backward_ += t.backward_end;
+        this->total_wait_ += t.wait_end - t.backward_end;
+        this->total_overlapped_ += t.overlapped();
+        this->total_communication_ += t.communication();
+    }
+
+    std::size_t bucket_bytes_;
+    MPI_Comm comm_;
+
+    std::vector<Bucket *> buckets_;
+    std::map<op::Operation<T> *, Slot> slots_;
+    std::vector<op::Operation<T> *> weights_;
+    op::GradTable<T> *grad_table_;
+    Tensor<T> *flat_grads_;
+    std::vector<unsigned int> flat_offsets_;
+
+    Timeline timeline_;
+    double start_time_;
+    unsigned int iters_;
+    double total_backward_;
+    double total_wait_;
+    double total_overlapped_;
+    double total_communication_;
+};
+
+}  // namespace solver
+}  // namespace magmadnn
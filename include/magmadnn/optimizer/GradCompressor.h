@@ -0,0 +1,225 @@
+#pragma once
+
+#include "magmadnn.h"
+#include "magmadnn/optimizer/MpiDatatype.h"
+#include "magmadnn/parallel.h"
+#include "math/half.h"
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+namespace magmadnn {
+namespace solver {
+
+// Sums a gradient over the processes of a communicator by exchanging a smaller representation of it than its
+// full-precision values. Compressors can keep state per gradient buffer, named by a key that stays the same across
+// iterations, and count the bytes they exchange so that their compression ratio can be reported.
+template <typename T>
+class GradCompressor {
+   public:
+    GradCompressor() : raw_bytes_(0), sent_bytes_(0) {}
+    virtual ~GradCompressor() {}
+
+    virtual const char *name() const = 0;
+
+    // Replaces the count values at data, in host memory, by their sum (or an approximation of it) over comm. Every
+    // process of comm calls it with the same count and key.
+    virtual void allreduce(T *data, int count, unsigned int key, MPI_Comm comm) = 0;
+
+    // Bytes each process would have contributed to full-precision allreduces, divided by the bytes it contributed
+    double ratio() const {
+        return (this->sent_bytes_ > 0) ? static_cast<double>(this->raw_bytes_) / this->sent_bytes_ : 1.0;
+    }
+
+    std::size_t raw_bytes() const { return this->raw_bytes_; }
+    std::size_t sent_bytes() const { return this->sent_bytes_; }
+
+    void reset_stats() {
+        this->raw_bytes_ = 0;
+        this->sent_bytes_ = 0;
+    }
+
+   protected:
+    void count_bytes(std::size_t raw, std::size_t sent) {
+        this->raw_bytes_ += raw;
+        this->sent_bytes_ += sent;
+    }
+
+   private:
+    std::size_t raw_bytes_;
+    std::size_t sent_bytes_;
+};
+
+// Full-precision allreduce, for comparison
+template <typename T>
+class NoCompressor : public GradCompressor<T> {
+   public:
+    const char *name() const { return "none"; }
+
+    void allreduce(T *data, int count, unsigned int key, MPI_Comm comm) {
+        MPI_Allreduce(MPI_IN_PLACE, data, count, mpi_datatype<T>(), MPI_SUM, comm);
+        this->count_bytes(count * sizeof(T), count * sizeof(T));
+    }
+};
+
+enum half_format_t { HALF_FP16, HALF_BF16 };
+
+// Casts the gradient to a 16-bit float format and reduces it in that format with a user-defined MPI sum. The values
+// are divided by the number of processes before the cast and multiplied back after, so that the sum stays within
+// the range of fp16. With fp16 that division also moves small gradients down towards its subnormal range (below
+// about 6e-5) or to zero, so fp16 loses them on many processes; bf16, the default, has the exponent range of float.
+//
+// The MPI operation is created by the first allreduce, so a compressor can be constructed before MPI_Init.
+template <typename T>
+class HalfCompressor : public GradCompressor<T> {
+   public:
+    explicit HalfCompressor(half_format_t format = HALF_BF16) : format_(format), op_created_(false) {}
+
+    ~HalfCompressor() {
+        int finalized = 0;
+        MPI_Finalized(&finalized);
+        if (this->op_created_ && !finalized) MPI_Op_free(&this->op_);
+    }
+
+    HalfCompressor(const HalfCompressor &) = delete;
+    HalfCompressor &operator=(const HalfCompressor &) = delete;
+
+    const char *name() const { return (this->format_ == HALF_FP16) ? "fp16" : "bf16"; }
+
+    void allreduce(T *data, int count, unsigned int key, MPI_Comm comm) {
+        int nnodes = 1;
+        MPI_Comm_size(comm, &nnodes);
+
+        this->buffer_.resize(count);
+        uint16_t *buffer = this->buffer_.data();
+        const bool fp16 = (this->format_ == HALF_FP16);
+        const float scale = 1.0f / nnodes;
+
+        ::magmadnn::internal::parallel_for(
+            count, ::magmadnn::internal::PARALLEL_GRAIN_SIZE, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++) {
+                    float v = static_cast<float>(data[i]) * scale;
+                    buffer[i] = fp16 ? math::float_to_half(v) : math::float_to_bfloat16(v);
+                }
+            });
+
+        if (!this->op_created_) {
+            MPI_Op_create(fp16 ? &HalfCompressor::sum_fp16 : &HalfCompressor::sum_bf16, 1, &this->op_);
+            this->op_created_ = true;
+        }
+        MPI_Allreduce(MPI_IN_PLACE, buffer, count, MPI_UINT16_T, this->op_, comm);
+
+        ::magmadnn::internal::parallel_for(
+            count, ::magmadnn::internal::PARALLEL_GRAIN_SIZE, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++) {
+                    float v = fp16 ? math::half_to_float(buffer[i]) : math::bfloat16_to_float(buffer[i]);
+                    data[i] = static_cast<T>(v * nnodes);
+                }
+            });
+
+        this->count_bytes(count * sizeof(T), count * sizeof(uint16_t));
+    }
+
+   private:
+    static void sum_fp16(void *in, void *inout, int *len, MPI_Datatype *type) {
+        const uint16_t *a = static_cast<const uint16_t *>(in);
+        uint16_t *b = static_cast<uint16_t *>(inout);
+        for (int i = 0; i < *len; i++) {
+            b[i] = math::float_to_half(math::half_to_float(a[i]) + math::half_to_float(b[i]));
+        }
+    }
+
+    static void sum_bf16(void *in, void *inout, int *len, MPI_Datatype *type) {
+        const uint16_t *a = static_cast<const uint16_t *>(in);
+        uint16_t *b = static_cast<uint16_t *>(inout);
+        for (int i = 0; i < *len; i++) {
+            b[i] = math::float_to_bfloat16(math::bfloat16_to_float(a[i]) + math::bfloat16_to_float(b[i]));
+        }
+    }
+
+    half_format_t format_;
+    bool op_created_;
+    MPI_Op op_;
+    std::vector<uint16_t> buffer_;
+};
+
+// Sends only the k = density * count entries of largest magnitude of each process's gradient, as (index, value)
+// pairs gathered on every process, and sums them. With error feedback, the entries that were not sent stay in a
+// residual per key and are added to the gradient of the next iteration, so no part of the gradient is lost, only
+// delayed. Every process sums the pairs in the same order and ends up with the same result.
+template <typename T>
+class TopKCompressor : public GradCompressor<T> {
+   public:
+    explicit TopKCompressor(double density = 0.01, bool error_feedback = true)
+        : density_(density), error_feedback_(error_feedback) {}
+
+    const char *name() const { return "top-k"; }
+
+    double density() const { return this->density_; }
+
+    // Gradient mass not sent yet for key, empty if there is none
+    const std::vector<T> &residual(unsigned int key) { return this->residuals_[key]; }
+
+    void allreduce(T *data, int count, unsigned int key, MPI_Comm comm) {
+        if (count <= 0) return;
+
+        int nnodes = 1;
+        MPI_Comm_size(comm, &nnodes);
+
+        int k = static_cast<int>(std::ceil(this->density_ * count));
+        k = std::min(std::max(k, 1), count);
+
+        // the gradient plus what previous iterations did not send; the entries sent are taken out of it below
+        std::vector<T> &acc = this->error_feedback_ ? this->residuals_[key] : this->scratch_;
+        if (acc.size() != static_cast<std::size_t>(count)) acc.assign(count, static_cast<T>(0));
+        if (this->error_feedback_) {
+            for (int i = 0; i < count; i++) acc[i] += data[i];
+        } else {
+            std::copy(data, data + count, acc.begin());
+        }
+
+        this->order_.resize(count);
+        for (int i = 0; i < count; i++) this->order_[i] = i;
+        std::nth_element(this->order_.begin(), this->order_.begin() + (k - 1), this->order_.end(),
+                         [&acc](int a, int b) { return std::abs(acc[a]) > std::abs(acc[b]); });
+
+        this->send_index_.resize(k);
+        this->send_value_.resize(k);
+        for (int j = 0; j < k; j++) {
+            int i = this->order_[j];
+            this->send_index_[j] = i;
+            this->send_value_[j] = acc[i];
+            acc[i] = static_cast<T>(0);
+        }
+
+        this->recv_index_.resize(static_cast<std::size_t>(k) * nnodes);
+        this->recv_value_.resize(static_cast<std::size_t>(k) * nnodes);
+        MPI_Allgather(this->send_index_.data(), k, MPI_INT, this->recv_index_.data(), k, MPI_INT, comm);
+        MPI_Allgather(this->send_value_.data(), k, mpi_datatype<T>(), this->recv_value_.data(), k, mpi_datatype<T>(),
+                      comm);
+
+        std::fill(data, data + count, static_cast<T>(0));
+        for (std::size_t j = 0; j < this->recv_index_.size(); j++) data[this->recv_index_[j]] += this->recv_value_[j];
+
+        this->count_bytes(count * sizeof(T), k * (sizeof(int) + sizeof(T)));
+    }
+
+   private:
+    double density_;
+    bool error_feedback_;
+    std::map<unsigned int, std::vector<T>> residuals_;
+    std::vector<T> scratch_;
+    std::vector<int> order_;
+    std::vector<int> send_index_, recv_index_;
+    std::vector<T> send_value_, recv_value_;
+};
+
+}  // namespace solver
+}  // namespace magmadnn
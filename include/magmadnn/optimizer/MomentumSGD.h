@@ -24,6 +24,20 @@ class MomentumSgdIter {
 
     void reset() { this->momentum_table_.clear(); }
 
+    // Momentum of each weight, created zeroed if missing, so that checkpoints can save and restore it
+    std::vector<Tensor<T> *> state_tensors(std::vector<op::Operation<T> *> const &weights) {
+        std::vector<Tensor<T> *> tensors;
+        for (auto w = weights.begin(); w != weights.end(); ++w) {
+            Tensor<T> *var_tensor = (*w)->get_output_tensor();
+            if (!momentum_table_.count(*w)) {
+                momentum_table_[*w] =
+                    new Tensor<T>(var_tensor->get_shape(), {ZERO, {}}, var_tensor->get_memory_type());
+            }
+            tensors.push_back(momentum_table_[*w]);
+        }
+        return tensors;
+    }
+
     void step(std::vector<op::Operation<T> *> const &weights, op::GradTable<T> &grad_table,
               T scale = static_cast<T>(1.0)) {
         for (auto w = weights.begin(); w != weights.end(); ++w) {
@@ -63,39 +77,10 @@ class MomentumSgdIter {
 
             if (var_tensor->get_memory_type() == HOST) {
                 magmadnn::math::sgd_momentum_cpu(learning_rate_ * scale, momentum_, prev_grad, grad, var_tensor);
-
-                // Check for update sparsity
-                // T *grad_ptr = grad->get_ptr();
-                // auto size = grad->get_size();
-                // uint64_t nnz = 0;
-                // for (uint64_t i = 0; i < size; ++i) {
-                //    if (grad_ptr[i] > 1e-7)
-                //       nnz++;
-                // }
-
-                // double density = static_cast<double>(nnz) / static_cast<double>(size);
-                // std::cout << "density = " << density << std::endl;
-
             } else {
                 magmadnn::math::sgd_momentum_device(custream, learning_rate_ * scale, momentum_, prev_grad, grad,
                                                     var_tensor);
                 if (!async) cudaStreamSynchronize(custream);
-
-                // Check for update sparsity
-                // Tensor<T> tmp(grad->get_shape(), {NONE, {}}, HOST);
-                // cudaStreamSynchronize(custream);
-                // tmp.copy_from(*grad);
-                // cudaStreamSynchronize(custream);
-
-                // auto size = tmp.get_size();
-                // uint64_t nnz = 0;
-                // for (uint64_t i = 0; i < size; ++i) {
-                //    if (tmp.get_ptr()[i] > 1e-7)
-                //       nnz++;
-                // }
-
-                // double density = static_cast<double>(nnz) / static_cast<double>(size);
-                // std::cout << "density = " << density << std::endl;
             }
         }
     }
@@ -165,10 +150,14 @@ class MomentumSGD : public magmadnn::solver::FMinSolver<T> {
         T cumulative_loss = 0.0;
 
         op::GradTable<T> grad_table;
+        // Only the weight gradients are read back, the intermediate ones are freed during the backward pass
+        grad_table.get_executor().set_release_buffers(true);
         std::map<op::Operation<T> *, Tensor<T> *> momentum_table;
 
+#if defined(MAGMADNN_HAVE_CUDA)
         // CUDA stream
         cudaStream_t custream;
+#endif
 
         for (int e = 0; e < nepoch; ++e) {
             // Loss value for current epoch
@@ -199,7 +188,7 @@ class MomentumSGD : public magmadnn::solver::FMinSolver<T> {
                 // Synchronous step, no need for barrier
                 sgd_iter.step(custream, weights, grad_table, 1.0);
 #else
-                sgd_iter.step(weights, grad_table, scale);
+                sgd_iter.step(weights, grad_table, 1.0);
 #endif
 
                 // for (auto w = weights.begin(); w != weights.end(); ++w) {
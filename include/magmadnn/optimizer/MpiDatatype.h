@@ -0,0 +1,28 @@
+#pragma once
+
+#include <mpi.h>
+
+namespace magmadnn {
+namespace solver {
+
+// MPI datatype of T
+template <typename T>
+inline MPI_Datatype mpi_datatype();
+
+template <>
+inline MPI_Datatype mpi_datatype<int>() {
+    return MPI_INT;
+}
+
+template <>
+inline MPI_Datatype mpi_datatype<float>() {
+    return MPI_FLOAT;
+}
+
+template <>
+inline MPI_Datatype mpi_datatype<double>() {
+    return MPI_DOUBLE;
+}
+
+}  // namespace solver
+}  // namespace magmadnn
@@ -0,0 +1,294 @@
+#pragma once
+
+#include "magmadnn.h"
+#include "magmadnn/optimizer/MpiDatatype.h"
+#include "tensor/flat_buffer.h"
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace magmadnn {
+namespace solver {
+
+enum sharded_update_t { SHARDED_MOMENTUM_SGD, SHARDED_ADAM, SHARDED_ADAGRAD, SHARDED_RMSPROP };
+
+// Optimizer step with its state partitioned over the processes of a communicator (ZeRO stage 1).
+//
+// The weights of a model are laid out as in its flat buffers (FlatBuffer::get_layout) and that range is cut into
+// one contiguous shard per process. A step reduce-scatters the gradients, so that each process receives the sum of
+// its shard only, updates the parameters of its shard with the state it keeps for that shard, and allgathers the
+// updated parameters. The optimizer state on each process is 1/P of that of the full model, and the communication
+// volume is that of a single allreduce.
+//
+// When the model has HOST flat buffers (nn_params_t::flat_buffers), the gradients are scattered from and the
+// parameters gathered into them in place. Otherwise they go through host staging buffers of the size of the model,
+// which every process keeps and which outweigh the saved state: the memory reduction needs flat buffers.
+template <typename T>
+class ShardedOptimizer {
+   public:
+    explicit ShardedOptimizer(sharded_update_t update = SHARDED_MOMENTUM_SGD, T learning_rate = 0.01,
+                              MPI_Comm comm = MPI_COMM_WORLD)
+        : update_(update),
+          learning_rate_(learning_rate),
+          momentum_(0.9),
+          beta1_(0.9),
+          beta2_(0.999),
+          decaying_factor_(0.9),
+          running_beta1_(0.9),
+          running_beta2_(0.999),
+          comm_(comm),
+          size_(0),
+          shard_begin_(0),
+          shard_size_(0),
+          param_shard_(NULL),
+          grad_shard_(NULL) {}
+
+    ~ShardedOptimizer() { this->clear(); }
+
+    ShardedOptimizer(const ShardedOptimizer &) = delete;
+    ShardedOptimizer &operator=(const ShardedOptimizer &) = delete;
+
+    void set_learning_rate(T learning_rate) { this->learning_rate_ = learning_rate; }
+    T learning_rate() const { return this->learning_rate_; }
+
+    // momentum SGD
+    void set_momentum(T momentum) { this->momentum_ = momentum; }
+
+    // Adam
+    void set_betas(T beta1, T beta2) {
+        this->beta1_ = beta1;
+        this->beta2_ = beta2;
+        this->running_beta1_ = beta1;
+        this->running_beta2_ = beta2;
+    }
+
+    // RMSProp
+    void set_decaying_factor(T decaying_factor) { this->decaying_factor_ = decaying_factor; }
+
+    // Cuts the weights of model into shards and allocates the zeroed state of this process's shard. Has to be
+    // called again if the weights of the model change.
+    magmadnn_error_t attach(magmadnn::model::NeuralNetwork<T> &model) {
+        int nnodes = 1, rank = 0;
+        MPI_Comm_size(this->comm_, &nnodes);
+        MPI_Comm_rank(this->comm_, &rank);
+
+        this->clear();
+
+        std::vector<op::Operation<T> *> &weights = model.weights();
+        std::vector<unsigned int> sizes;
+        for (op::Operation<T> *w : weights) sizes.push_back(w->get_output_tensor()->get_size());
+        this->size_ = FlatBuffer<T>::get_layout(sizes, &this->offsets_);
+        if (this->size_ == 0) return (magmadnn_error_t) 1;
+
+        unsigned int chunk = (this->size_ + nnodes - 1) / nnodes;
+        for (int r = 0; r < nnodes; r++) {
+            unsigned int begin = std::min(r * chunk, this->size_);
+            unsigned int end = std::min(begin + chunk, this->size_);
+            this->counts_.push_back(end - begin);
+            this->displs_.push_back(begin);
+        }
+        this->shard_begin_ = this->displs_[rank];
+        this->shard_size_ = this->counts_[rank];
+
+        // staging for the parameters if the model does not keep them in a HOST flat buffer
+        Tensor<T> *flat_weights = model.flat_weights();
+        if (flat_weights == NULL || flat_weights->get_memory_type() != HOST) {
+            this->params_.assign(this->size_, 0);
+            for (unsigned int i = 0; i < weights.size(); i++) {
+                this->param_views_.push_back(this->view(this->params_.data(), this->offsets_[i], sizes[i]));
+            }
+        }
+
+        this->grad_shard_values_.assign(this->shard_size_, 0);
+        if (this->shard_size_ > 0) {
+            this->grad_shard_ = this->view(this->grad_shard_values_.data(), 0, this->shard_size_);
+
+            unsigned int n_state = (this->update_ == SHARDED_ADAM) ? 2 : 1;
+            for (unsigned int i = 0; i < n_state; i++) {
+                this->state_.push_back(new Tensor<T>({this->shard_size_}, {ZERO, {}}, HOST));
+            }
+        }
+        this->running_beta1_ = this->beta1_;
+        this->running_beta2_ = this->beta2_;
+
+        return (magmadnn_error_t) 0;
+    }
+
+    // Sums the gradients in grad_table over the processes, scaled by scale, and updates the weights of model with
+    // them. Every process ends up with the same parameters.
+    void step(magmadnn::model::NeuralNetwork<T> &model, op::GradTable<T> &grad_table, T scale = 1.0) {
+        std::vector<op::Operation<T> *> &weights = model.weights();
+
+        // the gradients, in the flat layout
+        T *grads = this->in_place_grads(model, grad_table);
+        if (grads == NULL) {
+            // staging, allocated the first time it is needed; its gaps stay zero
+            if (this->grads_.empty()) {
+                this->grads_.assign(this->size_, 0);
+                for (unsigned int i = 0; i < weights.size(); i++) {
+                    unsigned int size = weights[i]->get_output_tensor()->get_size();
+                    this->grad_views_.push_back(this->view(this->grads_.data(), this->offsets_[i], size));
+                }
+            }
+            for (unsigned int i = 0; i < weights.size(); i++) {
+                this->grad_views_[i]->copy_from(*grad_table.get(weights[i]));
+            }
+            grads = this->grads_.data();
+        }
+
+        MPI_Reduce_scatter(grads, this->grad_shard_values_.data(), this->counts_.data(), mpi_datatype<T>(), MPI_SUM,
+                           this->comm_);
+
+        // the parameters, in the flat layout
+        T *params = NULL;
+        if (this->params_.empty()) {
+            params = model.flat_weights()->get_ptr();
+        } else {
+            for (unsigned int i = 0; i < weights.size(); i++) {
+                this->param_views_[i]->copy_from(*weights[i]->get_output_tensor());
+            }
+            params = this->params_.data();
+        }
+
+        if (this->shard_size_ > 0) {
+            if (this->param_shard_ == NULL || this->param_shard_->get_ptr() != params + this->shard_begin_) {
+                if (this->param_shard_ != NULL) delete this->param_shard_;
+                this->param_shard_ = this->view(params, this->shard_begin_, this->shard_size_);
+            }
+            this->update(scale);
+        }
+
+        MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, params, this->counts_.data(), this->displs_.data(),
+                       mpi_datatype<T>(), this->comm_);
+
+        if (!this->params_.empty()) {
+            for (unsigned int i = 0; i < weights.size(); i++) {
+                weights[i]->get_output_tensor()->copy_from(*this->param_views_[i]);
+            }
+        }
+    }
+
+    // Offset and number of elements of this process's shard in the flat layout
+    unsigned int shard_begin() const { return this->shard_begin_; }
+    unsigned int shard_size() const { return this->shard_size_; }
+
+    // Number of elements of the flat layout of the whole model
+    unsigned int size() const { return this->size_; }
+
+    // Optimizer state of this process's shard, e.g. to checkpoint it
+    const std::vector<Tensor<T> *> &state_tensors() const { return this->state_; }
+
+    // Bytes kept by this process for the step: the optimizer state and the gradient of its shard, and the staging
+    // buffers
+    std::size_t state_bytes() const {
+        return (this->state_.size() * this->shard_size_ + this->grad_shard_values_.size()) * sizeof(T) +
+               this->staging_bytes();
+    }
+
+    // Bytes of the full-model staging buffers, 0 when the model has HOST flat buffers. The gradient staging is only
+    // allocated by the first step that needs it.
+    std::size_t staging_bytes() const { return (this->params_.size() + this->grads_.size()) * sizeof(T); }
+
+   private:
+    Tensor<T> *view(T *base, unsigned int offset, unsigned int size) {
+        return new Tensor<T>(base + offset, {size}, HOST);
+    }
+
+    // the model's flat gradient buffer if every gradient in grad_table is a view of it
+    T *in_place_grads(magmadnn::model::NeuralNetwork<T> &model, op::GradTable<T> &grad_table) {
+        Tensor<T> *flat_grads = model.flat_gradients();
+        if (flat_grads == NULL || flat_grads->get_memory_type() != HOST) return NULL;
+
+        std::vector<op::Operation<T> *> &weights = model.weights();
+        for (unsigned int i = 0; i < weights.size(); i++) {
+            Tensor<T> *grad = grad_table.get(weights[i]);
+            if (grad == NULL || grad->get_ptr() != flat_grads->get_ptr() + this->offsets_[i]) return NULL;
+        }
+        return flat_grads->get_ptr();
+    }
+
+    void update(T scale) {
+        switch (this->update_) {
+            case SHARDED_MOMENTUM_SGD:
+                math::sgd_momentum(this->learning_rate_ * scale, this->momentum_, this->state_[0], this->grad_shard_,
+                                   this->param_shard_);
+                return;
+            default:
+                break;
+        }
+
+        // the other rules have no scale of their own
+        if (scale != static_cast<T>(1.0)) {
+            for (unsigned int i = 0; i < this->shard_size_; i++) this->grad_shard_values_[i] *= scale;
+        }
+
+        switch (this->update_) {
+            case SHARDED_ADAM:
+                math::adam(this->learning_rate_, this->beta1_, this->beta2_, this->running_beta1_, this->running_beta2_,
+                           this->state_[0], this->state_[1], this->grad_shard_, this->param_shard_);
+                this->running_beta1_ *= this->beta1_;
+                this->running_beta2_ *= this->beta2_;
+                break;
+            case SHARDED_ADAGRAD:
+                math::adagrad(this->learning_rate_, this->state_[0], this->grad_shard_, this->param_shard_);
+                break;
+            case SHARDED_RMSPROP:
+                math::rmsprop(this->learning_rate_, this->decaying_factor_, this->state_[0], this->grad_shard_,
+                              this->param_shard_);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void clear() {
+        for (Tensor<T> *t : this->param_views_) delete t;
+        for (Tensor<T> *t : this->grad_views_) delete t;
+        for (Tensor<T> *t : this->state_) delete t;
+        if (this->param_shard_ != NULL) delete this->param_shard_;
+        if (this->grad_shard_ != NULL) delete this->grad_shard_;
+
+        this->param_views_.clear();
+        this->grad_views_.clear();
+        this->state_.clear();
+        this->param_shard_ = NULL;
+        this->grad_shard_ = NULL;
+        this->counts_.clear();
+        this->displs_.clear();
+        this->offsets_.clear();
+        this->params_.clear();
+        this->grads_.clear();
+        this->shard_size_ = 0;
+    }
+
+    sharded_update_t update_;
+    T learning_rate_;
+    T momentum_;
+    T beta1_, beta2_;
+    T decaying_factor_;
+    T running_beta1_, running_beta2_;
+    MPI_Comm comm_;
+
+    unsigned int size_;
+    unsigned int shard_begin_;
+    unsigned int shard_size_;
+    std::vector<int> counts_;
+    std::vector<int> displs_;
+    std::vector<unsigned int> offsets_;
+
+    std::vector<T> params_;  // staging, empty when the model has HOST flat weights
+    std::vector<T> grads_;   // staging, empty until the gradients are not in a HOST flat buffer
+    std::vector<Tensor<T> *> param_views_;
+    std::vector<Tensor<T> *> grad_views_;
+
+    std::vector<T> grad_shard_values_;
+    Tensor<T> *param_shard_;
+    Tensor<T> *grad_shard_;
+    std::vector<Tensor<T> *> state_;  // shard_size_ elements each
+};
+
+}  // namespace solver
+}  // namespace magmadnn
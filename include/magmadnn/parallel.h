@@ -0,0 +1,97 @@
+/**
+ * @file parallel.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#if defined(MAGMADNN_CMAKE_BUILD)
+#include "magmadnn/config.h"
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#if defined(MAGMADNN_HAVE_OMP)
+#include <omp.h>
+#endif
+
+namespace magmadnn {
+
+/** Sets the number of threads used by the HOST kernels. A value <= 0 restores the default, which is taken from the
+ * MAGMADNN_NUM_THREADS environment variable, or else from the OpenMP runtime. Without OpenMP the HOST kernels always
+ * run on one thread.
+ * @param n_threads
+ */
+void magmadnn_set_num_threads(int n_threads);
+
+/** @return int the number of threads used by the HOST kernels
+ */
+int magmadnn_get_num_threads();
+
+namespace internal {
+
+/* Elementwise loops shorter than this per thread stay serial; below it the fork/join cost is not amortized. */
+const std::size_t PARALLEL_GRAIN_SIZE = 32768;
+
+/** Number of threads for a loop of `work` iterations, each thread getting at least `grain` of them. Returns 1 inside
+ * an enclosing parallel region.
+ */
+int parallel_num_threads(std::size_t work, std::size_t grain);
+
+/** Calls f(begin, end) on disjoint contiguous ranges that cover [0,n). The partition is static: thread t always
+ * gets the t-th range.
+ * @param n number of iterations
+ * @param grain minimum number of iterations per thread
+ * @param f callable taking (std::size_t begin, std::size_t end)
+ */
+template <typename F>
+void parallel_for(std::size_t n, std::size_t grain, F f) {
+    if (n == 0) return;
+
+    int n_threads = parallel_num_threads(n, grain);
+    if (n_threads <= 1) {
+        f((std::size_t) 0, n);
+        return;
+    }
+
+#if defined(MAGMADNN_HAVE_OMP)
+#pragma omp parallel num_threads(n_threads)
+    {
+        std::size_t tid = omp_get_thread_num();
+        std::size_t chunk = (n + omp_get_num_threads() - 1) / omp_get_num_threads();
+        std::size_t begin = std::min(tid * chunk, n);
+        std::size_t end = std::min(begin + chunk, n);
+        if (begin < end) f(begin, end);
+    }
+#else
+    f((std::size_t) 0, n);
+#endif
+}
+
+/** Sum reduction whose result does not depend on the number of threads. [0,n) is cut into blocks of `block`
+ * iterations, partial(begin, end) is evaluated for every block and the block results are added in order.
+ * @param n number of iterations
+ * @param block iterations per block, fixed independently of the thread count
+ * @param partial callable taking (std::size_t begin, std::size_t end) and returning R
+ */
+template <typename R, typename F>
+R parallel_reduce_sum(std::size_t n, std::size_t block, F partial) {
+    std::size_t n_blocks = (n + block - 1) / block;
+    if (n_blocks <= 1) return (n == 0) ? (R) 0 : partial((std::size_t) 0, n);
+
+    std::vector<R> partials(n_blocks);
+    parallel_for(n_blocks, 1, [&](std::size_t b_begin, std::size_t b_end) {
+        for (std::size_t b = b_begin; b < b_end; b++) partials[b] = partial(b * block, std::min((b + 1) * block, n));
+    });
+
+    R sum = (R) 0;
+    for (std::size_t b = 0; b < n_blocks; b++) sum += partials[b];
+    return sum;
+}
+
+}  // namespace internal
+}  // namespace magmadnn
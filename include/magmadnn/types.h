@@ -32,6 +32,7 @@ typedef unsigned int magmadnn_error_t;
 
 struct magmadnn_settings_t {
     unsigned int n_devices;
+    int n_threads; /* threads used by the HOST kernels, see magmadnn_set_num_threads */
 #if defined(MAGMADNN_HAVE_CUDA)
     cudnnHandle_t cudnn_handle;
     cublasHandle_t cublas_handle;
@@ -20,11 +20,36 @@
 namespace magmadnn {
 namespace math {
 
+/** Normalization modes of the HOST batchnorm, same meaning as CUDNN_BATCHNORM_SPATIAL and
+ * CUDNN_BATCHNORM_PER_ACTIVATION: spatial normalizes each channel of an NCHW tensor over N*H*W, per-activation
+ * normalizes every feature of x[0] over the batch.
+ */
+enum batchnorm_cpu_mode_t { BATCHNORM_CPU_SPATIAL, BATCHNORM_CPU_PER_ACTIVATION };
+
+struct batchnorm_cpu_settings {
+    batchnorm_cpu_mode_t mode;
+    double epsilon;
+};
+
+/** Training forward pass. Computes the batch mean and variance in a single pass over x, normalizes with them and
+ * updates running_mean/running_variance with factor 1/(1+num_calls) like batchnorm_device. saved_mean and
+ * saved_variance receive the batch mean and inverse standard deviation for batchnorm_grad.
+ */
 template <typename T>
-void batchnorm(Tensor<T> *x, Tensor<T> *out);
+void batchnorm(Tensor<T> *x, Tensor<T> *out, Tensor<T> *bn_scale, Tensor<T> *bn_bias, Tensor<T> *running_mean,
+               Tensor<T> *running_variance, Tensor<T> *saved_mean, Tensor<T> *saved_variance, unsigned int &num_calls,
+               batchnorm_cpu_settings settings);
+
+/** Inference forward pass. Folds scale, shift and the running statistics into one multiply-add per element.
+ */
+template <typename T>
+void batchnorm_inference(Tensor<T> *x, Tensor<T> *out, Tensor<T> *bn_scale, Tensor<T> *bn_bias,
+                         Tensor<T> *running_mean, Tensor<T> *running_variance, batchnorm_cpu_settings settings);
 
 template <typename T>
-void batchnorm_grad(Tensor<T> *grad, Tensor<T> *out);
+void batchnorm_grad(Tensor<T> *x, Tensor<T> *grad, Tensor<T> *out, Tensor<T> *bn_scale, Tensor<T> *bn_scale_diff,
+                    Tensor<T> *bn_bias_diff, Tensor<T> *saved_mean, Tensor<T> *saved_variance,
+                    batchnorm_cpu_settings settings);
 
 #if defined(MAGMADNN_HAVE_CUDA)
 
@@ -39,6 +64,10 @@ void batchnorm_device(Tensor<T> *x, Tensor<T> *out, Tensor<T> *bn_scale, Tensor<
                       Tensor<T> *running_variance, Tensor<T> *saved_mean, Tensor<T> *saved_variance,
                       unsigned int &num_calls, cudnn_batchnorm_settings_t settings);
 template <typename T>
+void batchnorm_inference_device(Tensor<T> *x, Tensor<T> *out, Tensor<T> *bn_scale, Tensor<T> *bn_bias,
+                                Tensor<T> *running_mean, Tensor<T> *running_variance,
+                                cudnn_batchnorm_settings_t settings);
+template <typename T>
 void batchnorm_grad_device(Tensor<T> *x, Tensor<T> *grad, Tensor<T> *out, Tensor<T> *bn_scale, Tensor<T> *bn_scale_diff,
                            Tensor<T> *bn_bias_diff, Tensor<T> *saved_mean, Tensor<T> *saved_variance,
                            cudnn_batchnorm_settings_t settings);
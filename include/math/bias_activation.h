@@ -0,0 +1,44 @@
+/**
+ * @file bias_activation.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#if defined(MAGMADNN_CMAKE_BUILD)
+#include "magmadnn/config.h"
+#endif
+#include "tensor/tensor.h"
+
+namespace magmadnn {
+namespace math {
+
+/* Activations that can be applied in the epilogue of a dense layer. Each derivative is a function of the activated
+   output alone, so the pre-activation values never need to be kept. */
+enum fused_activation_t { FUSED_IDENTITY, FUSED_RELU, FUSED_SIGMOID, FUSED_TANH };
+
+/** out = activation(x + bias) in one pass over x, where bias holds one value per row of x like bias_add. Can be
+ * called in-place (out == x).
+ * @tparam T
+ * @param x matrix
+ * @param bias vector with a value for each row of x, or NULL for none
+ * @param activation
+ * @param out matrix of the shape of x
+ */
+template <typename T>
+void bias_activation_cpu(Tensor<T> *x, Tensor<T> *bias, fused_activation_t activation, Tensor<T> *out);
+
+/** out = grad * activation'(y), the gradient w.r.t. the input of the activation, from its output y = activation(z).
+ * @tparam T
+ * @param y output of bias_activation_cpu
+ * @param grad gradient w.r.t. y, or a single value for every element
+ * @param activation
+ * @param out gradient w.r.t. z
+ */
+template <typename T>
+void activation_grad_cpu(Tensor<T> *y, Tensor<T> *grad, fused_activation_t activation, Tensor<T> *out);
+
+}  // namespace math
+}  // namespace magmadnn
@@ -8,6 +8,8 @@
  */
 #pragma once
 
+#include <vector>
+
 #if defined(MAGMADNN_CMAKE_BUILD)
 #include "magmadnn/config.h"
 #endif
@@ -21,14 +23,51 @@
 namespace magmadnn {
 namespace math {
 
+/** Algorithms available to the native CPU convolution engine.
+ */
+enum conv2d_cpu_algo_t {
+    /* blocked im2col followed by a GEMM, works for any configuration */
+    CONV2D_CPU_ALGO_IM2COL_GEMM,
+    /* 1x1 kernel, unit stride and no padding: the input already is the im2col matrix */
+    CONV2D_CPU_ALGO_GEMM_1X1,
+    /* direct convolution for 3x3 kernels with unit stride and no dilation */
+    CONV2D_CPU_ALGO_DIRECT_3X3
+};
+
+/** Settings for the native CPU convolution engine. Dilation follows the cuDNN convention, i.e. a dilation of 1 means
+ * no dilation.
+ */
+struct conv2d_cpu_settings {
+    int pad_h, pad_w;
+    int vertical_stride, horizontal_stride;
+    int dilation_h, dilation_w;
+    bool use_cross_correlation;
+    conv2d_cpu_algo_t algo;
+    /* number of output rows unfolded at once by the im2col algorithm */
+    int block_rows;
+    void *workspace;
+    size_t workspace_size;
+};
+
+/** Chooses the CPU convolution algorithm and the im2col blocking for the given shapes and sets
+ * settings.workspace_size to the number of bytes the caller must allocate in settings.workspace.
+ * @param x_shape input shape (NCHW)
+ * @param w_shape filter shape (KCRS)
+ * @param out_shape output shape (NKPQ)
+ * @param settings pad, stride, dilation and use_cross_correlation must be set
+ */
+template <typename T>
+void conv2d_cpu_init_settings(const std::vector<unsigned int> &x_shape, const std::vector<unsigned int> &w_shape,
+                              const std::vector<unsigned int> &out_shape, conv2d_cpu_settings &settings);
+
 template <typename T>
-void conv2d(Tensor<T> *x, Tensor<T> *w, Tensor<T> *out);
+void conv2d(Tensor<T> *x, Tensor<T> *w, Tensor<T> *out, conv2d_cpu_settings settings);
 
 template <typename T>
-void conv2d_grad_data(Tensor<T> *w, Tensor<T> *grad, Tensor<T> *out);
+void conv2d_grad_data(Tensor<T> *w, Tensor<T> *grad, Tensor<T> *out, conv2d_cpu_settings settings);
 
 template <typename T>
-void conv2d_grad_filter(Tensor<T> *x, Tensor<T> *grad, Tensor<T> *out);
+void conv2d_grad_filter(Tensor<T> *x, Tensor<T> *grad, Tensor<T> *out, conv2d_cpu_settings settings);
 
 #if defined(MAGMADNN_HAVE_CUDA)
 
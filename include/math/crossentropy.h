@@ -27,6 +27,28 @@ void crossentropy_full_cpu(Tensor<T> *x, Tensor<T> *y, Tensor<T> *softmax, Tenso
 template <typename T>
 void crossentropy(Tensor<T> *predicted, Tensor<T> *ground_truth, Tensor<T> *out);
 
+/** Mean cross entropy of softmax(logits) against labels, from the log-sum-exp of each row so that large logits do
+ * not overflow. The softmax of each row is written to softmax on the way, for softmax_crossentropy_grad.
+ * @tparam T
+ * @param logits n_samples x n_classes
+ * @param labels n_samples class indices, or n_samples x n_classes probabilities (one-hot). An index outside
+ * [0, n_classes) throws a magmadnn::Error, as does memory other than HOST.
+ * @param softmax n_samples x n_classes
+ * @param out scalar tensor
+ */
+template <typename T>
+void softmax_crossentropy(Tensor<T> *logits, Tensor<T> *labels, Tensor<T> *softmax, Tensor<T> *out);
+
+/** Gradient of softmax_crossentropy w.r.t. the logits: out = grad * (softmax - labels) / n_samples.
+ * @tparam T
+ * @param softmax softmax computed by softmax_crossentropy
+ * @param labels class indices or probabilities, as given to softmax_crossentropy
+ * @param grad gradient w.r.t. the loss
+ * @param out n_samples x n_classes
+ */
+template <typename T>
+void softmax_crossentropy_grad(Tensor<T> *softmax, Tensor<T> *labels, T grad, Tensor<T> *out);
+
 #if defined(MAGMADNN_HAVE_CUDA)
 template <typename T>
 void crossentropy_device(Tensor<T> *predicted, Tensor<T> *ground_truth, Tensor<T> *out);
@@ -0,0 +1,115 @@
+/**
+ * @file elementwise.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#if defined(MAGMADNN_CMAKE_BUILD)
+#include "magmadnn/config.h"
+#endif
+
+#include <cmath>
+
+/* Elementwise loops are annotated with `omp simd` when the compiler accepts it. Each iteration only touches index i,
+ * so the kernels below may be called in-place (out == x). */
+#if defined(_OPENMP) || defined(MAGMADNN_HAVE_OPENMP_SIMD)
+#define MAGMADNN_PRAGMA_SIMD _Pragma("omp simd")
+#else
+#define MAGMADNN_PRAGMA_SIMD
+#endif
+
+namespace magmadnn {
+namespace math {
+
+/** Shared HOST elementwise kernels working directly on raw buffers, so that the loops vectorize instead of going
+ * through Tensor::get/set.
+ */
+
+/** out[i] = f(x[i]) for i in [0,size)
+ */
+template <typename T, typename F>
+inline void elementwise_unary(unsigned int size, const T *x, T *out, F f) {
+    MAGMADNN_PRAGMA_SIMD
+    for (unsigned int i = 0; i < size; i++) out[i] = f(x[i]);
+}
+
+/** out[i] = f(a[i], b[i]) for i in [0,size)
+ */
+template <typename T, typename F>
+inline void elementwise_binary(unsigned int size, const T *a, const T *b, T *out, F f) {
+    MAGMADNN_PRAGMA_SIMD
+    for (unsigned int i = 0; i < size; i++) out[i] = f(a[i], b[i]);
+}
+
+/** out[i] = f(a[i], b[i], c[i]) for i in [0,size)
+ */
+template <typename T, typename F>
+inline void elementwise_ternary(unsigned int size, const T *a, const T *b, const T *c, T *out, F f) {
+    MAGMADNN_PRAGMA_SIMD
+    for (unsigned int i = 0; i < size; i++) out[i] = f(a[i], b[i], c[i]);
+}
+
+/* functors shared by the compute and math HOST paths */
+
+template <typename T>
+struct relu_functor {
+    T operator()(T x) const { return (x > static_cast<T>(0)) ? x : static_cast<T>(0); }
+};
+
+template <typename T>
+struct relu_grad_functor {
+    T operator()(T x, T grad) const { return (x > static_cast<T>(0)) ? grad : static_cast<T>(0); }
+};
+
+template <typename T>
+struct sigmoid_functor {
+    T operator()(T x) const { return 1 / (1 + std::exp(-x)); }
+};
+
+/* fast_sigmoid(x) = x / (1 + |x|) */
+template <typename T>
+struct fast_sigmoid_functor {
+    T operator()(T x) const { return x / (1 + std::abs(x)); }
+};
+
+template <typename T>
+struct tanh_functor {
+    T operator()(T x) const { return std::tanh(x); }
+};
+
+template <typename T>
+struct negate_functor {
+    T operator()(T x) const { return -x; }
+};
+
+template <typename T>
+struct axpby_functor {
+    T alpha, beta;
+    axpby_functor(T alpha, T beta) : alpha(alpha), beta(beta) {}
+    T operator()(T a, T b) const { return (alpha * a) + (beta * b); }
+};
+
+template <typename T>
+struct add_functor {
+    T operator()(T a, T b) const { return a + b; }
+};
+
+template <typename T>
+struct scale_functor {
+    T alpha;
+    explicit scale_functor(T alpha) : alpha(alpha) {}
+    T operator()(T x) const { return alpha * x; }
+};
+
+template <typename T>
+struct shift_functor {
+    T alpha;
+    explicit shift_functor(T alpha) : alpha(alpha) {}
+    T operator()(T x) const { return alpha + x; }
+};
+
+}  // namespace math
+}  // namespace magmadnn
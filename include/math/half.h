@@ -0,0 +1,115 @@
+/**
+ * @file half.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace magmadnn {
+namespace math {
+
+/** Converts an IEEE binary16 value, stored in a uint16_t, to float. Exact for every half value.
+ * @param h
+ * @return float
+ */
+inline float half_to_float(uint16_t h) {
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1f;
+    uint32_t mantissa = h & 0x3ff;
+    uint32_t bits;
+
+    if (exponent == 0x1f) {
+        /* inf or nan */
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if (mantissa != 0) {
+        /* subnormal: normalize it */
+        exponent = 113;
+        while ((mantissa & 0x400) == 0) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    } else {
+        bits = sign;
+    }
+
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+/** Converts a float to IEEE binary16, rounding to nearest even. Values beyond the half range become infinity.
+ * @param f
+ * @return uint16_t
+ */
+inline uint16_t float_to_half(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    uint32_t abs = bits & 0x7fffffff;
+
+    if (abs >= 0x7f800000) {
+        /* inf stays inf, nan stays a (quiet) nan */
+        return sign | 0x7c00 | ((abs > 0x7f800000) ? 0x200 : 0);
+    }
+    if (abs >= 0x477ff000) {
+        /* rounds to beyond 65504 */
+        return sign | 0x7c00;
+    }
+    if (abs < 0x38800000) {
+        /* subnormal half (or zero): shift the mantissa with its implicit bit into place, rounding to nearest even */
+        if (abs < 0x33000000) return sign;
+
+        uint32_t shift = 126 - (abs >> 23);
+        uint32_t mantissa = (abs & 0x7fffff) | 0x800000;
+        uint32_t half_mantissa = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+
+        if (rest > halfway || (rest == halfway && (half_mantissa & 1))) half_mantissa++;
+        return sign | (uint16_t) half_mantissa;
+    }
+
+    /* normal: rebias the exponent and round the mantissa; a carry correctly bumps the exponent */
+    uint32_t rounded = abs - 0x38000000 + 0xfff + ((abs >> 13) & 1);
+    return sign | (uint16_t)(rounded >> 13);
+}
+
+/** Converts a bfloat16 value, the upper 16 bits of a float, stored in a uint16_t, to float. Exact.
+ * @param b
+ * @return float
+ */
+inline float bfloat16_to_float(uint16_t b) {
+    uint32_t bits = (uint32_t) b << 16;
+
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+/** Converts a float to bfloat16, rounding to nearest even. It has the range of float, so only nan needs care.
+ * @param f
+ * @return uint16_t
+ */
+inline uint16_t float_to_bfloat16(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+
+    if ((bits & 0x7fffffff) > 0x7f800000) {
+        /* keep it a (quiet) nan even if the payload is in the dropped bits */
+        return (uint16_t)((bits >> 16) | 0x40);
+    }
+    bits += 0x7fff + ((bits >> 16) & 1);
+    return (uint16_t)(bits >> 16);
+}
+
+}  // namespace math
+}  // namespace magmadnn
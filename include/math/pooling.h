@@ -22,11 +22,27 @@ enum pooling_mode { MAX_POOL, AVERAGE_POOL };
 namespace magmadnn {
 namespace math {
 
+/** Settings for the native NCHW pooling kernels used on HOST when oneDNN is not available.
+ * For MAX_POOL the forward pass records, for every output element, the offset of the selected input element
+ * within its (n,c) plane in argmax. The backward pass then scatters each gradient entry to that offset instead of
+ * rescanning the input window. argmax must hold out->get_size() entries; if it is NULL the backward pass falls back
+ * to rescanning the window.
+ * AVERAGE_POOL excludes padding from the divisor, like CUDNN_POOLING_AVERAGE_COUNT_EXCLUDE_PADDING.
+ */
+struct pooling_cpu_settings {
+    int filter_h, filter_w;
+    int pad_h, pad_w;
+    int vertical_stride, horizontal_stride;
+    pooling_mode mode;
+    bool propagate_nan;
+    int *argmax;
+};
+
 template <typename T>
-void pooling(Tensor<T> *x, Tensor<T> *out);
+void pooling(Tensor<T> *x, Tensor<T> *out, pooling_cpu_settings settings);
 
 template <typename T>
-void pooling_grad(Tensor<T> *x, Tensor<T> *y, Tensor<T> *grad, Tensor<T> *out);
+void pooling_grad(Tensor<T> *x, Tensor<T> *y, Tensor<T> *grad, Tensor<T> *out, pooling_cpu_settings settings);
 
 #if defined(MAGMADNN_HAVE_CUDA)
 
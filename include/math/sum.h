@@ -14,6 +14,12 @@
 namespace magmadnn {
 namespace math {
 
+/** out = sum of tensors, in a single pass over out. Tensors of size 1 are broadcast as scalars. out may alias
+ * tensors[0].
+ * @tparam T numeric
+ * @param tensors
+ * @param out
+ */
 template <typename T>
 void sum(const std::vector<Tensor<T>*>& tensors, Tensor<T>* out);
 
@@ -11,6 +11,7 @@
 
 #include "math/add.h"
 #include "math/argmax.h"
+#include "math/bias_activation.h"
 #include "math/concat.h"
 #include "math/dot.h"
 #include "math/dropout.h"
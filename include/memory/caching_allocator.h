@@ -0,0 +1,95 @@
+/**
+ * @file caching_allocator.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#include <cstddef>
+
+#if defined(MAGMADNN_CMAKE_BUILD)
+#include "magmadnn/config.h"
+#endif
+#include "magmadnn/types.h"
+
+namespace magmadnn {
+namespace memory {
+
+/** Counters of one caching allocator. Byte counts are in rounded up block sizes.
+ */
+struct allocator_stats_t {
+    std::size_t bytes_in_use;      /* handed out and not yet freed */
+    std::size_t bytes_cached;      /* freed and kept for reuse */
+    std::size_t peak_bytes_in_use; /* highest bytes_in_use since the last reset_peak_bytes_in_use */
+    std::size_t n_system_allocs;   /* calls to malloc/cudaMalloc so far */
+    std::size_t n_system_frees;    /* calls to free/cudaFree so far */
+};
+
+/* The MemoryManager allocates HOST and DEVICE memory from these caching allocators. Requests are rounded up to a
+ * size class, at most a quarter above the request, and freed blocks are kept in a free list per class instead of
+ * being returned to the system. Once a training loop has run one iteration, every later iteration asks for the same
+ * sizes and is served from the cache.
+ *
+ * A DEVICE block records an event on the stream it was freed on. It is handed out again right away for the same
+ * stream, since the stream orders the new work after the old, and for another stream only once that event has
+ * completed. Otherwise a new block is allocated. When cudaMalloc runs out of memory, the cache is trimmed and the
+ * allocation retried.
+ *
+ * CUDA_MANAGED memory is not cached. */
+
+/** Allocates bytes of HOST memory.
+ * @param bytes
+ * @return void* NULL if bytes is 0 or the allocation failed
+ */
+void *host_malloc(std::size_t bytes);
+
+/** Returns ptr, from host_malloc, to the cache.
+ * @param ptr may be NULL
+ */
+void host_free(void *ptr);
+
+#if defined(MAGMADNN_HAVE_CUDA)
+/** Allocates bytes of DEVICE memory on the current device for use on stream.
+ * @param bytes
+ * @param stream
+ * @return void* NULL if bytes is 0 or the allocation failed
+ */
+void *device_malloc(std::size_t bytes, cudaStream_t stream);
+
+/** Returns ptr, from device_malloc, to the cache once the work queued on stream is done with it.
+ * @param ptr may be NULL
+ * @param stream the last stream that used ptr
+ */
+void device_free(void *ptr, cudaStream_t stream);
+#endif
+
+/** Counters of the allocator behind mem_type: HOST, or DEVICE for the current device.
+ * @param mem_type
+ * @return allocator_stats_t
+ */
+allocator_stats_t get_allocator_stats(memory_t mem_type);
+
+/** Sets peak_bytes_in_use of the allocator behind mem_type to its current bytes_in_use.
+ * @param mem_type
+ */
+void reset_peak_bytes_in_use(memory_t mem_type);
+
+/** Gives every cached block of every allocator back to the system. Blocks in use are not affected.
+ */
+void trim_allocator_cache();
+
+/** Turns the caching on or off. When off, every allocation and free goes to the system, which is what memory
+ * checkers want to see. Defaults to on unless the environment variable MAGMADNN_CACHING_ALLOCATOR is 0. Turning it
+ * off does not trim the cache.
+ * @param enabled
+ */
+void set_allocator_caching(bool enabled);
+
+/** @return bool whether freed blocks are cached
+ */
+bool get_allocator_caching();
+
+}  // namespace memory
+}  // namespace magmadnn
@@ -25,6 +25,16 @@ class MemoryManager {
      */
     MemoryManager(unsigned int size, memory_t mem_type, device_t device_id);
 
+    /** MemoryManager that uses the size elements at ptr, which it does not own, from the start. Nothing is
+     *  allocated. ptr must outlive this memory manager. Not supported for MANAGED memory, which gets its own
+     *  allocation instead.
+     *  @param size the number of elements at ptr
+     *  @param mem_type memory type of ptr
+     *  @param device_id device of ptr
+     *  @param ptr memory to use
+     */
+    MemoryManager(unsigned int size, memory_t mem_type, device_t device_id, T* ptr);
+
     /** Copy Constructor
      * @param that
      */
@@ -162,7 +172,32 @@ class MemoryManager {
      */
     magmadnn_error_t zero();
 
+    /** Makes this memory manager use the get_size() elements at ptr instead of its own allocation, which is freed.
+     *  ptr is not owned and must outlive this memory manager or a later call with ptr == NULL, which switches back to
+     *  a private allocation. Not supported for MANAGED memory.
+     *  @param ptr memory of the same memory type and device, or NULL
+     *  @param copy_contents if true the current contents are copied to the new memory, otherwise the data is what
+     *  the new memory holds (use a view of existing data)
+     *  @return magmadnn_error_t non-zero on error
+     */
+    magmadnn_error_t use_external_memory(T* ptr, bool copy_contents = true);
+
+    /** Exchanges the memory of this and that, which must have the same size and memory type and own their memory.
+     *  Nothing is copied.
+     *  @param that
+     *  @return magmadnn_error_t non-zero if the two are not interchangeable
+     */
+    magmadnn_error_t swap_memory(MemoryManager<T>& that);
+
+    /** Whether the memory is allocated (and freed) by this memory manager.
+     * @return bool
+     */
+    bool owns_memory() const { return owns; }
+
    private:
+    /** frees the memory if owned */
+    void free_memory();
+
     /** init with HOST parameters */
     void init_host();
 
@@ -182,6 +217,7 @@ class MemoryManager {
 
     unsigned int size;
     T* host_ptr;
+    bool owns; /* false when using memory given to use_external_memory */
 
 #if defined(MAGMADNN_HAVE_CUDA)
     T* device_ptr;
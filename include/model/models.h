@@ -9,4 +9,5 @@
 #pragma once
 
 #include "model/model.h"
+#include "model/neuralnetwork/inferencesession.h"
 #include "model/neuralnetwork/neuralnetwork.h"
\ No newline at end of file
@@ -0,0 +1,106 @@
+/**
+ * @file inferencesession.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#include <vector>
+
+#include "compute/batchnorm/batchnormop.h"
+#include "compute/dropout/dropoutop.h"
+#include "compute/operation.h"
+#include "math/bias_activation.h"
+#include "model/neuralnetwork/neuralnetwork.h"
+#include "tensor/tensor.h"
+
+namespace magmadnn {
+namespace model {
+
+/** Forward-only evaluation of a trained NeuralNetwork for serving. HOST networks made of input, fully connected,
+ * activation, dropout, flatten and output layers are compiled into a list of steps over buffers allocated once
+ * for the session's batch size: each fully connected layer is a GEMM followed by one pass applying its bias and
+ * activation, softmax runs in place, dropout is the identity and flatten only reshapes. No operation of the graph
+ * is evaluated, so no gradient tensors or consumer lists are touched, and the weights are read from the model
+ * without copying them.
+ *
+ * Other networks run on the model's graph with its dropout and batch normalization switched to inference while
+ * the session evaluates it; the batch size is then the model's.
+ * @tparam T
+ */
+template <typename T>
+class InferenceSession {
+   public:
+    /**
+     * @param model trained network; it has to outlive the session
+     * @param batch_size number of samples evaluated at once, at most the batch size of the model
+     */
+    InferenceSession(NeuralNetwork<T> *model, unsigned int batch_size = 1);
+    ~InferenceSession();
+
+    /** Evaluates the network on samples, which is copied into the start of the input buffer. Rows of the buffer
+     * after those of samples keep their previous values.
+     * @param samples at most get_batch_size() samples
+     * @return Tensor<T>* output buffer of the session, valid until the next call
+     */
+    Tensor<T> *predict(Tensor<T> *samples);
+
+    /** math::argmax of the network output for a single sample, without allocating.
+     * @param sample
+     * @return unsigned int the index of the predicted class
+     */
+    unsigned int predict_class(Tensor<T> *sample);
+
+    unsigned int get_batch_size() const { return this->batch_size; }
+
+    /** Whether the network was compiled into steps (true) or runs on the model's graph.
+     * @return bool
+     */
+    bool is_compiled() const { return this->compiled; }
+
+   protected:
+    enum step_kind_t { STEP_DENSE, STEP_ACTIVATION, STEP_SOFTMAX };
+
+    struct step_t {
+        step_kind_t kind;
+        Tensor<T> *in, *out;       /* the same tensor for in-place steps */
+        Tensor<T> *weights, *bias; /* dense only; bias may be NULL */
+        Tensor<T> *bias_rows;      /* the first batch_size rows of bias, when it has more */
+        math::fused_activation_t activation;
+    };
+
+    /* turns the layers of the model into steps; false if one of them is not supported */
+    bool compile();
+
+    /* adds a dense step reading from current, which then becomes its output; false if the shapes do not fit */
+    bool add_dense_step(Tensor<T> *weights, Tensor<T> *bias, math::fused_activation_t activation);
+
+    /* runs the compiled steps on input_buffer */
+    Tensor<T> *run();
+
+    /* switches dropout and batch normalization of the model between training and inference */
+    void set_graph_training(bool training);
+
+    /* the mode of each of those ops, dropout first, and the inverse to restore them */
+    std::vector<bool> get_graph_training();
+    void set_graph_training(const std::vector<bool> &modes);
+
+    NeuralNetwork<T> *model;
+    unsigned int batch_size;
+    bool compiled;
+
+    std::vector<step_t> steps;
+    std::vector<Tensor<T> *> buffers; /* owned by the session */
+    Tensor<T> *current;               /* output of the last step while compiling */
+    Tensor<T> *input_buffer, *output_buffer;
+
+    /* ops of the graph that behave differently in training */
+    std::vector<op::DropoutOp<T> *> graph_dropout_ops;
+    std::vector<op::BatchNormOp<T> *> graph_batchnorm_ops;
+    Tensor<T> *host_output; /* copy of a device output for predict_class */
+};
+
+}  // namespace model
+}  // namespace magmadnn
@@ -11,24 +11,33 @@
 #include <cmath>
 #include <ctime>
 #include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
 #include "compute/op_utilities.h"
 #include "dataloader/dataloaders.h"
 #include "layer/layers.h"
 #include "math/argmax.h"
 #include "model/model.h"
 #include "optimizer/optimizers.h"
+#include "tensor/flat_buffer.h"
 
 namespace magmadnn {
 namespace model {
 
 struct nn_params_t {
-    unsigned int n_epochs;        /**<n_epochs number of epochs to train for */
-    unsigned int batch_size;      /**<batch_size the size of the batch */
-    double learning_rate;         /**<initial learning rate */
-    double momentum = 0.9;        /**<momentum rate */
-    double decaying_factor = 0.9; /**<decaying factor for RMSProp */
-    double beta1 = 0.9;           /**<beta1 for Adam */
-    double beta2 = 0.999;         /**<beta2 for Adam */
+    unsigned int n_epochs;           /**<n_epochs number of epochs to train for */
+    unsigned int batch_size;         /**<batch_size the size of the batch */
+    double learning_rate;            /**<initial learning rate */
+    double momentum = 0.9;           /**<momentum rate */
+    double decaying_factor = 0.9;    /**<decaying factor for RMSProp */
+    double beta1 = 0.9;              /**<beta1 for Adam */
+    double beta2 = 0.999;            /**<beta2 for Adam */
+    unsigned int prefetch_depth = 0; /**<batches loaded ahead on a background thread during fit; 0 loads in line */
+    bool shuffle = false;            /**<visit the samples in a new random order every epoch during fit */
+    unsigned int checkpoint_every = 0;               /**<epochs between checkpoints saved during fit; 0 never */
+    std::string checkpoint_path = "checkpoint.mdnn"; /**<file the checkpoints of fit are saved to */
+    bool flat_buffers = false; /**<keep all weights, and separately all their gradients, in one contiguous buffer */
 };
 
 template <typename T>
@@ -57,7 +66,7 @@ class NeuralNetwork : public Model<T> {
     /** Trains this neural network using x and y. The batch size and epochs are used from the model parameters given
      * during construction. If verbose, then training info is printed periodically.
      * @param x independent data
-     * @param y ground truth <i>one-hot encoded</i> data
+     * @param y ground truth <i>one-hot encoded</i> data, or one class index per sample for SPARSE_CROSS_ENTROPY
      * @param metric_out [out] metric to write training metrics in
      * @param verbose if true, run in verbose mode
      * @return magmadnn_error_t 0 on success
@@ -66,10 +75,47 @@ class NeuralNetwork : public Model<T> {
     virtual Tensor<T> *predict(Tensor<T> *sample);
     virtual unsigned int predict_class(Tensor<T> *sample);
 
+    /** Evaluates the network on every sample of x, a batch of the model's batch size at a time; the last batch is
+     * padded with zeros. Copying batch b+1 in and batch b-1 out is done on a second thread while batch b is
+     * evaluated. Dropout and batch normalization run in inference mode and are restored to their mode after.
+     * @param x any number of samples along the first axis, on HOST
+     * @param out [out] on HOST, {n_samples, outputs...} for the network outputs, or {n_samples} for the index of the
+     * largest output of each sample
+     * @return magmadnn_error_t 0 on success, 1 if x or out do not fit the network
+     */
+    magmadnn_error_t predict_batch(Tensor<T> *x, Tensor<T> *out);
+
     /** Prints out a summary of the neural network
      */
     virtual void summary();
 
+    /** Saves the weights, the optimizer state and the epoch count to file_name. They are copied into a host snapshot
+     * right away; unless blocking, the snapshot is written on a background thread while training goes on. The file
+     * is replaced only once it is complete. A save waits for the write of the previous one.
+     * @param file_name
+     * @param blocking return only once the file is written
+     * @return magmadnn_error_t 0 on success (of the snapshot, unless blocking) @see wait_for_checkpoint
+     */
+    magmadnn_error_t save_checkpoint(const std::string &file_name, bool blocking = false);
+
+    /** Waits for the background write of the last checkpoint.
+     * @return magmadnn_error_t 0 if it was written
+     */
+    magmadnn_error_t wait_for_checkpoint();
+
+    /** Restores the weights, the optimizer state and the epoch count saved by save_checkpoint, for a network of the
+     * same layers and optimizer. The next fit resumes training at the saved epoch.
+     * @param file_name
+     * @return magmadnn_error_t 0 on success, 1 if the file is not a checkpoint, 2 if it was saved from a different
+     * network or optimizer; nothing is restored on error
+     */
+    magmadnn_error_t load_checkpoint(const std::string &file_name);
+
+    /** Epochs completed by the current or last fit, counting those before a restored checkpoint.
+     * @return unsigned int
+     */
+    unsigned int get_epoch() const { return this->epoch; }
+
     virtual std::vector<layer::Layer<T> *> get_layers() { return this->layers; }
 
     // Return model memory type
@@ -83,6 +129,19 @@ class NeuralNetwork : public Model<T> {
 
     std::vector<op::Operation<T> *> &weights() { return this->_vars; }
 
+    /** With nn_params_t::flat_buffers, the buffer holding the output tensors of weights() in that order, each
+     * starting at a multiple of FLAT_BUFFER_ALIGNMENT bytes. A collective or an update can then work on all of
+     * them at once.
+     * @return Tensor<T>* NULL without flat buffers
+     */
+    Tensor<T> *flat_weights() { return this->flat_params.get_tensor(); }
+
+    /** With nn_params_t::flat_buffers, the buffer the backward pass writes the gradients of weights() into, with
+     * the layout of flat_weights().
+     * @return Tensor<T>* NULL without flat buffers
+     */
+    Tensor<T> *flat_gradients() { return this->flat_grads.get_tensor(); }
+
    protected:
     typename std::vector<layer::Layer<T> *> layers;
     optimizer::loss_t loss_func;
@@ -101,7 +160,31 @@ class NeuralNetwork : public Model<T> {
     std::vector<op::Operation<T> *> _vars; /* network weights */
     op::Operation<T> *_obj;                /* objective function to optimize -- i.e. the loss function */
     Tensor<T> *_obj_tensor_ptr;            /* pointer to objective function's tensor */
+    op::Operation<T> *score_op_ptr;        /* argmax'ed for accuracy: the output, or logits of a fused softmax */
+    Tensor<T> *score_tensor_ptr;           /* output tensor of score_op_ptr */
     optimizer::Optimizer<T> *optim;        /* network optimizer */
+
+    /* creates the ground truth and the loss (_obj). A softmax output under a cross entropy loss is fused into it. */
+    void init_loss();
+
+    /* the weights followed by the optimizer state, as checkpoints store them */
+    std::vector<Tensor<T> *> get_checkpoint_tensors();
+
+    /* moves the weights into flat_params and hands gradient tensors in flat_grads to their consumers */
+    void init_flat_buffers();
+
+    /* whether the weights are still the tensors of flat_params, which then has the layout of their checkpoint */
+    bool weights_are_flat();
+
+    FlatBuffer<T> flat_params;
+    FlatBuffer<T> flat_grads;
+
+    unsigned int epoch;        /* epochs completed by fit */
+    unsigned int resume_epoch; /* epoch the next fit starts at */
+
+    std::thread checkpoint_thread;       /* writes checkpoint_buffer */
+    std::vector<char> checkpoint_buffer; /* checkpoint file contents */
+    magmadnn_error_t checkpoint_error;
 };
 
 }  // namespace model
@@ -28,6 +28,8 @@ class AdaGrad : public Optimizer<T> {
     void set_learning_rate(T learning_rate) { this->learning_rate = learning_rate; }
     T get_learning_rate() { return this->learning_rate; }
 
+    virtual std::vector<Tensor<T> *> get_state_tensors(const std::vector<op::Operation<T> *> &wrt);
+
    protected:
     virtual void update(op::Operation<T> *var, Tensor<T> *grad);
 
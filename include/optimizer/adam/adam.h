@@ -28,6 +28,10 @@ class Adam : public Optimizer<T> {
     void set_learning_rate(T learning_rate) { this->learning_rate = learning_rate; }
     T get_learning_rate() { return this->learning_rate; }
 
+    virtual std::vector<Tensor<T> *> get_state_tensors(const std::vector<op::Operation<T> *> &wrt);
+    virtual std::vector<double> get_state_scalars();
+    virtual void set_state_scalars(const std::vector<double> &scalars);
+
    protected:
     virtual void update(op::Operation<T> *var, Tensor<T> *grad);
 
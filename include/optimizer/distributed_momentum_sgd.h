@@ -26,6 +26,8 @@ class DistMomentumSGD : public Optimizer<T> {
     void set_momentum(T momentum) { this->momentum = momentum; }
     T get_momentum() { return this->momentum; }
 
+    virtual std::vector<Tensor<T> *> get_state_tensors(const std::vector<op::Operation<T> *> &wrt);
+
    protected:
     virtual void update(op::Operation<T> *var, Tensor<T> *grad);
 
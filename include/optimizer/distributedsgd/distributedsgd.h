@@ -38,6 +38,9 @@ class DistributedGradientDescent : public Optimizer<T> {
     DistributedGradientDescent(T learning_rate) : learning_rate(learning_rate) {
         this->_name = "DistributedGradientDescentOptimizer";
 
+        /* only the gradients of wrt are read back, so the intermediate ones are freed during the backward pass */
+        this->table.get_executor().set_release_buffers(true);
+
         nnodes = 1;
 
 #if defined(_HAS_MPI_)
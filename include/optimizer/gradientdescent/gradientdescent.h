@@ -15,6 +15,7 @@
 #include "math/optimizer_math/sgd_momentum.h"
 #include "optimizer/gradientdescent/gradientdescent_internal.h"
 #include "optimizer/optimizer.h"
+#include "tensor/flat_buffer.h"
 
 namespace magmadnn {
 namespace optimizer {
@@ -32,13 +33,25 @@ class GradientDescent : public Optimizer<T> {
     void set_momentum(T momentum) { this->momentum = momentum; }
     T get_momentum() { return this->momentum; }
 
+    virtual std::vector<Tensor<T> *> get_state_tensors(const std::vector<op::Operation<T> *> &wrt);
+
+    /** The momentum of wrt is moved into a flat buffer of the same layout, so a step is one sgd_momentum call. */
+    virtual bool set_flat_buffers(const std::vector<op::Operation<T> *> &wrt, Tensor<T> *params, Tensor<T> *grads);
+
    protected:
     virtual void update(op::Operation<T> *var, Tensor<T> *grad);
 
+    /* whether the gradients of wrt in table are the views of flat_grads */
+    bool flat_step_applies(const std::vector<op::Operation<T> *> &wrt);
+
     T learning_rate;
     T momentum;
     op::GradTable<T> table;
     std::map<op::Operation<T> *, Tensor<T> *> momentum_table;
+
+    std::vector<op::Operation<T> *> flat_wrt;
+    Tensor<T> *flat_params, *flat_grads;
+    FlatBuffer<T> flat_momentum;
 };
 
 }  // namespace optimizer
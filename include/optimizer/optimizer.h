@@ -8,6 +8,7 @@
  */
 #pragma once
 
+#include <map>
 #include <string>
 #include <vector>
 #include "compute/operation.h"
@@ -26,9 +27,46 @@ class Optimizer {
 
     virtual std::string get_name() { return _name; }
 
+    /** The tensors holding this optimizer's state for the variables wrt, such as momentum, in a fixed order, so that
+     * checkpoints can save and restore them. Entries the first update would create are created here, zeroed, so the
+     * list does not depend on whether training has started.
+     * @param wrt
+     * @return std::vector<Tensor<T> *> tensors owned by the optimizer
+     */
+    virtual std::vector<Tensor<T> *> get_state_tensors(const std::vector<op::Operation<T> *> &wrt) { return {}; }
+
+    /** Scalar state, such as step counters, for checkpoints.
+     * @return std::vector<double>
+     */
+    virtual std::vector<double> get_state_scalars() { return {}; }
+    virtual void set_state_scalars(const std::vector<double> &scalars) {}
+
+    /** Tells the optimizer that the outputs of wrt are the tensors of the FlatBuffer params, in this order, and that
+     * their gradients are computed into the tensors of grads, which has the same layout. An optimizer that supports
+     * it then updates all of them with one call on the whole buffers, as long as the gradients are still there.
+     * @param wrt
+     * @param params flat buffer of the variables, or NULL to update them one by one again
+     * @param grads flat buffer of the gradients
+     * @return bool whether the optimizer uses the flat buffers
+     */
+    virtual bool set_flat_buffers(const std::vector<op::Operation<T> *> &wrt, Tensor<T> *params, Tensor<T> *grads) {
+        return false;
+    }
+
    protected:
     virtual void update(op::Operation<T> *var, Tensor<T> *grad) = 0;
 
+    /* table[var], created zeroed in the shape and memory of var's output if missing */
+    static Tensor<T> *get_state_tensor(std::map<op::Operation<T> *, Tensor<T> *> &table, op::Operation<T> *var) {
+        typename std::map<op::Operation<T> *, Tensor<T> *>::iterator it = table.find(var);
+        if (it != table.end()) return it->second;
+
+        Tensor<T> *var_tensor = var->get_output_tensor();
+        Tensor<T> *state = new Tensor<T>(var_tensor->get_shape(), {ZERO, {}}, var_tensor->get_memory_type());
+        table[var] = state;
+        return state;
+    }
+
     op::Operation<T> *_obj_func;
     std::string _name = "Generic Optimizer";
 };
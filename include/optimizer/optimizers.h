@@ -24,7 +24,8 @@ enum optimizer_t {
     ADAM,
 };
 
-enum loss_t { CROSS_ENTROPY, MSE };
+/* SPARSE_CROSS_ENTROPY takes one class index per sample as ground truth instead of one-hot rows */
+enum loss_t { CROSS_ENTROPY, MSE, SPARSE_CROSS_ENTROPY };
 
 }  // namespace optimizer
 }  // namespace magmadnn
\ No newline at end of file
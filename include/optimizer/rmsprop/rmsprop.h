@@ -31,6 +31,8 @@ class RMSProp : public Optimizer<T> {
     void set_decaying_factor(T decaying_factor) { this->decaying_factor = decaying_factor; }
     T get_decaying_factor() { return this->decaying_factor; }
 
+    virtual std::vector<Tensor<T> *> get_state_tensors(const std::vector<op::Operation<T> *> &wrt);
+
    protected:
     virtual void update(op::Operation<T> *var, Tensor<T> *grad);
 
@@ -0,0 +1,90 @@
+/**
+ * @file flat_buffer.h
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "magmadnn/types.h"
+#include "tensor/tensor.h"
+
+namespace magmadnn {
+
+/* byte alignment of every tensor in a FlatBuffer, the same as that of the tensors in a checkpoint file */
+const std::size_t FLAT_BUFFER_ALIGNMENT = 64;
+
+/** One contiguous allocation holding the memory of several tensors.
+ *
+ * bind() moves each tensor, keeping its contents, to the next multiple of FLAT_BUFFER_ALIGNMENT bytes of the buffer.
+ * The tensors stay the same objects, so pointers to them remain valid. The whole buffer is a tensor of its own, so a
+ * single call (a collective, an optimizer step, a copy) can work on all of them at once. The gaps between tensors
+ * are zero and only change if such a call writes them.
+ *
+ * Two FlatBuffers bound to tensors of the same sizes in the same order have the same layout.
+ * @tparam T numeric
+ */
+template <typename T>
+class FlatBuffer {
+   public:
+    FlatBuffer();
+    ~FlatBuffer();
+
+    FlatBuffer(const FlatBuffer &) = delete;
+    FlatBuffer &operator=(const FlatBuffer &) = delete;
+
+    /** Allocates the buffer and moves tensors into it, in this order. Unbinds a previous binding.
+     * @param tensors tensors of one memory type that own their memory
+     * @return magmadnn_error_t 0 on success, 1 if tensors cannot be bound; nothing is moved on error
+     */
+    magmadnn_error_t bind(const std::vector<Tensor<T> *> &tensors);
+
+    /** Gives every bound tensor its own memory again (keeping its contents) and frees the buffer.
+     */
+    void unbind();
+
+    bool is_bound() const { return this->buffer != NULL; }
+
+    /** The whole buffer, gaps included, as a vector of get_size() elements.
+     * @return Tensor<T>* NULL if not bound
+     */
+    Tensor<T> *get_tensor() { return this->buffer; }
+
+    /** Number of elements of the buffer.
+     * @return unsigned int
+     */
+    unsigned int get_size() const { return (this->buffer != NULL) ? this->buffer->get_size() : 0; }
+
+    /** Offset in elements of the i-th bound tensor.
+     * @param i
+     * @return unsigned int
+     */
+    unsigned int get_offset(unsigned int i) const { return this->offsets[i]; }
+
+    const std::vector<Tensor<T> *> &get_tensors() const { return this->tensors; }
+
+    /** Whether tensor still uses the memory of the i-th bound tensor.
+     * @param i
+     * @param tensor
+     * @return bool
+     */
+    bool is_view(unsigned int i, Tensor<T> *tensor) const;
+
+    /** Size in elements of the buffer that bind would allocate for tensors of these sizes.
+     * @param sizes
+     * @param offsets [out] if not NULL, the offset of each tensor
+     * @return unsigned int
+     */
+    static unsigned int get_layout(const std::vector<unsigned int> &sizes, std::vector<unsigned int> *offsets = NULL);
+
+   protected:
+    Tensor<T> *buffer;
+    std::vector<Tensor<T> *> tensors;
+    std::vector<unsigned int> offsets;
+};
+
+}  // namespace magmadnn
@@ -79,6 +79,16 @@ class Tensor {
      */
     Tensor(std::vector<unsigned int> shape, tensor_filler_t<T> filler, memory_t mem_type, device_t device_id);
 
+    /** Initializes a tensor with the given shape that is a view of ptr, which it does not own. No memory is
+     * allocated and the data is what ptr holds. ptr must outlive the tensor. @see use_external_memory
+     * @param ptr memory of the given memory type holding at least as many elements as shape
+     * @param shape a vector of axis sizes
+     * @param mem_type memory type of ptr
+     * @param device_id device of ptr
+     */
+    Tensor(T* ptr, std::vector<unsigned int> shape, memory_t mem_type = TENSOR_DEFAULT_MEM_TYPE,
+           device_t device_id = TENSOR_DEFAULT_DEVICE_ID);
+
     /** Free tensor memory
      */
     ~Tensor();
@@ -268,8 +278,26 @@ class Tensor {
      */
     magmadnn_error_t zero();
 
+    /** Stores this tensor's data at ptr, which it does not own, instead of in its own allocation. NULL switches back
+     * to an own allocation. @see MemoryManager<T>::use_external_memory
+     * @param ptr
+     * @param copy_contents whether the current data moves along; false makes the tensor a view of ptr
+     * @return magmadnn_error_t non-zero on error
+     */
+    magmadnn_error_t use_external_memory(T* ptr, bool copy_contents = true) {
+        return this->mem_manager->use_external_memory(ptr, copy_contents);
+    }
+
+    /** Exchanges the data of this and that without copying. They must have the same size and memory type.
+     * @see MemoryManager<T>::swap_memory
+     * @param that
+     * @return magmadnn_error_t non-zero if the data could not be swapped
+     */
+    magmadnn_error_t swap_memory(Tensor<T>& that) { return this->mem_manager->swap_memory(*that.mem_manager); }
+
    private:
-    void init(std::vector<unsigned int>& shape, tensor_filler_t<T> filler, memory_t mem_type, device_t device_id);
+    void init(std::vector<unsigned int>& shape, tensor_filler_t<T> filler, memory_t mem_type, device_t device_id,
+              T* external_ptr = NULL);
     unsigned int get_flattened_index(const std::vector<unsigned int>& idx) const;
     unsigned int get_flattened_index_old(const std::vector<unsigned int>& idx) const;
 
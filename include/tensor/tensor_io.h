@@ -6,6 +6,10 @@
  *
  * @copyright Copyright (c) 2019
  */
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -15,12 +19,15 @@ namespace magmadnn {
 namespace io {
 
 /** Reads from "file_name" into the tensor t. It interprets the data as having the flattened shape of the
- * input tensor. Returns 0 if successfull, otherwise something else. @see write_tensor_to_csv
+ * input tensor. Values are separated by delim or by new lines; a delimiter at the end of a line is allowed. The file
+ * is read at once and parsed in parallel. Returns 0 if successfull, otherwise something else.
+ * @see write_tensor_to_csv
  * @tparam T data type
  * @param t tensor to read values into
  * @param file_name file name of csv file (should be a text file, not binary)
  * @param delim the delimiter of the csv (assumed to be a comma)
- * @return magmadnn_error_t 0 if successful, otherwise anything else
+ * @return magmadnn_error_t 0 if successful, 1 if the file cannot be read, 2 if a value cannot be parsed, 3 if the
+ * file has more values than t
  */
 template <typename T>
 magmadnn_error_t read_csv_to_tensor(Tensor<T>& t, const std::string& file_name, char delim = ',');
@@ -38,5 +45,139 @@ template <typename T>
 magmadnn_error_t write_tensor_to_csv(const Tensor<T>& t, const std::string& file_name, char delim = ',',
                                      bool create = true);
 
+/* Element type of a binary tensor file */
+enum tensor_dtype_t { TENSOR_INT32 = 0, TENSOR_FLOAT32 = 1, TENSOR_FLOAT64 = 2 };
+
+/* Order of the elements of a binary tensor file. Tensors are always stored densely in row major order. */
+enum tensor_layout_t { TENSOR_ROW_MAJOR = 0 };
+
+/** The element type of Tensor<T>
+ * @tparam T int, float or double
+ * @return tensor_dtype_t
+ */
+template <typename T>
+tensor_dtype_t get_tensor_dtype();
+template <>
+tensor_dtype_t get_tensor_dtype<int>();
+template <>
+tensor_dtype_t get_tensor_dtype<float>();
+template <>
+tensor_dtype_t get_tensor_dtype<double>();
+
+/* Binary tensor file layout: this header, n_dims uint64_t axis lengths, zero padding up to data_offset (a multiple
+   of 64), then the n_elements elements. Everything is in the byte order of the machine that wrote it, which
+   byte_order_mark (0x01020304) lets a reader check. */
+struct tensor_file_header_t {
+    char magic[8]; /* "MDNNTENS" */
+    uint32_t version;
+    uint32_t byte_order_mark;
+    uint32_t dtype;  /* tensor_dtype_t */
+    uint32_t layout; /* tensor_layout_t */
+    uint32_t n_dims;
+    uint32_t reserved;
+    uint64_t n_elements;
+    uint64_t data_offset;
+};
+
+/** Writes a binary tensor file in pieces, so that tensors can be saved without holding all of them in memory.
+ * The header goes out on construction and the elements, in row major order, with each write.
+ * @tparam T int, float or double
+ */
+template <typename T>
+class TensorFileWriter {
+   public:
+    /** Creates file_name for a tensor of the given shape. Check is_open() for errors.
+     * @param file_name
+     * @param shape
+     */
+    TensorFileWriter(const std::string& file_name, const std::vector<unsigned int>& shape);
+    ~TensorFileWriter();
+
+    TensorFileWriter(const TensorFileWriter&) = delete;
+    TensorFileWriter& operator=(const TensorFileWriter&) = delete;
+
+    bool is_open() const { return file != NULL; }
+
+    /** Appends count elements from host memory.
+     * @param values
+     * @param count
+     * @return magmadnn_error_t 0 on success
+     */
+    magmadnn_error_t write(const T* values, std::size_t count);
+
+    /** Appends every element of t, which may live in any memory.
+     * @param t
+     * @return magmadnn_error_t 0 on success
+     */
+    magmadnn_error_t write(const Tensor<T>& t);
+
+    /** Finishes the file.
+     * @return magmadnn_error_t 0 if all elements of the shape were written, otherwise something else
+     */
+    magmadnn_error_t close();
+
+   private:
+    std::FILE* file;
+    uint64_t n_elements;
+    uint64_t n_written;
+    bool failed;
+};
+
+/** Writes t to file_name as a binary tensor file. @see read_binary_to_tensor
+ * @tparam T data type
+ * @param t
+ * @param file_name
+ * @return magmadnn_error_t 0 on success
+ */
+template <typename T>
+magmadnn_error_t write_tensor_to_binary(const Tensor<T>& t, const std::string& file_name);
+
+/** Reads a binary tensor file into t, which must have as many elements. @see write_tensor_to_binary
+ * @tparam T data type, which must match the file's
+ * @param t
+ * @param file_name
+ * @return magmadnn_error_t 0 if successful, 1 if the file cannot be read or is not a tensor file of T, 2 if t has a
+ * different size
+ */
+template <typename T>
+magmadnn_error_t read_binary_to_tensor(Tensor<T>& t, const std::string& file_name);
+
+/** Reads a binary tensor file into a new tensor of the file's shape.
+ * @tparam T data type, which must match the file's
+ * @param file_name
+ * @param mem memory type of the new tensor
+ * @return Tensor<T>* NULL on error
+ */
+template <typename T>
+Tensor<T>* read_binary_tensor(const std::string& file_name, memory_t mem = HOST);
+
+/** A binary tensor file mapped into memory, whose elements a HOST tensor uses without copying them. Only the pages
+ * that are touched are ever read.
+ * @tparam T data type, which must match the file's
+ */
+template <typename T>
+class MappedTensorFile {
+   public:
+    /** Maps file_name. Check get_tensor() != NULL for errors.
+     * @param file_name
+     * @param writable let the tensor be written to; writes go to private copies of the pages, never to the file
+     */
+    explicit MappedTensorFile(const std::string& file_name, bool writable = false);
+    ~MappedTensorFile();
+
+    MappedTensorFile(const MappedTensorFile&) = delete;
+    MappedTensorFile& operator=(const MappedTensorFile&) = delete;
+
+    /** The tensor over the mapping, owned by this and valid as long as it is. Read only unless writable.
+     * @return Tensor<T>* NULL if the file could not be mapped
+     */
+    Tensor<T>* get_tensor() { return tensor; }
+
+   private:
+    void* base;
+    std::size_t mapped_bytes;
+    Tensor<T>* tensor;
+};
+
 }  // namespace io
 }  // namespace magmadnn
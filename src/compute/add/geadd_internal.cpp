@@ -11,6 +11,8 @@
 #endif
 #include "compute/add/geadd_internal.h"
 
+#include "math/elementwise.h"
+
 namespace magmadnn {
 namespace internal {
 
@@ -34,10 +36,7 @@ void geadd_full_cpu(T alpha, Tensor<T> *A, T beta, Tensor<T> *B, Tensor<T> *C) {
     T *c_ptr = C->get_ptr();
     unsigned int size = A->get_size();
 
-    // TODO Use BLAS kernels and MKL omatadd operation if available
-    for (unsigned int i = 0; i < size; i++) {
-        c_ptr[i] = (alpha * a_ptr[i]) + (beta * b_ptr[i]);
-    }
+    math::elementwise_binary(size, a_ptr, b_ptr, c_ptr, math::axpby_functor<T>(alpha, beta));
 }
 template void geadd_full_cpu(int alpha, Tensor<int> *A, int beta, Tensor<int> *B, Tensor<int> *C);
 template void geadd_full_cpu(float alpha, Tensor<float> *A, float beta, Tensor<float> *B, Tensor<float> *C);
@@ -64,9 +63,7 @@ void tensor_scalar_add_full_cpu(T alpha, Tensor<T> *x, Tensor<T> *out) {
     T *out_ptr = out->get_ptr();
     unsigned int size = out->get_size();
 
-    for (unsigned int i = 0; i < size; i++) {
-        out_ptr[i] = alpha + x_ptr[i];
-    }
+    math::elementwise_unary(size, x_ptr, out_ptr, math::shift_functor<T>(alpha));
 }
 template void tensor_scalar_add_full_cpu(int alpha, Tensor<int> *x, Tensor<int> *out);
 template void tensor_scalar_add_full_cpu(float alpha, Tensor<float> *x, Tensor<float> *out);
@@ -0,0 +1,325 @@
+/**
+ * @file backward_executor.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "compute/backward_executor.h"
+
+#include "math/sum.h"
+
+#if defined(MAGMADNN_CMAKE_BUILD)
+#include "magmadnn/config.h"
+#endif
+
+namespace magmadnn {
+namespace op {
+
+template <typename T>
+BackwardExecutor<T>::BackwardExecutor()
+    : plan_graph(NULL), grad_loss(NULL), release_buffers(false), n_released(0) {}
+
+template <typename T>
+BackwardExecutor<T>::~BackwardExecutor() {
+    if (this->grad_loss != NULL) delete this->grad_loss;
+}
+
+template <typename T>
+bool BackwardExecutor<T>::plan_is_valid(const std::vector<Operation<T> *> &vars, Operation<T> *graph) {
+    if (this->plan_graph != graph || this->plan_vars != vars) return false;
+
+    for (unsigned int i = 0; i < this->order.size(); i++) {
+        if (this->order[i]->get_consumers().size() != this->n_consumers[i]) return false;
+    }
+    return true;
+}
+
+template <typename T>
+magmadnn_error_t BackwardExecutor<T>::build_plan(const std::vector<Operation<T> *> &vars, Operation<T> *graph) {
+    struct frame {
+        Operation<T> *op;
+        std::vector<Operation<T> *> consumers;
+        unsigned int next;
+    };
+    std::vector<frame> stack;
+    std::vector<Operation<T> *> to_visit;
+    std::set<Operation<T> *> ancestors, visited;
+
+    this->order.clear();
+    this->n_consumers.clear();
+    this->plan_consumers.clear();
+    this->n_reads.clear();
+    this->plan_graph = NULL;
+
+    /* mark the ancestors of the head; a gradient can only flow back along them */
+    ancestors.insert(graph);
+    to_visit.push_back(graph);
+    while (!to_visit.empty()) {
+        std::vector<Operation<T> *> inputs = to_visit.back()->get_inputs();
+        to_visit.pop_back();
+
+        for (unsigned int i = 0; i < inputs.size(); i++) {
+            if (inputs[i] != NULL && ancestors.insert(inputs[i]).second) to_visit.push_back(inputs[i]);
+        }
+    }
+
+    /* iterative post-order DFS from the vars along the consumer edges that stay among the ancestors: an operation is
+       appended once all of its consumers have been, which is exactly the order the gradients have to be computed in.
+       The graph head is the end of every path, so its consumers are not followed. */
+    for (typename std::vector<Operation<T> *>::const_iterator vit = vars.begin(); vit != vars.end(); vit++) {
+        /* graph does not depend on this var */
+        if (!ancestors.count(*vit)) return (magmadnn_error_t) 2;
+
+        if (visited.count(*vit)) continue;
+
+        visited.insert(*vit);
+        stack.push_back({*vit, (*vit == graph) ? std::vector<Operation<T> *>() : (*vit)->get_consumers(), 0});
+
+        while (!stack.empty()) {
+            frame &top = stack.back();
+
+            if (top.next < top.consumers.size()) {
+                Operation<T> *consumer = top.consumers[top.next++];
+
+                if (consumer == NULL || !ancestors.count(consumer) || visited.count(consumer)) continue;
+
+                visited.insert(consumer);
+                /* top is invalidated by the push */
+                stack.push_back(
+                    {consumer, (consumer == graph) ? std::vector<Operation<T> *>() : consumer->get_consumers(), 0});
+            } else {
+                this->order.push_back(top.op);
+                stack.pop_back();
+            }
+        }
+    }
+
+    /* the post-order puts every variable after the whole path it starts, so weights would all come last. A variable
+       whose gradient no operation of the plan reads (a leaf, like a weight) only has to come after its consumers,
+       so it is moved up to right after the last of them and its gradient is done as early as possible in a run. */
+    std::set<Operation<T> *> var_set(vars.begin(), vars.end());
+    std::map<Operation<T> *, unsigned int> position;
+    std::vector<std::vector<Operation<T> *>> moved_after(this->order.size());
+    std::vector<bool> moved(this->order.size(), false);
+
+    for (unsigned int i = 0; i < this->order.size(); i++) {
+        Operation<T> *op = this->order[i];
+        position[op] = i;
+
+        if (op == graph || !var_set.count(op)) continue;
+
+        bool is_leaf = true;
+        std::vector<Operation<T> *> inputs = op->get_inputs();
+        for (unsigned int j = 0; j < inputs.size() && is_leaf; j++) {
+            if (inputs[j] != NULL && visited.count(inputs[j])) is_leaf = false;
+        }
+        if (!is_leaf) continue;
+
+        /* consumers in the plan come earlier in the order */
+        int last = -1;
+        std::vector<Operation<T> *> consumers = op->get_consumers();
+        for (unsigned int j = 0; j < consumers.size(); j++) {
+            if (consumers[j] == NULL || !visited.count(consumers[j])) continue;
+            if ((int) position[consumers[j]] > last) last = position[consumers[j]];
+        }
+        if (last >= 0 && (unsigned int) last + 1 < i) {
+            moved_after[last].push_back(op);
+            moved[i] = true;
+        }
+    }
+
+    std::vector<Operation<T> *> schedule;
+    schedule.reserve(this->order.size());
+    for (unsigned int i = 0; i < this->order.size(); i++) {
+        if (!moved[i]) schedule.push_back(this->order[i]);
+        schedule.insert(schedule.end(), moved_after[i].begin(), moved_after[i].end());
+    }
+    this->order.swap(schedule);
+
+    /* every non-head operation reads the gradient of each of its consumers in the plan once per edge */
+    for (unsigned int i = 0; i < this->order.size(); i++) {
+        std::vector<Operation<T> *> consumers = this->order[i]->get_consumers();
+
+        this->n_consumers.push_back(consumers.size());
+        this->plan_consumers.push_back(std::vector<Operation<T> *>());
+
+        if (this->order[i] == graph) continue;
+
+        for (unsigned int j = 0; j < consumers.size(); j++) {
+            if (consumers[j] == NULL || !visited.count(consumers[j])) continue;
+
+            this->plan_consumers[i].push_back(consumers[j]);
+            this->n_reads[consumers[j]]++;
+        }
+    }
+
+    this->plan_graph = graph;
+    this->plan_vars = vars;
+    this->plan_var_set = std::set<Operation<T> *>(vars.begin(), vars.end());
+
+    return (magmadnn_error_t) 0;
+}
+
+template <typename T>
+magmadnn_error_t BackwardExecutor<T>::prepare(const std::vector<Operation<T> *> &vars, Operation<T> *graph) {
+    if (graph == NULL) return (magmadnn_error_t) 1;
+    for (typename std::vector<Operation<T> *>::const_iterator vit = vars.begin(); vit != vars.end(); vit++) {
+        if (*vit == NULL) return (magmadnn_error_t) 1;
+    }
+
+    if (this->plan_is_valid(vars, graph)) return (magmadnn_error_t) 0;
+
+    return this->build_plan(vars, graph);
+}
+
+template <typename T>
+magmadnn_error_t BackwardExecutor<T>::run(const std::vector<Operation<T> *> &vars, Operation<T> *graph,
+                                          GradTable<T> &table) {
+    magmadnn_error_t err;
+    Tensor<T> *result;
+
+    err = this->prepare(vars, graph);
+    if (err != 0) return err;
+
+    this->pending_reads.clear();
+    this->owners.clear();
+    this->holders.clear();
+    this->kept.clear();
+    this->n_released = 0;
+
+    /* d graph / d graph = 1 */
+    if (this->grad_loss == NULL || this->grad_loss->get_memory_type() != graph->get_memory_type()) {
+        if (this->grad_loss != NULL) delete this->grad_loss;
+
+        this->grad_loss = new Tensor<T>({1}, {NONE, {}}, graph->get_memory_type());
+#if defined(MAGMADNN_HAVE_CUDA)
+        this->grad_loss->set_custream(graph->get_custream());
+        this->grad_loss->set_cublas_handle(graph->get_cublas_handle());
+#endif
+    }
+    this->grad_loss->fill_memory({ONE, {}});
+
+    table.set(graph, this->grad_loss);
+    this->kept.insert(this->grad_loss);
+
+    for (unsigned int n = 0; n < this->order.size(); n++) {
+        Operation<T> *var = this->order[n];
+
+        if (var == graph) continue;
+
+        const std::vector<Operation<T> *> &consumers = this->plan_consumers[n];
+
+        this->bprops.clear();
+        this->consumer_grads.clear();
+
+        for (unsigned int i = 0; i < consumers.size(); i++) {
+            Operation<T> *consumer = consumers[i];
+
+            /* consumers come earlier in the order, so their gradient is in the table */
+            Tensor<T> *consumer_grad = table.get(consumer);
+            if (consumer_grad == NULL) return (magmadnn_error_t) 2;
+
+            Tensor<T> *bprop = consumer->grad(consumer, var, consumer_grad);
+
+            /* anything other than the incoming gradient lives in the consumer's grad cache */
+            if (bprop != consumer_grad && this->owners.find(bprop) == this->owners.end()) {
+                this->owners[bprop] = {consumer, var};
+            }
+
+            this->bprops.push_back(bprop);
+            this->consumer_grads.push_back(consumer_grad);
+        }
+
+        /* sum of each partial gradient is the total gradient */
+        if (this->bprops.size() == 0) {
+            return (magmadnn_error_t) 2;
+        } else if (this->bprops.size() == 1) {
+            result = this->bprops[0];
+        } else {
+            Tensor<T> *widest = this->bprops[0]; /* partials that are scalars get broadcast */
+            for (unsigned int i = 1; i < this->bprops.size(); i++) {
+                if (this->bprops[i]->get_size() > widest->get_size()) widest = this->bprops[i];
+            }
+            result = var->get_grad_accumulator(widest->get_shape(), widest->get_memory_type());
+            magmadnn::math::sum(this->bprops, result);
+
+            this->owners[result] = {var, NULL};
+        }
+
+        table.set(var, result);
+        if (this->plan_var_set.count(var)) {
+            this->kept.insert(result);
+            if (this->grad_ready_callback) this->grad_ready_callback(var, result);
+        } else {
+            this->holders[result].push_back(var);
+        }
+        this->pending_reads[result] += this->n_reads[var];
+
+        /* this operation was the last reader of some of its consumers' gradients */
+        for (unsigned int i = 0; i < this->consumer_grads.size(); i++) {
+            this->consume(this->consumer_grads[i], table);
+        }
+
+        /* partial gradients that were summed are dead unless another entry still points to them */
+        if (this->bprops.size() > 1 && this->release_buffers) {
+            for (unsigned int i = 0; i < this->bprops.size(); i++) {
+                typename std::map<Tensor<T> *, unsigned int>::iterator pit = this->pending_reads.find(this->bprops[i]);
+
+                if (pit == this->pending_reads.end() || pit->second == 0) this->release(this->bprops[i], table);
+            }
+        }
+    }
+
+    return (magmadnn_error_t) 0;
+}
+
+template <typename T>
+void BackwardExecutor<T>::consume(Tensor<T> *grad, GradTable<T> &table) {
+    typename std::map<Tensor<T> *, unsigned int>::iterator it = this->pending_reads.find(grad);
+
+    if (it == this->pending_reads.end() || it->second == 0) return;
+
+    it->second--;
+    if (it->second == 0 && this->release_buffers) this->release(grad, table);
+}
+
+template <typename T>
+void BackwardExecutor<T>::release(Tensor<T> *grad, GradTable<T> &table) {
+    bool freed;
+
+    /* kept, or memory planned by someone else that is already reused */
+    if (this->kept.count(grad) || !grad->get_memory_manager()->owns_memory()) return;
+
+    typename std::map<Tensor<T> *, grad_owner>::iterator owner = this->owners.find(grad);
+    if (owner == this->owners.end()) return;
+
+    if (owner->second.wrt == NULL) {
+        owner->second.op->release_grad_accumulator();
+        freed = true;
+    } else {
+        freed = owner->second.op->release_grad_tensor(owner->second.wrt, grad);
+    }
+    this->owners.erase(owner);
+
+    if (!freed) return;
+
+    this->n_released++;
+
+    /* drop the table entries that pointed to it; the address may be handed out again by the next allocation */
+    typename std::map<Tensor<T> *, std::vector<Operation<T> *>>::iterator hit = this->holders.find(grad);
+    if (hit != this->holders.end()) {
+        for (unsigned int i = 0; i < hit->second.size(); i++) {
+            if (table.get(hit->second[i]) == grad) table.erase(hit->second[i]);
+        }
+        this->holders.erase(hit);
+    }
+    this->pending_reads.erase(grad);
+}
+
+template class BackwardExecutor<int>;
+template class BackwardExecutor<float>;
+template class BackwardExecutor<double>;
+
+}  // namespace op
+}  // namespace magmadnn
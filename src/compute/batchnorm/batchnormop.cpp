@@ -10,7 +10,7 @@ namespace op {
 
 template <typename T>
 BatchNormOp<T>::BatchNormOp(Operation<T> *input, bool needs_grad)
-    : Operation<T>::Operation({input}, needs_grad), input(input), num_calls(0) {
+    : Operation<T>::Operation({input}, needs_grad), input(input), num_calls(0), training(true) {
     /* setup code in here */
     this->output_shape = input->get_output_shape();
     this->mem_type = input->get_memory_type();
@@ -19,13 +19,23 @@ BatchNormOp<T>::BatchNormOp(Operation<T> *input, bool needs_grad)
     this->input_tensor = input->get_output_tensor();
     this->output_tensor = new Tensor<T>(this->output_shape, {NONE, {}}, this->mem_type);
 
-#if defined(MAGMADNN_HAVE_CUDA)
     init_settings();
-#endif
 }
 
 template <typename T>
-BatchNormOp<T>::~BatchNormOp() {}
+BatchNormOp<T>::~BatchNormOp() {
+    delete bn_scale;
+    delete bn_bias;
+    delete bn_scale_diff;
+    delete bn_bias_diff;
+    delete running_mean;
+    delete running_variance;
+    delete saved_mean;
+    delete saved_variance;
+#if defined(MAGMADNN_HAVE_CUDA)
+    if (this->mem_type != HOST) cudnnErrchk(cudnnDestroyTensorDescriptor(settings.bn_tensor_desc));
+#endif
+}
 
 template <typename T>
 Tensor<T> *BatchNormOp<T>::_eval(bool recompute) {
@@ -34,13 +44,24 @@ Tensor<T> *BatchNormOp<T>::_eval(bool recompute) {
     input_tensor = input->eval(recompute);
 
     if (this->mem_type == HOST) {
-        math::batchnorm(input_tensor, this->output_tensor);
+        if (training) {
+            math::batchnorm(input_tensor, this->output_tensor, bn_scale, bn_bias, running_mean, running_variance,
+                            saved_mean, saved_variance, num_calls, this->cpu_settings);
+        } else {
+            math::batchnorm_inference(input_tensor, this->output_tensor, bn_scale, bn_bias, running_mean,
+                                      running_variance, this->cpu_settings);
+        }
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
         this->settings.handle = this->get_cudnn_handle();
-        math::batchnorm_device(input_tensor, this->output_tensor, bn_scale, bn_bias, running_mean, running_variance,
-                               saved_mean, saved_variance, num_calls, this->settings);
+        if (training) {
+            math::batchnorm_device(input_tensor, this->output_tensor, bn_scale, bn_bias, running_mean,
+                                   running_variance, saved_mean, saved_variance, num_calls, this->settings);
+        } else {
+            math::batchnorm_inference_device(input_tensor, this->output_tensor, bn_scale, bn_bias, running_mean,
+                                             running_variance, this->settings);
+        }
         if (!this->get_async()) cudaStreamSynchronize(this->get_custream());
     }
 #endif
@@ -63,7 +84,8 @@ Tensor<T> *BatchNormOp<T>::_grad(Operation<T> *consumer, Operation<T> *var, Tens
     }
 
     if (this->mem_type == HOST) {
-        math::batchnorm_grad(grad, out);
+        math::batchnorm_grad(this->input_tensor, grad, out, bn_scale, bn_scale_diff, bn_bias_diff, saved_mean,
+                             saved_variance, this->cpu_settings);
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -77,21 +99,27 @@ Tensor<T> *BatchNormOp<T>::_grad(Operation<T> *consumer, Operation<T> *var, Tens
     return out;
 }
 
-#if defined(MAGMADNN_HAVE_CUDA)
 template <typename T>
 void BatchNormOp<T>::init_settings() {
-    settings.handle = ::magmadnn::internal::MAGMADNN_SETTINGS->cudnn_handle;
-
     /* Use spatial if 4D (conv layer), and use per activation if 2D (fully connected layer) */
-    settings.mode = (this->output_shape.size() == 4) ? CUDNN_BATCHNORM_SPATIAL : CUDNN_BATCHNORM_PER_ACTIVATION;
-    cudnnErrchk(cudnnCreateTensorDescriptor(&settings.bn_tensor_desc));
-    cudnnErrchk(cudnnDeriveBNTensorDescriptor(settings.bn_tensor_desc,
-                                              this->input_tensor->get_cudnn_tensor_descriptor(), settings.mode));
+    cpu_settings.mode = (this->output_shape.size() == 4) ? math::BATCHNORM_CPU_SPATIAL
+                                                         : math::BATCHNORM_CPU_PER_ACTIVATION;
+    cpu_settings.epsilon = 1E-8;
+
+#if defined(MAGMADNN_HAVE_CUDA)
+    if (this->mem_type != HOST) {
+        settings.handle = ::magmadnn::internal::MAGMADNN_SETTINGS->cudnn_handle;
+        settings.mode = (this->output_shape.size() == 4) ? CUDNN_BATCHNORM_SPATIAL : CUDNN_BATCHNORM_PER_ACTIVATION;
+        cudnnErrchk(cudnnCreateTensorDescriptor(&settings.bn_tensor_desc));
+        cudnnErrchk(cudnnDeriveBNTensorDescriptor(settings.bn_tensor_desc,
+                                                  this->input_tensor->get_cudnn_tensor_descriptor(), settings.mode));
+    }
+#endif
 
     /* Determine and set the dimensions for the normalization tensors */
     std::vector<unsigned int> bn_tensor_shape = this->output_shape;
     bn_tensor_shape[0] = 1;
-    if (settings.mode == CUDNN_BATCHNORM_SPATIAL) {
+    if (cpu_settings.mode == math::BATCHNORM_CPU_SPATIAL) {
         bn_tensor_shape[2] = 1;
         bn_tensor_shape[3] = 1;
     }
@@ -106,8 +134,6 @@ void BatchNormOp<T>::init_settings() {
     saved_variance = new Tensor<T>(bn_tensor_shape, {ZERO, {}}, this->mem_type);
 }
 
-#endif
-
 template class BatchNormOp<int>;
 template class BatchNormOp<float>;
 template class BatchNormOp<double>;
@@ -1,5 +1,6 @@
 #include "compute/conv2dforward/conv2dforwardop.h"
 
+#include <cstdlib>
 #include <iostream>
 
 #if defined(MAGMADNN_CMAKE_BUILD)
@@ -43,6 +44,9 @@ Conv2DForwardOp<T>::Conv2DForwardOp(Operation<T> *input, Operation<T> *filter, i
 template <typename T>
 Conv2DForwardOp<T>::~Conv2DForwardOp() {
     if (this->mem_type == HOST) {
+#if !defined(MAGMADNN_HAVE_MKLDNN)
+        std::free(this->cpu_settings.workspace);
+#endif
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -66,8 +70,7 @@ Tensor<T> *Conv2DForwardOp<T>::_eval(bool recompute) {
 #if defined(MAGMADNN_HAVE_MKLDNN)
         this->onednn_forward();
 #else
-        // TODO: raise exception
-        std::fprintf(stderr, "Error: Conv2dForward::_eval requires GPU\n");
+        ::magmadnn::math::conv2d(this->input_tensor, this->filter_tensor, this->output_tensor, this->cpu_settings);
 #endif
     }
 #if defined(MAGMADNN_HAVE_CUDA)
@@ -101,7 +104,7 @@ Tensor<T> *Conv2DForwardOp<T>::_grad(Operation<T> *consumer, Operation<T> *var,
 
             this->onednn_backward_data(grad, out);
 #else
-            ::magmadnn::math::conv2d_grad_data(this->filter_tensor, grad, out);
+            ::magmadnn::math::conv2d_grad_data(this->filter_tensor, grad, out, this->cpu_settings);
 #endif
         }
 #if defined(MAGMADNN_HAVE_CUDA)
@@ -128,7 +131,7 @@ Tensor<T> *Conv2DForwardOp<T>::_grad(Operation<T> *consumer, Operation<T> *var,
 #if defined(MAGMADNN_HAVE_MKLDNN)
             onednn_backward_weights(grad, out);
 #else
-            ::magmadnn::math::conv2d_grad_filter(this->input_tensor, grad, out);
+            ::magmadnn::math::conv2d_grad_filter(this->input_tensor, grad, out, this->cpu_settings);
 #endif
         }
 #if defined(MAGMADNN_HAVE_CUDA)
@@ -229,7 +232,7 @@ template <typename T>
 void Conv2DForwardOp<T>::init_settings() {
     if (this->mem_type == HOST) {
 #if !defined(MAGMADNN_HAVE_MKLDNN)
-        std::fprintf(stderr, "Error: Conv2DForward::init_settings requires GPU.\n");
+        this->cpu_init_settings();
 #endif
     }
 #if defined(MAGMADNN_HAVE_CUDA)
@@ -329,6 +332,32 @@ void Conv2DForwardOp<T>::init_settings() {
 #endif
 }
 
+#if !defined(MAGMADNN_HAVE_MKLDNN)
+template <typename T>
+void Conv2DForwardOp<T>::cpu_init_settings() {
+    assert((vertical_stride > 0) && (horizontal_stride > 0));
+    assert((dilation_h > 0) && (dilation_w > 0));
+
+    this->cpu_settings.pad_h = pad_h;
+    this->cpu_settings.pad_w = pad_w;
+    this->cpu_settings.vertical_stride = vertical_stride;
+    this->cpu_settings.horizontal_stride = horizontal_stride;
+    this->cpu_settings.dilation_h = dilation_h;
+    this->cpu_settings.dilation_w = dilation_w;
+    this->cpu_settings.use_cross_correlation = use_cross_correlation;
+
+    this->calculate_and_set_output_shape();
+
+    /* pick the CPU algorithm and allocate the im2col workspace once, it is reused by forward and backward */
+    ::magmadnn::math::conv2d_cpu_init_settings<T>(this->input->get_output_shape(), this->filter->get_output_shape(),
+                                                   this->output_shape, this->cpu_settings);
+    this->cpu_settings.workspace = NULL;
+    if (this->cpu_settings.workspace_size > 0) {
+        this->cpu_settings.workspace = std::malloc(this->cpu_settings.workspace_size);
+    }
+}
+#endif
+
 template <typename T>
 void Conv2DForwardOp<T>::calculate_and_set_output_shape() {
     int on = 0, oc = 0, oh = 0, ow = 0;
@@ -361,8 +390,23 @@ void Conv2DForwardOp<T>::calculate_and_set_output_shape() {
                               static_cast<unsigned int>(oh), static_cast<unsigned int>(ow)};
 
 #else
-        std::fprintf(stderr, "Error: Conv2dForward::output_shape requires GPU.\n");
-        this->output_shape = this->input->get_output_shape();
+        /* same formula as cudnnGetConvolution2dForwardOutputDim */
+        const std::vector<unsigned int> &input_shape = this->input->get_output_shape();
+        const std::vector<unsigned int> &filter_shape = this->filter->get_output_shape();
+
+        assert(input_shape.size() == 4 && filter_shape.size() == 4);
+        assert(input_shape[1] == filter_shape[1]);
+
+        int dkh = 1 + (static_cast<int>(filter_shape[2]) - 1) * dilation_h;
+        int dkw = 1 + (static_cast<int>(filter_shape[3]) - 1) * dilation_w;
+
+        on = input_shape[0];
+        oc = filter_shape[0];
+        oh = 1 + (static_cast<int>(input_shape[2]) + 2 * pad_h - dkh) / vertical_stride;
+        ow = 1 + (static_cast<int>(input_shape[3]) + 2 * pad_w - dkw) / horizontal_stride;
+
+        this->output_shape = {static_cast<unsigned int>(on), static_cast<unsigned int>(oc),
+                              static_cast<unsigned int>(oh), static_cast<unsigned int>(ow)};
 #endif
     }
 #if defined(MAGMADNN_HAVE_CUDA)
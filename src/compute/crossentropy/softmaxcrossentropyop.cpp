@@ -0,0 +1,95 @@
+/**
+ * @file softmaxcrossentropyop.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "compute/crossentropy/softmaxcrossentropyop.h"
+
+#include "magmadnn/exception.h"
+
+namespace magmadnn {
+namespace op {
+
+namespace {
+
+template <typename T>
+std::vector<Operation<T> *> softmax_crossentropy_inputs(Operation<T> *labels, Operation<T> *logits) {
+    /* checked before the operation joins the graph, whose inputs it would otherwise delete when it throws */
+    if (logits->get_memory_type() != HOST) {
+        throw ::magmadnn::Error(__FILE__, __LINE__, "SoftmaxCrossEntropy is only implemented on HOST");
+    }
+    return {labels, logits};
+}
+
+}  // namespace
+
+template <typename T>
+SoftmaxCrossEntropyOp<T>::SoftmaxCrossEntropyOp(Operation<T> *labels, Operation<T> *logits, bool needs_grad)
+    : Operation<T>::Operation(softmax_crossentropy_inputs(labels, logits), needs_grad),
+      labels(labels),
+      logits(logits) {
+    /*  logits should be (n_samples x n_classes)
+        labels should be (n_samples) or (n_samples x n_classes)
+    */
+    assert(OP_IS_MATRIX(logits));
+    assert(labels->get_output_shape(0) == logits->get_output_shape(0));
+    assert(labels->get_output_shape().size() == 1 || labels->get_output_shape() == logits->get_output_shape());
+
+    this->output_shape = {1};
+    this->mem_type = logits->get_memory_type();
+    this->name = "SoftmaxCrossEntropy";
+
+    this->output_tensor = new Tensor<T>(this->output_shape, {NONE, {}}, this->mem_type);
+    this->softmax = new Tensor<T>(logits->get_output_shape(), {NONE, {}}, this->mem_type);
+}
+
+template <typename T>
+SoftmaxCrossEntropyOp<T>::~SoftmaxCrossEntropyOp() {
+    delete softmax;
+}
+
+template <typename T>
+Tensor<T> *SoftmaxCrossEntropyOp<T>::_eval(bool recompute) {
+    logits_tensor = logits->eval(recompute);
+    labels_tensor = labels->eval(recompute);
+
+    math::softmax_crossentropy(logits_tensor, labels_tensor, this->softmax, this->output_tensor);
+
+    return this->output_tensor;
+}
+
+template <typename T>
+Tensor<T> *SoftmaxCrossEntropyOp<T>::_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad) {
+    Tensor<T> *out = this->_grad_cache[(uintptr_t) var];
+
+    if (out == NULL) {
+        out = new Tensor<T>(var->get_output_shape(), {ZERO, {}}, this->mem_type);
+        this->_grad_cache[(uintptr_t) var] = out;
+    }
+
+    /* labels are constants, their gradient stays zero */
+    if (var == this->logits) {
+        grad->get_memory_manager()->sync();
+        this->labels_tensor = this->labels->eval(false);
+        math::softmax_crossentropy_grad(this->softmax, this->labels_tensor, grad->get(0), out);
+    }
+
+    return out;
+}
+
+template class SoftmaxCrossEntropyOp<int>;
+template class SoftmaxCrossEntropyOp<float>;
+template class SoftmaxCrossEntropyOp<double>;
+
+template <typename T>
+SoftmaxCrossEntropyOp<T> *softmax_crossentropy(Operation<T> *labels, Operation<T> *logits, bool needs_grad) {
+    return new SoftmaxCrossEntropyOp<T>(labels, logits, needs_grad);
+}
+template SoftmaxCrossEntropyOp<int> *softmax_crossentropy(Operation<int> *, Operation<int> *, bool);
+template SoftmaxCrossEntropyOp<float> *softmax_crossentropy(Operation<float> *, Operation<float> *, bool);
+template SoftmaxCrossEntropyOp<double> *softmax_crossentropy(Operation<double> *, Operation<double> *, bool);
+
+}  // namespace op
+}  // namespace magmadnn
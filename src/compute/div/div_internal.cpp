@@ -1,5 +1,8 @@
 #include "compute/div/div_internal.h"
 
+#include "math/elementwise.h"
+
+#include <algorithm>
 #include <cassert>
 
 #if defined(MAGMADNN_CMAKE_BUILD)
@@ -17,10 +20,8 @@ void tensor_div_tensor_full(Tensor<T> *a, Tensor<T> *b, Tensor<T> *out) {
         T *out_ptr = out->get_ptr();
         unsigned int size = out->get_size();
 
-        for (unsigned int i = 0; i < size; i++) {
-            if (b_ptr[i] == (T) 0) assert(false);
-            out_ptr[i] = a_ptr[i] / b_ptr[i];
-        }
+        assert(std::find(b_ptr, b_ptr + size, (T) 0) == b_ptr + size);
+        math::elementwise_binary(size, a_ptr, b_ptr, out_ptr, [](T a, T b) { return a / b; });
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -41,9 +42,7 @@ void tensor_div_scalar_full(Tensor<T> *a, T scalar, Tensor<T> *out) {
         T *out_ptr = out->get_ptr();
         unsigned int size = out->get_size();
 
-        for (unsigned int i = 0; i < size; i++) {
-            out_ptr[i] = a_ptr[i] / scalar;
-        }
+        math::elementwise_unary(size, a_ptr, out_ptr, [scalar](T a) { return a / scalar; });
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -62,10 +61,8 @@ void scalar_div_tensor_full(T scalar, Tensor<T> *a, Tensor<T> *out) {
         T *out_ptr = out->get_ptr();
         unsigned int size = out->get_size();
 
-        for (unsigned int i = 0; i < size; i++) {
-            if (a_ptr[i] == (T) 0) assert(false);
-            out_ptr[i] = scalar / a_ptr[i];
-        }
+        assert(std::find(a_ptr, a_ptr + size, (T) 0) == a_ptr + size);
+        math::elementwise_unary(size, a_ptr, out_ptr, [scalar](T a) { return scalar / a; });
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
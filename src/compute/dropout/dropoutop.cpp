@@ -14,7 +14,8 @@ DropoutOp<T>::DropoutOp(Operation<T> *input, float dropout_rate, unsigned long l
       dropout_rate(dropout_rate),
       seed(seed),
       copy(copy),
-      mask_tensor(nullptr) {
+      mask_tensor(nullptr),
+      training(true) {
     /* setup code in here */
     assert(dropout_rate >= 0 && dropout_rate <= 1);
 
@@ -51,6 +52,11 @@ Tensor<T> *DropoutOp<T>::_eval(bool recompute) {
 
     input_tensor = input->eval(recompute);
 
+    if (!training) {
+        this->output_tensor->copy_from(*input_tensor);
+        return this->output_tensor;
+    }
+
     if (this->mem_type == HOST) {
         math::dropout(input_tensor, this->output_tensor, mask_tensor, dropout_rate);
     }
@@ -0,0 +1,264 @@
+/**
+ * @file fuseddenseop.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "compute/fuseddense/fuseddenseop.h"
+
+#include "magmadnn/exception.h"
+
+namespace magmadnn {
+namespace op {
+
+namespace {
+
+template <typename T>
+std::vector<Operation<T> *> fused_dense_inputs(Operation<T> *input, Operation<T> *weights, Operation<T> *bias) {
+    /* checked before the operation joins the graph, whose inputs it would otherwise delete when it throws */
+    if (input->get_memory_type() != HOST) {
+        throw ::magmadnn::Error(__FILE__, __LINE__, "FusedDense is only implemented on HOST");
+    }
+
+    if (bias != NULL) return {input, weights, bias};
+    return {input, weights};
+}
+
+}  // namespace
+
+template <typename T>
+FusedDenseOp<T>::FusedDenseOp(Operation<T> *input, Operation<T> *weights, Operation<T> *bias,
+                              math::fused_activation_t activation, Tensor<T> *output, bool needs_grad)
+    : Operation<T>::Operation(fused_dense_inputs(input, weights, bias), needs_grad),
+#if defined(MAGMADNN_HAVE_MKLDNN)
+      dnnl_cpu_engine_(dnnl::engine::kind::cpu, 0),
+      dnnl_fwd_pdesc_(nullptr),
+#endif
+      input(input),
+      weights(weights),
+      bias(bias),
+      bias_ones(NULL),
+      activation(activation),
+      activation_grad(NULL),
+      activation_grad_source(NULL),
+      n_evals(0),
+      activation_grad_eval(0) {
+    this->output_shape = {input->get_output_shape(0), weights->get_output_shape(1)};
+    this->mem_type = input->get_memory_type();
+    this->name = "FusedDense";
+
+    if (output != NULL && output->get_shape() == this->output_shape) {
+        this->output_tensor = output;
+    } else {
+        this->output_tensor = new Tensor<T>(this->output_shape, {NONE, {}}, this->mem_type);
+    }
+
+    if (bias != NULL) {
+        this->bias_ones = new Tensor<T>({this->output_shape[1]}, {ONE, {}}, this->mem_type);
+    }
+
+#if defined(MAGMADNN_HAVE_MKLDNN)
+    this->init_dnnl_settings();
+#endif
+}
+
+template <typename T>
+FusedDenseOp<T>::~FusedDenseOp() {
+    if (bias_ones != NULL) delete bias_ones;
+    if (activation_grad != NULL) delete activation_grad;
+}
+
+template <typename T>
+Tensor<T> *FusedDenseOp<T>::_eval(bool recompute) {
+    input_tensor = input->eval(recompute);
+    weights_tensor = weights->eval(recompute);
+    bias_tensor = (bias != NULL) ? bias->eval(recompute) : NULL;
+
+    /* a new forward pass invalidates activation_grad */
+    this->n_evals++;
+
+#if defined(MAGMADNN_HAVE_MKLDNN)
+    auto src_mem = dnnl::memory(this->dnnl_fwd_pdesc_->src_desc(), this->dnnl_cpu_engine_,
+                                (void *) this->input_tensor->get_ptr());
+    auto weights_mem = dnnl::memory(this->dnnl_fwd_pdesc_->weights_desc(), this->dnnl_cpu_engine_,
+                                    (void *) this->weights_tensor->get_ptr());
+    auto dst_mem = dnnl::memory(this->dnnl_fwd_pdesc_->dst_desc(), this->dnnl_cpu_engine_,
+                                (void *) this->output_tensor->get_ptr());
+
+    std::unordered_map<int, dnnl::memory> inner_product_fwd_args;
+    inner_product_fwd_args.insert({DNNL_ARG_SRC, src_mem});
+    inner_product_fwd_args.insert({DNNL_ARG_WEIGHTS, weights_mem});
+    inner_product_fwd_args.insert({DNNL_ARG_DST, dst_mem});
+
+    if (bias != NULL) {
+        auto bias_mem = dnnl::memory(this->dnnl_fwd_pdesc_->bias_desc(), this->dnnl_cpu_engine_,
+                                     (void *) this->bias_tensor->get_ptr());
+        inner_product_fwd_args.insert({DNNL_ARG_BIAS, bias_mem});
+    }
+
+    dnnl::stream engine_stream(this->dnnl_cpu_engine_);
+    dnnl_fwd_->execute(engine_stream, inner_product_fwd_args);
+    engine_stream.wait();
+#else
+    /* XW, then bias and activation while writing the result once more */
+    math::matmul((T) 1, false, input_tensor, false, weights_tensor, (T) 0, this->output_tensor);
+    math::bias_activation_cpu(this->output_tensor, bias_tensor, activation, this->output_tensor);
+#endif
+
+    return this->output_tensor;
+}
+
+template <typename T>
+Tensor<T> *FusedDenseOp<T>::get_activation_grad(Tensor<T> *grad) {
+    /* the gradients w.r.t. input, weights and bias of one backward pass all come with the same grad */
+    if (this->activation_grad != NULL && this->activation_grad_source == grad &&
+        this->activation_grad_eval == this->n_evals) {
+        return this->activation_grad;
+    }
+
+    if (this->activation_grad == NULL) {
+        this->activation_grad = new Tensor<T>(this->output_shape, {NONE, {}}, this->mem_type);
+    }
+
+    math::activation_grad_cpu(this->eval(false), grad, activation, this->activation_grad);
+
+    this->activation_grad_source = grad;
+    this->activation_grad_eval = this->n_evals;
+    return this->activation_grad;
+}
+
+template <typename T>
+Tensor<T> *FusedDenseOp<T>::get_grad_out(Operation<T> *var, const std::vector<unsigned int> &shape) {
+    Tensor<T> *out = this->_grad_cache[(uintptr_t) var];
+
+    if (out == NULL) {
+        out = new Tensor<T>(shape, {NONE, {}}, this->mem_type);
+        this->_grad_cache[(uintptr_t) var] = out;
+    }
+    return out;
+}
+
+template <typename T>
+Tensor<T> *FusedDenseOp<T>::_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad) {
+    /* with dz = grad * activation'(output):  wrt input : dz W^T  --  wrt weights : X^T dz  --  wrt bias : row sums
+       of dz */
+    Tensor<T> *dz = this->get_activation_grad(grad);
+    Tensor<T> *out = NULL;
+
+    if (var == this->input) {
+        this->weights_tensor = this->weights->eval(false);
+
+        out = this->get_grad_out(var, {dz->get_shape(0), this->weights_tensor->get_shape(0)});
+        math::matmul((T) 1, false, dz, true, this->weights_tensor, (T) 0, out);
+
+    } else if (var == this->weights) {
+        this->input_tensor = this->input->eval(false);
+
+        out = this->get_grad_out(var, {this->input_tensor->get_shape(1), dz->get_shape(1)});
+        math::matmul((T) 1, true, this->input_tensor, false, dz, (T) 0, out);
+
+    } else if (this->bias != NULL && var == this->bias) {
+        this->bias_tensor = this->bias->eval(false);
+
+        out = this->get_grad_out(var, this->bias_tensor->get_shape());
+        math::reduce_sum(dz, 1, this->bias_ones, out);
+    }
+
+    return out;
+}
+
+#if defined(MAGMADNN_HAVE_MKLDNN)
+template <typename T>
+void FusedDenseOp<T>::init_dnnl_settings() {
+    /* same layouts as LinearForwardOp */
+    dnnl::memory::dims src_dims = {input->get_output_shape(0), input->get_output_shape(1)};
+    dnnl::memory::dims src_strides = {src_dims[1], 1};
+
+    dnnl::memory::dims trans_weights_dims = {weights->get_output_shape(1), weights->get_output_shape(0)};
+    dnnl::memory::dims trans_weights_strides = {1, weights->get_output_shape(1)};
+
+    dnnl::memory::dims dst_dims = {this->output_shape[0], this->output_shape[1]};
+    dnnl::memory::dims dst_strides = {dst_dims[1], 1};
+
+    auto src_md = dnnl::memory::desc(src_dims, dnnl::memory::data_type::f32, src_strides);
+    auto trans_weights_md = dnnl::memory::desc(trans_weights_dims, dnnl::memory::data_type::f32, trans_weights_strides);
+    auto dst_md = dnnl::memory::desc(dst_dims, dnnl::memory::data_type::f32, dst_strides);
+
+    std::unique_ptr<dnnl::inner_product_forward::desc> inner_product_fwd_desc = nullptr;
+
+    if (bias != NULL) {
+        dnnl::memory::desc bias_md = dnnl::memory::desc({this->output_shape[1]}, dnnl::memory::data_type::f32, {1});
+
+        inner_product_fwd_desc.reset(new dnnl::inner_product_forward::desc(dnnl::prop_kind::forward_training, src_md,
+                                                                           trans_weights_md, bias_md, dst_md));
+    } else {
+        inner_product_fwd_desc.reset(
+            new dnnl::inner_product_forward::desc(dnnl::prop_kind::forward_training, src_md, trans_weights_md, dst_md));
+    }
+
+    /* the activation runs as a post-op on the inner product output */
+    dnnl::post_ops ops;
+    switch (activation) {
+        case math::FUSED_RELU:
+            ops.append_eltwise(1.0f, dnnl::algorithm::eltwise_relu, 0.0f, 0.0f);
+            break;
+        case math::FUSED_SIGMOID:
+            ops.append_eltwise(1.0f, dnnl::algorithm::eltwise_logistic, 0.0f, 0.0f);
+            break;
+        case math::FUSED_TANH:
+            ops.append_eltwise(1.0f, dnnl::algorithm::eltwise_tanh, 0.0f, 0.0f);
+            break;
+        default:
+            break;
+    }
+    dnnl::primitive_attr attr;
+    attr.set_post_ops(ops);
+
+    this->dnnl_fwd_pdesc_.reset(new dnnl::inner_product_forward::primitive_desc(*(inner_product_fwd_desc.get()), attr,
+                                                                                this->dnnl_cpu_engine_));
+
+    this->dnnl_fwd_.reset(new dnnl::inner_product_forward(*(this->dnnl_fwd_pdesc_.get())));
+}
+#endif
+
+template class FusedDenseOp<int>;
+template class FusedDenseOp<float>;
+template class FusedDenseOp<double>;
+
+template <typename T>
+FusedDenseOp<T> *fuseddense(Operation<T> *input, Operation<T> *weights, Operation<T> *bias,
+                            math::fused_activation_t activation, bool needs_grad) {
+    return new FusedDenseOp<T>(input, weights, bias, activation, NULL, needs_grad);
+}
+template FusedDenseOp<int> *fuseddense(Operation<int> *input, Operation<int> *weights, Operation<int> *bias,
+                                       math::fused_activation_t activation, bool needs_grad);
+template FusedDenseOp<float> *fuseddense(Operation<float> *input, Operation<float> *weights, Operation<float> *bias,
+                                         math::fused_activation_t activation, bool needs_grad);
+template FusedDenseOp<double> *fuseddense(Operation<double> *input, Operation<double> *weights,
+                                          Operation<double> *bias, math::fused_activation_t activation,
+                                          bool needs_grad);
+
+template <typename T>
+FusedDenseOp<T> *fuse_dense_activation(LinearForwardOp<T> *linear, math::fused_activation_t activation) {
+    if (linear == NULL || linear->get_memory_type() != HOST || !linear->get_consumers().empty()) return NULL;
+
+    Operation<T> *input = linear->get_input();
+    Operation<T> *weights = linear->get_weights();
+    Operation<T> *bias = linear->get_bias();
+
+    /* linear drops out of the graph, so the backward pass does not reach it through its inputs */
+    input->remove_consumer(linear);
+    weights->remove_consumer(linear);
+    if (bias != NULL) bias->remove_consumer(linear);
+
+    return new FusedDenseOp<T>(input, weights, bias, activation, linear->get_output_tensor());
+}
+template FusedDenseOp<int> *fuse_dense_activation(LinearForwardOp<int> *linear, math::fused_activation_t activation);
+template FusedDenseOp<float> *fuse_dense_activation(LinearForwardOp<float> *linear,
+                                                    math::fused_activation_t activation);
+template FusedDenseOp<double> *fuse_dense_activation(LinearForwardOp<double> *linear,
+                                                     math::fused_activation_t activation);
+
+}  // namespace op
+}  // namespace magmadnn
@@ -7,7 +7,8 @@
  * @copyright Copyright (c) 2019
  */
 #include "compute/gradients.h"
-#include "math/add.h"
+#include "compute/backward_executor.h"
+#include "math/sum.h"
 
 #if defined(MAGMADNN_CMAKE_BUILD)
 #include "magmadnn/config.h"
@@ -18,39 +19,9 @@ namespace op {
 
 template <typename T>
 magmadnn_error_t get_grad_table(const std::vector<Operation<T> *> &vars, Operation<T> *graph, GradTable<T> &table) {
-    magmadnn_error_t err;
-    Tensor<T> *tmp;
-
-    /* prune compute graph:
-        construct a new graph G' that only contains nodes that are ancestors of
-       graph and descendents of nodes in vars. */
-    /* TODO */
-
-    // Tensor<T> *grad_loss = new Tensor<T>({1}, {ONE, {}}, graph->get_memory_type());
-    Tensor<T> *grad_loss = new Tensor<T>({1}, {NONE, {}}, graph->get_memory_type());
-#if defined(MAGMADNN_HAVE_CUDA)
-    grad_loss->set_custream(graph->get_custream());
-    grad_loss->set_cublas_handle(graph->get_cublas_handle());
-#endif
-    /* init Loss in grad table to one */
-    grad_loss->fill_memory({ONE, {}});
-
-    table.set(graph, grad_loss);
-
-    /* compute the gradients for each variable */
-    for (typename std::vector<Operation<T> *>::const_iterator vit = vars.begin(); vit != vars.end(); vit++) {
-        if (*vit != NULL) {
-            err = internal::build_grad(*vit, graph, table, &tmp);
-        } else {
-            return (magmadnn_error_t) 1;
-        }
-
-        if (err != 0) {
-            return err;
-        }
-    }
-
-    return (magmadnn_error_t) 0;
+    /* the table's executor prunes graph to the nodes that are ancestors of graph and descendents of nodes in vars,
+       and keeps that schedule between calls */
+    return table.get_executor().run(vars, graph, table);
 }
 template magmadnn_error_t get_grad_table(const std::vector<Operation<int> *> &vars, Operation<int> *graph,
                                          GradTable<int> &table);
@@ -100,55 +71,22 @@ magmadnn_error_t build_grad(op::Operation<T> *var, op::Operation<T> *graph, op::
         bprop = consumer->grad(consumer, var, tmp_grad);
         bprops.push_back(bprop);
     }
-    // std::cout << "bprops.size() = " << bprops.size()  << std::endl;
     /* sum of each partial gradient is the total gradient */
-    /* TODO : no need to sum if just one */
     if (bprops.size() == 0) {
         return (magmadnn_error_t) 2;
     } else if (bprops.size() == 1) {
         result = bprops.at(0);
-    } else if (bprops.size() == 2) {
-        /*
-          result = op::add(bprops.at(0), bprops.at(1), true, false);
-        */
-        /* TODO : Add and sum tensors */
-        // result = NULL;
-        // fprintf(stderr, "Implement add in gradients\n");
-        auto *g0 = bprops.at(0);
-        auto *g1 = bprops.at(1);
-
-        // result = new Tensor<T>(g0->get_shape(), {NONE, {}}, g0->get_memory_type());
-        // result->fill_memory({ZERO, {}});
-        // result->copy_from(*g0);
-        result = g0;
-        // result = g1;
-
-        // std::cout << "[build_grad] g0 size = "
-        //           << g0->get_size()
-        //           << ", g1 size = "
-        //           << g1->get_size()
-        //           << std::endl;
-
-        if (result->get_memory_type() == HOST) {
-            magmadnn::math::add_in_place_cpu(g1, result);
-        }
-#if defined(MAGMADNN_HAVE_CUDA)
-        else {  // DEVICE
-            magmadnn::math::add_in_place_device(var->get_cudnn_handle(), g1, result);
-        }
-#endif
-
     } else {
-        /* currently sum cannot handle scalar values, so just tetrate adds for
-         * now */
-        // result = op::sum(bprops);
-        /*
-        result = bprops.at(0);
+        /* the partial gradients may alias the consumers' own gradients (e.g. add passes its gradient through), so
+           they are summed into a buffer owned by var instead of into one of them. math::sum reads each input once
+           and writes the buffer once for any number of consumers. */
+        Tensor<T> *widest = bprops.at(0); /* partials that are scalars get broadcast */
         for (unsigned int i = 1; i < bprops.size(); i++) {
-            result = op::add(result, bprops.at(i));
-        }*/
-        result = NULL;
-        fprintf(stderr, "Implement sum in gradients\n");
+            if (bprops.at(i)->get_size() > widest->get_size()) widest = bprops.at(i);
+        }
+        result = var->get_grad_accumulator(widest->get_shape(), widest->get_memory_type());
+
+        magmadnn::math::sum(bprops, result);
     }
 
     table.set(var, result);
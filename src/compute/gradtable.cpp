@@ -7,6 +7,7 @@
  * @copyright Copyright (c) 2019
  */
 #include "compute/gradtable.h"
+#include "compute/backward_executor.h"
 
 namespace magmadnn {
 namespace op {
@@ -41,6 +42,11 @@ void GradTable<T>::set(Operation<T> *var, Tensor<T> *grad) {
     _table[var] = grad;
 }
 
+template <typename T>
+void GradTable<T>::erase(Operation<T> *var) {
+    _table.erase(var);
+}
+
 template <typename T>
 void GradTable<T>::clear() {
     this->_table.clear();
@@ -54,6 +60,13 @@ void GradTable<T>::zero() {
     }
 }
 
+template <typename T>
+BackwardExecutor<T> &GradTable<T>::get_executor() {
+    if (!_executor) _executor = std::make_shared<BackwardExecutor<T>>();
+
+    return *_executor;
+}
+
 template class GradTable<int>;
 template class GradTable<float>;
 template class GradTable<double>;
@@ -1,5 +1,7 @@
 #include "compute/log/log_internal.h"
 
+#include "math/elementwise.h"
+
 #if defined(MAGMADNN_CMAKE_BUILD)
 #include "magmadnn/config.h"
 #endif
@@ -15,9 +17,7 @@ void log_full_cpu(Tensor<T> *x, Tensor<T> *out, bool stable) {
 
     T epsilon = (stable) ? static_cast<T>(1E-8) : static_cast<T>(0);
 
-    for (unsigned int i = 0; i < size; i++) {
-        out_ptr[i] = log(x_ptr[i] + epsilon);
-    }
+    math::elementwise_unary(size, x_ptr, out_ptr, [epsilon](T x) { return (T) std::log(x + epsilon); });
 }
 template void log_full_cpu(Tensor<int> *x, Tensor<int> *out, bool stable);
 template void log_full_cpu(Tensor<float> *x, Tensor<float> *out, bool stable);
@@ -47,9 +47,7 @@ void log_grad_cpu(Tensor<T> *x, Tensor<T> *grad, Tensor<T> *out, bool stable) {
 
     T epsilon = (stable) ? static_cast<T>(1E-8) : static_cast<T>(0);
 
-    for (unsigned int i = 0; i < size; i++) {
-        out_ptr[i] = grad_ptr[i] / (x_ptr[i] + epsilon);
-    }
+    math::elementwise_binary(size, x_ptr, grad_ptr, out_ptr, [epsilon](T x, T g) { return g / (x + epsilon); });
 }
 template void log_grad_cpu(Tensor<int> *x, Tensor<int> *grad, Tensor<int> *out, bool stable);
 template void log_grad_cpu(Tensor<float> *x, Tensor<float> *grad, Tensor<float> *out, bool stable);
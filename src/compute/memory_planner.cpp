@@ -0,0 +1,338 @@
+/**
+ * @file memory_planner.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "compute/memory_planner.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "compute/backward_executor.h"
+
+#if defined(MAGMADNN_CMAKE_BUILD)
+#include "magmadnn/config.h"
+#endif
+
+/* buffers start on 64 byte boundaries in the arena */
+#define PLANNER_ALIGNMENT 64
+
+namespace magmadnn {
+namespace op {
+
+template <typename T>
+MemoryPlanner<T>::MemoryPlanner() : naive_bytes(0), arena_size(0), mem_type(HOST), arena(NULL) {}
+
+template <typename T>
+MemoryPlanner<T>::~MemoryPlanner() {
+    this->unbind();
+}
+
+template <typename T>
+unsigned int MemoryPlanner<T>::activation(Tensor<T> *tensor, Operation<T> *op) {
+    for (unsigned int i = 0; i < this->buffers.size(); i++) {
+        if (this->buffers[i].kind == ACTIVATION && this->buffers[i].tensor == tensor) return i;
+    }
+
+    this->buffers.push_back({ACTIVATION, op, NULL, tensor, tensor->get_shape(), tensor->get_size(), 0, 0, 0});
+    this->buffers.back().first = (unsigned int) -1;
+    return this->buffers.size() - 1;
+}
+
+template <typename T>
+void MemoryPlanner<T>::touch(unsigned int buffer, unsigned int step) {
+    buffer_t &b = this->buffers[buffer];
+
+    if (b.first == (unsigned int) -1 || step < b.first) b.first = step;
+    if (step > b.last) b.last = step;
+}
+
+template <typename T>
+magmadnn_error_t MemoryPlanner<T>::plan(Operation<T> *graph, const std::vector<Operation<T> *> &vars) {
+    struct frame {
+        Operation<T> *op;
+        std::vector<Operation<T> *> inputs;
+        unsigned int next;
+    };
+    std::vector<frame> stack;
+    std::vector<Operation<T> *> to_visit;
+    std::set<Operation<T> *> seen;
+    std::set<Tensor<T> *> leaves;
+    std::map<Tensor<T> *, unsigned int> planned; /* activation tensor -> buffer */
+    unsigned int step = 0;
+
+    this->unbind();
+    this->buffers.clear();
+    this->naive_bytes = 0;
+    this->arena_size = 0;
+
+    if (graph == NULL) return (magmadnn_error_t) 1;
+
+    /* MANAGED tensors keep two copies and cannot be placed in one arena */
+    this->mem_type = graph->get_memory_type();
+#if defined(MAGMADNN_HAVE_CUDA)
+    if (this->mem_type == MANAGED) return (magmadnn_error_t) 1;
+#endif
+
+    /* leaves hold parameters and inputs, which live as long as the graph */
+    to_visit.push_back(graph);
+    seen.insert(graph);
+    while (!to_visit.empty()) {
+        Operation<T> *op = to_visit.back();
+        std::vector<Operation<T> *> inputs = op->get_inputs();
+        to_visit.pop_back();
+
+        if (inputs.empty()) leaves.insert(op->get_output_tensor());
+
+        for (unsigned int i = 0; i < inputs.size(); i++) {
+            if (inputs[i] != NULL && seen.insert(inputs[i]).second) to_visit.push_back(inputs[i]);
+        }
+    }
+
+    /* activation buffer of op, -1 if it is not planned */
+    auto activation_of = [&](Operation<T> *op) -> int {
+        Tensor<T> *tensor = op->get_output_tensor();
+
+        if (tensor == NULL || leaves.count(tensor) || op->get_inputs().empty()) return -1;
+        if (tensor->get_memory_type() != this->mem_type) return -1;
+
+        typename std::map<Tensor<T> *, unsigned int>::iterator it = planned.find(tensor);
+        if (it != planned.end()) return it->second;
+
+        unsigned int idx = this->activation(tensor, op);
+        planned[tensor] = idx;
+        return idx;
+    };
+
+    /* forward: replay eval(true), which evaluates the inputs of an operation (again) right before it. An output is
+       alive from its first evaluation to the last evaluation that reads it. */
+    stack.push_back({graph, graph->get_inputs(), 0});
+    while (!stack.empty()) {
+        frame &top = stack.back();
+
+        if (top.next < top.inputs.size()) {
+            Operation<T> *input = top.inputs[top.next++];
+
+            /* top is invalidated by the push */
+            if (input != NULL) stack.push_back({input, input->get_inputs(), 0});
+        } else {
+            step++;
+
+            int out = activation_of(top.op);
+            if (out >= 0) this->touch(out, step);
+
+            for (unsigned int i = 0; i < top.inputs.size(); i++) {
+                int in = (top.inputs[i] != NULL) ? activation_of(top.inputs[i]) : -1;
+                if (in >= 0) this->touch(in, step);
+            }
+            stack.pop_back();
+        }
+    }
+
+    std::vector<int> kept_to_end;
+    int head = activation_of(graph);
+    if (head >= 0) kept_to_end.push_back(head);
+
+    /* backward: replay the BackwardExecutor's schedule. Processing v calls c->grad(c, v, grad of c) for each consumer
+       c, which reads the activations around c and the gradient of c, and writes c's gradient buffer for v. */
+    if (!vars.empty()) {
+        BackwardExecutor<T> executor;
+        std::map<Operation<T> *, int> grad_of;                         /* buffer holding an operation's gradient */
+        std::map<std::pair<Operation<T> *, Operation<T> *>, int> edges; /* (consumer, input) -> buffer */
+
+        magmadnn_error_t err = executor.prepare(vars, graph);
+        if (err != 0) return err;
+
+        const std::vector<Operation<T> *> &order = executor.get_order();
+        std::set<Operation<T> *> in_plan(order.begin(), order.end());
+
+        grad_of[graph] = -1; /* the executor's own scalar */
+
+        for (unsigned int n = 0; n < order.size(); n++) {
+            Operation<T> *v = order[n];
+            std::vector<Operation<T> *> consumers = v->get_consumers();
+            std::vector<int> parts;
+
+            if (v == graph) continue;
+
+            step++;
+
+            for (unsigned int i = 0; i < consumers.size(); i++) {
+                Operation<T> *c = consumers[i];
+
+                if (c == NULL || !in_plan.count(c)) continue;
+
+                int act = activation_of(c);
+                if (act >= 0) this->touch(act, step);
+
+                std::vector<Operation<T> *> c_inputs = c->get_inputs();
+                for (unsigned int j = 0; j < c_inputs.size(); j++) {
+                    act = (c_inputs[j] != NULL) ? activation_of(c_inputs[j]) : -1;
+                    if (act >= 0) this->touch(act, step);
+                }
+
+                int c_grad = grad_of[c];
+                if (c_grad >= 0) this->touch(c_grad, step);
+
+                if (c->passes_grad_through()) {
+                    parts.push_back(c_grad);
+                    continue;
+                }
+
+                std::pair<Operation<T> *, Operation<T> *> key(c, v);
+                if (!edges.count(key)) {
+                    std::vector<unsigned int> shape = v->get_output_shape();
+                    unsigned int size = 1;
+                    for (unsigned int k = 0; k < shape.size(); k++) size *= shape[k];
+
+                    this->buffers.push_back({GRADIENT, c, v, NULL, shape, size, step, step, 0});
+                    edges[key] = this->buffers.size() - 1;
+                }
+                this->touch(edges[key], step);
+                parts.push_back(edges[key]);
+            }
+
+            if (parts.size() > 1) {
+                std::vector<unsigned int> shape = v->get_output_shape();
+                unsigned int size = 1;
+                for (unsigned int k = 0; k < shape.size(); k++) size *= shape[k];
+
+                this->buffers.push_back({ACCUMULATOR, v, NULL, NULL, shape, size, step, step, 0});
+                grad_of[v] = this->buffers.size() - 1;
+            } else {
+                grad_of[v] = (parts.empty()) ? -1 : parts[0];
+            }
+        }
+
+        /* the optimizer reads the variables' gradients after the pass */
+        for (unsigned int i = 0; i < vars.size(); i++) {
+            if (grad_of.count(vars[i]) && grad_of[vars[i]] >= 0) kept_to_end.push_back(grad_of[vars[i]]);
+        }
+    }
+
+    step++;
+    for (unsigned int i = 0; i < kept_to_end.size(); i++) this->touch(kept_to_end[i], step);
+
+    this->pack();
+
+    return (magmadnn_error_t) 0;
+}
+
+template <typename T>
+void MemoryPlanner<T>::pack() {
+    const std::size_t align = (PLANNER_ALIGNMENT > sizeof(T)) ? PLANNER_ALIGNMENT / sizeof(T) : 1;
+    std::vector<unsigned int> by_size;
+    std::vector<unsigned int> placed;
+
+    for (unsigned int i = 0; i < this->buffers.size(); i++) {
+        this->naive_bytes += this->buffers[i].size * sizeof(T);
+        this->buffers[i].size = (this->buffers[i].size + align - 1) / align * align;
+        by_size.push_back(i);
+    }
+
+    std::stable_sort(by_size.begin(), by_size.end(), [this](unsigned int a, unsigned int b) {
+        return this->buffers[a].size > this->buffers[b].size;
+    });
+
+    /* largest first, at the lowest offset that does not overlap a placed buffer with an intersecting lifetime */
+    for (unsigned int i = 0; i < by_size.size(); i++) {
+        buffer_t &b = this->buffers[by_size[i]];
+        std::vector<std::pair<std::size_t, std::size_t>> taken;
+
+        for (unsigned int j = 0; j < placed.size(); j++) {
+            const buffer_t &p = this->buffers[placed[j]];
+
+            if (p.first <= b.last && b.first <= p.last) taken.push_back(std::make_pair(p.offset, p.offset + p.size));
+        }
+        std::sort(taken.begin(), taken.end());
+
+        std::size_t offset = 0;
+        for (unsigned int j = 0; j < taken.size(); j++) {
+            if (offset + b.size <= taken[j].first) break;
+            offset = std::max(offset, taken[j].second);
+        }
+
+        b.offset = offset;
+        this->arena_size = std::max(this->arena_size, offset + b.size);
+        placed.push_back(by_size[i]);
+    }
+}
+
+template <typename T>
+magmadnn_error_t MemoryPlanner<T>::bind() {
+    if (this->arena != NULL) return (magmadnn_error_t) 0;
+    if (this->buffers.empty()) return (magmadnn_error_t) 0;
+
+    this->arena = new MemoryManager<T>(this->arena_size, this->mem_type, 0);
+    T *base = this->arena->get_ptr();
+
+    for (unsigned int i = 0; i < this->buffers.size(); i++) {
+        buffer_t &b = this->buffers[i];
+        Tensor<T> *current;
+
+        if (b.kind == ACTIVATION) {
+            if (b.tensor->use_external_memory(base + b.offset) != 0) {
+                this->unbind();
+                return (magmadnn_error_t) 1;
+            }
+            continue;
+        }
+
+        /* reuse the operation's gradient tensor if it has one of the right size */
+        current = (b.kind == GRADIENT) ? b.op->get_grad_tensor(b.wrt) : b.op->get_grad_accumulator();
+
+        if (current != NULL && current->get_shape() == b.shape) {
+            b.tensor = current;
+        } else {
+            b.tensor = new Tensor<T>(b.shape, {NONE, {}}, this->mem_type);
+#if defined(MAGMADNN_HAVE_CUDA)
+            b.tensor->set_custream(b.op->get_custream());
+            b.tensor->set_cublas_handle(b.op->get_cublas_handle());
+#endif
+            if (b.kind == GRADIENT) {
+                if (current != NULL) b.op->release_grad_tensor(b.wrt, current);
+                b.op->set_grad_tensor(b.wrt, b.tensor);
+            } else {
+                b.op->set_grad_accumulator(b.tensor);
+            }
+        }
+        b.tensor->use_external_memory(base + b.offset);
+    }
+
+    return (magmadnn_error_t) 0;
+}
+
+template <typename T>
+void MemoryPlanner<T>::unbind() {
+    if (this->arena == NULL) return;
+
+    for (unsigned int i = 0; i < this->buffers.size(); i++) {
+        buffer_t &b = this->buffers[i];
+
+        if (b.kind == ACTIVATION) {
+            b.tensor->use_external_memory(NULL);
+            continue;
+        }
+
+        /* the operation may have replaced the tensor since; it only has to be moved out if it is still there */
+        Tensor<T> *current = (b.kind == GRADIENT) ? b.op->get_grad_tensor(b.wrt) : b.op->get_grad_accumulator();
+        if (current != NULL && current == b.tensor) current->use_external_memory(NULL);
+        b.tensor = NULL;
+    }
+
+    delete this->arena;
+    this->arena = NULL;
+}
+
+template class MemoryPlanner<int>;
+template class MemoryPlanner<float>;
+template class MemoryPlanner<double>;
+
+}  // namespace op
+}  // namespace magmadnn
+
+#undef PLANNER_ALIGNMENT
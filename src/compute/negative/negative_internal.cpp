@@ -3,6 +3,8 @@
 #endif
 #include "compute/negative/negative_internal.h"
 
+#include "math/elementwise.h"
+
 namespace magmadnn {
 namespace internal {
 
@@ -11,10 +13,7 @@ void negative_full_cpu(Tensor<T> *x, Tensor<T> *out) {
     T *x_ptr = x->get_ptr();
     T *out_ptr = out->get_ptr();
     unsigned int size = out->get_size();
-    // TODO Use BLAS
-    for (unsigned int i = 0; i < size; i++) {
-        out_ptr[i] = -x_ptr[i];
-    }
+    math::elementwise_unary(size, x_ptr, out_ptr, math::negate_functor<T>());
 }
 
 template void negative_full_cpu(Tensor<int> *x, Tensor<int> *out);
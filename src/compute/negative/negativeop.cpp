@@ -44,17 +44,35 @@ Tensor<T> *NegativeOp<T>::_eval(bool recompute) {
 template <typename T>
 Tensor<T> *NegativeOp<T>::_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad) {
     /* grad : -grad */
+    /* grad may be shared with other consumers (e.g. passed through an add), so negate into our own tensor. It takes
+       grad's shape, which is a scalar when this is the head of the graph. */
+    Tensor<T> *out = this->_grad_cache[(uintptr_t) var];
+
+    if (out != NULL && out->get_shape() != grad->get_shape()) {
+        delete out;
+        out = NULL;
+    }
+
+    if (out == NULL) {
+        out = new Tensor<T>(grad->get_shape(), {NONE, {}}, this->mem_type);
+#if defined(MAGMADNN_HAVE_CUDA)
+        out->set_custream(this->get_custream());
+        out->set_cublas_handle(this->get_cublas_handle());
+#endif
+        this->_grad_cache[(uintptr_t) var] = out;
+    }
+
     if (grad->get_memory_type() == HOST) {
-        magmadnn::internal::negative_full_cpu(grad, grad);
+        magmadnn::internal::negative_full_cpu(grad, out);
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
-        magmadnn::internal::negative_full_device(this->get_custream(), grad, grad);
+        magmadnn::internal::negative_full_device(this->get_custream(), grad, out);
         if (!this->get_async()) cudaStreamSynchronize(this->get_custream());
     }
 #endif
 
-    return grad;
+    return out;
 }
 
 template class NegativeOp<int>;
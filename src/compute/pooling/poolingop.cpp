@@ -4,6 +4,7 @@
 #include "magmadnn/config.h"
 #endif
 
+#include <cstdlib>
 #include <iostream>
 
 namespace magmadnn {
@@ -41,6 +42,9 @@ PoolingOp<T>::~PoolingOp() {
         // #if defined(MAGMADNN_HAVE_MKLDNN)
         //        dnnl_engine_destroy(this->engine_);
         // #endif
+#if !defined(MAGMADNN_HAVE_MKLDNN)
+        if (this->cpu_settings.argmax != NULL) std::free(this->cpu_settings.argmax);
+#endif
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -99,7 +103,7 @@ Tensor<T> *PoolingOp<T>::_eval(bool recompute) {
         dnnl_engine_stream.wait();
 
 #else
-        std::fprintf(stderr, "Error: Pooling::_eval requires GPU\n");
+        ::magmadnn::math::pooling(this->input_tensor, this->output_tensor, this->cpu_settings);
 #endif
     }
 #if defined(MAGMADNN_HAVE_CUDA)
@@ -195,7 +199,7 @@ Tensor<T> *PoolingOp<T>::_grad(Operation<T> *consumer, Operation<T> *var, Tensor
         dnnl_bwd.execute(dnnl_engine_stream, dnnl_args);
         dnnl_engine_stream.wait();
 #else
-        MAGMADNN_NOT_IMPLEMENTED;
+        ::magmadnn::math::pooling_grad(this->input_tensor, this->output_tensor, grad, out, this->cpu_settings);
 #endif
     }
 #if defined(MAGMADNN_HAVE_CUDA)
@@ -285,7 +289,21 @@ void PoolingOp<T>::init_settings() {
         this->output_tensor = new Tensor<T>(this->output_shape, {NONE, {}}, this->mem_type);
 
 #else
-        std::fprintf(stderr, "Error: PoolingOp::init_settings requires GPU.\n");
+        this->cpu_settings.filter_h = filter_h;
+        this->cpu_settings.filter_w = filter_w;
+        this->cpu_settings.pad_h = pad_h;
+        this->cpu_settings.pad_w = pad_w;
+        this->cpu_settings.vertical_stride = vertical_stride;
+        this->cpu_settings.horizontal_stride = horizontal_stride;
+        this->cpu_settings.mode = mode;
+        this->cpu_settings.propagate_nan = propagate_nan;
+        this->cpu_settings.argmax = NULL;
+
+        this->calculate_and_set_output_shape();
+
+        if (mode == MAX_POOL) {
+            this->cpu_settings.argmax = (int *) std::malloc(this->output_tensor->get_size() * sizeof(int));
+        }
 #endif
 
     }
@@ -320,8 +338,17 @@ template <typename T>
 void PoolingOp<T>::calculate_and_set_output_shape() {
     /* calculate the correct output shape here */
     if (this->mem_type == HOST) {
-        std::fprintf(stderr, "Error: Pooling::output_shape requires GPU.\n");
-        this->output_shape = this->input->get_output_shape();
+        /* same formula as cudnnGetPooling2dForwardOutputDim */
+        assert(this->input_tensor->get_shape().size() == 4);
+        assert(filter_h > 0 && filter_w > 0 && vertical_stride > 0 && horizontal_stride > 0);
+
+        int h = 1 + ((int) this->input_tensor->get_shape(2) + 2 * pad_h - filter_h) / vertical_stride;
+        int w = 1 + ((int) this->input_tensor->get_shape(3) + 2 * pad_w - filter_w) / horizontal_stride;
+
+        assert((h > 0) && (w > 0));
+
+        this->output_shape = {this->input_tensor->get_shape(0), this->input_tensor->get_shape(1),
+                              static_cast<unsigned int>(h), static_cast<unsigned int>(w)};
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
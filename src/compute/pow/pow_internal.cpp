@@ -3,6 +3,8 @@
 #endif
 #include "compute/pow/pow_internal.h"
 
+#include "math/elementwise.h"
+
 namespace magmadnn {
 namespace internal {
 
@@ -13,10 +15,15 @@ void pow_grad_cpu(Tensor<T> *x, int power, Tensor<T> *grad, Tensor<T> *out) {
     T *out_ptr = out->get_ptr();
     unsigned int size = out->get_size();
     bool grad_is_scalar = T_IS_SCALAR(grad);
+    const T p = (T) power;
 
-    for (unsigned int i = 0; i < size; i++) {
-        /* compute the power */
-        out_ptr[i] = grad_ptr[(grad_is_scalar) ? 0 : i] * ((T) power) * std::pow((T) x_ptr[i], (T) power - 1);
+    /* compute the power */
+    if (grad_is_scalar) {
+        const T g = grad_ptr[0];
+        math::elementwise_unary(size, x_ptr, out_ptr, [g, p](T x) { return g * p * std::pow(x, p - 1); });
+    } else {
+        math::elementwise_binary(size, x_ptr, grad_ptr, out_ptr,
+                                 [p](T x, T g) { return g * p * std::pow(x, p - 1); });
     }
 }
 
@@ -28,10 +35,16 @@ void pow_grad_cpu(Tensor<int> *x, int power, Tensor<int> *grad, Tensor<int> *out
     unsigned int size = out->get_size();
     bool grad_is_scalar = T_IS_SCALAR(grad);
 
-    for (unsigned int i = 0; i < size; i++) {
-        /* compute the power */
-        out_ptr[i] =
-            grad_ptr[(grad_is_scalar) ? 0 : i] * power * ((int) std::pow((float) x_ptr[i], (float) (power - 1)));
+    /* compute the power */
+    if (grad_is_scalar) {
+        const int g = grad_ptr[0];
+        math::elementwise_unary(size, x_ptr, out_ptr, [g, power](int x) {
+            return g * power * ((int) std::pow((float) x, (float) (power - 1)));
+        });
+    } else {
+        math::elementwise_binary(size, x_ptr, grad_ptr, out_ptr, [power](int x, int g) {
+            return g * power * ((int) std::pow((float) x, (float) (power - 1)));
+        });
     }
 }
 template void pow_grad_cpu(Tensor<float> *x, int power, Tensor<float> *grad, Tensor<float> *out);
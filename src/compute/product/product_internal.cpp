@@ -8,6 +8,8 @@
  */
 #include "compute/product/product_internal.h"
 
+#include "math/elementwise.h"
+
 namespace magmadnn {
 namespace internal {
 
@@ -18,9 +20,7 @@ void product_full(T alpha, Tensor<T> *a, Tensor<T> *b, Tensor<T> *out) {
         T *b_ptr = b->get_ptr();
         T *out_ptr = out->get_ptr();
         unsigned int size = out->get_size();
-        for (unsigned int i = 0; i < size; i++) {
-            out_ptr[i] = alpha * a_ptr[i] * b_ptr[i];
-        }
+        math::elementwise_binary(size, a_ptr, b_ptr, out_ptr, [alpha](T a, T b) { return alpha * a * b; });
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -38,9 +38,7 @@ void scalar_tensor_product_full(T scalar, Tensor<T> *a, Tensor<T> *out) {
         T *a_ptr = a->get_ptr();
         T *out_ptr = out->get_ptr();
         unsigned int size = out->get_size();
-        for (unsigned int i = 0; i < size; i++) {
-            out_ptr[i] = scalar * a_ptr[i];
-        }
+        math::elementwise_unary(size, a_ptr, out_ptr, math::scale_functor<T>(scalar));
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -8,20 +8,15 @@
  */
 #include "compute/relu/relu_internal.h"
 
+#include "math/elementwise.h"
+
 namespace magmadnn {
 namespace internal {
 
 template <typename T>
 magmadnn_error_t relu_full(Tensor<T> *x, Tensor<T> *out) {
     if (x->get_memory_type() == HOST) {
-        T val;
-        for (unsigned int i = 0; i < x->get_size(); i++) {
-            val = x->get(i);
-            if (val < 0)
-                out->set(i, (T) 0);
-            else
-                out->set(i, val);
-        }
+        math::elementwise_unary(x->get_size(), x->get_ptr(), out->get_ptr(), math::relu_functor<T>());
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -65,34 +65,42 @@ Tensor<T> *ScalarProductOp<T>::_eval(bool recompute) {
 
 template <typename T>
 Tensor<T> *ScalarProductOp<T>::_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad) {
+    /* grad : alpha * grad */
+    /* grad may be shared with other consumers, so scale into our own tensor */
+    T grad_alpha = alpha;
     if (scalar != NULL) {
         scalar_tensor = scalar->eval(false);
         scalar_tensor->get_memory_manager()->sync(true);
+        grad_alpha = scalar_tensor->get(0);
+    }
+
+    Tensor<T> *out = this->_grad_cache[(uintptr_t) var];
+
+    if (out != NULL && out->get_shape() != grad->get_shape()) {
+        delete out;
+        out = NULL;
+    }
 
-        // internal::scalarproduct_full(scalar_tensor->get(0), grad, grad);
-        if (x->get_memory_type() == HOST) {
-            magmadnn::internal::scalarproduct_full_cpu(scalar_tensor->get(0), grad, grad);
-        }
+    if (out == NULL) {
+        out = new Tensor<T>(grad->get_shape(), {NONE, {}}, this->mem_type);
 #if defined(MAGMADNN_HAVE_CUDA)
-        else {
-            magmadnn::internal::scalarproduct_full_device(this->get_custream(), scalar_tensor->get(0), grad, grad);
-            if (!this->get_async()) cudaStreamSynchronize(this->get_custream());
-        }
+        out->set_custream(this->get_custream());
+        out->set_cublas_handle(this->get_cublas_handle());
 #endif
+        this->_grad_cache[(uintptr_t) var] = out;
+    }
 
-    } else {
-        // internal::scalarproduct_full(alpha, grad, grad);
-        if (x->get_memory_type() == HOST) {
-            magmadnn::internal::scalarproduct_full_cpu(alpha, grad, grad);
-        }
+    if (x->get_memory_type() == HOST) {
+        magmadnn::internal::scalarproduct_full_cpu(grad_alpha, grad, out);
+    }
 #if defined(MAGMADNN_HAVE_CUDA)
-        else {
-            magmadnn::internal::scalarproduct_full_device(this->get_custream(), alpha, grad, grad);
-            if (!this->get_async()) cudaStreamSynchronize(this->get_custream());
-        }
-#endif
+    else {
+        magmadnn::internal::scalarproduct_full_device(this->get_custream(), grad_alpha, grad, out);
+        if (!this->get_async()) cudaStreamSynchronize(this->get_custream());
     }
-    return grad;
+#endif
+
+    return out;
 }
 
 template <typename T>
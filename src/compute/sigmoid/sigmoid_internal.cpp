@@ -8,6 +8,8 @@
  */
 #include "compute/sigmoid/sigmoid_internal.h"
 
+#include "math/elementwise.h"
+
 #if defined(MAGMADNN_CMAKE_BUILD)
 #include "magmadnn/config.h"
 #endif
@@ -23,10 +25,10 @@ void sigmoid_full_cpu(Tensor<T> *x, Tensor<T> *out, bool fast) {
 
     if (fast) {
         // fast sigmoid -- fast_sigmoid(x) = x / (1 + |x|)
-        for (unsigned int i = 0; i < size; i++) out_ptr[i] = x_ptr[i] / (1 + abs(x_ptr[i]));
+        math::elementwise_unary(size, x_ptr, out_ptr, math::fast_sigmoid_functor<T>());
     } else {
         // normal sigmoid -- sigmoid(x) = 1 / (1 + exp(-x))
-        for (unsigned int i = 0; i < size; i++) out_ptr[i] = 1 / (1 + exp(-x_ptr[i]));
+        math::elementwise_unary(size, x_ptr, out_ptr, math::sigmoid_functor<T>());
     }
 }
 template void sigmoid_full_cpu(Tensor<int> *x, Tensor<int> *out, bool fast);
@@ -56,13 +58,11 @@ void sigmoid_grad_cpu(Tensor<T> *output, Tensor<T> *grad, Tensor<T> *out) {
     unsigned int size = out->get_size();
 
     if (grad->get_size() == 1) {
-        for (unsigned int i = 0; i < size; i++) {
-            out_ptr[i] = grad_ptr[0] * output_ptr[i] * (((T) 1) - output_ptr[i]);
-        }
+        const T g = grad_ptr[0];
+        math::elementwise_unary(size, output_ptr, out_ptr, [g](T s) { return g * s * (((T) 1) - s); });
     } else {
-        for (unsigned int i = 0; i < size; i++) {
-            out_ptr[i] = grad_ptr[i] * output_ptr[i] * (((T) 1) - output_ptr[i]);
-        }
+        math::elementwise_binary(size, output_ptr, grad_ptr, out_ptr,
+                                 [](T s, T g) { return g * s * (((T) 1) - s); });
     }
 }
 template void sigmoid_grad_cpu(Tensor<int> *output, Tensor<int> *grad, Tensor<int> *out);
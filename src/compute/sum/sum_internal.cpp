@@ -8,19 +8,26 @@
  */
 #include "compute/sum/sum_internal.h"
 
+#include "math/elementwise.h"
+
 namespace magmadnn {
 namespace internal {
 
 template <typename T>
 void sum_full(std::vector<Tensor<T> *> &vals, Tensor<T> &out) {
     if (vals.at(0)->get_memory_type() == HOST) {
-        T sum;
-        for (unsigned int idx = 0; idx < vals[0]->get_size(); idx++) {
-            sum = (T) 0;
-            for (unsigned int i = 0; i < vals.size(); i++) {
-                sum += (vals[i])->get(idx);
+        /* accumulate pairwise so each pass is a vectorized sweep; out may alias vals[0] or vals[1] */
+        unsigned int size = vals[0]->get_size();
+        T *out_ptr = out.get_ptr();
+
+        if (vals.size() == 1) {
+            math::elementwise_unary(size, vals[0]->get_ptr(), out_ptr, [](T x) { return x; });
+        } else {
+            math::elementwise_binary(size, vals[0]->get_ptr(), vals[1]->get_ptr(), out_ptr, math::add_functor<T>());
+            for (unsigned int i = 2; i < vals.size(); i++) {
+                math::elementwise_binary(size, (const T *) out_ptr, vals[i]->get_ptr(), out_ptr,
+                                         math::add_functor<T>());
             }
-            out.set(idx, sum);
         }
     }
 #if defined(MAGMADNN_HAVE_CUDA)
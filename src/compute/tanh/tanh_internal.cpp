@@ -8,6 +8,8 @@
  */
 #include "compute/tanh/tanh_internal.h"
 
+#include "math/elementwise.h"
+
 namespace magmadnn {
 namespace internal {
 
@@ -18,9 +20,7 @@ void tanh_full(Tensor<T> *x, Tensor<T> *out) {
         T *out_ptr = out->get_ptr();
         unsigned int size = out->get_size();
 
-        for (unsigned int i = 0; i < size; i++) {
-            out_ptr[i] = tanh(x_ptr[i]);
-        }
+        math::elementwise_unary(size, x_ptr, out_ptr, math::tanh_functor<T>());
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -32,5 +32,40 @@ template void tanh_full(Tensor<int> *x, Tensor<int> *out);
 template void tanh_full(Tensor<float> *x, Tensor<float> *out);
 template void tanh_full(Tensor<double> *x, Tensor<double> *out);
 
+template <typename T>
+void tanh_grad_cpu(Tensor<T> *output, Tensor<T> *grad, Tensor<T> *out) {
+    T *output_ptr = output->get_ptr();
+    T *grad_ptr = grad->get_ptr();
+    T *out_ptr = out->get_ptr();
+    unsigned int size = out->get_size();
+
+    if (grad->get_size() == 1) {
+        const T g = grad_ptr[0];
+        math::elementwise_unary(size, output_ptr, out_ptr, [g](T t) { return g * (((T) 1) - t * t); });
+    } else {
+        math::elementwise_binary(size, output_ptr, grad_ptr, out_ptr, [](T t, T g) { return g * (((T) 1) - t * t); });
+    }
+}
+template void tanh_grad_cpu(Tensor<int> *output, Tensor<int> *grad, Tensor<int> *out);
+template void tanh_grad_cpu(Tensor<float> *output, Tensor<float> *grad, Tensor<float> *out);
+template void tanh_grad_cpu(Tensor<double> *output, Tensor<double> *grad, Tensor<double> *out);
+
+template <typename T>
+void tanh_grad(Tensor<T> *output, Tensor<T> *grad, Tensor<T> *out) {
+    /* d tanh(x) = G * (1 - tanh(x)^2) */
+
+    if (out->get_memory_type() == HOST) {
+        tanh_grad_cpu(output, grad, out);
+    }
+#if defined(MAGMADNN_HAVE_CUDA)
+    else {
+        tanh_grad_device(output, grad, out);
+    }
+#endif
+}
+template void tanh_grad(Tensor<int> *output, Tensor<int> *grad, Tensor<int> *out);
+template void tanh_grad(Tensor<float> *output, Tensor<float> *grad, Tensor<float> *out);
+template void tanh_grad(Tensor<double> *output, Tensor<double> *grad, Tensor<double> *out);
+
 }  // namespace internal
 }  // namespace magmadnn
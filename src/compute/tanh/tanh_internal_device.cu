@@ -50,6 +50,39 @@ void tanh_full_device(Tensor<int> *x, Tensor<int> *out) {
 template void tanh_full_device(Tensor<float> *x, Tensor<float> *out);
 template void tanh_full_device(Tensor<double> *x, Tensor<double> *out);
 
+template <typename T>
+__global__ void kernel_tanh_grad_device(T *output, T *grad, T *out, unsigned int size, bool is_grad_scalar) {
+    unsigned int idx = blockIdx.x * blockDim.x + threadIdx.x;
+    unsigned int stride = blockDim.x * gridDim.x;
+
+    for (unsigned int i = idx; i < size; i += stride) {
+        out[i] = grad[(is_grad_scalar) ? 0 : i] * (1 - output[i] * output[i]);
+    }
+}
+
+template <typename T>
+void tanh_grad_device(Tensor<T> *output, Tensor<T> *grad, Tensor<T> *out) {
+    unsigned int size = out->get_size();
+    kernel_tanh_grad_device<<<(size + BLK_SIZE - 1) / BLK_SIZE, BLK_SIZE>>>(output->get_ptr(), grad->get_ptr(),
+                                                                           out->get_ptr(), size,
+                                                                           (grad->get_size() == 1));
+}
+template void tanh_grad_device(Tensor<int> *output, Tensor<int> *grad, Tensor<int> *out);
+template void tanh_grad_device(Tensor<float> *output, Tensor<float> *grad, Tensor<float> *out);
+template void tanh_grad_device(Tensor<double> *output, Tensor<double> *grad, Tensor<double> *out);
+
+template <typename T>
+void tanh_grad_device(cudaStream_t custream, Tensor<T> *output, Tensor<T> *grad, Tensor<T> *out) {
+    unsigned int size = out->get_size();
+    kernel_tanh_grad_device<<<(size + BLK_SIZE - 1) / BLK_SIZE, BLK_SIZE, 0, custream>>>(
+        output->get_ptr(), grad->get_ptr(), out->get_ptr(), size, (grad->get_size() == 1));
+}
+template void tanh_grad_device(cudaStream_t custream, Tensor<int> *output, Tensor<int> *grad, Tensor<int> *out);
+template void tanh_grad_device(cudaStream_t custream, Tensor<float> *output, Tensor<float> *grad,
+                               Tensor<float> *out);
+template void tanh_grad_device(cudaStream_t custream, Tensor<double> *output, Tensor<double> *grad,
+                               Tensor<double> *out);
+
 }  // namespace internal
 }  // namespace magmadnn
 
@@ -8,6 +8,10 @@
  */
 #include "compute/tanh/tanhop.h"
 
+#if defined(MAGMADNN_CMAKE_BUILD)
+#include "magmadnn/config.h"
+#endif
+
 namespace magmadnn {
 namespace op {
 
@@ -31,8 +35,34 @@ Tensor<T> *TanhOp<T>::_eval(bool recompute) {
 
 template <typename T>
 Tensor<T> *TanhOp<T>::_grad(Operation<T> *consumer, Operation<T> *var, Tensor<T> *grad) {
-    return grad;
+    /* tanh grad is   grad * (1-output^2)  */
+
+    Tensor<T> *out;
+    Tensor<T> *output = this->eval(false);
+    out = this->_grad_cache[(uintptr_t) var];
+
+    if (out == NULL) {
+        out = new Tensor<T>(this->output_shape, {NONE, {}}, this->mem_type);
+#if defined(MAGMADNN_HAVE_CUDA)
+        out->set_custream(this->get_custream());
+        out->set_cublas_handle(this->get_cublas_handle());
+#endif
+        this->_grad_cache[(uintptr_t) var] = out;
+    }
+
+    if (out->get_memory_type() == HOST) {
+        internal::tanh_grad_cpu(output, grad, out);
+    }
+#if defined(MAGMADNN_HAVE_CUDA)
+    else {
+        internal::tanh_grad_device(this->get_custream(), output, grad, out);
+        if (!this->get_async()) cudaStreamSynchronize(this->get_custream());
+    }
+#endif
+
+    return out;
 }
+
 template class TanhOp<int>;
 template class TanhOp<float>;
 template class TanhOp<double>;
@@ -0,0 +1,417 @@
+/**
+ * @file BinaryDataset.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "magmadnn/data/BinaryDataset.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#include "magmadnn/parallel.h"
+#include "math/half.h"
+
+namespace magmadnn {
+namespace data {
+
+namespace {
+
+const char binary_dataset_magic[8] = {'M', 'D', 'N', 'N', 'D', 'A', 'T', 'A'};
+const uint32_t binary_dataset_version = 1;
+
+std::size_t dtype_bytes(uint32_t dtype) {
+    switch (dtype) {
+        case BINARY_UINT8:
+            return 1;
+        case BINARY_FLOAT16:
+            return 2;
+        case BINARY_FLOAT32:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+uint64_t align_64(uint64_t offset) { return (offset + 63) & ~((uint64_t) 63); }
+
+/* a * b and a + b, false if they do not fit in 64 bits */
+bool checked_mul(uint64_t a, uint64_t b, uint64_t& out) {
+    if (b != 0 && a > UINT64_MAX / b) return false;
+    out = a * b;
+    return true;
+}
+
+bool checked_add(uint64_t a, uint64_t b, uint64_t& out) {
+    if (a > UINT64_MAX - b) return false;
+    out = a + b;
+    return true;
+}
+
+/* writes bytes and zero padding up to offset */
+bool write_padded(std::FILE* file, const void* bytes, std::size_t n_bytes, uint64_t& position, uint64_t offset) {
+    static const char zeros[64] = {0};
+
+    if (n_bytes != 0 && std::fwrite(bytes, 1, n_bytes, file) != n_bytes) return false;
+    position += n_bytes;
+    while (position < offset) {
+        std::size_t n = (std::size_t) std::min((uint64_t) sizeof(zeros), offset - position);
+        if (std::fwrite(zeros, 1, n, file) != n) return false;
+        position += n;
+    }
+    return true;
+}
+
+}  // namespace
+
+magmadnn_error_t write_binary_dataset(const std::string& file_name, const void* samples, binary_dtype_t dtype,
+                                      const std::vector<uint32_t>& sample_shape, const uint32_t* labels,
+                                      uint64_t n_samples, uint32_t n_classes, float scale, float shift) {
+    binary_dataset_header_t header;
+    uint64_t sample_elements = 1;
+
+    if (dtype_bytes(dtype) == 0 || sample_shape.empty() || sample_shape.size() > 4) {
+        std::fprintf(stderr, "Error: write_binary_dataset: bad dtype or sample shape.\n");
+        return (magmadnn_error_t) 1;
+    }
+
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, binary_dataset_magic, sizeof(header.magic));
+    header.version = binary_dataset_version;
+    header.dtype = dtype;
+    header.n_samples = n_samples;
+    header.n_dims = sample_shape.size();
+    for (unsigned int i = 0; i < sample_shape.size(); i++) {
+        header.shape[i] = sample_shape[i];
+        sample_elements *= sample_shape[i];
+    }
+    header.n_classes = n_classes;
+    header.scale = scale;
+    header.shift = shift;
+
+    uint64_t data_bytes = n_samples * sample_elements * dtype_bytes(dtype);
+    header.data_offset = align_64(sizeof(header));
+    header.labels_offset = align_64(header.data_offset + data_bytes);
+
+    std::FILE* file = std::fopen(file_name.c_str(), "wb");
+    if (file == NULL) {
+        std::fprintf(stderr, "Error: write_binary_dataset: cannot open %s.\n", file_name.c_str());
+        return (magmadnn_error_t) 1;
+    }
+
+    uint64_t position = 0;
+    bool ok = write_padded(file, &header, sizeof(header), position, header.data_offset) &&
+              write_padded(file, samples, data_bytes, position, header.labels_offset) &&
+              write_padded(file, labels, n_samples * sizeof(uint32_t), position, 0);
+
+    if (std::fclose(file) != 0) ok = false;
+    if (!ok) {
+        std::fprintf(stderr, "Error: write_binary_dataset: failed writing %s.\n", file_name.c_str());
+        return (magmadnn_error_t) 1;
+    }
+    return (magmadnn_error_t) 0;
+}
+
+template <typename T>
+magmadnn_error_t write_binary_dataset(const std::string& file_name, Tensor<T>* x, Tensor<T>* y, binary_dtype_t dtype,
+                                      float scale, float shift) {
+    const std::vector<unsigned int>& x_shape = x->get_shape();
+    uint64_t n_samples = x_shape[0];
+    std::vector<uint32_t> sample_shape(x_shape.begin() + 1, x_shape.end());
+    std::size_t sample_elements = (n_samples != 0) ? x->get_size() / n_samples : 0;
+    std::size_t n_elements = n_samples * sample_elements;
+
+    if (sample_shape.empty()) sample_shape.push_back(1);
+    if (y->get_shape(0) != n_samples) {
+        std::fprintf(stderr, "Error: write_binary_dataset: x and y have different numbers of samples.\n");
+        return (magmadnn_error_t) 1;
+    }
+
+    /* convert on the host */
+    Tensor<T> x_host(x->get_shape(), {NONE, {}}, HOST);
+    Tensor<T> y_host(y->get_shape(), {NONE, {}}, HOST);
+    x_host.copy_from(*x);
+    y_host.copy_from(*y);
+    const T* x_ptr = x_host.get_ptr();
+    const T* y_ptr = y_host.get_ptr();
+
+    std::vector<unsigned char> samples(n_elements * dtype_bytes(dtype));
+    float inv_scale = 1.0f / scale;
+
+    ::magmadnn::internal::parallel_for(
+        n_elements, ::magmadnn::internal::PARALLEL_GRAIN_SIZE, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                float stored = ((float) x_ptr[i] - shift) * inv_scale;
+
+                if (dtype == BINARY_UINT8) {
+                    samples[i] = (unsigned char) std::min(255.0f, std::max(0.0f, std::round(stored)));
+                } else if (dtype == BINARY_FLOAT16) {
+                    uint16_t h = ::magmadnn::math::float_to_half(stored);
+                    std::memcpy(&samples[2 * i], &h, sizeof(h));
+                } else {
+                    std::memcpy(&samples[4 * i], &stored, sizeof(stored));
+                }
+            }
+        });
+
+    /* one hot rows become their argmax */
+    uint32_t label_width = (n_samples != 0) ? y->get_size() / n_samples : 1;
+    uint32_t n_classes = label_width;
+    std::vector<uint32_t> labels(n_samples);
+
+    for (uint64_t i = 0; i < n_samples; i++) {
+        const T* row = y_ptr + i * label_width;
+        if (label_width > 1) {
+            labels[i] = (uint32_t)(std::max_element(row, row + label_width) - row);
+        } else {
+            labels[i] = (uint32_t) row[0];
+        }
+    }
+    if (label_width <= 1) {
+        n_classes = 0;
+        for (uint64_t i = 0; i < n_samples; i++) n_classes = std::max(n_classes, labels[i] + 1);
+    }
+
+    return write_binary_dataset(file_name, samples.data(), dtype, sample_shape, labels.data(), n_samples, n_classes,
+                                scale, shift);
+}
+template magmadnn_error_t write_binary_dataset(const std::string&, Tensor<int>*, Tensor<int>*, binary_dtype_t, float,
+                                               float);
+template magmadnn_error_t write_binary_dataset(const std::string&, Tensor<float>*, Tensor<float>*, binary_dtype_t,
+                                               float, float);
+template magmadnn_error_t write_binary_dataset(const std::string&, Tensor<double>*, Tensor<double>*, binary_dtype_t,
+                                               float, float);
+
+template <typename T>
+BinaryDataset<T>::BinaryDataset(const std::string& file_name)
+    : sample_elements(0),
+      sample_bytes(0),
+      base(NULL),
+      mapped_bytes(0),
+      samples(NULL),
+      labels(NULL),
+      x_staging(NULL),
+      y_staging(NULL) {
+    std::memset(&this->header, 0, sizeof(this->header));
+
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::fprintf(stderr, "Error: BinaryDataset: cannot open %s.\n", file_name.c_str());
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (std::size_t) st.st_size < sizeof(this->header) ||
+        pread(fd, &this->header, sizeof(this->header), 0) != (ssize_t) sizeof(this->header)) {
+        std::fprintf(stderr, "Error: BinaryDataset: cannot read the header of %s.\n", file_name.c_str());
+        close(fd);
+        return;
+    }
+
+    std::size_t element_bytes = dtype_bytes(this->header.dtype);
+    bool valid = std::memcmp(this->header.magic, binary_dataset_magic, sizeof(binary_dataset_magic)) == 0 &&
+                 this->header.version == binary_dataset_version && element_bytes != 0 && this->header.n_dims >= 1 &&
+                 this->header.n_dims <= 4;
+
+    if (valid) {
+        /* every size is checked for overflow, since the header may come from anywhere */
+        uint64_t elements = 1, n = this->header.n_samples, data_bytes, data_end, labels_bytes, labels_end;
+        for (uint32_t i = 0; i < this->header.n_dims && valid; i++) {
+            this->shape.push_back(this->header.shape[i]);
+            valid = this->header.shape[i] != 0 && checked_mul(elements, this->header.shape[i], elements);
+        }
+        valid = valid && elements <= UINT32_MAX;
+        this->sample_elements = valid ? elements : 0;
+        this->sample_bytes = this->sample_elements * element_bytes;
+
+        valid = valid && this->header.data_offset >= sizeof(this->header) && this->header.data_offset % 64 == 0 &&
+                this->header.labels_offset % 64 == 0 && checked_mul(n, this->sample_bytes, data_bytes) &&
+                checked_add(this->header.data_offset, data_bytes, data_end) &&
+                data_end <= this->header.labels_offset && checked_mul(n, sizeof(uint32_t), labels_bytes) &&
+                checked_add(this->header.labels_offset, labels_bytes, labels_end) &&
+                labels_end <= (uint64_t) st.st_size;
+    }
+    if (!valid) {
+        std::fprintf(stderr, "Error: BinaryDataset: %s is not a valid binary dataset.\n", file_name.c_str());
+        this->shape.clear();
+        close(fd);
+        return;
+    }
+
+    /* the mapping outlives the descriptor */
+    void* mapped = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::fprintf(stderr, "Error: BinaryDataset: cannot map %s.\n", file_name.c_str());
+        this->shape.clear();
+        return;
+    }
+
+    this->base = mapped;
+    this->mapped_bytes = st.st_size;
+    this->samples = static_cast<const unsigned char*>(mapped) + this->header.data_offset;
+    this->labels = reinterpret_cast<const uint32_t*>(static_cast<const unsigned char*>(mapped) +
+                                                     this->header.labels_offset);
+}
+
+template <typename T>
+BinaryDataset<T>::~BinaryDataset() {
+    if (this->x_staging != NULL) delete this->x_staging;
+    if (this->y_staging != NULL) delete this->y_staging;
+    if (this->base != NULL) munmap(this->base, this->mapped_bytes);
+}
+
+template <typename T>
+bool BinaryDataset<T>::can_view() const {
+    return this->is_open() && std::is_same<T, float>::value && this->header.dtype == BINARY_FLOAT32 &&
+           this->header.scale == 1.0f && this->header.shift == 0.0f;
+}
+
+template <typename T>
+Tensor<T>* BinaryDataset<T>::view(uint64_t begin, unsigned int count) {
+    if (!this->can_view() || count == 0 || count > this->header.n_samples || begin > this->header.n_samples - count) {
+        return NULL;
+    }
+
+    std::vector<unsigned int> view_shape(1, count);
+    view_shape.insert(view_shape.end(), this->shape.begin(), this->shape.end());
+
+    /* no memory of its own: the tensor points into the read only mapping */
+    T* ptr = const_cast<T*>(reinterpret_cast<const T*>(this->samples + begin * this->sample_bytes));
+    return new Tensor<T>(ptr, view_shape, HOST);
+}
+
+template <typename T>
+template <typename F>
+magmadnn_error_t BinaryDataset<T>::load(F sample_at, unsigned int count, Tensor<T>* x_batch, Tensor<T>* y_batch) {
+    if (!this->is_open()) return (magmadnn_error_t) 1;
+
+    const std::size_t sample_elements = this->sample_elements;
+    const uint32_t n_classes = this->header.n_classes;
+    const float scale = this->header.scale;
+    const float shift = this->header.shift;
+    const uint32_t dtype = this->header.dtype;
+
+    if (x_batch->get_size() < count * sample_elements) {
+        std::fprintf(stderr, "Error: BinaryDataset::load_batch: x_batch holds fewer than %u samples.\n", count);
+        return (magmadnn_error_t) 1;
+    }
+    /* one label per sample at least; one-hot rows are only written when they fit */
+    if (y_batch != NULL && y_batch->get_size() < count) {
+        std::fprintf(stderr, "Error: BinaryDataset::load_batch: y_batch holds fewer than %u labels.\n", count);
+        return (magmadnn_error_t) 1;
+    }
+
+    /* targets on another memory type are filled on the host first */
+    Tensor<T>* x_out = x_batch;
+    Tensor<T>* y_out = y_batch;
+    if (x_batch->get_memory_type() != HOST) {
+        if (this->x_staging == NULL || this->x_staging->get_shape() != x_batch->get_shape()) {
+            if (this->x_staging != NULL) delete this->x_staging;
+            this->x_staging = new Tensor<T>(x_batch->get_shape(), {NONE, {}}, HOST);
+        }
+        x_out = this->x_staging;
+    }
+    if (y_batch != NULL && y_batch->get_memory_type() != HOST) {
+        if (this->y_staging == NULL || this->y_staging->get_shape() != y_batch->get_shape()) {
+            if (this->y_staging != NULL) delete this->y_staging;
+            this->y_staging = new Tensor<T>(y_batch->get_shape(), {NONE, {}}, HOST);
+        }
+        y_out = this->y_staging;
+    }
+
+    T* x_ptr = x_out->get_ptr();
+    const unsigned char* samples = this->samples;
+    const std::size_t sample_bytes = this->sample_bytes;
+    const bool identity = (scale == 1.0f && shift == 0.0f);
+    std::size_t grain = std::max((std::size_t) 1, ::magmadnn::internal::PARALLEL_GRAIN_SIZE / sample_elements);
+
+    ::magmadnn::internal::parallel_for(count, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            const unsigned char* src = samples + (std::size_t) sample_at(i) * sample_bytes;
+            T* dst = x_ptr + i * sample_elements;
+
+            if (dtype == BINARY_FLOAT32 && identity && std::is_same<T, float>::value) {
+                std::memcpy(dst, src, sample_bytes);
+            } else if (dtype == BINARY_UINT8) {
+                for (std::size_t j = 0; j < sample_elements; j++) dst[j] = (T)(src[j] * scale + shift);
+            } else if (dtype == BINARY_FLOAT16) {
+                for (std::size_t j = 0; j < sample_elements; j++) {
+                    uint16_t h;
+                    std::memcpy(&h, src + 2 * j, sizeof(h));
+                    dst[j] = (T)(::magmadnn::math::half_to_float(h) * scale + shift);
+                }
+            } else {
+                for (std::size_t j = 0; j < sample_elements; j++) {
+                    float f;
+                    std::memcpy(&f, src + 4 * j, sizeof(f));
+                    dst[j] = (T)(f * scale + shift);
+                }
+            }
+        }
+    });
+
+    if (y_batch != NULL) {
+        T* y_ptr = y_out->get_ptr();
+        bool one_hot = n_classes > 1 && y_batch->get_size() >= (std::size_t) count * n_classes;
+
+        if (one_hot) {
+            std::fill(y_ptr, y_ptr + (std::size_t) count * n_classes, (T) 0);
+            for (unsigned int i = 0; i < count; i++) {
+                uint32_t label = this->labels[sample_at(i)];
+                if (label < n_classes) y_ptr[(std::size_t) i * n_classes + label] = (T) 1;
+            }
+        } else {
+            for (unsigned int i = 0; i < count; i++) y_ptr[i] = (T) this->labels[sample_at(i)];
+        }
+        if (y_out != y_batch) y_batch->copy_from(*y_out, 0, one_hot ? count * n_classes : count);
+    }
+
+    if (x_out != x_batch) x_batch->copy_from(*x_out, 0, count * sample_elements);
+
+    return (magmadnn_error_t) 0;
+}
+
+template <typename T>
+magmadnn_error_t BinaryDataset<T>::load_batch(const unsigned int* indices, unsigned int count, Tensor<T>* x_batch,
+                                              Tensor<T>* y_batch) {
+    for (unsigned int i = 0; i < count; i++) {
+        if (indices[i] >= this->header.n_samples) {
+            std::fprintf(stderr, "Error: BinaryDataset::load_batch: sample %u out of range.\n", indices[i]);
+            return (magmadnn_error_t) 1;
+        }
+    }
+    return this->load([indices](std::size_t i) { return (uint64_t) indices[i]; }, count, x_batch, y_batch);
+}
+
+template <typename T>
+magmadnn_error_t BinaryDataset<T>::load_range(uint64_t begin, unsigned int count, Tensor<T>* x_batch,
+                                              Tensor<T>* y_batch) {
+    if (count > this->header.n_samples || begin > this->header.n_samples - count) {
+        std::fprintf(stderr, "Error: BinaryDataset::load_range: samples out of range.\n");
+        return (magmadnn_error_t) 1;
+    }
+    return this->load([begin](std::size_t i) { return begin + i; }, count, x_batch, y_batch);
+}
+
+template <typename T>
+void BinaryDataset<T>::advise(bool random) {
+    if (this->base == NULL) return;
+    madvise(this->base, this->mapped_bytes, random ? MADV_RANDOM : MADV_SEQUENTIAL);
+}
+
+template class BinaryDataset<int>;
+template class BinaryDataset<float>;
+template class BinaryDataset<double>;
+
+}  // namespace data
+}  // namespace magmadnn
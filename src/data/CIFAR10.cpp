@@ -9,7 +9,8 @@ namespace magmadnn {
 namespace data {
 
 template <typename T>
-CIFAR10<T>::CIFAR10(std::string const &root, dataset_type type, uint32_t batch_idx) {
+CIFAR10<T>::CIFAR10(std::string const &root, dataset_type type, uint32_t batch_idx,
+                    const pixel_normalization_t &norm) {
     if ((batch_idx < 1) || (batch_idx > 5)) {
         throw ::magmadnn::Error(__FILE__, __LINE__,
                                 "No dataset associated with batch index: " + std::to_string(batch_idx));
@@ -28,7 +29,7 @@ CIFAR10<T>::CIFAR10(std::string const &root, dataset_type type, uint32_t batch_i
 
     magmadnn::magmadnn_error_t err =
         read_cifar10(data_filename, &cifar10_images, &cifar10_labels, this->nimages_, this->ncols_, this->nrows_,
-                     this->nchanels_, this->nclasses_ /*, bool normalize*/);
+                     this->nchanels_, this->nclasses_, norm);
 
     if (err != static_cast<magmadnn::magmadnn_error_t>(0)) {
         throw ::magmadnn::Error(__FILE__, __LINE__,
@@ -9,7 +9,7 @@ namespace magmadnn {
 namespace data {
 
 template <typename T>
-CIFAR100<T>::CIFAR100(std::string const &root, dataset_type type) {
+CIFAR100<T>::CIFAR100(std::string const &root, dataset_type type, const pixel_normalization_t &norm) {
     magmadnn::magmadnn_error_t err = 1;
 
     magmadnn::Tensor<T> *cifar100_images = nullptr;
@@ -22,14 +22,14 @@ CIFAR100<T>::CIFAR100(std::string const &root, dataset_type type) {
         data_filename = root + "/test.bin";
 
         err = read_cifar100_test(data_filename, &cifar100_images, &cifar100_labels, this->nimages_, this->ncols_,
-                                 this->nrows_, this->nchanels_, this->nclasses_, this->nsuperclasses_);
+                                 this->nrows_, this->nchanels_, this->nclasses_, this->nsuperclasses_, norm);
 
     } else {
         // Training dataset filename
         data_filename = root + "/train.bin";
 
         err = read_cifar100_train(data_filename, &cifar100_images, &cifar100_labels, this->nimages_, this->ncols_,
-                                  this->nrows_, this->nchanels_, this->nclasses_, this->nsuperclasses_);
+                                  this->nrows_, this->nchanels_, this->nclasses_, this->nsuperclasses_, norm);
     }
 
     // std::cout << "" << std::endl;
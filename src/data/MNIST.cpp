@@ -11,7 +11,7 @@ namespace magmadnn {
 namespace data {
 
 template <typename T>
-MNIST<T>::MNIST(std::string const &root, dataset_type type) {
+MNIST<T>::MNIST(std::string const &root, dataset_type type, const pixel_normalization_t &norm) {
     std::string images_filename;
     std::string labels_filename;
 
@@ -29,7 +29,7 @@ MNIST<T>::MNIST(std::string const &root, dataset_type type) {
     this->nchanels(1);
     this->nclasses(10);
 
-    mnist_images = read_mnist_images(images_filename.c_str(), this->nimages_, this->nrows_, this->ncols_);
+    mnist_images = read_mnist_images(images_filename.c_str(), this->nimages_, this->nrows_, this->ncols_, norm);
     mnist_labels = read_mnist_labels(labels_filename.c_str(), this->nlabels_, this->nclasses_);
 
     assert((mnist_images != nullptr) && (mnist_labels != nullptr));
@@ -1,3 +1,12 @@
+#include "magmadnn/data/utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "magmadnn/parallel.h"
+#include "math/elementwise.h"
 #include "tensor/tensor.h"
 
 namespace magmadnn {
@@ -6,6 +15,7 @@ namespace data {
 #define FREAD_CHECK(res, nmemb)           \
     if ((res) != (nmemb)) {               \
         fprintf(stderr, "fread fail.\n"); \
+        fclose(file);                     \
         return NULL;                      \
     }
 
@@ -14,14 +24,65 @@ inline void endian_swap(uint32_t& val) {
     val = (val >> 24) | ((val << 8) & 0xff0000) | ((val >> 8) & 0xff00) | (val << 24);
 }
 
+magmadnn_error_t normalize_pixels(const uint8_t* src, std::size_t src_stride, float* dst, uint32_t n_images,
+                                  uint32_t n_channels, uint32_t channel_size, const pixel_normalization_t& norm) {
+    std::vector<float> scale(n_channels), shift(n_channels);
+
+    if ((norm.mean.size() != 1 && norm.mean.size() != n_channels) ||
+        (norm.std.size() != 1 && norm.std.size() != n_channels)) {
+        std::fprintf(stderr, "Normalization needs one mean and std, or one per channel.\n");
+        return (magmadnn_error_t) 1;
+    }
+
+    /* (pixel - mean) / std as one multiply-add */
+    for (uint32_t c = 0; c < n_channels; c++) {
+        float mean = norm.mean[(norm.mean.size() == 1) ? 0 : c];
+        float std = norm.std[(norm.std.size() == 1) ? 0 : c];
+        scale[c] = 1.0f / std;
+        shift[c] = -mean / std;
+    }
+
+    const std::size_t image_size = (std::size_t) n_channels * channel_size;
+    const std::size_t grain = std::max((std::size_t) 1, ::magmadnn::internal::PARALLEL_GRAIN_SIZE / image_size);
+
+    ::magmadnn::internal::parallel_for(n_images, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            for (uint32_t c = 0; c < n_channels; c++) {
+                const uint8_t* in = src + i * src_stride + (std::size_t) c * channel_size;
+                float* out = dst + i * image_size + (std::size_t) c * channel_size;
+                const float a = scale[c];
+                const float b = shift[c];
+
+                MAGMADNN_PRAGMA_SIMD
+                for (uint32_t j = 0; j < channel_size; j++) out[j] = in[j] * a + b;
+            }
+        }
+    });
+
+    return (magmadnn_error_t) 0;
+}
+
+/* sets labels[i * n_classes + class_idx[i * stride]] to 1 in zeroed labels */
+static magmadnn_error_t set_one_hot(const uint8_t* class_idx, std::size_t stride, uint32_t n_labels,
+                                    uint32_t n_classes, float* labels) {
+    for (uint32_t i = 0; i < n_labels; i++) {
+        uint8_t label = class_idx[(std::size_t) i * stride];
+        if (label >= n_classes) {
+            std::fprintf(stderr, "Label %u of sample %u is not below %u.\n", label, i, n_classes);
+            return (magmadnn_error_t) 1;
+        }
+        labels[(std::size_t) i * n_classes + label] = 1.0f;
+    }
+    return (magmadnn_error_t) 0;
+}
+
 magmadnn::Tensor<float>* read_mnist_images(const char* file_name, uint32_t& n_images, uint32_t& n_rows,
-                                           uint32_t& n_cols) {
+                                           uint32_t& n_cols, const pixel_normalization_t& norm) {
     FILE* file;
     unsigned char magic[4];
     magmadnn::Tensor<float>* data;
-    uint8_t val;
 
-    file = std::fopen(file_name, "r");
+    file = std::fopen(file_name, "rb");
 
     if (file == NULL) {
         std::fprintf(stderr, "Could not open %s for reading.\n", file_name);
@@ -31,6 +92,7 @@ magmadnn::Tensor<float>* read_mnist_images(const char* file_name, uint32_t& n_im
     FREAD_CHECK(fread(magic, sizeof(char), 4, file), 4);
     if (magic[2] != 0x08 || magic[3] != 0x03) {
         std::fprintf(stderr, "Bad file magic.\n");
+        fclose(file);
         return NULL;
     }
 
@@ -45,66 +107,90 @@ magmadnn::Tensor<float>* read_mnist_images(const char* file_name, uint32_t& n_im
 
     printf("Preparing to read %u images with size %u x %u ...\n", n_images, n_rows, n_cols);
 
-    char bytes[n_rows * n_cols];
+    /* every image in one read */
+    std::size_t image_size = (std::size_t) n_rows * n_cols;
+    std::vector<uint8_t> bytes((std::size_t) n_images * image_size);
+    FREAD_CHECK(fread(bytes.data(), sizeof(uint8_t), bytes.size(), file), bytes.size());
+    fclose(file);
 
     /* allocate tensor */
     data = new magmadnn::Tensor<float>({n_images, n_rows, n_cols}, {magmadnn::NONE, {}}, magmadnn::HOST);
 
-    for (uint32_t i = 0; i < n_images; i++) {
-        FREAD_CHECK(fread(bytes, sizeof(char), n_rows * n_cols, file), n_rows * n_cols);
-
-        for (uint32_t r = 0; r < n_rows; r++) {
-            for (uint32_t c = 0; c < n_cols; c++) {
-                val = bytes[r * n_cols + c];
-
-                data->set(i * n_rows * n_cols + r * n_cols + c, (val / 128.0f) - 1.0f);
-            }
-        }
+    if (normalize_pixels(bytes.data(), image_size, data->get_ptr(), n_images, 1, image_size, norm) != 0) {
+        delete data;
+        return NULL;
     }
     printf("finished reading images.\n");
 
-    fclose(file);
-
     return data;
 }
 
-magmadnn::Tensor<float>* read_mnist_labels(const char* file_name, uint32_t& n_labels, uint32_t n_classes) {
+/* reads the label bytes of an MNIST label file, false on error */
+static bool read_mnist_label_bytes(const char* file_name, uint32_t& n_labels, std::vector<uint8_t>& bytes) {
     FILE* file;
     unsigned char magic[4];
-    magmadnn::Tensor<float>* labels;
-    uint8_t val;
 
-    file = std::fopen(file_name, "r");
+    file = std::fopen(file_name, "rb");
 
     if (file == NULL) {
         std::fprintf(stderr, "Could not open %s for reading.\n", file_name);
-        return NULL;
+        return false;
     }
 
-    FREAD_CHECK(fread(magic, sizeof(char), 4, file), 4);
-
-    if (magic[2] != 0x08 || magic[3] != 0x01) {
+    if (fread(magic, sizeof(char), 4, file) != 4 || magic[2] != 0x08 || magic[3] != 0x01) {
         std::fprintf(stderr, "Bad file magic.\n");
-        return NULL;
+        fclose(file);
+        return false;
     }
 
-    FREAD_CHECK(fread(&n_labels, sizeof(uint32_t), 1, file), 1);
+    if (fread(&n_labels, sizeof(uint32_t), 1, file) != 1) {
+        fprintf(stderr, "fread fail.\n");
+        fclose(file);
+        return false;
+    }
     endian_swap(n_labels);
 
+    bytes.resize(n_labels);
+    if (fread(bytes.data(), sizeof(uint8_t), n_labels, file) != n_labels) {
+        fprintf(stderr, "fread fail.\n");
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+
+    return true;
+}
+
+magmadnn::Tensor<float>* read_mnist_labels(const char* file_name, uint32_t& n_labels, uint32_t n_classes) {
+    magmadnn::Tensor<float>* labels;
+    std::vector<uint8_t> bytes;
+
+    if (!read_mnist_label_bytes(file_name, n_labels, bytes)) return NULL;
+
     printf("Preparing to read %u labels with %u classes ...\n", n_labels, n_classes);
 
     /* allocate tensor */
     labels = new magmadnn::Tensor<float>({n_labels, n_classes}, {magmadnn::ZERO, {}}, magmadnn::HOST);
 
+    if (set_one_hot(bytes.data(), 1, n_labels, n_classes, labels->get_ptr()) != 0) {
+        delete labels;
+        return NULL;
+    }
     printf("finished reading labels.\n");
 
-    for (unsigned int i = 0; i < n_labels; i++) {
-        FREAD_CHECK(fread(&val, sizeof(char), 1, file), 1);
+    return labels;
+}
 
-        labels->set(i * n_classes + val, 1.0f);
-    }
+magmadnn::Tensor<float>* read_mnist_label_indices(const char* file_name, uint32_t& n_labels) {
+    magmadnn::Tensor<float>* labels;
+    std::vector<uint8_t> bytes;
 
-    fclose(file);
+    if (!read_mnist_label_bytes(file_name, n_labels, bytes)) return NULL;
+
+    labels = new magmadnn::Tensor<float>({n_labels}, {magmadnn::NONE, {}}, magmadnn::HOST);
+
+    float* labels_ptr = labels->get_ptr();
+    for (uint32_t i = 0; i < n_labels; i++) labels_ptr[i] = (float) bytes[i];
 
     return labels;
 }
@@ -144,16 +230,45 @@ template void mnist_print_image<double>(uint32_t image_idx, magmadnn::Tensor<dou
 ////////////////////////////////////////////////////////////
 // CIFAR https://www.cs.toronto.edu/~kriz/cifar.html
 
-#define FREAD_CHECK(res, nmemb, ret)           \
-    if ((res) != (nmemb)) {                    \
-        std::fprintf(stderr, "fread fail.\n"); \
-        return ret;                            \
+/* Reads n_images records of label_bytes label bytes then the image, in one block, into data and the zeroed one hot
+   labels from image offset on. label_idx picks the label byte that is used. */
+static magmadnn::magmadnn_error_t read_cifar_records(const std::string& file_name, uint32_t n_images,
+                                                     uint32_t label_bytes, uint32_t label_idx, uint32_t n_classes,
+                                                     magmadnn::Tensor<float>* data, magmadnn::Tensor<float>* labels,
+                                                     uint32_t offset, const pixel_normalization_t& norm) {
+    const uint32_t n_channels = 3, channel_size = 32 * 32;
+    const std::size_t record_bytes = label_bytes + (std::size_t) n_channels * channel_size;
+
+    FILE* file = std::fopen(file_name.c_str(), "rb");
+
+    if (file == NULL) {
+        std::fprintf(stderr, "could not open file %s for reading.\n", file_name.c_str());
+        return (magmadnn::magmadnn_error_t) 1;
+    }
+
+    std::vector<uint8_t> records((std::size_t) n_images * record_bytes);
+    std::size_t n_read = fread(records.data(), sizeof(uint8_t), records.size(), file);
+    fclose(file);
+
+    if (n_read != records.size()) {
+        std::fprintf(stderr, "fread fail.\n");
+        return (magmadnn::magmadnn_error_t) 1;
     }
 
+    float* data_ptr = data->get_ptr() + (std::size_t) offset * n_channels * channel_size;
+    float* labels_ptr = labels->get_ptr() + (std::size_t) offset * n_classes;
+
+    magmadnn::magmadnn_error_t err = normalize_pixels(records.data() + label_bytes, record_bytes, data_ptr, n_images,
+                                                      n_channels, channel_size, norm);
+    if (err != 0) return err;
+
+    return set_one_hot(records.data() + label_idx, record_bytes, n_images, n_classes, labels_ptr);
+}
+
 magmadnn::magmadnn_error_t read_cifar100(const std::string& file_name, magmadnn::Tensor<float>** data,
                                          magmadnn::Tensor<float>** labels, uint32_t n_images, uint32_t& image_width,
                                          uint32_t& image_height, uint32_t& n_channels, uint32_t& n_classes,
-                                         uint32_t& n_super_classes /*, bool normalize = true*/) {
+                                         uint32_t& n_super_classes, const pixel_normalization_t& norm) {
     // n_images = 50000; /* training set */
     // n_images = 10000; /* test set */
     image_width = 32;
@@ -166,77 +281,44 @@ magmadnn::magmadnn_error_t read_cifar100(const std::string& file_name, magmadnn:
                                         magmadnn::HOST);
     *labels = new magmadnn::Tensor<float>({n_images, n_classes}, {magmadnn::ZERO, {}}, magmadnn::HOST);
 
-    FILE* file;
-    uint8_t val;
-    uint8_t* img;
-
-    file = std::fopen(file_name.c_str(), "r");
-
-    if (file == NULL) {
-        std::fprintf(stderr, "could not open file %s for reading.\n", file_name.c_str());
-        return 1;
-    }
-
-    img = new uint8_t[n_channels * image_width * image_height];
-    for (uint32_t i = 0; i < n_images; i++) {
-        FREAD_CHECK(fread(&val, sizeof(uint8_t), 1, file), 1, 1);
-        /* course label -- do nothing with it for now */
-
-        FREAD_CHECK(fread(&val, sizeof(uint8_t), 1, file), 1, 1);
-        (*labels)->set(i * n_classes + (val), 1.0f);
-        /* fine label */
-
-        FREAD_CHECK(fread(img, sizeof(uint8_t), n_channels * image_width * image_height, file),
-                    n_channels * image_width * image_height, 1);
-
-        for (uint32_t j = 0; j < n_channels * image_height * image_width; j++) {
-            float normalized_val = (img[j] / 128.0f) - 1.0f;
-
-            (*data)->set(i * n_channels * image_height * image_width + j, normalized_val);
-        }
-    }
-
-    delete img;
-
-    return (magmadnn::magmadnn_error_t) 0;
+    /* a coarse label (unused for now), then the fine label */
+    return read_cifar_records(file_name, n_images, 2, 1, n_classes, *data, *labels, 0, norm);
 }
 
 magmadnn::magmadnn_error_t read_cifar100_train(const std::string& file_name, magmadnn::Tensor<float>** data,
                                                magmadnn::Tensor<float>** labels, uint32_t& n_images,
                                                uint32_t& image_width, uint32_t& image_height, uint32_t& n_channels,
-                                               uint32_t& n_classes,
-                                               uint32_t& n_super_classes /*, bool normalize = true*/) {
+                                               uint32_t& n_classes, uint32_t& n_super_classes,
+                                               const pixel_normalization_t& norm) {
     n_images = 50000;
 
     return read_cifar100(file_name, data, labels, n_images, image_width, image_height, n_channels, n_classes,
-                         n_super_classes /*, bool normalize = true*/);
+                         n_super_classes, norm);
 }
 
 magmadnn::magmadnn_error_t read_cifar100_test(const std::string& file_name, magmadnn::Tensor<float>** data,
                                               magmadnn::Tensor<float>** labels, uint32_t& n_images,
                                               uint32_t& image_width, uint32_t& image_height, uint32_t& n_channels,
-                                              uint32_t& n_classes,
-                                              uint32_t& n_super_classes /*, bool normalize = true*/) {
+                                              uint32_t& n_classes, uint32_t& n_super_classes,
+                                              const pixel_normalization_t& norm) {
     n_images = 10000;
 
     return read_cifar100(file_name, data, labels, n_images, image_width, image_height, n_channels, n_classes,
-                         n_super_classes /*, bool normalize = true*/);
+                         n_super_classes, norm);
 }
 
 magmadnn::magmadnn_error_t load_cifar100(const std::string& cifar_root, magmadnn::Tensor<float>** data,
                                          magmadnn::Tensor<float>** labels, uint32_t& n_images, uint32_t& image_width,
                                          uint32_t& image_height, uint32_t& n_channels, uint32_t& n_classes,
-                                         uint32_t& n_super_classes /*,
-                                                                     bool normalize = true*/
-) {
-    return read_cifar100(cifar_root + "/train.bin", data, labels, n_images, image_width, image_height, n_channels,
-                         n_classes, n_super_classes /*, normalize*/);
+                                         uint32_t& n_super_classes, const pixel_normalization_t& norm) {
+    return read_cifar100_train(cifar_root + "/train.bin", data, labels, n_images, image_width, image_height,
+                               n_channels, n_classes, n_super_classes, norm);
 }
 
 magmadnn::magmadnn_error_t read_cifar10(const std::string& file_name, magmadnn::Tensor<float>** data,
                                         magmadnn::Tensor<float>** labels, uint32_t& n_images, uint32_t& image_width,
-                                        uint32_t& image_height, uint32_t& n_channels,
-                                        uint32_t& n_classes /*, bool normalize*/) {
+                                        uint32_t& image_height, uint32_t& n_channels, uint32_t& n_classes,
+                                        const pixel_normalization_t& norm) {
     n_images = 10000; /* magic numbers from cifar10 file format */
     image_width = 32;
     image_height = 32;
@@ -247,49 +329,43 @@ magmadnn::magmadnn_error_t read_cifar10(const std::string& file_name, magmadnn::
                                         magmadnn::HOST);
     *labels = new magmadnn::Tensor<float>({n_images, n_classes}, {magmadnn::ZERO, {}}, magmadnn::HOST);
 
-    FILE* file;
-    uint8_t val;
-    uint8_t* img;
-
-    file = std::fopen(file_name.c_str(), "r");
+    return read_cifar_records(file_name, n_images, 1, 0, n_classes, *data, *labels, 0, norm);
+}
 
-    if (file == NULL) {
-        std::fprintf(stderr, "could not open file %s for reading.\n", file_name.c_str());
-        return 1;
-    }
+magmadnn::magmadnn_error_t load_cifar10_batch(uint32_t batch_idx, const std::string& cifar_root,
+                                              magmadnn::Tensor<float>** data, magmadnn::Tensor<float>** labels,
+                                              uint32_t& n_images, uint32_t& image_width, uint32_t& image_height,
+                                              uint32_t& n_channels, uint32_t& n_classes,
+                                              const pixel_normalization_t& norm) {
+    return read_cifar10(cifar_root + "/data_batch_" + std::to_string(batch_idx) + ".bin", data, labels, n_images,
+                        image_width, image_height, n_channels, n_classes, norm);
+}
 
-    img = new uint8_t[n_channels * image_width * image_height];
-    for (uint32_t i = 0; i < n_images; i++) {
-        FREAD_CHECK(fread(&val, sizeof(uint8_t), 1, file), 1, 1);
-        (*labels)->set(i * n_classes + (val), 1.0f);
+magmadnn::magmadnn_error_t load_cifar10_train(const std::string& cifar_root, magmadnn::Tensor<float>** data,
+                                              magmadnn::Tensor<float>** labels, uint32_t& n_images,
+                                              uint32_t& image_width, uint32_t& image_height, uint32_t& n_channels,
+                                              uint32_t& n_classes, const pixel_normalization_t& norm) {
+    const uint32_t n_batches = 5, batch_images = 10000;
 
-        FREAD_CHECK(fread(img, sizeof(uint8_t), n_channels * image_width * image_height, file),
-                    n_channels * image_width * image_height, 1);
+    n_images = n_batches * batch_images;
+    image_width = 32;
+    image_height = 32;
+    n_channels = 3;
+    n_classes = 10;
 
-        for (uint32_t j = 0; j < n_channels * image_height * image_width; j++) {
-            float normalized_val = (img[j] / 128.0f) - 1.0f;
+    *data = new magmadnn::Tensor<float>({n_images, n_channels, image_height, image_width}, {magmadnn::NONE, {}},
+                                        magmadnn::HOST);
+    *labels = new magmadnn::Tensor<float>({n_images, n_classes}, {magmadnn::ZERO, {}}, magmadnn::HOST);
 
-            (*data)->set(i * n_channels * image_height * image_width + j, normalized_val);
-        }
+    /* each batch file lands straight in its slice of the training set */
+    for (uint32_t b = 0; b < n_batches; b++) {
+        magmadnn::magmadnn_error_t err =
+            read_cifar_records(cifar_root + "/data_batch_" + std::to_string(b + 1) + ".bin", batch_images, 1, 0,
+                               n_classes, *data, *labels, b * batch_images, norm);
+        if (err != 0) return err;
     }
-
-    delete img;
-
     return (magmadnn::magmadnn_error_t) 0;
 }
 
-magmadnn::magmadnn_error_t load_cifar10_batch(
-      uint32_t batch_idx, const std::string& cifar_root,
-      magmadnn::Tensor<float>** data,
-      magmadnn::Tensor<float>** labels,
-      uint32_t& n_images, uint32_t& image_width,
-      uint32_t& image_height, uint32_t& n_channels, uint32_t& n_classes/*,
-      bool normalize*/) {
-    return read_cifar10(cifar_root + "/data_batch_" + std::to_string(batch_idx) + ".bin", data, labels, n_images,
-                        image_width, image_height, n_channels, n_classes /*, normalize*/);
-}
-
-#undef FREAD_CHECK
-
 }  // namespace data
 }  // namespace magmadnn
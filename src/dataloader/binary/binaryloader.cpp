@@ -0,0 +1,75 @@
+/**
+ * @file binaryloader.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "dataloader/binary/binaryloader.h"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+#include "magmadnn/exception.h"
+
+namespace magmadnn {
+namespace dataloader {
+
+template <typename T>
+BinaryLoader<T>::BinaryLoader(data::BinaryDataset<T> *dataset, unsigned int batch_size, bool shuffle)
+    : DataLoader<T>::DataLoader(dataset->n_samples(), dataset->sample_size(), dataset->n_classes(), batch_size),
+      dataset(dataset),
+      shuffle(shuffle),
+      curr_index(0) {
+    if (shuffle) this->set_seed(std::random_device()());
+
+    /* in order, the next batch is read ahead; shuffled, read ahead only wastes page cache */
+    dataset->advise(shuffle);
+}
+
+template <typename T>
+void BinaryLoader<T>::next(Tensor<T> *x_batch, Tensor<T> *y_batch) {
+    assert(this->curr_index < this->num_batches);
+
+    unsigned int begin = this->curr_index * this->batch_size;
+
+    magmadnn_error_t err;
+    if (this->shuffle) {
+        err = this->dataset->load_batch(this->permutation.data() + begin, this->batch_size, x_batch, y_batch);
+    } else {
+        err = this->dataset->load_range(begin, this->batch_size, x_batch, y_batch);
+    }
+    if (err != 0) {
+        throw ::magmadnn::Error(__FILE__, __LINE__, "Could not load batch " + std::to_string(this->curr_index));
+    }
+    this->curr_index++;
+}
+
+template <typename T>
+void BinaryLoader<T>::reset() {
+    if (this->shuffle) std::shuffle(this->permutation.begin(), this->permutation.end(), this->generator);
+    this->curr_index = 0;
+}
+
+template <typename T>
+void BinaryLoader<T>::set_batch_size(unsigned int size) {
+    DataLoader<T>::set_batch_size(size);
+    this->curr_index = 0;
+}
+
+template <typename T>
+void BinaryLoader<T>::set_seed(unsigned int seed) {
+    this->shuffle = true;
+    this->generator.seed(seed);
+    this->permutation.resize(this->n_samples);
+    std::iota(this->permutation.begin(), this->permutation.end(), 0u);
+    this->reset();
+}
+
+template class BinaryLoader<int>;
+template class BinaryLoader<float>;
+template class BinaryLoader<double>;
+
+}  // namespace dataloader
+}  // namespace magmadnn
@@ -0,0 +1,206 @@
+/**
+ * @file prefetchloader.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "dataloader/prefetch/prefetchloader.h"
+
+#include <chrono>
+
+namespace magmadnn {
+namespace dataloader {
+
+template <typename T>
+PrefetchLoader<T>::PrefetchLoader(DataLoader<T> *source, unsigned int n_buffers)
+    : DataLoader<T>::DataLoader(source->get_num_samples(), source->get_sample_size_x(), source->get_sample_size_y(),
+                                source->get_batch_size()),
+      source(source),
+      n_buffers((n_buffers > 0) ? n_buffers : 1),
+      produced(0),
+      consumed(0),
+      running(false),
+      paused(false),
+      busy(false),
+      stopping(false),
+      queue_depth_sum(0) {
+    /* the source may count a partial batch */
+    this->num_batches = source->get_num_batches();
+    this->reset_stats();
+}
+
+template <typename T>
+PrefetchLoader<T>::~PrefetchLoader() {
+    this->stop();
+}
+
+template <typename T>
+void PrefetchLoader<T>::start(Tensor<T> *x_batch, Tensor<T> *y_batch) {
+    for (unsigned int i = 0; i < this->n_buffers; i++) {
+        this->x_slots.push_back(new Tensor<T>(x_batch->get_shape(), {NONE, {}}, x_batch->get_memory_type()));
+        this->y_slots.push_back(new Tensor<T>(y_batch->get_shape(), {NONE, {}}, y_batch->get_memory_type()));
+        this->free_slots.push_back(i);
+    }
+
+#if defined(MAGMADNN_HAVE_CUDA)
+    cudaGetDevice(&this->device);
+#endif
+
+    this->stopping = false;
+    this->running = true;
+    this->worker = std::thread(&PrefetchLoader<T>::produce, this);
+}
+
+template <typename T>
+void PrefetchLoader<T>::stop() {
+    if (!this->running) return;
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->cv.notify_all();
+    this->worker.join();
+
+    for (unsigned int i = 0; i < this->x_slots.size(); i++) {
+        delete this->x_slots[i];
+        delete this->y_slots[i];
+    }
+    this->x_slots.clear();
+    this->y_slots.clear();
+    this->ready.clear();
+    this->free_slots.clear();
+    this->running = false;
+}
+
+template <typename T>
+void PrefetchLoader<T>::produce() {
+#if defined(MAGMADNN_HAVE_CUDA)
+    cudaSetDevice(this->device);
+#endif
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    while (true) {
+        this->cv.wait(lock, [this] {
+            return this->stopping ||
+                   (!this->paused && this->produced < this->num_batches && !this->free_slots.empty());
+        });
+        if (this->stopping) break;
+
+        unsigned int slot = this->free_slots.front();
+        this->free_slots.pop_front();
+        this->busy = true;
+
+        lock.unlock();
+        this->source->next(this->x_slots[slot], this->y_slots[slot]);
+        lock.lock();
+
+        this->busy = false;
+        this->produced++;
+        this->ready.push_back(slot);
+        this->cv.notify_all();
+    }
+}
+
+template <typename T>
+void PrefetchLoader<T>::hand_over(Tensor<T> *staged, Tensor<T> *batch) {
+    if (staged->get_shape() == batch->get_shape() && batch->swap_memory(*staged) == 0) {
+        this->stats.n_swapped++;
+        return;
+    }
+    batch->copy_from(*staged, 0, batch->get_size());
+}
+
+template <typename T>
+void PrefetchLoader<T>::next(Tensor<T> *x_batch, Tensor<T> *y_batch) {
+    assert(this->consumed < this->num_batches);
+
+    if (!this->running) this->start(x_batch, y_batch);
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    this->queue_depth_sum += this->ready.size();
+    if (this->ready.empty()) {
+        auto begin = std::chrono::steady_clock::now();
+        this->cv.wait(lock, [this] { return !this->ready.empty(); });
+        this->stats.stall_seconds +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        this->stats.n_stalls++;
+    }
+
+    unsigned int slot = this->ready.front();
+    this->ready.pop_front();
+
+    /* the thread does not touch a slot that is in neither queue */
+    lock.unlock();
+    this->hand_over(this->x_slots[slot], x_batch);
+    this->hand_over(this->y_slots[slot], y_batch);
+    lock.lock();
+
+    this->free_slots.push_back(slot);
+    this->consumed++;
+    this->stats.n_batches++;
+    this->stats.mean_queue_depth = (double) this->queue_depth_sum / this->stats.n_batches;
+    this->cv.notify_all();
+}
+
+template <typename T>
+void PrefetchLoader<T>::reset() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    /* let the batch in flight land, then drop whatever was staged for the old epoch */
+    this->paused = true;
+    this->cv.wait(lock, [this] { return !this->busy; });
+
+    this->source->reset();
+    while (!this->ready.empty()) {
+        this->free_slots.push_back(this->ready.front());
+        this->ready.pop_front();
+    }
+    this->produced = 0;
+    this->consumed = 0;
+
+    this->paused = false;
+    this->cv.notify_all();
+}
+
+template <typename T>
+void PrefetchLoader<T>::set_batch_size(unsigned int size) {
+    /* the staging ring has the old batch shape */
+    this->stop();
+
+    this->source->set_batch_size(size);
+    this->source->reset();
+    this->batch_size = size;
+    this->num_batches = this->source->get_num_batches();
+    this->produced = 0;
+    this->consumed = 0;
+}
+
+template <typename T>
+unsigned int PrefetchLoader<T>::get_queue_depth() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->ready.size();
+}
+
+template <typename T>
+prefetch_stats_t PrefetchLoader<T>::get_stats() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->stats;
+}
+
+template <typename T>
+void PrefetchLoader<T>::reset_stats() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stats = {0, 0, 0.0, 0.0, 0};
+    this->queue_depth_sum = 0;
+}
+
+template class PrefetchLoader<int>;
+template class PrefetchLoader<float>;
+template class PrefetchLoader<double>;
+
+}  // namespace dataloader
+}  // namespace magmadnn
@@ -0,0 +1,172 @@
+/**
+ * @file shuffleloader.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "dataloader/shuffle/shuffleloader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include "magmadnn/parallel.h"
+
+#if defined(MAGMADNN_HAVE_CUDA)
+#include "magmadnn/utilities_internal.h"
+#endif
+
+namespace magmadnn {
+namespace dataloader {
+
+template <typename T>
+ShuffleLoader<T>::ShuffleLoader(Tensor<T> *x, Tensor<T> *y, unsigned int batch_size, bool drop_last)
+    : ShuffleLoader(x, y, batch_size, std::random_device()(), drop_last) {}
+
+template <typename T>
+ShuffleLoader<T>::ShuffleLoader(Tensor<T> *x, Tensor<T> *y, unsigned int batch_size, unsigned int seed,
+                                bool drop_last)
+    : DataLoader<T>::DataLoader(x, y, batch_size),
+      permutation(x->get_shape(0)),
+      curr_index(0),
+      last_batch_count(0),
+      drop_last(drop_last),
+      x_staging(NULL),
+      y_staging(NULL) {
+    this->count_batches();
+    this->set_seed(seed);
+}
+
+template <typename T>
+ShuffleLoader<T>::~ShuffleLoader() {
+    if (this->x_staging != NULL) delete this->x_staging;
+    if (this->y_staging != NULL) delete this->y_staging;
+}
+
+template <typename T>
+void ShuffleLoader<T>::count_batches() {
+    unsigned int n_samples = this->permutation.size();
+
+    this->num_batches = n_samples / this->batch_size;
+    if (!this->drop_last && n_samples % this->batch_size != 0) this->num_batches++;
+    assert(this->num_batches > 0);
+}
+
+template <typename T>
+void ShuffleLoader<T>::set_seed(unsigned int seed) {
+    this->generator.seed(seed);
+    std::iota(this->permutation.begin(), this->permutation.end(), 0u);
+    this->reset();
+}
+
+template <typename T>
+void ShuffleLoader<T>::reset() {
+    std::shuffle(this->permutation.begin(), this->permutation.end(), this->generator);
+    this->curr_index = 0;
+}
+
+template <typename T>
+void ShuffleLoader<T>::set_batch_size(unsigned int size) {
+    this->batch_size = size;
+    this->count_batches();
+    this->curr_index = 0;
+
+    /* the staging batches have the old shape */
+    if (this->x_staging != NULL) delete this->x_staging;
+    if (this->y_staging != NULL) delete this->y_staging;
+    this->x_staging = NULL;
+    this->y_staging = NULL;
+}
+
+template <typename T>
+void ShuffleLoader<T>::gather(Tensor<T> *src, unsigned int sample_size, Tensor<T> *dst, Tensor<T> *&staging) {
+    const std::vector<unsigned int> &rows = this->rows;
+    const std::size_t row_bytes = sample_size * sizeof(T);
+    unsigned int batch_elements = rows.size() * sample_size;
+    MemoryManager<T> *src_mem = src->get_memory_manager();
+    Tensor<T> *target = dst;
+    const T *src_host = NULL;
+
+    assert(dst->get_size() >= batch_elements);
+
+    switch (src->get_memory_type()) {
+        case HOST:
+            src_host = src_mem->get_host_ptr();
+            break;
+#if defined(MAGMADNN_HAVE_CUDA)
+        case MANAGED:
+            src_host = src_mem->get_host_ptr();
+            break;
+        case CUDA_MANAGED:
+            src_host = src_mem->get_cuda_managed_ptr();
+            break;
+        default:
+            break;
+#endif
+    }
+
+    /* the batch is built where the rows can be read from, and moved in one copy if dst is elsewhere */
+    memory_t build_mem = (src_host != NULL) ? HOST : src->get_memory_type();
+    if (dst->get_memory_type() != build_mem) {
+        if (staging == NULL || staging->get_shape() != dst->get_shape()) {
+            if (staging != NULL) delete staging;
+            staging = new Tensor<T>(dst->get_shape(), {NONE, {}}, build_mem);
+        }
+        target = staging;
+    }
+    T *out = target->get_ptr();
+
+    if (src_host != NULL) {
+        std::size_t grain = std::max((std::size_t) 1, ::magmadnn::internal::PARALLEL_GRAIN_SIZE / sample_size);
+
+        ::magmadnn::internal::parallel_for(rows.size(), grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                std::memcpy(out + i * sample_size, src_host + (std::size_t) rows[i] * sample_size, row_bytes);
+            }
+        });
+    }
+#if defined(MAGMADNN_HAVE_CUDA)
+    else {
+        const T *src_device = src->get_ptr();
+        cudaStream_t stream = target->get_memory_manager()->get_custream();
+
+        for (std::size_t i = 0; i < rows.size(); i++) {
+            cudaErrchk(cudaMemcpyAsync(out + i * sample_size, src_device + (std::size_t) rows[i] * sample_size,
+                                       row_bytes, cudaMemcpyDeviceToDevice, stream));
+        }
+        cudaErrchk(cudaStreamSynchronize(stream));
+    }
+#endif
+
+    if (target != dst) dst->copy_from(*target, 0, batch_elements);
+}
+
+template <typename T>
+void ShuffleLoader<T>::next(Tensor<T> *x_batch, Tensor<T> *y_batch) {
+    assert(this->curr_index < this->num_batches);
+
+    unsigned int n_samples = this->permutation.size();
+    unsigned int begin = this->curr_index * this->batch_size;
+    unsigned int count = std::min(this->batch_size, n_samples - begin);
+
+    this->rows.assign(this->permutation.begin() + begin, this->permutation.begin() + begin + count);
+
+    /* pad a partial batch with the start of the epoch */
+    for (unsigned int i = count; i < this->batch_size; i++) {
+        this->rows.push_back(this->permutation[(i - count) % n_samples]);
+    }
+
+    this->gather(this->x, this->sample_size_x, x_batch, this->x_staging);
+    this->gather(this->y, this->sample_size_y, y_batch, this->y_staging);
+
+    this->last_batch_count = count;
+    this->curr_index++;
+}
+
+template class ShuffleLoader<int>;
+template class ShuffleLoader<float>;
+template class ShuffleLoader<double>;
+
+}  // namespace dataloader
+}  // namespace magmadnn
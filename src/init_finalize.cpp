@@ -8,6 +8,9 @@
  */
 #include "magmadnn/init_finalize.h"
 
+#include "magmadnn/parallel.h"
+#include "memory/caching_allocator.h"
+
 #if defined(MAGMADNN_HAVE_CUDA)
 #include <cuda.h>
 #endif
@@ -15,18 +18,24 @@
 namespace magmadnn {
 
 namespace internal {
-magmadnn_settings_t *MAGMADNN_SETTINGS;
+magmadnn_settings_t *MAGMADNN_SETTINGS = NULL;
 }  // namespace internal
 
-magmadnn_error_t magmadnn_init() {
+magmadnn_error_t magmadnn_init(int n_threads) {
     magmadnn_error_t err = 0;
 
     /* init the settings struct */
     internal::MAGMADNN_SETTINGS = new magmadnn_settings_t;
 
+    /* intra-op parallelism of the HOST kernels */
+    magmadnn_set_num_threads(n_threads);
+
     int rank = 0;
 #if defined(MAGMADNN_HAVE_MPI)
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    /* programs that do not use MPI do not initialize it */
+    int mpi_initialized = 0;
+    MPI_Initialized(&mpi_initialized);
+    if (mpi_initialized) MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 #endif
 
 #if defined(MAGMADNN_HAVE_CUDA)
@@ -57,6 +66,9 @@ magmadnn_error_t magmadnn_init() {
 magmadnn_error_t magmadnn_finalize() {
     magmadnn_error_t err = 0;
 
+    /* give the cached blocks back while the CUDA context is still up */
+    memory::trim_allocator_cache();
+
 #if defined(MAGMADNN_HAVE_CUDA)
     err = (magmadnn_error_t) magma_finalize();
 
@@ -69,6 +81,7 @@ magmadnn_error_t magmadnn_finalize() {
 
     /* delete settings */
     delete internal::MAGMADNN_SETTINGS;
+    internal::MAGMADNN_SETTINGS = NULL;
 
     return err;
 }
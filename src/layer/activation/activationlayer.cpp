@@ -12,8 +12,8 @@ namespace magmadnn {
 namespace layer {
 
 template <typename T>
-ActivationLayer<T>::ActivationLayer(op::Operation<T>* input, activation_t activation_func)
-    : Layer<T>::Layer(input->get_output_shape(), input), activation_func(activation_func) {
+ActivationLayer<T>::ActivationLayer(op::Operation<T>* input, activation_t activation_func, bool fuse)
+    : Layer<T>::Layer(input->get_output_shape(), input), activation_func(activation_func), fuse(fuse) {
     init();
 }
 
@@ -29,6 +29,20 @@ template <typename T>
 void ActivationLayer<T>::init() {
     this->name = "Activation";
 
+    /* a fully connected layer feeding only this activation is rewritten into one fused operation */
+    op::LinearForwardOp<T>* linear = this->fuse ? dynamic_cast<op::LinearForwardOp<T>*>(this->input) : NULL;
+    if (linear != NULL && this->activation_func != SOFTMAX) {
+        math::fused_activation_t fused_activation = math::FUSED_SIGMOID;
+        if (this->activation_func == TANH) fused_activation = math::FUSED_TANH;
+        if (this->activation_func == RELU) fused_activation = math::FUSED_RELU;
+
+        op::Operation<T>* fused = op::fuse_dense_activation(linear, fused_activation);
+        if (fused != NULL) {
+            this->output = fused;
+            return;
+        }
+    }
+
     switch (this->activation_func) {
         case SIGMOID:
             this->output = op::sigmoid(this->input);
@@ -53,12 +67,12 @@ template class ActivationLayer<float>;
 template class ActivationLayer<double>;
 
 template <typename T>
-ActivationLayer<T>* activation(op::Operation<T>* input, activation_t activation_func) {
-    return new ActivationLayer<T>(input, activation_func);
+ActivationLayer<T>* activation(op::Operation<T>* input, activation_t activation_func, bool fuse) {
+    return new ActivationLayer<T>(input, activation_func, fuse);
 }
-template ActivationLayer<int>* activation(op::Operation<int>*, activation_t);
-template ActivationLayer<float>* activation(op::Operation<float>*, activation_t);
-template ActivationLayer<double>* activation(op::Operation<double>*, activation_t);
+template ActivationLayer<int>* activation(op::Operation<int>*, activation_t, bool);
+template ActivationLayer<float>* activation(op::Operation<float>*, activation_t, bool);
+template ActivationLayer<double>* activation(op::Operation<double>*, activation_t, bool);
 
 }  // namespace layer
 }  // namespace magmadnn
\ No newline at end of file
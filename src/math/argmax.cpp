@@ -11,6 +11,8 @@
 
 #include "math/argmax.h"
 
+#include "magmadnn/parallel.h"
+
 namespace magmadnn {
 namespace math {
 
@@ -35,27 +37,34 @@ void argmax(Tensor<T> *x, int axis, Tensor<T> *out) {
             return;
         } else if (x_n_axes == 2) {
             /* ARG_MAX OF EACH ROW */
+            unsigned int n_outputs = x_shape[(axis == 0) ? 0 : 1];
+            unsigned int n_reduce = x_shape[(axis == 0) ? 1 : 0];
 
-            for (unsigned int i = 0; i < x_shape[(axis == 0) ? 0 : 1]; i++) {
-                if (axis == 0)
-                    max = x_ptr[i * x_shape[1]]; /* first element of row i */
-                else
-                    max = x_ptr[i]; /* first element of column i */
-
-                arg_max = static_cast<T>(0);
-                for (unsigned int j = 1; j < x_shape[(axis == 0) ? 1 : 0]; j++) {
+            auto argmax_rows = [&](std::size_t begin, std::size_t end) {
+                for (unsigned int i = begin; i < end; i++) {
+                    T row_max, row_val, row_arg_max;
                     if (axis == 0)
-                        val = x_ptr[i * x_shape[1] + j];  // x[i,j]
+                        row_max = x_ptr[i * x_shape[1]]; /* first element of row i */
                     else
-                        val = x_ptr[j * x_shape[1] + i];  // x[j,i]
+                        row_max = x_ptr[i]; /* first element of column i */
 
-                    if (val > max) {
-                        arg_max = (T) j;
-                        max = val;
+                    row_arg_max = static_cast<T>(0);
+                    for (unsigned int j = 1; j < n_reduce; j++) {
+                        if (axis == 0)
+                            row_val = x_ptr[i * x_shape[1] + j];  // x[i,j]
+                        else
+                            row_val = x_ptr[j * x_shape[1] + i];  // x[j,i]
+
+                        if (row_val > row_max) {
+                            row_arg_max = (T) j;
+                            row_max = row_val;
+                        }
                     }
+                    out_ptr[i] = row_arg_max;
                 }
-                out_ptr[i] = arg_max;
-            }
+            };
+            ::magmadnn::internal::parallel_for(n_outputs, ::magmadnn::internal::PARALLEL_GRAIN_SIZE / n_reduce + 1,
+                                               argmax_rows);
         } else {
             max = x_ptr[0];
             arg_max = (T) 0;
@@ -9,21 +9,217 @@
  */
 #include "math/batchnorm.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <vector>
 
-#if defined(MAGMADNN_CMAKE_BUILD)
-#include "magmadnn/config.h"
-#endif
+#include "magmadnn/parallel.h"
 
 namespace magmadnn {
 namespace math {
 
+namespace {
+
+/* x is viewed as [outer, channels, inner]; statistics of a channel are taken over outer*inner elements */
+struct batchnorm_layout {
+    unsigned int outer, channels, inner;
+};
+
+batchnorm_layout get_layout(const std::vector<unsigned int> &shape, batchnorm_cpu_mode_t mode) {
+    batchnorm_layout l;
+    assert(shape.size() >= 2);
+
+    l.outer = shape[0];
+    l.channels = 1;
+    l.inner = 1;
+    if (mode == BATCHNORM_CPU_SPATIAL) {
+        l.channels = shape[1];
+        for (unsigned int i = 2; i < shape.size(); i++) l.inner *= shape[i];
+    } else {
+        for (unsigned int i = 1; i < shape.size(); i++) l.channels *= shape[i];
+    }
+    return l;
+}
+
+/* Channels processed by one task. In per-activation mode neighbouring features share cache lines, so they are
+ * swept together row by row instead of one strided column at a time. */
+const unsigned int BATCHNORM_CPU_MAX_CHANNEL_BLOCK = 64;
+
+inline unsigned int channel_block(const batchnorm_layout &l) {
+    return (l.inner == 1) ? BATCHNORM_CPU_MAX_CHANNEL_BLOCK : 1;
+}
+
+template <typename T>
+void batchnorm_cpu(const T *x, T *y, const T *scale, const T *bias, T *running_mean, T *running_variance,
+                   T *saved_mean, T *saved_inv_std, double exp_avg_factor, double epsilon,
+                   const batchnorm_layout &l) {
+    const unsigned int block = channel_block(l);
+    const unsigned int n_blocks = (l.channels + block - 1) / block;
+    const double m = (double) l.outer * l.inner;
+
+    auto normalize_blocks = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end; b++) {
+            const unsigned int c0 = b * block;
+            const unsigned int c1 = std::min(c0 + block, l.channels);
+            double shift[BATCHNORM_CPU_MAX_CHANNEL_BLOCK], sum[BATCHNORM_CPU_MAX_CHANNEL_BLOCK],
+                sum_sq[BATCHNORM_CPU_MAX_CHANNEL_BLOCK];
+            T a[BATCHNORM_CPU_MAX_CHANNEL_BLOCK], shift_out[BATCHNORM_CPU_MAX_CHANNEL_BLOCK];
+
+            /* single pass: sums of x - x[0,c] accumulated in double, the shift keeps sum_sq - sum^2 well conditioned */
+            for (unsigned int c = c0; c < c1; c++) {
+                shift[c - c0] = (double) x[(size_t) c * l.inner];
+                sum[c - c0] = 0.0;
+                sum_sq[c - c0] = 0.0;
+            }
+            for (unsigned int n = 0; n < l.outer; n++) {
+                for (unsigned int c = c0; c < c1; c++) {
+                    const T *x_nc = x + ((size_t) n * l.channels + c) * l.inner;
+                    const double k = shift[c - c0];
+                    double s1 = 0.0, s2 = 0.0;
+                    for (unsigned int i = 0; i < l.inner; i++) {
+                        double d = (double) x_nc[i] - k;
+                        s1 += d;
+                        s2 += d * d;
+                    }
+                    sum[c - c0] += s1;
+                    sum_sq[c - c0] += s2;
+                }
+            }
+
+            for (unsigned int c = c0; c < c1; c++) {
+                double mean_shifted = sum[c - c0] / m;
+                double variance = std::max(sum_sq[c - c0] / m - mean_shifted * mean_shifted, 0.0);
+                double mean = shift[c - c0] + mean_shifted;
+                double inv_std = 1.0 / std::sqrt(variance + epsilon);
+                double unbiased_variance = (m > 1.0) ? variance * m / (m - 1.0) : variance;
+
+                saved_mean[c] = (T) mean;
+                saved_inv_std[c] = (T) inv_std;
+                running_mean[c] = (T)((1.0 - exp_avg_factor) * running_mean[c] + exp_avg_factor * mean);
+                running_variance[c] =
+                    (T)((1.0 - exp_avg_factor) * running_variance[c] + exp_avg_factor * unbiased_variance);
+
+                a[c - c0] = (T)(scale[c] * inv_std);
+                shift_out[c - c0] = (T)(bias[c] - scale[c] * inv_std * mean);
+            }
+
+            for (unsigned int n = 0; n < l.outer; n++) {
+                for (unsigned int c = c0; c < c1; c++) {
+                    const size_t offset = ((size_t) n * l.channels + c) * l.inner;
+                    const T a_c = a[c - c0], b_c = shift_out[c - c0];
+                    for (unsigned int i = 0; i < l.inner; i++) y[offset + i] = a_c * x[offset + i] + b_c;
+                }
+            }
+        }
+    };
+    /* a block is one iteration; at least PARALLEL_GRAIN_SIZE elements per thread */
+    const std::size_t block_size = (std::size_t) block * l.outer * l.inner;
+    const std::size_t grain = ::magmadnn::internal::PARALLEL_GRAIN_SIZE / (block_size + 1) + 1;
+    ::magmadnn::internal::parallel_for(n_blocks, grain, normalize_blocks);
+}
+
+template <typename T>
+void batchnorm_inference_cpu(const T *x, T *y, const T *scale, const T *bias, const T *running_mean,
+                             const T *running_variance, double epsilon, const batchnorm_layout &l) {
+    std::vector<T> a(l.channels), b(l.channels);
+
+    for (unsigned int c = 0; c < l.channels; c++) {
+        double a_c = scale[c] / std::sqrt((double) running_variance[c] + epsilon);
+        a[c] = (T) a_c;
+        b[c] = (T)(bias[c] - a_c * running_mean[c]);
+    }
+
+    const unsigned int n_rows = l.outer;
+    auto normalize_rows = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t n = begin; n < end; n++) {
+            for (unsigned int c = 0; c < l.channels; c++) {
+                const size_t offset = ((size_t) n * l.channels + c) * l.inner;
+                const T a_c = a[c], b_c = b[c];
+                for (unsigned int i = 0; i < l.inner; i++) y[offset + i] = a_c * x[offset + i] + b_c;
+            }
+        }
+    };
+    const std::size_t row_size = (std::size_t) l.channels * l.inner;
+    const std::size_t grain = ::magmadnn::internal::PARALLEL_GRAIN_SIZE / (row_size + 1) + 1;
+    ::magmadnn::internal::parallel_for(n_rows, grain, normalize_rows);
+}
+
 template <typename T>
-void batchnorm(Tensor<T> *x, Tensor<T> *out) {
+void batchnorm_grad_cpu(const T *x, const T *dy, T *dx, const T *scale, T *scale_diff, T *bias_diff,
+                        const T *saved_mean, const T *saved_inv_std, const batchnorm_layout &l) {
+    const unsigned int block = channel_block(l);
+    const unsigned int n_blocks = (l.channels + block - 1) / block;
+    const double m = (double) l.outer * l.inner;
+
+    auto grad_blocks = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end; b++) {
+            const unsigned int c0 = b * block;
+            const unsigned int c1 = std::min(c0 + block, l.channels);
+            double sum_dy[BATCHNORM_CPU_MAX_CHANNEL_BLOCK], sum_dy_xhat[BATCHNORM_CPU_MAX_CHANNEL_BLOCK];
+
+            /* dbias = sum(dy) and dscale = sum(dy * xhat) in one pass */
+            for (unsigned int c = c0; c < c1; c++) {
+                sum_dy[c - c0] = 0.0;
+                sum_dy_xhat[c - c0] = 0.0;
+            }
+            for (unsigned int n = 0; n < l.outer; n++) {
+                for (unsigned int c = c0; c < c1; c++) {
+                    const size_t offset = ((size_t) n * l.channels + c) * l.inner;
+                    const double mean = saved_mean[c];
+                    double s1 = 0.0, s2 = 0.0;
+                    for (unsigned int i = 0; i < l.inner; i++) {
+                        s1 += (double) dy[offset + i];
+                        s2 += (double) dy[offset + i] * ((double) x[offset + i] - mean);
+                    }
+                    sum_dy[c - c0] += s1;
+                    sum_dy_xhat[c - c0] += s2 * saved_inv_std[c];
+                }
+            }
+
+            for (unsigned int c = c0; c < c1; c++) {
+                bias_diff[c] = (T) sum_dy[c - c0];
+                scale_diff[c] = (T) sum_dy_xhat[c - c0];
+            }
+
+            /* dx = scale * inv_std * (dy - mean(dy) - xhat * mean(dy * xhat)) */
+            for (unsigned int n = 0; n < l.outer; n++) {
+                for (unsigned int c = c0; c < c1; c++) {
+                    const size_t offset = ((size_t) n * l.channels + c) * l.inner;
+                    const double inv_std = saved_inv_std[c];
+                    const double mean = saved_mean[c];
+                    const double k = scale[c] * inv_std;
+                    const double mean_dy = sum_dy[c - c0] / m;
+                    const double mean_dy_xhat = sum_dy_xhat[c - c0] / m;
+                    for (unsigned int i = 0; i < l.inner; i++) {
+                        double xhat = ((double) x[offset + i] - mean) * inv_std;
+                        dx[offset + i] = (T)(k * ((double) dy[offset + i] - mean_dy - xhat * mean_dy_xhat));
+                    }
+                }
+            }
+        }
+    };
+    const std::size_t block_size = (std::size_t) block * l.outer * l.inner;
+    const std::size_t grain = ::magmadnn::internal::PARALLEL_GRAIN_SIZE / (block_size + 1) + 1;
+    ::magmadnn::internal::parallel_for(n_blocks, grain, grad_blocks);
+}
+
+}  // namespace
+
+template <typename T>
+void batchnorm(Tensor<T> *x, Tensor<T> *out, Tensor<T> *bn_scale, Tensor<T> *bn_bias, Tensor<T> *running_mean,
+               Tensor<T> *running_variance, Tensor<T> *saved_mean, Tensor<T> *saved_variance, unsigned int &num_calls,
+               batchnorm_cpu_settings settings) {
     assert(T_IS_SAME_MEMORY_TYPE(x, out));
 
     if (out->get_memory_type() == HOST) {
-        fprintf(stderr, "batchnorm CPU not supported yet.\n");
+        batchnorm_layout l = get_layout(x->get_shape(), settings.mode);
+        assert(bn_scale->get_size() == l.channels);
+
+        num_calls++;
+        batchnorm_cpu(x->get_ptr(), out->get_ptr(), bn_scale->get_ptr(), bn_bias->get_ptr(), running_mean->get_ptr(),
+                      running_variance->get_ptr(), saved_mean->get_ptr(), saved_variance->get_ptr(),
+                      ((double) (1) / (double) (1 + num_calls)), settings.epsilon, l);
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -31,16 +227,56 @@ void batchnorm(Tensor<T> *x, Tensor<T> *out) {
     }
 #endif
 }
-template void batchnorm(Tensor<int> *x, Tensor<int> *out);
-template void batchnorm(Tensor<float> *x, Tensor<float> *out);
-template void batchnorm(Tensor<double> *x, Tensor<double> *out);
+template void batchnorm(Tensor<int> *x, Tensor<int> *out, Tensor<int> *bn_scale, Tensor<int> *bn_bias,
+                        Tensor<int> *running_mean, Tensor<int> *running_variance, Tensor<int> *saved_mean,
+                        Tensor<int> *saved_variance, unsigned int &num_calls, batchnorm_cpu_settings settings);
+template void batchnorm(Tensor<float> *x, Tensor<float> *out, Tensor<float> *bn_scale, Tensor<float> *bn_bias,
+                        Tensor<float> *running_mean, Tensor<float> *running_variance, Tensor<float> *saved_mean,
+                        Tensor<float> *saved_variance, unsigned int &num_calls, batchnorm_cpu_settings settings);
+template void batchnorm(Tensor<double> *x, Tensor<double> *out, Tensor<double> *bn_scale, Tensor<double> *bn_bias,
+                        Tensor<double> *running_mean, Tensor<double> *running_variance, Tensor<double> *saved_mean,
+                        Tensor<double> *saved_variance, unsigned int &num_calls, batchnorm_cpu_settings settings);
 
 template <typename T>
-void batchnorm_grad(Tensor<T> *grad, Tensor<T> *out) {
+void batchnorm_inference(Tensor<T> *x, Tensor<T> *out, Tensor<T> *bn_scale, Tensor<T> *bn_bias,
+                         Tensor<T> *running_mean, Tensor<T> *running_variance, batchnorm_cpu_settings settings) {
+    assert(T_IS_SAME_MEMORY_TYPE(x, out));
+
+    if (out->get_memory_type() == HOST) {
+        batchnorm_layout l = get_layout(x->get_shape(), settings.mode);
+        assert(bn_scale->get_size() == l.channels);
+
+        batchnorm_inference_cpu(x->get_ptr(), out->get_ptr(), bn_scale->get_ptr(), bn_bias->get_ptr(),
+                                running_mean->get_ptr(), running_variance->get_ptr(), settings.epsilon, l);
+    }
+#if defined(MAGMADNN_HAVE_CUDA)
+    else {
+        fprintf(stderr, "For batchnorm on GPU, please use batchnorm_inference_device\n");
+    }
+#endif
+}
+template void batchnorm_inference(Tensor<int> *x, Tensor<int> *out, Tensor<int> *bn_scale, Tensor<int> *bn_bias,
+                                  Tensor<int> *running_mean, Tensor<int> *running_variance,
+                                  batchnorm_cpu_settings settings);
+template void batchnorm_inference(Tensor<float> *x, Tensor<float> *out, Tensor<float> *bn_scale,
+                                  Tensor<float> *bn_bias, Tensor<float> *running_mean,
+                                  Tensor<float> *running_variance, batchnorm_cpu_settings settings);
+template void batchnorm_inference(Tensor<double> *x, Tensor<double> *out, Tensor<double> *bn_scale,
+                                  Tensor<double> *bn_bias, Tensor<double> *running_mean,
+                                  Tensor<double> *running_variance, batchnorm_cpu_settings settings);
+
+template <typename T>
+void batchnorm_grad(Tensor<T> *x, Tensor<T> *grad, Tensor<T> *out, Tensor<T> *bn_scale, Tensor<T> *bn_scale_diff,
+                    Tensor<T> *bn_bias_diff, Tensor<T> *saved_mean, Tensor<T> *saved_variance,
+                    batchnorm_cpu_settings settings) {
     assert(T_IS_SAME_MEMORY_TYPE(grad, out));
 
     if (out->get_memory_type() == HOST) {
-        fprintf(stderr, "batchnorm grad CPU not supported yet.\n");
+        batchnorm_layout l = get_layout(x->get_shape(), settings.mode);
+
+        batchnorm_grad_cpu(x->get_ptr(), grad->get_ptr(), out->get_ptr(), bn_scale->get_ptr(),
+                           bn_scale_diff->get_ptr(), bn_bias_diff->get_ptr(), saved_mean->get_ptr(),
+                           saved_variance->get_ptr(), l);
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -48,9 +284,15 @@ void batchnorm_grad(Tensor<T> *grad, Tensor<T> *out) {
     }
 #endif
 }
-template void batchnorm_grad(Tensor<int> *grad, Tensor<int> *out);
-template void batchnorm_grad(Tensor<float> *grad, Tensor<float> *out);
-template void batchnorm_grad(Tensor<double> *grad, Tensor<double> *out);
+template void batchnorm_grad(Tensor<int> *x, Tensor<int> *grad, Tensor<int> *out, Tensor<int> *bn_scale,
+                             Tensor<int> *bn_scale_diff, Tensor<int> *bn_bias_diff, Tensor<int> *saved_mean,
+                             Tensor<int> *saved_variance, batchnorm_cpu_settings settings);
+template void batchnorm_grad(Tensor<float> *x, Tensor<float> *grad, Tensor<float> *out, Tensor<float> *bn_scale,
+                             Tensor<float> *bn_scale_diff, Tensor<float> *bn_bias_diff, Tensor<float> *saved_mean,
+                             Tensor<float> *saved_variance, batchnorm_cpu_settings settings);
+template void batchnorm_grad(Tensor<double> *x, Tensor<double> *grad, Tensor<double> *out, Tensor<double> *bn_scale,
+                             Tensor<double> *bn_scale_diff, Tensor<double> *bn_bias_diff, Tensor<double> *saved_mean,
+                             Tensor<double> *saved_variance, batchnorm_cpu_settings settings);
 
 #if defined(MAGMADNN_HAVE_CUDA)
 template <typename T>
@@ -80,6 +322,28 @@ template void batchnorm_device(Tensor<double> *x, Tensor<double> *out, Tensor<do
                                Tensor<double> *saved_mean, Tensor<double> *saved_variance, unsigned int &num_calls,
                                cudnn_batchnorm_settings_t settings);
 
+template <typename T>
+void batchnorm_inference_device(Tensor<T> *x, Tensor<T> *out, Tensor<T> *bn_scale, Tensor<T> *bn_bias,
+                                Tensor<T> *running_mean, Tensor<T> *running_variance,
+                                cudnn_batchnorm_settings_t settings) {
+    T alpha = static_cast<T>(1), beta = static_cast<T>(0);
+    double epsilon = 1E-8;
+
+    cudnnErrchk(cudnnBatchNormalizationForwardInference(
+        settings.handle, settings.mode, &alpha, &beta, x->get_cudnn_tensor_descriptor(), x->get_ptr(),
+        out->get_cudnn_tensor_descriptor(), out->get_ptr(), settings.bn_tensor_desc, bn_scale->get_ptr(),
+        bn_bias->get_ptr(), running_mean->get_ptr(), running_variance->get_ptr(), epsilon));
+}
+template void batchnorm_inference_device(Tensor<int> *x, Tensor<int> *out, Tensor<int> *bn_scale,
+                                         Tensor<int> *bn_bias, Tensor<int> *running_mean,
+                                         Tensor<int> *running_variance, cudnn_batchnorm_settings_t settings);
+template void batchnorm_inference_device(Tensor<float> *x, Tensor<float> *out, Tensor<float> *bn_scale,
+                                         Tensor<float> *bn_bias, Tensor<float> *running_mean,
+                                         Tensor<float> *running_variance, cudnn_batchnorm_settings_t settings);
+template void batchnorm_inference_device(Tensor<double> *x, Tensor<double> *out, Tensor<double> *bn_scale,
+                                         Tensor<double> *bn_bias, Tensor<double> *running_mean,
+                                         Tensor<double> *running_variance, cudnn_batchnorm_settings_t settings);
+
 template <typename T>
 void batchnorm_grad_device(Tensor<T> *x, Tensor<T> *grad, Tensor<T> *out, Tensor<T> *bn_scale, Tensor<T> *bn_scale_diff,
                            Tensor<T> *bn_bias_diff, Tensor<T> *saved_mean, Tensor<T> *saved_variance,
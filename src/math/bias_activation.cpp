@@ -0,0 +1,122 @@
+/**
+ * @file bias_activation.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "math/bias_activation.h"
+
+#include <cassert>
+
+#include "magmadnn/parallel.h"
+#include "math/elementwise.h"
+
+namespace magmadnn {
+namespace math {
+
+namespace {
+
+/* out[r][c] = f(x[r][c] + bias[r]), parallel across rows */
+template <typename T, typename F>
+void bias_activation_rows(const T *x, const T *bias, T *out, unsigned int rows, unsigned int cols, F f) {
+    ::magmadnn::internal::parallel_for(
+        rows, ::magmadnn::internal::PARALLEL_GRAIN_SIZE / cols + 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t r = begin; r < end; r++) {
+                const T b = (bias != NULL) ? bias[r] : static_cast<T>(0);
+                elementwise_unary(cols, x + r * cols, out + r * cols, [b, f](T v) { return f(v + b); });
+            }
+        });
+}
+
+/* out[i] = f(y[i], grad[i]), parallel across elements. A grad of size 1 is broadcast. */
+template <typename T, typename F>
+void activation_grad_elements(unsigned int size, const T *y, const T *grad, unsigned int grad_size, T *out, F f) {
+    ::magmadnn::internal::parallel_for(
+        size, ::magmadnn::internal::PARALLEL_GRAIN_SIZE, [&](std::size_t begin, std::size_t end) {
+            if (grad_size == 1) {
+                const T g = grad[0];
+                elementwise_unary(end - begin, y + begin, out + begin, [g, f](T v) { return f(v, g); });
+            } else {
+                elementwise_binary(end - begin, y + begin, grad + begin, out + begin, f);
+            }
+        });
+}
+
+template <typename T>
+struct identity_functor {
+    T operator()(T x) const { return x; }
+};
+
+}  // namespace
+
+template <typename T>
+void bias_activation_cpu(Tensor<T> *x, Tensor<T> *bias, fused_activation_t activation, Tensor<T> *out) {
+    assert(x->get_shape().size() == 2 && x->get_size() == out->get_size());
+    assert(bias == NULL || bias->get_size() == x->get_shape(0));
+
+    const T *x_ptr = x->get_ptr();
+    const T *bias_ptr = (bias != NULL) ? bias->get_ptr() : NULL;
+    T *out_ptr = out->get_ptr();
+    unsigned int rows = x->get_shape(0);
+    unsigned int cols = x->get_shape(1);
+
+    switch (activation) {
+        case FUSED_RELU:
+            bias_activation_rows(x_ptr, bias_ptr, out_ptr, rows, cols, relu_functor<T>());
+            break;
+        case FUSED_SIGMOID:
+            bias_activation_rows(x_ptr, bias_ptr, out_ptr, rows, cols, sigmoid_functor<T>());
+            break;
+        case FUSED_TANH:
+            bias_activation_rows(x_ptr, bias_ptr, out_ptr, rows, cols, tanh_functor<T>());
+            break;
+        default:
+            bias_activation_rows(x_ptr, bias_ptr, out_ptr, rows, cols, identity_functor<T>());
+            break;
+    }
+}
+template void bias_activation_cpu(Tensor<int> *x, Tensor<int> *bias, fused_activation_t activation,
+                                  Tensor<int> *out);
+template void bias_activation_cpu(Tensor<float> *x, Tensor<float> *bias, fused_activation_t activation,
+                                  Tensor<float> *out);
+template void bias_activation_cpu(Tensor<double> *x, Tensor<double> *bias, fused_activation_t activation,
+                                  Tensor<double> *out);
+
+template <typename T>
+void activation_grad_cpu(Tensor<T> *y, Tensor<T> *grad, fused_activation_t activation, Tensor<T> *out) {
+    assert((grad->get_size() == 1 || y->get_size() == grad->get_size()) && y->get_size() == out->get_size());
+
+    const T *y_ptr = y->get_ptr();
+    const T *grad_ptr = grad->get_ptr();
+    T *out_ptr = out->get_ptr();
+    unsigned int size = out->get_size();
+    unsigned int grad_size = grad->get_size();
+
+    switch (activation) {
+        case FUSED_RELU:
+            /* y > 0 exactly where the input was */
+            activation_grad_elements(size, y_ptr, grad_ptr, grad_size, out_ptr, relu_grad_functor<T>());
+            break;
+        case FUSED_SIGMOID:
+            activation_grad_elements(size, y_ptr, grad_ptr, grad_size, out_ptr,
+                                     [](T s, T g) { return g * s * (((T) 1) - s); });
+            break;
+        case FUSED_TANH:
+            activation_grad_elements(size, y_ptr, grad_ptr, grad_size, out_ptr,
+                                     [](T t, T g) { return g * (((T) 1) - t * t); });
+            break;
+        default:
+            activation_grad_elements(size, y_ptr, grad_ptr, grad_size, out_ptr, [](T, T g) { return g; });
+            break;
+    }
+}
+template void activation_grad_cpu(Tensor<int> *y, Tensor<int> *grad, fused_activation_t activation,
+                                  Tensor<int> *out);
+template void activation_grad_cpu(Tensor<float> *y, Tensor<float> *grad, fused_activation_t activation,
+                                  Tensor<float> *out);
+template void activation_grad_cpu(Tensor<double> *y, Tensor<double> *grad, fused_activation_t activation,
+                                  Tensor<double> *out);
+
+}  // namespace math
+}  // namespace magmadnn
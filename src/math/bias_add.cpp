@@ -15,6 +15,8 @@
 
 #include <cassert>
 
+#include "magmadnn/parallel.h"
+
 namespace magmadnn {
 namespace math {
 
@@ -28,11 +30,14 @@ void bias_add_cpu(Tensor<T> *x, Tensor<T> *bias, Tensor<T> *out) {
     unsigned int x_cols = x->get_shape(1);
     // unsigned int x_size = x_rows*x_cols;
 
-    for (unsigned int r = 0; r < x_rows; r++) {
-        for (unsigned int c = 0; c < x_cols; c++) {
-            out_ptr[r * x_cols + c] = x_ptr[r * x_cols + c] + bias_ptr[r];
-        }
-    }
+    ::magmadnn::internal::parallel_for(
+        x_rows, ::magmadnn::internal::PARALLEL_GRAIN_SIZE / x_cols + 1, [&](std::size_t begin, std::size_t end) {
+            for (unsigned int r = begin; r < end; r++) {
+                for (unsigned int c = 0; c < x_cols; c++) {
+                    out_ptr[r * x_cols + c] = x_ptr[r * x_cols + c] + bias_ptr[r];
+                }
+            }
+        });
 }
 template void bias_add_cpu(Tensor<int> *x, Tensor<int> *bias, Tensor<int> *out);
 template void bias_add_cpu(Tensor<float> *x, Tensor<float> *bias, Tensor<float> *out);
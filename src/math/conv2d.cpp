@@ -9,17 +9,387 @@
  */
 #include "math/conv2d.h"
 
+#include <algorithm>
 #include <cassert>
 
+#include "magmadnn/exception_helpers.h"
+#include "math/wrappers.h"
+
 namespace magmadnn {
 namespace math {
 
+/* Upper bound on the number of elements of the im2col block, the block is kept small enough to stay in the
+   last level cache while still giving GEMM a large enough N dimension. */
+static const size_t CONV2D_CPU_IM2COL_BLOCK_ELEMS = 1 << 20;
+
+/* Channel count below which the direct 3x3 kernel beats im2col + GEMM (K = 9 * channels is too small for GEMM). */
+static const unsigned int CONV2D_CPU_DIRECT_3X3_MAX_CHANNELS = 8;
+
 template <typename T>
-void conv2d(Tensor<T> *x, Tensor<T> *w, Tensor<T> *out) {
+void conv2d_cpu_init_settings(const std::vector<unsigned int> &x_shape, const std::vector<unsigned int> &w_shape,
+                              const std::vector<unsigned int> &out_shape, conv2d_cpu_settings &settings) {
+    assert(x_shape.size() == 4 && w_shape.size() == 4 && out_shape.size() == 4);
+
+    unsigned int channels = x_shape[1];
+    unsigned int kh = w_shape[2], kw = w_shape[3];
+    unsigned int oh = out_shape[2], ow = out_shape[3];
+    bool unit_stride = (settings.vertical_stride == 1) && (settings.horizontal_stride == 1);
+    bool no_dilation = (settings.dilation_h == 1) && (settings.dilation_w == 1);
+
+    if (kh == 1 && kw == 1 && unit_stride && settings.pad_h == 0 && settings.pad_w == 0) {
+        settings.algo = CONV2D_CPU_ALGO_GEMM_1X1;
+    } else if (kh == 3 && kw == 3 && unit_stride && no_dilation && channels < CONV2D_CPU_DIRECT_3X3_MAX_CHANNELS) {
+        settings.algo = CONV2D_CPU_ALGO_DIRECT_3X3;
+    } else {
+        settings.algo = CONV2D_CPU_ALGO_IM2COL_GEMM;
+    }
+
+    settings.block_rows = 0;
+    settings.workspace_size = 0;
+    if (settings.algo == CONV2D_CPU_ALGO_IM2COL_GEMM) {
+        size_t col_rows = (size_t) channels * kh * kw;
+        size_t block_rows = CONV2D_CPU_IM2COL_BLOCK_ELEMS / (col_rows * ow);
+        if (block_rows < 1) block_rows = 1;
+        if (block_rows > oh) block_rows = oh;
+
+        settings.block_rows = (int) block_rows;
+        settings.workspace_size = col_rows * block_rows * ow * sizeof(T);
+    }
+}
+template void conv2d_cpu_init_settings<int>(const std::vector<unsigned int> &, const std::vector<unsigned int> &,
+                                            const std::vector<unsigned int> &, conv2d_cpu_settings &);
+template void conv2d_cpu_init_settings<float>(const std::vector<unsigned int> &, const std::vector<unsigned int> &,
+                                              const std::vector<unsigned int> &, conv2d_cpu_settings &);
+template void conv2d_cpu_init_settings<double>(const std::vector<unsigned int> &, const std::vector<unsigned int> &,
+                                               const std::vector<unsigned int> &, conv2d_cpu_settings &);
+
+namespace {
+
+/* Geometry of one convolution, gathered once from the tensor shapes. */
+struct conv2d_geometry {
+    int batch, channels, height, width;
+    int out_channels, kh, kw;
+    int oh, ow;
+};
+
+template <typename T>
+conv2d_geometry get_geometry(Tensor<T> *x, Tensor<T> *w, Tensor<T> *y) {
+    conv2d_geometry g;
+    g.batch = x->get_shape(0);
+    g.channels = x->get_shape(1);
+    g.height = x->get_shape(2);
+    g.width = x->get_shape(3);
+    g.out_channels = w->get_shape(0);
+    g.kh = w->get_shape(2);
+    g.kw = w->get_shape(3);
+    g.oh = y->get_shape(2);
+    g.ow = y->get_shape(3);
+    return g;
+}
+
+/* Range [lo, hi) of output columns whose input column ox * stride - pad + offset falls inside [0, width). */
+inline void valid_range(int ow, int width, int stride, int pad, int offset, int &lo, int &hi) {
+    lo = 0;
+    while (lo < ow && lo * stride - pad + offset < 0) lo++;
+    hi = ow;
+    while (hi > lo && (hi - 1) * stride - pad + offset >= width) hi--;
+}
+
+/* Unfolds output rows [oy0, oy0 + nrows) of image x (CHW) into col, a (C*kh*kw) x (nrows*ow) row-major matrix. */
+template <typename T>
+void im2col_block(const T *x, const conv2d_geometry &g, const conv2d_cpu_settings &s, int oy0, int nrows, T *col) {
+    const int ncols = nrows * g.ow;
+
+    for (int c = 0; c < g.channels; c++) {
+        for (int ky = 0; ky < g.kh; ky++) {
+            for (int kx = 0; kx < g.kw; kx++) {
+                T *col_row = col + ((c * g.kh + ky) * g.kw + kx) * ncols;
+                int ty = (s.use_cross_correlation) ? ky : g.kh - 1 - ky;
+                int tx = (s.use_cross_correlation) ? kx : g.kw - 1 - kx;
+                int x_off = tx * s.dilation_w;
+                int lo, hi;
+                valid_range(g.ow, g.width, s.horizontal_stride, s.pad_w, x_off, lo, hi);
+
+                for (int r = 0; r < nrows; r++) {
+                    T *dst = col_row + r * g.ow;
+                    int iy = (oy0 + r) * s.vertical_stride - s.pad_h + ty * s.dilation_h;
+
+                    if (iy < 0 || iy >= g.height) {
+                        std::fill(dst, dst + g.ow, static_cast<T>(0));
+                        continue;
+                    }
+
+                    const T *src = x + (c * g.height + iy) * g.width;
+                    std::fill(dst, dst + lo, static_cast<T>(0));
+                    if (s.horizontal_stride == 1) {
+                        std::copy(src + lo - s.pad_w + x_off, src + hi - s.pad_w + x_off, dst + lo);
+                    } else {
+                        for (int ox = lo; ox < hi; ox++) dst[ox] = src[ox * s.horizontal_stride - s.pad_w + x_off];
+                    }
+                    std::fill(dst + hi, dst + g.ow, static_cast<T>(0));
+                }
+            }
+        }
+    }
+}
+
+/* Adjoint of im2col_block: accumulates col back into the image dx (CHW). */
+template <typename T>
+void col2im_block(const T *col, const conv2d_geometry &g, const conv2d_cpu_settings &s, int oy0, int nrows, T *dx) {
+    const int ncols = nrows * g.ow;
+
+    for (int c = 0; c < g.channels; c++) {
+        for (int ky = 0; ky < g.kh; ky++) {
+            for (int kx = 0; kx < g.kw; kx++) {
+                const T *col_row = col + ((c * g.kh + ky) * g.kw + kx) * ncols;
+                int ty = (s.use_cross_correlation) ? ky : g.kh - 1 - ky;
+                int tx = (s.use_cross_correlation) ? kx : g.kw - 1 - kx;
+                int x_off = tx * s.dilation_w;
+                int lo, hi;
+                valid_range(g.ow, g.width, s.horizontal_stride, s.pad_w, x_off, lo, hi);
+
+                for (int r = 0; r < nrows; r++) {
+                    int iy = (oy0 + r) * s.vertical_stride - s.pad_h + ty * s.dilation_h;
+                    if (iy < 0 || iy >= g.height) continue;
+
+                    const T *src = col_row + r * g.ow;
+                    T *dst = dx + (c * g.height + iy) * g.width - s.pad_w + x_off;
+                    for (int ox = lo; ox < hi; ox++) dst[ox * s.horizontal_stride] += src[ox];
+                }
+            }
+        }
+    }
+}
+
+/* Index of the filter tap applied at kernel offset (ky, kx), taking the convolution mode into account. */
+inline int tap_index(const conv2d_geometry &g, const conv2d_cpu_settings &s, int ky, int kx) {
+    return (s.use_cross_correlation) ? ky * g.kw + kx : (g.kh - 1 - ky) * g.kw + (g.kw - 1 - kx);
+}
+
+/* y[n] = w * x[n] for 3x3 kernels with unit stride; the inner loop runs over contiguous output columns. */
+template <typename T>
+void direct_3x3_forward(const T *x, const T *w, T *y, const conv2d_geometry &g, const conv2d_cpu_settings &s) {
+    const int plane = g.oh * g.ow;
+
+    std::fill(y, y + g.out_channels * plane, static_cast<T>(0));
+
+    for (int k = 0; k < g.out_channels; k++) {
+        T *y_plane = y + k * plane;
+        for (int c = 0; c < g.channels; c++) {
+            const T *x_plane = x + c * g.height * g.width;
+            const T *w_kc = w + (k * g.channels + c) * 9;
+            for (int ky = 0; ky < 3; ky++) {
+                for (int kx = 0; kx < 3; kx++) {
+                    T wv = w_kc[tap_index(g, s, ky, kx)];
+                    int lo, hi;
+                    valid_range(g.ow, g.width, 1, s.pad_w, kx, lo, hi);
+                    for (int oy = 0; oy < g.oh; oy++) {
+                        int iy = oy - s.pad_h + ky;
+                        if (iy < 0 || iy >= g.height) continue;
+                        const T *x_row = x_plane + iy * g.width - s.pad_w + kx;
+                        T *y_row = y_plane + oy * g.ow;
+                        for (int ox = lo; ox < hi; ox++) y_row[ox] += wv * x_row[ox];
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* dx[n] = w^T * dy[n] for 3x3 kernels with unit stride. */
+template <typename T>
+void direct_3x3_backward_data(const T *w, const T *dy, T *dx, const conv2d_geometry &g, const conv2d_cpu_settings &s) {
+    const int plane = g.oh * g.ow;
+
+    std::fill(dx, dx + g.channels * g.height * g.width, static_cast<T>(0));
+
+    for (int c = 0; c < g.channels; c++) {
+        T *dx_plane = dx + c * g.height * g.width;
+        for (int k = 0; k < g.out_channels; k++) {
+            const T *dy_plane = dy + k * plane;
+            const T *w_kc = w + (k * g.channels + c) * 9;
+            for (int ky = 0; ky < 3; ky++) {
+                for (int kx = 0; kx < 3; kx++) {
+                    T wv = w_kc[tap_index(g, s, ky, kx)];
+                    int lo, hi;
+                    valid_range(g.ow, g.width, 1, s.pad_w, kx, lo, hi);
+                    for (int oy = 0; oy < g.oh; oy++) {
+                        int iy = oy - s.pad_h + ky;
+                        if (iy < 0 || iy >= g.height) continue;
+                        T *dx_row = dx_plane + iy * g.width - s.pad_w + kx;
+                        const T *dy_row = dy_plane + oy * g.ow;
+                        for (int ox = lo; ox < hi; ox++) dx_row[ox] += wv * dy_row[ox];
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* dw += dy[n] (x) x[n] for 3x3 kernels with unit stride. */
+template <typename T>
+void direct_3x3_backward_filter(const T *x, const T *dy, T *dw, const conv2d_geometry &g,
+                                const conv2d_cpu_settings &s) {
+    const int plane = g.oh * g.ow;
+
+    for (int k = 0; k < g.out_channels; k++) {
+        const T *dy_plane = dy + k * plane;
+        for (int c = 0; c < g.channels; c++) {
+            const T *x_plane = x + c * g.height * g.width;
+            T *dw_kc = dw + (k * g.channels + c) * 9;
+            for (int ky = 0; ky < 3; ky++) {
+                for (int kx = 0; kx < 3; kx++) {
+                    int lo, hi;
+                    valid_range(g.ow, g.width, 1, s.pad_w, kx, lo, hi);
+                    T acc = static_cast<T>(0);
+                    for (int oy = 0; oy < g.oh; oy++) {
+                        int iy = oy - s.pad_h + ky;
+                        if (iy < 0 || iy >= g.height) continue;
+                        const T *x_row = x_plane + iy * g.width - s.pad_w + kx;
+                        const T *dy_row = dy_plane + oy * g.ow;
+                        for (int ox = lo; ox < hi; ox++) acc += dy_row[ox] * x_row[ox];
+                    }
+                    dw_kc[tap_index(g, s, ky, kx)] += acc;
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+void conv2d_cpu(Tensor<T> *x, Tensor<T> *w, Tensor<T> *out, const conv2d_cpu_settings &s) {
+    const conv2d_geometry g = get_geometry(x, w, out);
+    const int in_image = g.channels * g.height * g.width;
+    const int out_plane = g.oh * g.ow;
+    const int col_rows = g.channels * g.kh * g.kw;
+    const T one = static_cast<T>(1), zero = static_cast<T>(0);
+
+    const T *x_ptr = x->get_ptr();
+    const T *w_ptr = w->get_ptr();
+    T *out_ptr = out->get_ptr();
+    T *col = static_cast<T *>(s.workspace);
+
+    for (int n = 0; n < g.batch; n++) {
+        const T *x_n = x_ptr + n * in_image;
+        T *out_n = out_ptr + n * g.out_channels * out_plane;
+
+        switch (s.algo) {
+            case CONV2D_CPU_ALGO_GEMM_1X1:
+                /* out_n (K x HW) = w (K x C) * x_n (C x HW), row-major */
+                gemm(OP_N, OP_N, out_plane, g.out_channels, g.channels, one, x_n, out_plane, w_ptr, g.channels, zero,
+                     out_n, out_plane);
+                break;
+            case CONV2D_CPU_ALGO_DIRECT_3X3:
+                direct_3x3_forward(x_n, w_ptr, out_n, g, s);
+                break;
+            case CONV2D_CPU_ALGO_IM2COL_GEMM:
+                for (int oy0 = 0; oy0 < g.oh; oy0 += s.block_rows) {
+                    int nrows = std::min(s.block_rows, g.oh - oy0);
+                    int ncols = nrows * g.ow;
+                    im2col_block(x_n, g, s, oy0, nrows, col);
+                    /* out_n[:, block] (K x ncols) = w (K x CRS) * col (CRS x ncols) */
+                    gemm(OP_N, OP_N, ncols, g.out_channels, col_rows, one, col, ncols, w_ptr, col_rows, zero,
+                         out_n + oy0 * g.ow, out_plane);
+                }
+                break;
+        }
+    }
+}
+
+template <typename T>
+void conv2d_grad_data_cpu(Tensor<T> *w, Tensor<T> *grad, Tensor<T> *out, const conv2d_cpu_settings &s) {
+    const conv2d_geometry g = get_geometry(out, w, grad);
+    const int in_image = g.channels * g.height * g.width;
+    const int out_plane = g.oh * g.ow;
+    const int col_rows = g.channels * g.kh * g.kw;
+    const T one = static_cast<T>(1), zero = static_cast<T>(0);
+
+    const T *w_ptr = w->get_ptr();
+    const T *grad_ptr = grad->get_ptr();
+    T *out_ptr = out->get_ptr();
+    T *col = static_cast<T *>(s.workspace);
+
+    for (int n = 0; n < g.batch; n++) {
+        const T *dy_n = grad_ptr + n * g.out_channels * out_plane;
+        T *dx_n = out_ptr + n * in_image;
+
+        switch (s.algo) {
+            case CONV2D_CPU_ALGO_GEMM_1X1:
+                /* dx_n (C x HW) = w^T (C x K) * dy_n (K x HW) */
+                gemm(OP_N, OP_T, out_plane, g.channels, g.out_channels, one, dy_n, out_plane, w_ptr, g.channels, zero,
+                     dx_n, out_plane);
+                break;
+            case CONV2D_CPU_ALGO_DIRECT_3X3:
+                direct_3x3_backward_data(w_ptr, dy_n, dx_n, g, s);
+                break;
+            case CONV2D_CPU_ALGO_IM2COL_GEMM:
+                std::fill(dx_n, dx_n + in_image, zero);
+                for (int oy0 = 0; oy0 < g.oh; oy0 += s.block_rows) {
+                    int nrows = std::min(s.block_rows, g.oh - oy0);
+                    int ncols = nrows * g.ow;
+                    /* col (CRS x ncols) = w^T (CRS x K) * dy_n[:, block] (K x ncols) */
+                    gemm(OP_N, OP_T, ncols, col_rows, g.out_channels, one, dy_n + oy0 * g.ow, out_plane, w_ptr,
+                         col_rows, zero, col, ncols);
+                    col2im_block(col, g, s, oy0, nrows, dx_n);
+                }
+                break;
+        }
+    }
+}
+
+template <typename T>
+void conv2d_grad_filter_cpu(Tensor<T> *x, Tensor<T> *grad, Tensor<T> *out, const conv2d_cpu_settings &s) {
+    const conv2d_geometry g = get_geometry(x, out, grad);
+    const int in_image = g.channels * g.height * g.width;
+    const int out_plane = g.oh * g.ow;
+    const int col_rows = g.channels * g.kh * g.kw;
+    const T one = static_cast<T>(1), zero = static_cast<T>(0);
+
+    const T *x_ptr = x->get_ptr();
+    const T *grad_ptr = grad->get_ptr();
+    T *out_ptr = out->get_ptr();
+    T *col = static_cast<T *>(s.workspace);
+
+    if (s.algo == CONV2D_CPU_ALGO_DIRECT_3X3) {
+        std::fill(out_ptr, out_ptr + out->get_size(), zero);
+    }
+
+    for (int n = 0; n < g.batch; n++) {
+        const T *x_n = x_ptr + n * in_image;
+        const T *dy_n = grad_ptr + n * g.out_channels * out_plane;
+        T beta = (n == 0) ? zero : one;
+
+        switch (s.algo) {
+            case CONV2D_CPU_ALGO_GEMM_1X1:
+                /* dw (K x C) += dy_n (K x HW) * x_n^T (HW x C) */
+                gemm(OP_T, OP_N, g.channels, g.out_channels, out_plane, one, x_n, out_plane, dy_n, out_plane, beta,
+                     out_ptr, g.channels);
+                break;
+            case CONV2D_CPU_ALGO_DIRECT_3X3:
+                direct_3x3_backward_filter(x_n, dy_n, out_ptr, g, s);
+                break;
+            case CONV2D_CPU_ALGO_IM2COL_GEMM:
+                for (int oy0 = 0; oy0 < g.oh; oy0 += s.block_rows) {
+                    int nrows = std::min(s.block_rows, g.oh - oy0);
+                    int ncols = nrows * g.ow;
+                    im2col_block(x_n, g, s, oy0, nrows, col);
+                    /* dw (K x CRS) += dy_n[:, block] (K x ncols) * col^T (ncols x CRS) */
+                    gemm(OP_T, OP_N, col_rows, g.out_channels, ncols, one, col, ncols, dy_n + oy0 * g.ow, out_plane,
+                         (oy0 == 0) ? beta : one, out_ptr, col_rows);
+                }
+                break;
+        }
+    }
+}
+
+}  // namespace
+
+template <typename T>
+void conv2d(Tensor<T> *x, Tensor<T> *w, Tensor<T> *out, conv2d_cpu_settings settings) {
     assert(T_IS_SAME_MEMORY_TYPE(x, w) && T_IS_SAME_MEMORY_TYPE(w, out));
 
     if (out->get_memory_type() == HOST) {
-        fprintf(stderr, "__Conv2d CPU not supported yet.\n");
+        conv2d_cpu(x, w, out, settings);
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -27,16 +397,20 @@ void conv2d(Tensor<T> *x, Tensor<T> *w, Tensor<T> *out) {
     }
 #endif
 }
-template void conv2d(Tensor<int> *x, Tensor<int> *w, Tensor<int> *out);
-template void conv2d(Tensor<float> *x, Tensor<float> *w, Tensor<float> *out);
-template void conv2d(Tensor<double> *x, Tensor<double> *w, Tensor<double> *out);
+template <>
+void conv2d(Tensor<int> *x, Tensor<int> *w, Tensor<int> *out, conv2d_cpu_settings settings) {
+    /* no integer GEMM available */
+    MAGMADNN_NOT_IMPLEMENTED;
+}
+template void conv2d(Tensor<float> *x, Tensor<float> *w, Tensor<float> *out, conv2d_cpu_settings settings);
+template void conv2d(Tensor<double> *x, Tensor<double> *w, Tensor<double> *out, conv2d_cpu_settings settings);
 
 template <typename T>
-void conv2d_grad_data(Tensor<T> *w, Tensor<T> *grad, Tensor<T> *out) {
+void conv2d_grad_data(Tensor<T> *w, Tensor<T> *grad, Tensor<T> *out, conv2d_cpu_settings settings) {
     assert(T_IS_SAME_MEMORY_TYPE(w, grad) && T_IS_SAME_MEMORY_TYPE(grad, out));
 
     if (out->get_memory_type() == HOST) {
-        fprintf(stderr, "__Conv2d_grad_data CPU not supported yet.\n");
+        conv2d_grad_data_cpu(w, grad, out, settings);
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -44,16 +418,21 @@ void conv2d_grad_data(Tensor<T> *w, Tensor<T> *grad, Tensor<T> *out) {
     }
 #endif
 }
-template void conv2d_grad_data(Tensor<int> *w, Tensor<int> *grad, Tensor<int> *out);
-template void conv2d_grad_data(Tensor<float> *w, Tensor<float> *grad, Tensor<float> *out);
-template void conv2d_grad_data(Tensor<double> *w, Tensor<double> *grad, Tensor<double> *out);
+template <>
+void conv2d_grad_data(Tensor<int> *w, Tensor<int> *grad, Tensor<int> *out, conv2d_cpu_settings settings) {
+    MAGMADNN_NOT_IMPLEMENTED;
+}
+template void conv2d_grad_data(Tensor<float> *w, Tensor<float> *grad, Tensor<float> *out,
+                               conv2d_cpu_settings settings);
+template void conv2d_grad_data(Tensor<double> *w, Tensor<double> *grad, Tensor<double> *out,
+                               conv2d_cpu_settings settings);
 
 template <typename T>
-void conv2d_grad_filter(Tensor<T> *w, Tensor<T> *grad, Tensor<T> *out) {
-    assert(T_IS_SAME_MEMORY_TYPE(w, grad) && T_IS_SAME_MEMORY_TYPE(grad, out));
+void conv2d_grad_filter(Tensor<T> *x, Tensor<T> *grad, Tensor<T> *out, conv2d_cpu_settings settings) {
+    assert(T_IS_SAME_MEMORY_TYPE(x, grad) && T_IS_SAME_MEMORY_TYPE(grad, out));
 
     if (out->get_memory_type() == HOST) {
-        fprintf(stderr, "__Conv2d_grad_filter CPU not supported yet.\n");
+        conv2d_grad_filter_cpu(x, grad, out, settings);
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -61,9 +440,14 @@ void conv2d_grad_filter(Tensor<T> *w, Tensor<T> *grad, Tensor<T> *out) {
     }
 #endif
 }
-template void conv2d_grad_filter(Tensor<int> *x, Tensor<int> *grad, Tensor<int> *out);
-template void conv2d_grad_filter(Tensor<float> *x, Tensor<float> *grad, Tensor<float> *out);
-template void conv2d_grad_filter(Tensor<double> *x, Tensor<double> *grad, Tensor<double> *out);
+template <>
+void conv2d_grad_filter(Tensor<int> *x, Tensor<int> *grad, Tensor<int> *out, conv2d_cpu_settings settings) {
+    MAGMADNN_NOT_IMPLEMENTED;
+}
+template void conv2d_grad_filter(Tensor<float> *x, Tensor<float> *grad, Tensor<float> *out,
+                                 conv2d_cpu_settings settings);
+template void conv2d_grad_filter(Tensor<double> *x, Tensor<double> *grad, Tensor<double> *out,
+                                 conv2d_cpu_settings settings);
 
 #if defined(MAGMADNN_HAVE_CUDA)
 
@@ -9,10 +9,33 @@
 #include "math/crossentropy.h"
 
 #include <cassert>
+#include <cmath>
+#include <string>
+
+#include "magmadnn/exception.h"
+#include "magmadnn/parallel.h"
+#include "math/elementwise.h"
 
 namespace magmadnn {
 namespace math {
 
+namespace {
+
+/* bad labels are reported rather than skipped, since they mean bad data; one pass over n_samples values */
+template <typename T>
+void check_class_indices(const T *labels, unsigned int n_samples, unsigned int n_classes, const char *func) {
+    for (unsigned int i = 0; i < n_samples; i++) {
+        if (!(labels[i] >= (T) 0 && labels[i] < (T) n_classes)) {
+            throw ::magmadnn::Error(__FILE__, __LINE__,
+                                    std::string(func) + ": label " + std::to_string((double) labels[i]) +
+                                        " of sample " + std::to_string(i) + " is not a class index in [0, " +
+                                        std::to_string(n_classes) + ")");
+        }
+    }
+}
+
+}  // namespace
+
 template <typename T>
 void crossentropy(Tensor<T> *predicted, Tensor<T> *ground_truth, Tensor<T> *out) {
     assert(T_IS_SCALAR(out) && T_IS_MATRIX(predicted) && T_IS_MATRIX(ground_truth));
@@ -23,16 +46,22 @@ void crossentropy(Tensor<T> *predicted, Tensor<T> *ground_truth, Tensor<T> *out)
         T *out_ptr = out->get_ptr();
         unsigned int n_samples = predicted->get_shape(0);
         unsigned int n_classes = predicted->get_shape(1);
-        T sum = (T) 0;
 
         /* compute dot product : ground_truth[i,:].log(predicted[i,:]) */
-        for (unsigned int i = 0; i < n_samples * n_classes; i++) {
-            /* TODO -- investigate "if(ground_truth[.] == 0) continue;" would speed this up.
-                        It might due to no log call, but introducing a conditional branch might hurt the pipeline. */
+        auto partial_dot = [&](std::size_t begin, std::size_t end) {
+            T partial = (T) 0;
+            for (unsigned int i = begin; i < end; i++) {
+                /* TODO -- investigate "if(ground_truth[.] == 0) continue;" would speed this up.
+                            It might due to no log call, but introducing a conditional branch might hurt the pipeline. */
 
-            if (predicted_ptr[i] <= 0) continue; /* avoids NaN from log */
-            sum += ground_truth_ptr[i] * (T) log(predicted_ptr[i]);
-        }
+                if (predicted_ptr[i] <= 0) continue; /* avoids NaN from log */
+                partial += ground_truth_ptr[i] * (T) log(predicted_ptr[i]);
+            }
+            return partial;
+        };
+        /* fixed block size keeps the summation order independent of the thread count */
+        T sum = ::magmadnn::internal::parallel_reduce_sum<T>((std::size_t) n_samples * n_classes,
+                                                             ::magmadnn::internal::PARALLEL_GRAIN_SIZE, partial_dot);
 
         out_ptr[0] = -sum / ((T) n_samples);
     }
@@ -46,5 +75,111 @@ template void crossentropy(Tensor<int> *predicted, Tensor<int> *ground_truth, Te
 template void crossentropy(Tensor<float> *predicted, Tensor<float> *ground_truth, Tensor<float> *out);
 template void crossentropy(Tensor<double> *predicted, Tensor<double> *ground_truth, Tensor<double> *out);
 
+template <typename T>
+void softmax_crossentropy(Tensor<T> *logits, Tensor<T> *labels, Tensor<T> *softmax, Tensor<T> *out) {
+    assert(T_IS_SCALAR(out) && T_IS_MATRIX(logits) && logits->get_size() == softmax->get_size());
+
+    if (out->get_memory_type() == HOST) {
+        const T *logits_ptr = logits->get_ptr();
+        const T *labels_ptr = labels->get_ptr();
+        T *softmax_ptr = softmax->get_ptr();
+        unsigned int n_samples = logits->get_shape(0);
+        unsigned int n_classes = logits->get_shape(1);
+        bool sparse = (labels->get_shape().size() == 1);
+
+        assert(labels->get_shape(0) == n_samples && (sparse || labels->get_size() == logits->get_size()));
+        if (sparse) check_class_indices(labels_ptr, n_samples, n_classes, "softmax_crossentropy");
+
+        /* loss of row i = logsumexp(x_i) - sum_j y_ij x_ij, with the row max taken out of the exponentials */
+        auto partial_loss = [&](std::size_t begin, std::size_t end) {
+            T partial = (T) 0;
+            for (std::size_t i = begin; i < end; i++) {
+                const T *x = logits_ptr + i * n_classes;
+                T *p = softmax_ptr + i * n_classes;
+
+                T max = x[0];
+                for (unsigned int j = 1; j < n_classes; j++) max = (x[j] > max) ? x[j] : max;
+
+                T sum = (T) 0;
+                for (unsigned int j = 0; j < n_classes; j++) {
+                    p[j] = (T) std::exp(x[j] - max);
+                    sum += p[j];
+                }
+                const T log_sum = (T) std::log(sum);
+                const T inv_sum = (T) 1 / sum;
+                for (unsigned int j = 0; j < n_classes; j++) p[j] *= inv_sum;
+
+                if (sparse) {
+                    partial += max + log_sum - x[(unsigned int) labels_ptr[i]];
+                } else {
+                    const T *y = labels_ptr + i * n_classes;
+                    for (unsigned int j = 0; j < n_classes; j++) {
+                        if (y[j] != (T) 0) partial += y[j] * (max + log_sum - x[j]);
+                    }
+                }
+            }
+            return partial;
+        };
+        /* blocks of rows; the summation order does not depend on the thread count */
+        T sum = ::magmadnn::internal::parallel_reduce_sum<T>(
+            n_samples, ::magmadnn::internal::PARALLEL_GRAIN_SIZE / n_classes + 1, partial_loss);
+
+        out->get_ptr()[0] = sum / ((T) n_samples);
+    }
+#if defined(MAGMADNN_HAVE_CUDA)
+    else {
+        throw ::magmadnn::Error(__FILE__, __LINE__, "softmax_crossentropy is only implemented on HOST");
+    }
+#endif
+}
+template void softmax_crossentropy(Tensor<int> *logits, Tensor<int> *labels, Tensor<int> *softmax, Tensor<int> *out);
+template void softmax_crossentropy(Tensor<float> *logits, Tensor<float> *labels, Tensor<float> *softmax,
+                                   Tensor<float> *out);
+template void softmax_crossentropy(Tensor<double> *logits, Tensor<double> *labels, Tensor<double> *softmax,
+                                   Tensor<double> *out);
+
+template <typename T>
+void softmax_crossentropy_grad(Tensor<T> *softmax, Tensor<T> *labels, T grad, Tensor<T> *out) {
+    assert(T_IS_MATRIX(softmax) && softmax->get_size() == out->get_size());
+
+    if (out->get_memory_type() == HOST) {
+        const T *softmax_ptr = softmax->get_ptr();
+        const T *labels_ptr = labels->get_ptr();
+        T *out_ptr = out->get_ptr();
+        unsigned int n_samples = softmax->get_shape(0);
+        unsigned int n_classes = softmax->get_shape(1);
+        bool sparse = (labels->get_shape().size() == 1);
+        const T scale = grad / ((T) n_samples);
+
+        if (sparse) check_class_indices(labels_ptr, n_samples, n_classes, "softmax_crossentropy_grad");
+
+        ::magmadnn::internal::parallel_for(
+            n_samples, ::magmadnn::internal::PARALLEL_GRAIN_SIZE / n_classes + 1,
+            [&](std::size_t begin, std::size_t end) {
+                std::size_t offset = begin * n_classes, row_end = end * n_classes;
+                if (sparse) {
+                    elementwise_unary(row_end - offset, softmax_ptr + offset, out_ptr + offset,
+                                      scale_functor<T>(scale));
+                    for (std::size_t i = begin; i < end; i++) {
+                        out_ptr[i * n_classes + (unsigned int) labels_ptr[i]] -= scale;
+                    }
+                } else {
+                    elementwise_binary(row_end - offset, softmax_ptr + offset, labels_ptr + offset, out_ptr + offset,
+                                       [scale](T p, T y) { return scale * (p - y); });
+                }
+            });
+    }
+#if defined(MAGMADNN_HAVE_CUDA)
+    else {
+        throw ::magmadnn::Error(__FILE__, __LINE__, "softmax_crossentropy_grad is only implemented on HOST");
+    }
+#endif
+}
+template void softmax_crossentropy_grad(Tensor<int> *softmax, Tensor<int> *labels, int grad, Tensor<int> *out);
+template void softmax_crossentropy_grad(Tensor<float> *softmax, Tensor<float> *labels, float grad,
+                                        Tensor<float> *out);
+template void softmax_crossentropy_grad(Tensor<double> *softmax, Tensor<double> *labels, double grad,
+                                        Tensor<double> *out);
+
 }  // namespace math
 }  // namespace magmadnn
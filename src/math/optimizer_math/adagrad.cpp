@@ -10,6 +10,8 @@
 
 #include <cassert>
 
+#include "magmadnn/parallel.h"
+
 namespace magmadnn {
 namespace math {
 
@@ -22,10 +24,13 @@ void adagrad(T learning_rate, Tensor<T> *scaling_tensors, Tensor<T> *grad, Tenso
         T *out_ptr = out->get_ptr();
         unsigned int size = out->get_size();
 
-        for (unsigned int i = 0; i < size; i++) {
-            scaling_tensors_ptr[i] += (grad_ptr[i] * grad_ptr[i]);
-            out_ptr[i] = out_ptr[i] - (learning_rate / sqrt(1e-8 + scaling_tensors_ptr[i])) * grad_ptr[i];
-        }
+        ::magmadnn::internal::parallel_for(
+            size, ::magmadnn::internal::PARALLEL_GRAIN_SIZE, [&](std::size_t begin, std::size_t end) {
+                for (unsigned int i = begin; i < end; i++) {
+                    scaling_tensors_ptr[i] += (grad_ptr[i] * grad_ptr[i]);
+                    out_ptr[i] = out_ptr[i] - (learning_rate / sqrt(1e-8 + scaling_tensors_ptr[i])) * grad_ptr[i];
+                }
+            });
     }
 #if defined(_HAS_CUDA_)
     else {
@@ -10,6 +10,8 @@
 
 #include <cassert>
 
+#include "magmadnn/parallel.h"
+
 namespace magmadnn {
 namespace math {
 
@@ -25,13 +27,17 @@ void adam(T learning_rate, T beta1, T beta2, T running_beta1, T running_beta2, T
         T *out_ptr = out->get_ptr();
         unsigned int size = out->get_size();
 
-        for (unsigned int i = 0; i < size; i++) {
-            first_moment_ptr[i] = (beta1 * first_moment_ptr[i]) + (1 - beta1) * (grad_ptr[i]);
-            second_moment_ptr[i] = (beta2 * second_moment_ptr[i]) + (1 - beta2) * (grad_ptr[i] * grad_ptr[i]);
-            T m_temp = first_moment_ptr[i] / (1 - running_beta1);
-            T v_temp = second_moment_ptr[i] / (1 - running_beta2);
-            out_ptr[i] = out_ptr[i] - (learning_rate / (sqrt(v_temp) + 1e-8)) * m_temp;
-        }
+        ::magmadnn::internal::parallel_for(
+            size, ::magmadnn::internal::PARALLEL_GRAIN_SIZE, [&](std::size_t begin, std::size_t end) {
+                for (unsigned int i = begin; i < end; i++) {
+                    first_moment_ptr[i] = (beta1 * first_moment_ptr[i]) + (1 - beta1) * (grad_ptr[i]);
+                    second_moment_ptr[i] =
+                        (beta2 * second_moment_ptr[i]) + (1 - beta2) * (grad_ptr[i] * grad_ptr[i]);
+                    T m_temp = first_moment_ptr[i] / (1 - running_beta1);
+                    T v_temp = second_moment_ptr[i] / (1 - running_beta2);
+                    out_ptr[i] = out_ptr[i] - (learning_rate / (sqrt(v_temp) + 1e-8)) * m_temp;
+                }
+            });
     }
 #if defined(_HAS_CUDA_)
     else {
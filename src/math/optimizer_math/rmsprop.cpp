@@ -10,6 +10,8 @@
 
 #include <cassert>
 
+#include "magmadnn/parallel.h"
+
 namespace magmadnn {
 namespace math {
 
@@ -22,11 +24,15 @@ void rmsprop(T learning_rate, T decaying_factor, Tensor<T> *decaying_squares_ave
         T *out_ptr = out->get_ptr();
         unsigned int size = out->get_size();
 
-        for (unsigned int i = 0; i < size; i++) {
-            decaying_squares_average_ptr[i] = (decaying_factor * decaying_squares_average_ptr[i]) +
-                                              (1 - decaying_factor) * (grad_ptr[i] * grad_ptr[i]);
-            out_ptr[i] = out_ptr[i] - (learning_rate / sqrt(1e-8 + decaying_squares_average_ptr[i])) * grad_ptr[i];
-        }
+        ::magmadnn::internal::parallel_for(
+            size, ::magmadnn::internal::PARALLEL_GRAIN_SIZE, [&](std::size_t begin, std::size_t end) {
+                for (unsigned int i = begin; i < end; i++) {
+                    decaying_squares_average_ptr[i] = (decaying_factor * decaying_squares_average_ptr[i]) +
+                                                      (1 - decaying_factor) * (grad_ptr[i] * grad_ptr[i]);
+                    out_ptr[i] =
+                        out_ptr[i] - (learning_rate / sqrt(1e-8 + decaying_squares_average_ptr[i])) * grad_ptr[i];
+                }
+            });
     }
 #if defined(_HAS_CUDA_)
     else {
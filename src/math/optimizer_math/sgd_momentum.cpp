@@ -11,6 +11,8 @@
 #include <cassert>
 #include <vector>
 
+#include "magmadnn/parallel.h"
+
 #if defined(MAGMADNN_CMAKE_BUILD)
 #include "magmadnn/config.h"
 #endif
@@ -52,10 +54,13 @@ void sgd_momentum_cpu(T learning_rate, T momentum, Tensor<T> *prev, Tensor<T> *g
     T *out_ptr = out->get_ptr();
     unsigned int size = out->get_size();
 
-    for (unsigned int i = 0; i < size; i++) {
-        prev_ptr[i] = momentum * prev_ptr[i] + (1 - momentum) * grad_ptr[i];
-        out_ptr[i] = out_ptr[i] - learning_rate * prev_ptr[i];
-    }
+    ::magmadnn::internal::parallel_for(
+        size, ::magmadnn::internal::PARALLEL_GRAIN_SIZE, [&](std::size_t begin, std::size_t end) {
+            for (unsigned int i = begin; i < end; i++) {
+                prev_ptr[i] = momentum * prev_ptr[i] + (1 - momentum) * grad_ptr[i];
+                out_ptr[i] = out_ptr[i] - learning_rate * prev_ptr[i];
+            }
+        });
 }
 template void sgd_momentum_cpu(int learning_rate, int momentum, Tensor<int> *prev, Tensor<int> *grad, Tensor<int> *out);
 template void sgd_momentum_cpu(float learning_rate, float momentum, Tensor<float> *prev, Tensor<float> *grad,
@@ -8,7 +8,9 @@
  */
 #include "math/pooling.h"
 
+#include <algorithm>
 #include <cassert>
+#include <vector>
 
 #if defined(MAGMADNN_CMAKE_BUILD)
 #include "magmadnn/config.h"
@@ -17,12 +19,232 @@
 namespace magmadnn {
 namespace math {
 
+namespace {
+
+struct pooling_geometry {
+    unsigned int planes;
+    int in_h, in_w, out_h, out_w;
+    /* output columns [ox_lo, ox_hi) have their whole window inside the input row */
+    int ox_lo, ox_hi;
+};
+
+pooling_geometry get_geometry(const std::vector<unsigned int> &x_shape, const std::vector<unsigned int> &y_shape,
+                              const pooling_cpu_settings &s) {
+    pooling_geometry g;
+    g.planes = x_shape[0] * x_shape[1];
+    g.in_h = x_shape[2];
+    g.in_w = x_shape[3];
+    g.out_h = y_shape[2];
+    g.out_w = y_shape[3];
+
+    g.ox_lo = (s.pad_w + s.horizontal_stride - 1) / s.horizontal_stride;
+    g.ox_hi = (g.in_w + s.pad_w >= s.filter_w) ? (g.in_w + s.pad_w - s.filter_w) / s.horizontal_stride + 1 : 0;
+    g.ox_hi = std::max(std::min(g.ox_hi, g.out_w), g.ox_lo);
+    g.ox_lo = std::min(g.ox_lo, g.out_w);
+    g.ox_hi = std::min(g.ox_hi, g.out_w);
+    return g;
+}
+
+/* clips the window starting at o*stride-pad to [0, extent) */
+inline void window_range(int o, int stride, int pad, int filter, int extent, int &lo, int &hi) {
+    int start = o * stride - pad;
+    lo = std::max(start, 0);
+    hi = std::min(start + filter, extent);
+}
+
+template <typename T>
+inline bool is_nan(T v) {
+    return v != v;
+}
+
+/* whether v replaces the current maximum; the first maximum in window order wins ties */
+template <typename T>
+inline bool max_pool_takes(T v, T best, bool propagate_nan) {
+    if (propagate_nan) return (v > best) || (is_nan(v) && !is_nan(best));
+    return (v > best) || (is_nan(best) && !is_nan(v));
+}
+
+template <typename T>
+void max_pooling_cpu(const T *x, T *y, int *argmax, const pooling_geometry &g, const pooling_cpu_settings &s) {
+    const int in_plane = g.in_h * g.in_w;
+    const int out_plane = g.out_h * g.out_w;
+
+    for (unsigned int p = 0; p < g.planes; p++) {
+        const T *x_p = x + (size_t) p * in_plane;
+        T *y_p = y + (size_t) p * out_plane;
+        int *a_p = argmax + (size_t) p * out_plane;
+
+        for (int oy = 0; oy < g.out_h; oy++) {
+            int ylo, yhi;
+            window_range(oy, s.vertical_stride, s.pad_h, s.filter_h, g.in_h, ylo, yhi);
+            T *y_row = y_p + oy * g.out_w;
+            int *a_row = a_p + oy * g.out_w;
+
+            /* border columns: clipped windows */
+            for (int ox = 0; ox < g.out_w; ox++) {
+                if (ox == g.ox_lo) ox = g.ox_hi;
+                if (ox >= g.out_w) break;
+
+                int xlo, xhi, best_idx = -1;
+                T best = (T) 0;
+                window_range(ox, s.horizontal_stride, s.pad_w, s.filter_w, g.in_w, xlo, xhi);
+                for (int iy = ylo; iy < yhi; iy++) {
+                    for (int ix = xlo; ix < xhi; ix++) {
+                        T v = x_p[iy * g.in_w + ix];
+                        if (best_idx < 0 || max_pool_takes(v, best, s.propagate_nan)) {
+                            best = v;
+                            best_idx = iy * g.in_w + ix;
+                        }
+                    }
+                }
+                y_row[ox] = best;
+                a_row[ox] = best_idx;
+            }
+
+            if (g.ox_lo >= g.ox_hi) continue;
+
+            /* interior columns: one pass over the output row per filter tap, unit-stride in the output */
+            if (ylo >= yhi) {
+                for (int ox = g.ox_lo; ox < g.ox_hi; ox++) {
+                    y_row[ox] = (T) 0;
+                    a_row[ox] = -1;
+                }
+                continue;
+            }
+            for (int iy = ylo; iy < yhi; iy++) {
+                for (int fx = 0; fx < s.filter_w; fx++) {
+                    const int offset = iy * g.in_w - s.pad_w + fx;
+                    if (iy == ylo && fx == 0) {
+                        for (int ox = g.ox_lo; ox < g.ox_hi; ox++) {
+                            y_row[ox] = x_p[offset + ox * s.horizontal_stride];
+                            a_row[ox] = offset + ox * s.horizontal_stride;
+                        }
+                        continue;
+                    }
+                    for (int ox = g.ox_lo; ox < g.ox_hi; ox++) {
+                        T v = x_p[offset + ox * s.horizontal_stride];
+                        if (max_pool_takes(v, y_row[ox], s.propagate_nan)) {
+                            y_row[ox] = v;
+                            a_row[ox] = offset + ox * s.horizontal_stride;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+void average_pooling_cpu(const T *x, T *y, const pooling_geometry &g, const pooling_cpu_settings &s) {
+    const int in_plane = g.in_h * g.in_w;
+    const int out_plane = g.out_h * g.out_w;
+
+    for (unsigned int p = 0; p < g.planes; p++) {
+        const T *x_p = x + (size_t) p * in_plane;
+        T *y_p = y + (size_t) p * out_plane;
+
+        for (int oy = 0; oy < g.out_h; oy++) {
+            int ylo, yhi;
+            window_range(oy, s.vertical_stride, s.pad_h, s.filter_h, g.in_h, ylo, yhi);
+            T *y_row = y_p + oy * g.out_w;
+
+            for (int ox = 0; ox < g.out_w; ox++) {
+                if (ox == g.ox_lo) ox = g.ox_hi;
+                if (ox >= g.out_w) break;
+
+                int xlo, xhi;
+                T sum = (T) 0;
+                window_range(ox, s.horizontal_stride, s.pad_w, s.filter_w, g.in_w, xlo, xhi);
+                for (int iy = ylo; iy < yhi; iy++) {
+                    for (int ix = xlo; ix < xhi; ix++) sum += x_p[iy * g.in_w + ix];
+                }
+                int count = std::max(yhi - ylo, 0) * std::max(xhi - xlo, 0);
+                y_row[ox] = (count > 0) ? sum / (T) count : (T) 0;
+            }
+
+            for (int ox = g.ox_lo; ox < g.ox_hi; ox++) y_row[ox] = (T) 0;
+            for (int iy = ylo; iy < yhi; iy++) {
+                for (int fx = 0; fx < s.filter_w; fx++) {
+                    const int offset = iy * g.in_w - s.pad_w + fx;
+                    for (int ox = g.ox_lo; ox < g.ox_hi; ox++) y_row[ox] += x_p[offset + ox * s.horizontal_stride];
+                }
+            }
+            const int count = std::max(yhi - ylo, 0) * s.filter_w;
+            for (int ox = g.ox_lo; ox < g.ox_hi; ox++) y_row[ox] = (count > 0) ? y_row[ox] / (T) count : (T) 0;
+        }
+    }
+}
+
+/* O(output) scatter of dy through the recorded argmax offsets */
+template <typename T>
+void max_pooling_grad_cpu(const T *dy, const int *argmax, T *dx, const pooling_geometry &g) {
+    const int in_plane = g.in_h * g.in_w;
+    const int out_plane = g.out_h * g.out_w;
+
+    std::fill(dx, dx + (size_t) g.planes * in_plane, (T) 0);
+
+    for (unsigned int p = 0; p < g.planes; p++) {
+        const T *dy_p = dy + (size_t) p * out_plane;
+        const int *a_p = argmax + (size_t) p * out_plane;
+        T *dx_p = dx + (size_t) p * in_plane;
+
+        for (int o = 0; o < out_plane; o++) {
+            if (a_p[o] >= 0) dx_p[a_p[o]] += dy_p[o];
+        }
+    }
+}
+
 template <typename T>
-void pooling(Tensor<T> *x, Tensor<T> *out) {
+void average_pooling_grad_cpu(const T *dy, T *dx, const pooling_geometry &g, const pooling_cpu_settings &s) {
+    const int in_plane = g.in_h * g.in_w;
+    const int out_plane = g.out_h * g.out_w;
+
+    std::fill(dx, dx + (size_t) g.planes * in_plane, (T) 0);
+
+    for (unsigned int p = 0; p < g.planes; p++) {
+        const T *dy_p = dy + (size_t) p * out_plane;
+        T *dx_p = dx + (size_t) p * in_plane;
+
+        for (int oy = 0; oy < g.out_h; oy++) {
+            int ylo, yhi;
+            window_range(oy, s.vertical_stride, s.pad_h, s.filter_h, g.in_h, ylo, yhi);
+            for (int ox = 0; ox < g.out_w; ox++) {
+                int xlo, xhi;
+                window_range(ox, s.horizontal_stride, s.pad_w, s.filter_w, g.in_w, xlo, xhi);
+                int count = std::max(yhi - ylo, 0) * std::max(xhi - xlo, 0);
+                if (count == 0) continue;
+
+                T val = dy_p[oy * g.out_w + ox] / (T) count;
+                for (int iy = ylo; iy < yhi; iy++) {
+                    T *dst = dx_p + iy * g.in_w;
+                    for (int ix = xlo; ix < xhi; ix++) dst[ix] += val;
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+template <typename T>
+void pooling(Tensor<T> *x, Tensor<T> *out, pooling_cpu_settings settings) {
     assert(T_IS_SAME_MEMORY_TYPE(x, out));
 
     if (out->get_memory_type() == HOST) {
-        fprintf(stderr, "__pooling CPU not supported yet.\n");
+        assert(x->get_shape().size() == 4 && out->get_shape().size() == 4);
+
+        pooling_geometry g = get_geometry(x->get_shape(), out->get_shape(), settings);
+
+        if (settings.mode == MAX_POOL) {
+            if (settings.argmax != NULL) {
+                max_pooling_cpu(x->get_ptr(), out->get_ptr(), settings.argmax, g, settings);
+            } else {
+                std::vector<int> argmax(out->get_size());
+                max_pooling_cpu(x->get_ptr(), out->get_ptr(), argmax.data(), g, settings);
+            }
+        } else {
+            average_pooling_cpu(x->get_ptr(), out->get_ptr(), g, settings);
+        }
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -30,18 +252,34 @@ void pooling(Tensor<T> *x, Tensor<T> *out) {
     }
 #endif
 }
-template void pooling(Tensor<int> *x, Tensor<int> *out);
-template void pooling(Tensor<float> *x, Tensor<float> *out);
-template void pooling(Tensor<double> *x, Tensor<double> *out);
+template void pooling(Tensor<int> *x, Tensor<int> *out, pooling_cpu_settings settings);
+template void pooling(Tensor<float> *x, Tensor<float> *out, pooling_cpu_settings settings);
+template void pooling(Tensor<double> *x, Tensor<double> *out, pooling_cpu_settings settings);
 
 template <typename T>
-void pooling_grad(Tensor<T> *x, Tensor<T> *y, Tensor<T> *grad, Tensor<T> *out) {
+void pooling_grad(Tensor<T> *x, Tensor<T> *y, Tensor<T> *grad, Tensor<T> *out, pooling_cpu_settings settings) {
     assert(T_IS_SAME_MEMORY_TYPE(x, y));
     assert(T_IS_SAME_MEMORY_TYPE(y, grad));
     assert(T_IS_SAME_MEMORY_TYPE(grad, out));
 
     if (out->get_memory_type() == HOST) {
-        fprintf(stderr, "__Pooling_grad CPU not supported yet.\n");
+        assert(x->get_shape().size() == 4 && grad->get_shape().size() == 4);
+
+        pooling_geometry g = get_geometry(x->get_shape(), grad->get_shape(), settings);
+
+        if (settings.mode == MAX_POOL) {
+            if (settings.argmax != NULL) {
+                max_pooling_grad_cpu(grad->get_ptr(), settings.argmax, out->get_ptr(), g);
+            } else {
+                /* no cached indices: recover them by rescanning the input */
+                std::vector<T> y_scratch(grad->get_size());
+                std::vector<int> argmax(grad->get_size());
+                max_pooling_cpu(x->get_ptr(), y_scratch.data(), argmax.data(), g, settings);
+                max_pooling_grad_cpu(grad->get_ptr(), argmax.data(), out->get_ptr(), g);
+            }
+        } else {
+            average_pooling_grad_cpu(grad->get_ptr(), out->get_ptr(), g, settings);
+        }
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -49,9 +287,12 @@ void pooling_grad(Tensor<T> *x, Tensor<T> *y, Tensor<T> *grad, Tensor<T> *out) {
     }
 #endif
 }
-template void pooling_grad(Tensor<int> *x, Tensor<int> *y, Tensor<int> *grad, Tensor<int> *out);
-template void pooling_grad(Tensor<float> *x, Tensor<float> *y, Tensor<float> *grad, Tensor<float> *out);
-template void pooling_grad(Tensor<double> *x, Tensor<double> *y, Tensor<double> *grad, Tensor<double> *out);
+template void pooling_grad(Tensor<int> *x, Tensor<int> *y, Tensor<int> *grad, Tensor<int> *out,
+                           pooling_cpu_settings settings);
+template void pooling_grad(Tensor<float> *x, Tensor<float> *y, Tensor<float> *grad, Tensor<float> *out,
+                           pooling_cpu_settings settings);
+template void pooling_grad(Tensor<double> *x, Tensor<double> *y, Tensor<double> *grad, Tensor<double> *out,
+                           pooling_cpu_settings settings);
 
 #if defined(MAGMADNN_HAVE_CUDA)
 
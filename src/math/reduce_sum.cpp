@@ -14,6 +14,8 @@
 #endif
 #include "math/wrappers.h"
 
+#include "magmadnn/parallel.h"
+
 namespace magmadnn {
 namespace math {
 
@@ -90,10 +92,12 @@ void reduce_sum(Tensor<T> *x, int axis, Tensor<T> *ones, Tensor<T> *out) {
         if (T_IS_VECTOR(x) || T_IS_SCALAR(x)) {
             /* simple sum all the elements of x */
             unsigned int size = x->get_size();
-            out_ptr[0] = (T) 0;
-            for (unsigned int i = 0; i < size; i++) {
-                out_ptr[0] += x_ptr[i];
-            }
+            out_ptr[0] = ::magmadnn::internal::parallel_reduce_sum<T>(
+                size, ::magmadnn::internal::PARALLEL_GRAIN_SIZE, [&](std::size_t begin, std::size_t end) {
+                    T partial = (T) 0;
+                    for (unsigned int i = begin; i < end; i++) partial += x_ptr[i];
+                    return partial;
+                });
         } else if (T_IS_MATRIX(x)) {
             /* use gemv to compute row-sum or col-sum */
             if (axis == 0) {
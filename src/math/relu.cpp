@@ -8,6 +8,8 @@
  */
 #include "math/relu.h"
 
+#include "math/elementwise.h"
+
 #include <cassert>
 
 #if defined(MAGMADNN_CMAKE_BUILD)
@@ -22,13 +24,7 @@ void relu(Tensor<T> *x, Tensor<T> *out) {
     assert(T_IS_SAME_MEMORY_TYPE(x, out));
 
     if (out->get_memory_type() == HOST) {
-        T *x_ptr = x->get_ptr();
-        T *out_ptr = out->get_ptr();
-        unsigned int size = out->get_size();
-
-        for (unsigned int i = 0; i < size; i++) {
-            out_ptr[i] = (x_ptr[i] > static_cast<T>(0)) ? x_ptr[i] : static_cast<T>(0);
-        }
+        elementwise_unary(out->get_size(), x->get_ptr(), out->get_ptr(), relu_functor<T>());
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
@@ -45,14 +41,7 @@ void relu_grad(Tensor<T> *x, Tensor<T> *relu_out, Tensor<T> *grad, Tensor<T> *ou
     assert(T_IS_SAME_MEMORY_TYPE(x, grad) && T_IS_SAME_MEMORY_TYPE(grad, out));
 
     if (out->get_memory_type() == HOST) {
-        T *x_ptr = x->get_ptr();
-        T *grad_ptr = grad->get_ptr();
-        T *out_ptr = out->get_ptr();
-        unsigned int size = out->get_size();
-
-        for (unsigned int i = 0; i < size; i++) {
-            out_ptr[i] = (x_ptr[i] > static_cast<T>(0)) ? grad_ptr[i] : static_cast<T>(0);
-        }
+        elementwise_binary(out->get_size(), x->get_ptr(), grad->get_ptr(), out->get_ptr(), relu_grad_functor<T>());
     }
 #if defined(MAGMADNN_HAVE_CUDA)
     else {
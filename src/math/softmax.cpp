@@ -10,6 +10,8 @@
 
 #include <cassert>
 
+#include "magmadnn/parallel.h"
+
 namespace magmadnn {
 namespace math {
 
@@ -20,34 +22,36 @@ void softmax(Tensor<T> *x, Tensor<T> *out) {
 
         T *x_ptr = x->get_ptr();
         T *out_ptr = out->get_ptr();
-        T x_max = x_ptr[0];
-        T exps_sum = (T) 0;
         unsigned int x_rows = x->get_shape(0);
         unsigned int x_cols = x->get_shape(1);
 
         /* for each row in x, compute the softmax function */
-        for (unsigned int i = 0; i < x_rows; i++) {
-            x_max = x_ptr[i * x_cols + 0];
-            exps_sum = (T) 0;
-
-            /* compute max of this row */
-            for (unsigned int j = 1; j < x_cols; j++) {
-                if (x_ptr[i * x_cols + j] > x_max) {
-                    x_max = x_ptr[i * x_cols + j];
+        auto softmax_rows = [&](std::size_t begin, std::size_t end) {
+            for (unsigned int i = begin; i < end; i++) {
+                T x_max = x_ptr[i * x_cols + 0];
+                T exps_sum = (T) 0;
+
+                /* compute max of this row */
+                for (unsigned int j = 1; j < x_cols; j++) {
+                    if (x_ptr[i * x_cols + j] > x_max) {
+                        x_max = x_ptr[i * x_cols + j];
+                    }
                 }
-            }
 
-            /* softmax = exp(x-max). also keep track of sum of exps */
-            for (unsigned int j = 0; j < x_cols; j++) {
-                out_ptr[i * x_cols + j] = exp(x_ptr[i * x_cols + j] - x_max);
-                exps_sum += out_ptr[i * x_cols + j];
-            }
+                /* softmax = exp(x-max). also keep track of sum of exps */
+                for (unsigned int j = 0; j < x_cols; j++) {
+                    out_ptr[i * x_cols + j] = exp(x_ptr[i * x_cols + j] - x_max);
+                    exps_sum += out_ptr[i * x_cols + j];
+                }
 
-            /* normalize by the sum */
-            for (unsigned int j = 0; j < x_cols; j++) {
-                out_ptr[i * x_cols + j] /= exps_sum;
+                /* normalize by the sum */
+                for (unsigned int j = 0; j < x_cols; j++) {
+                    out_ptr[i * x_cols + j] /= exps_sum;
+                }
             }
-        }
+        };
+        ::magmadnn::internal::parallel_for(x_rows, ::magmadnn::internal::PARALLEL_GRAIN_SIZE / x_cols + 1,
+                                           softmax_rows);
     } else {
         fprintf(stderr, "For softmax on GPU, please use softmax_device\n");
     }
@@ -68,20 +72,22 @@ void softmax_grad(Tensor<T> *softmax, Tensor<T> *grad, Tensor<T> *out) {
         unsigned int n_rows = out->get_shape(0);
         unsigned int n_cols = out->get_shape(1);
         bool grad_is_scalar = T_IS_SCALAR(grad);
-        T sum;
 
-        for (unsigned int i = 0; i < n_rows; i++) {
-            sum = (T) 0;
-            for (unsigned int j = 0; j < n_cols; j++) {
-                sum += grad_ptr[(grad_is_scalar) ? 0 : (i * n_cols + j)] * softmax_ptr[i * n_cols + j];
-            }
+        auto softmax_grad_rows = [&](std::size_t begin, std::size_t end) {
+            for (unsigned int i = begin; i < end; i++) {
+                T sum = (T) 0;
+                for (unsigned int j = 0; j < n_cols; j++) {
+                    sum += grad_ptr[(grad_is_scalar) ? 0 : (i * n_cols + j)] * softmax_ptr[i * n_cols + j];
+                }
 
-            for (unsigned int j = 0; j < n_cols; j++) {
-                out_ptr[i * n_cols + j] =
-                    (grad_ptr[(grad_is_scalar) ? 0 : (i * n_cols + j)] - sum) * softmax_ptr[i * n_cols + j];
+                for (unsigned int j = 0; j < n_cols; j++) {
+                    out_ptr[i * n_cols + j] =
+                        (grad_ptr[(grad_is_scalar) ? 0 : (i * n_cols + j)] - sum) * softmax_ptr[i * n_cols + j];
+                }
             }
-        }
-
+        };
+        ::magmadnn::internal::parallel_for(n_rows, ::magmadnn::internal::PARALLEL_GRAIN_SIZE / n_cols + 1,
+                                           softmax_grad_rows);
     }
 #if defined(_HAS_CUDA_)
     else {
@@ -8,8 +8,15 @@
  */
 #include "math/sum.h"
 
+#include <algorithm>
 #include <cassert>
 
+#include "magmadnn/parallel.h"
+#include "math/elementwise.h"
+
+/* number of elements of out kept in cache while every input is accumulated into it */
+#define SUM_CHUNK_SIZE 2048
+
 namespace magmadnn {
 namespace math {
 
@@ -21,31 +28,40 @@ void sum(const std::vector<Tensor<T>*>& tensors, Tensor<T>* out) {
     /* iterate over all the tensors and ensure the same memory type */
     for (const auto& t : tensors) {
         assert(T_IS_SAME_MEMORY_TYPE(out, t));
+        assert(t->get_size() == out->get_size() || t->get_size() == 1);
     }
 
     if (out->get_memory_type() == HOST) {
         T* out_ptr = out->get_ptr();
-        T* t_ptr;
         unsigned int size = out->get_size();
+        unsigned int n_tensors = tensors.size();
 
-        /* iterate over tensors first for cache efficiency */
-        for (typename std::vector<Tensor<T>*>::const_iterator it = tensors.begin(); it != tensors.end(); it++) {
-            t_ptr = (*it)->get_ptr(); /* get the pointer to this tensors memory */
+        /* walk out in cache sized chunks and accumulate every tensor into each chunk before moving on, so out is
+           only streamed through memory once. */
+        ::magmadnn::internal::parallel_for(
+            size, ::magmadnn::internal::PARALLEL_GRAIN_SIZE, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t c_begin = begin; c_begin < end; c_begin += SUM_CHUNK_SIZE) {
+                    unsigned int len = std::min<std::size_t>(SUM_CHUNK_SIZE, end - c_begin);
+                    T* o = out_ptr + c_begin;
 
-            if (it == tensors.begin()) {
-                /* assign if we're the first element */
-                for (unsigned int i = 0; i < size; i++) {
-                    out_ptr[i] = t_ptr[i];
-                }
-            } else {
-                /* continue to accumulate after first element */
-                for (unsigned int i = 0; i < size; i++) {
-                    out_ptr[i] += t_ptr[i];
+                    if (tensors[0]->get_size() == 1 && size != 1) {
+                        std::fill(o, o + len, tensors[0]->get_ptr()[0]);
+                    } else if (tensors[0]->get_ptr() != out_ptr) {
+                        std::copy(tensors[0]->get_ptr() + c_begin, tensors[0]->get_ptr() + c_begin + len, o);
+                    }
+
+                    for (unsigned int t = 1; t < n_tensors; t++) {
+                        if (tensors[t]->get_size() == 1 && size != 1) {
+                            elementwise_unary(len, (const T*) o, o, shift_functor<T>(tensors[t]->get_ptr()[0]));
+                        } else {
+                            elementwise_binary(len, (const T*) o, (const T*) tensors[t]->get_ptr() + c_begin, o,
+                                               add_functor<T>());
+                        }
+                    }
                 }
-            }
-        }
+            });
     }
-#if defined(_HAS_CUDA_)
+#if defined(MAGMADNN_HAVE_CUDA)
     else {
         sum_device(tensors, out);
     }
@@ -57,3 +73,5 @@ template void sum(const std::vector<Tensor<double>*>& tensors, Tensor<double>* o
 
 }  // namespace math
 }  // namespace magmadnn
+
+#undef SUM_CHUNK_SIZE
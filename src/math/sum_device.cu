@@ -13,46 +13,54 @@
 #define BLK_DIM 1024
 #define BLK2D_DIM 32
 
+/* number of input pointers passed to one kernel launch by value */
+#define SUM_MAX_TENSORS 16
+
 namespace magmadnn {
 namespace math {
 
 template <typename T>
-__global__ void kernel_sum_device(T** tensors, T* out, unsigned int size, unsigned int n_tensors) {
+struct sum_device_args {
+    const T* tensors[SUM_MAX_TENSORS];
+    bool scalar[SUM_MAX_TENSORS]; /* broadcast element 0 */
+    unsigned int n_tensors;
+};
+
+template <typename T>
+__global__ void kernel_sum_device(sum_device_args<T> args, T* out, unsigned int size, bool accumulate) {
     unsigned int idx = blockDim.x * blockIdx.x + threadIdx.x;
     unsigned int stride = gridDim.x * blockDim.x;
 
+    /* every element of out is read and written once per launch */
     for (unsigned int i = idx; i < size; i += stride) {
-        out[i] = tensors[0][i];
-    }
+        T acc = (accumulate) ? out[i] : args.tensors[0][(args.scalar[0]) ? 0 : i];
 
-    /* x_idx will span the individual tensor sizes */
-    for (unsigned int t = 1; t < n_tensors; t++) {
-        for (unsigned int i = idx; i < size; i += stride) {
-            out[i] += tensors[t][i];
+        for (unsigned int t = (accumulate) ? 0 : 1; t < args.n_tensors; t++) {
+            acc += args.tensors[t][(args.scalar[t]) ? 0 : i];
         }
+        out[i] = acc;
     }
 }
 
 template <typename T>
 void sum_device(const std::vector<Tensor<T>*>& tensors, Tensor<T>* out) {
     unsigned int size = out->get_size();
-
-    T** tensors_arr, **host_tensors_arr;
-    host_tensors_arr = (T**) malloc(tensors.size() * sizeof(T*));
-    cudaErrchk(cudaMalloc((void**) &tensors_arr, tensors.size() * sizeof(T*)));
-    
-    for (unsigned int i = 0; i < tensors.size(); i++) {
-        host_tensors_arr[i] = tensors[i]->get_ptr();
-    }
-    
-    cudaErrchk(cudaMemcpy(tensors_arr, host_tensors_arr, tensors.size() * sizeof(T*), cudaMemcpyHostToDevice));
-
     const auto grid_dim = ceildiv(size, BLK_DIM);
 
-    kernel_sum_device<<<grid_dim, BLK_DIM>>>(tensors_arr, out->get_ptr(), size, tensors.size());
+    /* the input pointers travel in the kernel arguments, so nothing is allocated or copied per call. More than
+       SUM_MAX_TENSORS inputs take one extra accumulating launch per group. */
+    for (unsigned int first = 0; first < tensors.size(); first += SUM_MAX_TENSORS) {
+        sum_device_args<T> args;
+        args.n_tensors = 0;
+        for (unsigned int t = first; t < tensors.size() && args.n_tensors < SUM_MAX_TENSORS; t++) {
+            args.scalar[args.n_tensors] = (tensors[t]->get_size() == 1 && size != 1);
+            args.tensors[args.n_tensors++] = tensors[t]->get_ptr();
+        }
 
-    cudaErrchk(cudaFree(tensors_arr));
-    free(host_tensors_arr);
+        kernel_sum_device
+           <<<grid_dim, BLK_DIM, 0, out->get_custream()>>>
+           (args, out->get_ptr(), size, first != 0);
+    }
 }
 template void sum_device(const std::vector<Tensor<int>*>& tensors, Tensor<int>* out);
 template void sum_device(const std::vector<Tensor<float>*>& tensors, Tensor<float>* out);
@@ -63,3 +71,4 @@ template void sum_device(const std::vector<Tensor<double>*>& tensors, Tensor<dou
 
 #undef BLK_DIM
 #undef BLK2D_DIM
+#undef SUM_MAX_TENSORS
@@ -8,8 +8,11 @@
  */
 #include "math/tile.h"
 
+#include <algorithm>
 #include <cassert>
 
+#include "magmadnn/parallel.h"
+
 namespace magmadnn {
 namespace math {
 
@@ -32,6 +35,26 @@ void tile(Tensor<T> *A, Tensor<T> *B, unsigned int t, unsigned int axis) {
     assert(diff_index_B == axis);
     assert(B->get_shape(axis) == A->get_shape(axis) * t);
 
+    if (B->get_memory_type() == HOST) {
+        /* B[o, j, r] = A[o, 0, r] where o runs over the axes before `axis` and r over the axes after it */
+        T *a_ptr = A->get_ptr();
+        T *b_ptr = B->get_ptr();
+        std::size_t outer = 1, rest = 1;
+        for (unsigned int i = 0; i < axis; i++) outer *= B->get_shape(i);
+        for (unsigned int i = axis + 1; i < dims; i++) rest *= B->get_shape(i);
+        std::size_t a_axis = A->get_shape(axis), b_axis = B->get_shape(axis);
+
+        ::magmadnn::internal::parallel_for(
+            outer * b_axis, ::magmadnn::internal::PARALLEL_GRAIN_SIZE / rest + 1,
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t row = begin; row < end; row++) {
+                    const T *src = a_ptr + (row / b_axis) * a_axis * rest;
+                    std::copy(src, src + rest, b_ptr + row * rest);
+                }
+            });
+        return;
+    }
+
     // actual tiling
     std::vector<unsigned int> target_shape(dims, 0);
     std::vector<unsigned int> target_shape_copy(dims, 0);
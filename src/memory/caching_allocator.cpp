@@ -0,0 +1,315 @@
+/**
+ * @file caching_allocator.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "memory/caching_allocator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "magmadnn/utilities_internal.h"
+
+namespace magmadnn {
+namespace memory {
+
+namespace {
+
+/* smallest block; also the granularity of small requests */
+const std::size_t MIN_BLOCK_SIZE = 512;
+
+/* rounds bytes up to one of four classes per power of two, so a block is at most 25% larger than the request */
+std::size_t size_class(std::size_t bytes) {
+    if (bytes <= MIN_BLOCK_SIZE) return MIN_BLOCK_SIZE;
+
+    std::size_t pow2 = MIN_BLOCK_SIZE;
+    while (pow2 * 2 < bytes) pow2 *= 2;
+
+    std::size_t step = pow2 / 4;
+    return (bytes + step - 1) / step * step;
+}
+
+bool default_caching() {
+    const char *env = std::getenv("MAGMADNN_CACHING_ALLOCATOR");
+    return env == NULL || std::atoi(env) != 0;
+}
+
+bool caching_enabled = default_caching();
+
+struct block_t {
+    void *ptr;
+    std::size_t size;
+#if defined(MAGMADNN_HAVE_CUDA)
+    cudaStream_t stream; /* stream that last used the block */
+    cudaEvent_t event;   /* recorded on stream when the block was freed */
+#endif
+};
+
+/* one allocator: the free lists per size class, and the blocks that are handed out */
+struct pool_t {
+    std::map<std::size_t, std::vector<block_t>> free_blocks;
+    std::unordered_map<void *, block_t> live;
+    allocator_stats_t stats;
+
+    pool_t() : stats({0, 0, 0, 0, 0}) {}
+
+    void hand_out(const block_t &block) {
+        this->live[block.ptr] = block;
+        this->stats.bytes_in_use += block.size;
+        if (this->stats.bytes_in_use > this->stats.peak_bytes_in_use) {
+            this->stats.peak_bytes_in_use = this->stats.bytes_in_use;
+        }
+    }
+};
+
+/* never destroyed, so that tensors with static storage can still free their memory at exit */
+std::mutex &allocator_mutex() {
+    static std::mutex *mutex = new std::mutex;
+    return *mutex;
+}
+
+pool_t &host_pool() {
+    static pool_t *pool = new pool_t;
+    return *pool;
+}
+
+void trim_host(pool_t &pool) {
+    for (auto &entry : pool.free_blocks) {
+        for (unsigned int i = 0; i < entry.second.size(); i++) {
+            std::free(entry.second[i].ptr);
+            pool.stats.n_system_frees++;
+        }
+    }
+    pool.free_blocks.clear();
+    pool.stats.bytes_cached = 0;
+}
+
+#if defined(MAGMADNN_HAVE_CUDA)
+pool_t &device_pool(int device) {
+    static std::map<int, pool_t> *pools = new std::map<int, pool_t>;
+    return (*pools)[device];
+}
+
+std::vector<int> &device_pool_ids() {
+    static std::vector<int> *ids = new std::vector<int>;
+    return *ids;
+}
+
+void trim_device(pool_t &pool) {
+    for (auto &entry : pool.free_blocks) {
+        for (unsigned int i = 0; i < entry.second.size(); i++) {
+            block_t &block = entry.second[i];
+
+            if (block.event != NULL) {
+                cudaErrchk(cudaEventSynchronize(block.event));
+                cudaErrchk(cudaEventDestroy(block.event));
+            }
+            cudaErrchk(cudaFree(block.ptr));
+            pool.stats.n_system_frees++;
+        }
+    }
+    pool.free_blocks.clear();
+    pool.stats.bytes_cached = 0;
+}
+#endif
+
+}  // namespace
+
+void *host_malloc(std::size_t bytes) {
+    if (bytes == 0) return NULL;
+
+    std::lock_guard<std::mutex> lock(allocator_mutex());
+    pool_t &pool = host_pool();
+    block_t block;
+
+    block.size = size_class(bytes);
+#if defined(MAGMADNN_HAVE_CUDA)
+    block.stream = NULL;
+    block.event = NULL;
+#endif
+
+    std::vector<block_t> &cached = pool.free_blocks[block.size];
+    if (!cached.empty()) {
+        block = cached.back();
+        cached.pop_back();
+        pool.stats.bytes_cached -= block.size;
+    } else {
+        block.ptr = std::malloc(block.size);
+        if (block.ptr == NULL && pool.stats.bytes_cached != 0) {
+            trim_host(pool);
+            block.ptr = std::malloc(block.size);
+        }
+        if (block.ptr == NULL) return NULL;
+        pool.stats.n_system_allocs++;
+    }
+
+    pool.hand_out(block);
+    return block.ptr;
+}
+
+void host_free(void *ptr) {
+    if (ptr == NULL) return;
+
+    std::lock_guard<std::mutex> lock(allocator_mutex());
+    pool_t &pool = host_pool();
+
+    auto it = pool.live.find(ptr);
+    if (it == pool.live.end()) {
+        fprintf(stderr, "host_free: pointer was not allocated by host_malloc.\n");
+        return;
+    }
+    block_t block = it->second;
+    pool.live.erase(it);
+    pool.stats.bytes_in_use -= block.size;
+
+    if (caching_enabled) {
+        pool.free_blocks[block.size].push_back(block);
+        pool.stats.bytes_cached += block.size;
+    } else {
+        std::free(block.ptr);
+        pool.stats.n_system_frees++;
+    }
+}
+
+#if defined(MAGMADNN_HAVE_CUDA)
+void *device_malloc(std::size_t bytes, cudaStream_t stream) {
+    if (bytes == 0) return NULL;
+
+    int device;
+    cudaErrchk(cudaGetDevice(&device));
+
+    std::lock_guard<std::mutex> lock(allocator_mutex());
+    pool_t &pool = device_pool(device);
+    std::size_t size = size_class(bytes);
+    std::vector<block_t> &cached = pool.free_blocks[size];
+    int found = -1;
+
+    /* a block last used on this stream is ordered before any new work on it */
+    for (int i = (int) cached.size() - 1; i >= 0 && found < 0; i--) {
+        if (cached[i].stream == stream) found = i;
+    }
+    /* from another stream only once its work is done, rather than waiting for it */
+    for (int i = (int) cached.size() - 1; i >= 0 && found < 0; i--) {
+        if (cached[i].event == NULL || cudaEventQuery(cached[i].event) == cudaSuccess) found = i;
+    }
+
+    block_t block;
+    if (found >= 0) {
+        block = cached[found];
+        cached.erase(cached.begin() + found);
+        pool.stats.bytes_cached -= block.size;
+    } else {
+        block.size = size;
+        block.event = NULL;
+
+        if (cudaMalloc(&block.ptr, block.size) != cudaSuccess) {
+            /* clear the error and retry with the cache given back */
+            cudaGetLastError();
+            trim_device(pool);
+            if (cudaMalloc(&block.ptr, block.size) != cudaSuccess) {
+                cudaGetLastError();
+                return NULL;
+            }
+        }
+        pool.stats.n_system_allocs++;
+
+        if (pool.stats.n_system_allocs == 1) device_pool_ids().push_back(device);
+    }
+    block.stream = stream;
+
+    pool.hand_out(block);
+    return block.ptr;
+}
+
+void device_free(void *ptr, cudaStream_t stream) {
+    if (ptr == NULL) return;
+
+    int device;
+    cudaErrchk(cudaGetDevice(&device));
+
+    std::lock_guard<std::mutex> lock(allocator_mutex());
+
+    /* the block may have been allocated on another device than the current one */
+    pool_t *pool = &device_pool(device);
+    auto it = pool->live.find(ptr);
+    for (unsigned int i = 0; i < device_pool_ids().size() && it == pool->live.end(); i++) {
+        pool = &device_pool(device_pool_ids()[i]);
+        it = pool->live.find(ptr);
+    }
+    if (it == pool->live.end()) {
+        fprintf(stderr, "device_free: pointer was not allocated by device_malloc.\n");
+        return;
+    }
+    block_t block = it->second;
+    pool->live.erase(it);
+    pool->stats.bytes_in_use -= block.size;
+
+    if (!caching_enabled) {
+        if (block.event != NULL) cudaErrchk(cudaEventDestroy(block.event));
+        cudaErrchk(cudaFree(block.ptr));
+        pool->stats.n_system_frees++;
+        return;
+    }
+
+    if (block.event == NULL) cudaErrchk(cudaEventCreateWithFlags(&block.event, cudaEventDisableTiming));
+    cudaErrchk(cudaEventRecord(block.event, stream));
+    block.stream = stream;
+
+    pool->free_blocks[block.size].push_back(block);
+    pool->stats.bytes_cached += block.size;
+}
+#endif
+
+allocator_stats_t get_allocator_stats(memory_t mem_type) {
+    std::lock_guard<std::mutex> lock(allocator_mutex());
+
+#if defined(MAGMADNN_HAVE_CUDA)
+    if (mem_type == DEVICE) {
+        int device;
+        cudaErrchk(cudaGetDevice(&device));
+        return device_pool(device).stats;
+    }
+#endif
+    (void) mem_type;
+    return host_pool().stats;
+}
+
+void reset_peak_bytes_in_use(memory_t mem_type) {
+    std::lock_guard<std::mutex> lock(allocator_mutex());
+    pool_t *pool = &host_pool();
+
+#if defined(MAGMADNN_HAVE_CUDA)
+    if (mem_type == DEVICE) {
+        int device;
+        cudaErrchk(cudaGetDevice(&device));
+        pool = &device_pool(device);
+    }
+#endif
+    (void) mem_type;
+    pool->stats.peak_bytes_in_use = pool->stats.bytes_in_use;
+}
+
+void trim_allocator_cache() {
+    std::lock_guard<std::mutex> lock(allocator_mutex());
+
+    trim_host(host_pool());
+#if defined(MAGMADNN_HAVE_CUDA)
+    for (unsigned int i = 0; i < device_pool_ids().size(); i++) trim_device(device_pool(device_pool_ids()[i]));
+#endif
+}
+
+void set_allocator_caching(bool enabled) {
+    std::lock_guard<std::mutex> lock(allocator_mutex());
+    caching_enabled = enabled;
+}
+
+bool get_allocator_caching() { return caching_enabled; }
+
+}  // namespace memory
+}  // namespace magmadnn
@@ -12,11 +12,13 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <utility>
 
 #if defined(MAGMADNN_CMAKE_BUILD)
 #include "magmadnn/config.h"
 #endif
 #include "magmadnn/utilities_internal.h"
+#include "memory/caching_allocator.h"
 #if defined(MAGMADNN_HAVE_CUDA)
 #include "memory/memory_internal_device.h"
 #endif
@@ -25,7 +27,7 @@ namespace magmadnn {
 
 template <typename T>
 MemoryManager<T>::MemoryManager(unsigned int size, memory_t mem_type, device_t device_id)
-    : mem_type(mem_type), size(size) {
+    : mem_type(mem_type), size(size), owns(true) {
     set_device(device_id);
 
     // initialize based on the chosen memory type
@@ -49,25 +51,53 @@ MemoryManager<T>::MemoryManager(unsigned int size, memory_t mem_type, device_t d
     }
 }
 
+template <typename T>
+MemoryManager<T>::MemoryManager(unsigned int size, memory_t mem_type, device_t device_id, T* ptr)
+    : mem_type(mem_type), size(size), owns(false) {
+    set_device(device_id);
+
+    switch (mem_type) {
+        case HOST:
+            host_ptr = ptr;
+            break;
+#if defined(MAGMADNN_HAVE_CUDA)
+        case DEVICE:
+            this->set_custream(nullptr);
+            device_ptr = ptr;
+            break;
+        case CUDA_MANAGED:
+            this->set_custream(nullptr);
+            cuda_managed_ptr = ptr;
+            break;
+        case MANAGED:
+            /* keeps a host and a device copy, so there is nothing to wrap */
+            fprintf(stderr, "Cannot use external MANAGED memory.\n");
+            owns = true;
+            init_managed();
+            break;
+#endif
+        default:
+            fprintf(stderr, "Invalid memory type.\n");
+    }
+}
+
 template <typename T>
 void MemoryManager<T>::init_host() {
-    // TODO: replace use of `malloc` with `new`
-    host_ptr = (T*) std::malloc(size * sizeof(T));
+    host_ptr = (T*) memory::host_malloc(size * sizeof(T));
 }
 
 #if defined(MAGMADNN_HAVE_CUDA)
 template <typename T>
 void MemoryManager<T>::init_device() {
     this->set_custream(nullptr);
-    cudaErrchk(cudaMalloc((void**) &device_ptr, size * sizeof(T)));
+    device_ptr = (T*) memory::device_malloc(size * sizeof(T), this->custream_);
 }
 
 template <typename T>
 void MemoryManager<T>::init_managed() {
     this->set_custream(nullptr);
-    // TODO: replace use of `malloc` with `new`
-    host_ptr = (T*) std::malloc(size * sizeof(T));
-    cudaErrchk(cudaMalloc((void**) &device_ptr, size * sizeof(T)));
+    host_ptr = (T*) memory::host_malloc(size * sizeof(T));
+    device_ptr = (T*) memory::device_malloc(size * sizeof(T), this->custream_);
 }
 
 template <typename T>
@@ -79,7 +109,7 @@ void MemoryManager<T>::init_cuda_managed() {
 
 template <typename T>
 MemoryManager<T>::MemoryManager(const MemoryManager& that)
-    : mem_type(that.mem_type), device_id(that.device_id), size(that.size) {
+    : mem_type(that.mem_type), device_id(that.device_id), size(that.size), owns(true) {
     this->copy_from(that);
 }
 
@@ -96,20 +126,24 @@ MemoryManager<T>& MemoryManager<T>::operator=(const MemoryManager<T>& that) {
 
 template <typename T>
 MemoryManager<T>::~MemoryManager<T>() {
+    free_memory();
+}
+
+template <typename T>
+void MemoryManager<T>::free_memory() {
+    if (!owns) return;
+
     switch (mem_type) {
         case HOST:
-            // TODO: replace use of `free` with `delete`
-            std::free(host_ptr);
+            memory::host_free(host_ptr);
             break;
 #if defined(MAGMADNN_HAVE_CUDA)
         case DEVICE:
-            cudaErrchk(cudaFree(device_ptr));
+            memory::device_free(device_ptr, this->custream_);
             break;
         case MANAGED:
-            // TODO: replace use of `free` with `delete`
-            std::free(host_ptr);
-            break;
-            cudaErrchk(cudaFree(device_ptr));
+            memory::host_free(host_ptr);
+            memory::device_free(device_ptr, this->custream_);
             break;
         case CUDA_MANAGED:
             cudaErrchk(cudaFree(cuda_managed_ptr));
@@ -433,6 +467,78 @@ magmadnn_error_t MemoryManager<T>::zero() {
     return (magmadnn_error_t) 1;
 }
 
+template <typename T>
+magmadnn_error_t MemoryManager<T>::use_external_memory(T* ptr, bool copy_contents) {
+    T* old_ptr;
+    bool old_owns = owns;
+    std::size_t sz = size * sizeof(T);
+
+    if (ptr == NULL && owns) return (magmadnn_error_t) 0;
+
+    switch (mem_type) {
+        case HOST:
+            old_ptr = host_ptr;
+            if (ptr == NULL) {
+                init_host();
+            } else {
+                host_ptr = ptr;
+            }
+            if (copy_contents && old_ptr != host_ptr) std::memcpy(host_ptr, old_ptr, sz);
+            if (old_owns) memory::host_free(old_ptr);
+            break;
+#if defined(MAGMADNN_HAVE_CUDA)
+        case DEVICE:
+            old_ptr = device_ptr;
+            if (ptr == NULL) {
+                device_ptr = (T*) memory::device_malloc(sz, this->custream_);
+            } else {
+                device_ptr = ptr;
+            }
+            if (copy_contents && old_ptr != device_ptr) {
+                cudaErrchk(cudaMemcpyAsync(device_ptr, old_ptr, sz, cudaMemcpyDeviceToDevice, this->custream_));
+                cudaErrchk(cudaStreamSynchronize(this->custream_));
+            }
+            if (old_owns) memory::device_free(old_ptr, this->custream_);
+            break;
+        case CUDA_MANAGED:
+            old_ptr = cuda_managed_ptr;
+            if (ptr == NULL) {
+                cudaErrchk(cudaMallocManaged((void**) &cuda_managed_ptr, sz));
+            } else {
+                cuda_managed_ptr = ptr;
+            }
+            if (copy_contents && old_ptr != cuda_managed_ptr) {
+                cudaErrchk(cudaMemcpyAsync(cuda_managed_ptr, old_ptr, sz, cudaMemcpyDefault, this->custream_));
+                cudaErrchk(cudaStreamSynchronize(this->custream_));
+            }
+            if (old_owns) cudaErrchk(cudaFree(old_ptr));
+            break;
+#endif
+        default:
+            /* MANAGED keeps a host and a device copy */
+            return (magmadnn_error_t) 1;
+    }
+
+    owns = (ptr == NULL);
+    return (magmadnn_error_t) 0;
+}
+
+template <typename T>
+magmadnn_error_t MemoryManager<T>::swap_memory(MemoryManager<T>& that) {
+    if (this->mem_type != that.mem_type || this->size != that.size || this->device_id != that.device_id) {
+        return (magmadnn_error_t) 1;
+    }
+    if (!this->owns || !that.owns) return (magmadnn_error_t) 1;
+
+    std::swap(this->host_ptr, that.host_ptr);
+#if defined(MAGMADNN_HAVE_CUDA)
+    std::swap(this->device_ptr, that.device_ptr);
+    std::swap(this->cuda_managed_ptr, that.cuda_managed_ptr);
+#endif
+
+    return (magmadnn_error_t) 0;
+}
+
 /* COMPILE FOR INT, FLOAT, AND DOUBLE */
 template class MemoryManager<int>;
 template class MemoryManager<float>;
@@ -0,0 +1,266 @@
+/**
+ * @file inferencesession.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "model/neuralnetwork/inferencesession.h"
+
+#include <cassert>
+#include <cstdio>
+
+#include "compute/tensor_operations.h"
+#include "math/matmul.h"
+#include "math/softmax.h"
+
+namespace magmadnn {
+namespace model {
+
+template <typename T>
+InferenceSession<T>::InferenceSession(NeuralNetwork<T> *model, unsigned int batch_size)
+    : model(model),
+      batch_size(batch_size),
+      compiled(false),
+      current(NULL),
+      input_buffer(NULL),
+      output_buffer(NULL),
+      host_output(NULL) {
+    unsigned int model_batch_size = model->network_input_tensor()->get_shape(0);
+    if (this->batch_size == 0 || this->batch_size > model_batch_size) {
+        std::fprintf(stderr, "InferenceSession batch size has to be in [1, %u].\n", model_batch_size);
+        this->batch_size = model_batch_size;
+    }
+
+    this->compiled = this->compile();
+    if (this->compiled) return;
+
+    /* run on the graph instead */
+    for (unsigned int i = 0; i < this->buffers.size(); i++) delete this->buffers[i];
+    for (unsigned int i = 0; i < this->steps.size(); i++) {
+        if (this->steps[i].bias_rows != NULL) delete this->steps[i].bias_rows;
+    }
+    this->buffers.clear();
+    this->steps.clear();
+    this->batch_size = model_batch_size;
+
+    std::vector<layer::Layer<T> *> layers = model->get_layers();
+    for (unsigned int i = 0; i < layers.size(); i++) {
+        op::DropoutOp<T> *dropout = dynamic_cast<op::DropoutOp<T> *>(layers[i]->out());
+        op::BatchNormOp<T> *batchnorm = dynamic_cast<op::BatchNormOp<T> *>(layers[i]->out());
+        if (dropout != NULL) this->graph_dropout_ops.push_back(dropout);
+        if (batchnorm != NULL) this->graph_batchnorm_ops.push_back(batchnorm);
+    }
+
+    if (model->memory_type() != HOST) {
+        this->host_output = new Tensor<T>(model->network_output_tensor()->get_shape(), {NONE, {}}, HOST);
+    }
+}
+
+template <typename T>
+InferenceSession<T>::~InferenceSession() {
+    for (unsigned int i = 0; i < this->buffers.size(); i++) delete this->buffers[i];
+    for (unsigned int i = 0; i < this->steps.size(); i++) {
+        if (this->steps[i].bias_rows != NULL) delete this->steps[i].bias_rows;
+    }
+    if (this->host_output != NULL) delete this->host_output;
+}
+
+template <typename T>
+bool InferenceSession<T>::compile() {
+    if (this->model->memory_type() != HOST) return false;
+
+    std::vector<layer::Layer<T> *> layers = this->model->get_layers();
+    if (layers.empty() || layers[0]->out()->get_output_tensor() != this->model->network_input_tensor()) return false;
+
+    std::vector<unsigned int> input_shape = layers[0]->out()->get_output_shape();
+    input_shape[0] = this->batch_size;
+    this->input_buffer = new Tensor<T>(input_shape, {ZERO, {}}, HOST);
+    this->buffers.push_back(this->input_buffer);
+    this->current = this->input_buffer;
+
+    op::Operation<T> *previous = layers[0]->out();
+    for (unsigned int i = 1; i < layers.size(); i++) {
+        op::Operation<T> *op = layers[i]->out();
+
+        /* layers like the output layer pass their input through */
+        if (op == previous) continue;
+        previous = op;
+
+        op::LinearForwardOp<T> *linear = dynamic_cast<op::LinearForwardOp<T> *>(op);
+        op::FusedDenseOp<T> *fused = dynamic_cast<op::FusedDenseOp<T> *>(op);
+
+        math::fused_activation_t activation = math::FUSED_IDENTITY;
+        if (dynamic_cast<op::ReluOp<T> *>(op) != NULL) activation = math::FUSED_RELU;
+        if (dynamic_cast<op::SigmoidOp<T> *>(op) != NULL) activation = math::FUSED_SIGMOID;
+        if (dynamic_cast<op::TanhOp<T> *>(op) != NULL) activation = math::FUSED_TANH;
+
+        /* the activation of the last dense step, if it does not have one yet */
+        step_t *last_dense = NULL;
+        if (!this->steps.empty() && this->steps.back().kind == STEP_DENSE &&
+            this->steps.back().activation == math::FUSED_IDENTITY) {
+            last_dense = &this->steps.back();
+        }
+
+        if (dynamic_cast<op::DropoutOp<T> *>(op) != NULL) {
+            /* identity at inference */
+            continue;
+        } else if (dynamic_cast<op::FlattenOp<T> *>(op) != NULL) {
+            /* the buffers are contiguous, so this is only a new shape */
+            this->current->reshape({this->batch_size, this->current->get_size() / this->batch_size});
+        } else if (linear != NULL) {
+            Tensor<T> *bias = (linear->get_bias() != NULL) ? linear->get_bias()->get_output_tensor() : NULL;
+            if (!this->add_dense_step(linear->get_weights()->get_output_tensor(), bias, math::FUSED_IDENTITY)) {
+                return false;
+            }
+        } else if (fused != NULL) {
+            /* the fully connected layer before it still holds the detached LinearForwardOp of the same weights */
+            if (last_dense != NULL && last_dense->weights == fused->get_weights()->get_output_tensor()) {
+                last_dense->activation = fused->get_activation();
+            } else {
+                Tensor<T> *bias = (fused->get_bias() != NULL) ? fused->get_bias()->get_output_tensor() : NULL;
+                if (!this->add_dense_step(fused->get_weights()->get_output_tensor(), bias, fused->get_activation())) {
+                    return false;
+                }
+            }
+        } else if (activation != math::FUSED_IDENTITY) {
+            if (last_dense != NULL) {
+                last_dense->activation = activation;
+            } else {
+                this->steps.push_back({STEP_ACTIVATION, this->current, this->current, NULL, NULL, NULL, activation});
+            }
+        } else if (dynamic_cast<op::SoftmaxOp<T> *>(op) != NULL) {
+            if (this->current->get_shape().size() != 2) return false;
+            this->steps.push_back(
+                {STEP_SOFTMAX, this->current, this->current, NULL, NULL, NULL, math::FUSED_IDENTITY});
+        } else {
+            return false;
+        }
+    }
+
+    this->output_buffer = this->current;
+    return true;
+}
+
+template <typename T>
+bool InferenceSession<T>::add_dense_step(Tensor<T> *weights, Tensor<T> *bias, math::fused_activation_t activation) {
+    if (this->current->get_shape().size() != 2 || this->current->get_shape(1) != weights->get_shape(0)) return false;
+    /* bias has a value per row, so it needs at least as many rows as the session */
+    if (bias != NULL && bias->get_size() < this->batch_size) return false;
+
+    Tensor<T> *out = new Tensor<T>({this->batch_size, weights->get_shape(1)}, {NONE, {}}, HOST);
+    this->buffers.push_back(out);
+
+    Tensor<T> *bias_rows = NULL;
+    if (bias != NULL && bias->get_size() != this->batch_size) {
+        bias_rows = new Tensor<T>({this->batch_size}, {NONE, {}}, HOST);
+    }
+
+    this->steps.push_back({STEP_DENSE, this->current, out, weights, bias, bias_rows, activation});
+    this->current = out;
+    return true;
+}
+
+template <typename T>
+Tensor<T> *InferenceSession<T>::run() {
+    for (unsigned int i = 0; i < this->steps.size(); i++) {
+        step_t &step = this->steps[i];
+
+        switch (step.kind) {
+            case STEP_DENSE: {
+                Tensor<T> *bias = step.bias;
+                if (step.bias_rows != NULL) {
+                    /* copied on every run, so training the model afterwards is seen by the session */
+                    step.bias_rows->copy_from(*step.bias, 0, this->batch_size);
+                    bias = step.bias_rows;
+                }
+                math::matmul((T) 1, false, step.in, false, step.weights, (T) 0, step.out);
+                math::bias_activation_cpu(step.out, bias, step.activation, step.out);
+                break;
+            }
+            case STEP_ACTIVATION:
+                math::bias_activation_cpu(step.in, (Tensor<T> *) NULL, step.activation, step.out);
+                break;
+            case STEP_SOFTMAX:
+                math::softmax(step.in, step.out);
+                break;
+        }
+    }
+    return this->output_buffer;
+}
+
+template <typename T>
+void InferenceSession<T>::set_graph_training(bool training) {
+    for (unsigned int i = 0; i < this->graph_dropout_ops.size(); i++) {
+        this->graph_dropout_ops[i]->set_training(training);
+    }
+    for (unsigned int i = 0; i < this->graph_batchnorm_ops.size(); i++) {
+        this->graph_batchnorm_ops[i]->set_training(training);
+    }
+}
+
+template <typename T>
+std::vector<bool> InferenceSession<T>::get_graph_training() {
+    std::vector<bool> modes;
+    for (unsigned int i = 0; i < this->graph_dropout_ops.size(); i++) {
+        modes.push_back(this->graph_dropout_ops[i]->is_training());
+    }
+    for (unsigned int i = 0; i < this->graph_batchnorm_ops.size(); i++) {
+        modes.push_back(this->graph_batchnorm_ops[i]->is_training());
+    }
+    return modes;
+}
+
+template <typename T>
+void InferenceSession<T>::set_graph_training(const std::vector<bool> &modes) {
+    unsigned int n_dropout = this->graph_dropout_ops.size();
+    for (unsigned int i = 0; i < n_dropout; i++) {
+        this->graph_dropout_ops[i]->set_training(modes[i]);
+    }
+    for (unsigned int i = 0; i < this->graph_batchnorm_ops.size(); i++) {
+        this->graph_batchnorm_ops[i]->set_training(modes[n_dropout + i]);
+    }
+}
+
+template <typename T>
+Tensor<T> *InferenceSession<T>::predict(Tensor<T> *samples) {
+    if (this->compiled) {
+        assert(samples->get_size() <= this->input_buffer->get_size());
+
+        this->input_buffer->copy_from(*samples, 0, samples->get_size());
+        return this->run();
+    }
+
+    /* the graph may already be in inference mode; leave it as it was found */
+    std::vector<bool> previous_modes = this->get_graph_training();
+    this->set_graph_training(false);
+    Tensor<T> *out = this->model->predict(samples);
+    this->set_graph_training(previous_modes);
+    return out;
+}
+
+template <typename T>
+unsigned int InferenceSession<T>::predict_class(Tensor<T> *sample) {
+    Tensor<T> *out = this->predict(sample);
+
+    if (out->get_memory_type() != HOST) {
+        this->host_output->copy_from(*out);
+        out = this->host_output;
+    }
+
+    /* argmax of the first row */
+    const T *out_ptr = out->get_ptr();
+    unsigned int n_classes = out->get_size() / out->get_shape(0);
+    unsigned int best = 0;
+    for (unsigned int j = 1; j < n_classes; j++) {
+        if (out_ptr[j] > out_ptr[best]) best = j;
+    }
+    return best;
+}
+
+template class InferenceSession<int>;
+template class InferenceSession<float>;
+template class InferenceSession<double>;
+
+}  // namespace model
+}  // namespace magmadnn
@@ -8,13 +8,81 @@
  */
 #include "model/neuralnetwork/neuralnetwork.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include "tensor/tensor_io.h"
+
 namespace magmadnn {
 namespace model {
 
+namespace {
+
+/* Checkpoint file layout: this header, n_tensors uint64_t element counts, n_scalars doubles, then every tensor's
+   elements starting at a multiple of 64 bytes, in the byte order of the machine that wrote it. */
+struct checkpoint_header_t {
+    char magic[8]; /* "MDNNCKPT" */
+    uint32_t version;
+    uint32_t byte_order_mark; /* 0x01020304 */
+    uint32_t dtype;           /* io::tensor_dtype_t */
+    uint32_t n_tensors;
+    uint32_t n_scalars;
+    uint32_t reserved;
+    uint64_t epoch;
+    char optimizer_name[64];
+};
+
+const char checkpoint_magic[8] = {'M', 'D', 'N', 'N', 'C', 'K', 'P', 'T'};
+const uint32_t checkpoint_version = 1;
+const uint32_t checkpoint_byte_order_mark = 0x01020304;
+const std::size_t checkpoint_alignment = 64;
+
+std::size_t align_checkpoint_offset(std::size_t offset) {
+    return (offset + checkpoint_alignment - 1) / checkpoint_alignment * checkpoint_alignment;
+}
+
+/* offset of the first tensor's elements */
+std::size_t checkpoint_data_offset(uint32_t n_tensors, uint32_t n_scalars) {
+    return align_checkpoint_offset(sizeof(checkpoint_header_t) + n_tensors * sizeof(uint64_t) +
+                                   n_scalars * sizeof(double));
+}
+
+/* writes the buffer to file_name.tmp and renames it, so that file_name is never left half written */
+magmadnn_error_t write_checkpoint_file(const std::string &file_name, const std::vector<char> &buffer) {
+    std::string tmp_name = file_name + ".tmp";
+    std::FILE *file = std::fopen(tmp_name.c_str(), "wb");
+    if (file == NULL) {
+        std::fprintf(stderr, "Could not open checkpoint %s.\n", tmp_name.c_str());
+        return (magmadnn_error_t) 1;
+    }
+
+    bool failed = std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size();
+    failed = (std::fflush(file) != 0) || failed;
+    failed = (fsync(fileno(file)) != 0) || failed;
+    failed = (std::fclose(file) != 0) || failed;
+    if (failed || std::rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+        std::fprintf(stderr, "Could not write checkpoint %s.\n", file_name.c_str());
+        std::remove(tmp_name.c_str());
+        return (magmadnn_error_t) 1;
+    }
+    return (magmadnn_error_t) 0;
+}
+
+}  // namespace
+
 template <typename T>
 NeuralNetwork<T>::NeuralNetwork(std::vector<layer::Layer<T> *> layers, optimizer::loss_t loss_func,
                                 optimizer::optimizer_t optimizer, nn_params_t params)
-    : Model<T>::Model(), layers(layers), loss_func(loss_func), optimizer(optimizer), model_params(params) {
+    : Model<T>::Model(), layers(layers), loss_func(loss_func), optimizer(optimizer), model_params(params),
+      epoch(0),
+      resume_epoch(0),
+      checkpoint_error((magmadnn_error_t) 0) {
     this->_name = "NeuralNetworkModel";
 
     typename std::vector<layer::Layer<T> *>::iterator vit;
@@ -35,25 +103,8 @@ NeuralNetwork<T>::NeuralNetwork(std::vector<layer::Layer<T> *> layers, optimizer
     this->network_input_tensor_ptr = this->network_input_op_ptr->get_output_tensor();
     this->network_output_tensor_ptr = this->network_output_op_ptr->get_output_tensor();
 
-    /* init ground truth pointers */
-    this->ground_truth_op_ptr =
-        op::var<T>(this->_name + "::ground_truth", {params.batch_size, network_output_tensor_ptr->get_shape().back()},
-                   {NONE, {}}, network_output_tensor_ptr->get_memory_type());
-    this->ground_truth_tensor_ptr = this->ground_truth_op_ptr->get_output_tensor();
-
-    /* init loss function -- _obj */
-    switch (loss_func) {
-        case optimizer::CROSS_ENTROPY:
-            this->_obj = op::crossentropy(this->ground_truth_op_ptr, this->network_output_op_ptr);
-            break;
-        case optimizer::MSE:
-            this->_obj = op::meansquarederror(this->ground_truth_op_ptr, this->network_output_op_ptr);
-            break;
-        default:
-            std::fprintf(stderr, "Unknown loss function.\n");
-            break;
-    }
-    this->_obj_tensor_ptr = this->_obj->get_output_tensor();
+    /* init ground truth and loss function -- _obj */
+    this->init_loss();
 
     /* init optimizer */
     switch (optimizer) {
@@ -74,14 +125,20 @@ NeuralNetwork<T>::NeuralNetwork(std::vector<layer::Layer<T> *> layers, optimizer
             break;
         default:
             std::fprintf(stderr, "Unknown optimizer.\n");
+            this->optim = NULL;
             break;
     }
+
+    if (params.flat_buffers) this->init_flat_buffers();
 }
 
 template <typename T>
 NeuralNetwork<T>::NeuralNetwork(std::vector<layer::Layer<T> *> layers, optimizer::loss_t loss_func,
                                 optimizer::Optimizer<T> *optim, nn_params_t params)
-    : Model<T>::Model(), layers(layers), loss_func(loss_func), model_params(params), optim(optim) {
+    : Model<T>::Model(), layers(layers), loss_func(loss_func), model_params(params), optim(optim),
+      epoch(0),
+      resume_epoch(0),
+      checkpoint_error((magmadnn_error_t) 0) {
     this->_name = "NeuralNetworkModel";
 
     typename std::vector<layer::Layer<T> *>::iterator vit;
@@ -102,16 +159,46 @@ NeuralNetwork<T>::NeuralNetwork(std::vector<layer::Layer<T> *> layers, optimizer
     this->network_input_tensor_ptr = this->network_input_op_ptr->get_output_tensor();
     this->network_output_tensor_ptr = this->network_output_op_ptr->get_output_tensor();
 
+    /* init ground truth and loss function -- _obj */
+    this->init_loss();
+
+    if (params.flat_buffers) this->init_flat_buffers();
+}
+
+template <typename T>
+void NeuralNetwork<T>::init_loss() {
+    unsigned int n_classes = network_output_tensor_ptr->get_shape().back();
+    memory_t mem = network_output_tensor_ptr->get_memory_type();
+    bool sparse = (this->loss_func == optimizer::SPARSE_CROSS_ENTROPY);
+
     /* init ground truth pointers */
-    this->ground_truth_op_ptr =
-        op::var<T>(this->_name + "::ground_truth", {params.batch_size, network_output_tensor_ptr->get_shape().back()},
-                   {NONE, {}}, network_output_tensor_ptr->get_memory_type());
+    if (sparse) {
+        this->ground_truth_op_ptr =
+            op::var<T>(this->_name + "::ground_truth", {this->model_params.batch_size}, {NONE, {}}, mem);
+    } else {
+        this->ground_truth_op_ptr =
+            op::var<T>(this->_name + "::ground_truth", {this->model_params.batch_size, n_classes}, {NONE, {}}, mem);
+    }
     this->ground_truth_tensor_ptr = this->ground_truth_op_ptr->get_output_tensor();
 
-    /* init loss function -- _obj */
-    switch (loss_func) {
+    /* a softmax output feeding cross entropy is computed by the loss from the logits, so training skips the softmax
+       op; predict still evaluates it */
+    op::SoftmaxOp<T> *softmax_output = dynamic_cast<op::SoftmaxOp<T> *>(this->network_output_op_ptr);
+    bool fuse_softmax = (softmax_output != NULL && mem == HOST);
+
+    this->_obj = NULL;
+    this->score_op_ptr = this->network_output_op_ptr;
+    switch (this->loss_func) {
         case optimizer::CROSS_ENTROPY:
-            this->_obj = op::crossentropy(this->ground_truth_op_ptr, this->network_output_op_ptr);
+        case optimizer::SPARSE_CROSS_ENTROPY:
+            if (fuse_softmax) {
+                this->_obj = op::softmax_crossentropy(this->ground_truth_op_ptr, softmax_output->get_input());
+                this->score_op_ptr = softmax_output->get_input();
+            } else if (!sparse) {
+                this->_obj = op::crossentropy(this->ground_truth_op_ptr, this->network_output_op_ptr);
+            } else {
+                std::fprintf(stderr, "Sparse cross entropy needs a softmax output on HOST.\n");
+            }
             break;
         case optimizer::MSE:
             this->_obj = op::meansquarederror(this->ground_truth_op_ptr, this->network_output_op_ptr);
@@ -120,11 +207,13 @@ NeuralNetwork<T>::NeuralNetwork(std::vector<layer::Layer<T> *> layers, optimizer
             std::fprintf(stderr, "Unknown loss function.\n");
             break;
     }
-    this->_obj_tensor_ptr = this->_obj->get_output_tensor();
+    this->score_tensor_ptr = this->score_op_ptr->get_output_tensor();
+    this->_obj_tensor_ptr = (this->_obj != NULL) ? this->_obj->get_output_tensor() : NULL;
 }
 
 template <typename T>
 NeuralNetwork<T>::~NeuralNetwork() {
+    this->wait_for_checkpoint();
     delete optim;
 }
 
@@ -138,7 +227,7 @@ magmadnn_error_t NeuralNetwork<T>::fit(Tensor<T> *x, Tensor<T> *y, metric_t &met
                               HOST); /* this will store the result of the argmax on the output of the network */
     actual = new Tensor<T>({network_output_tensor_ptr->get_shape(0)}, {ZERO, {}},
                            HOST); /* this will store the result of the argmax on the ground_truth */
-    host_network_output_tensor_ptr = new Tensor<T>(network_output_tensor_ptr->get_shape(), {NONE, {}},
+    host_network_output_tensor_ptr = new Tensor<T>(score_tensor_ptr->get_shape(), {NONE, {}},
                                                    HOST); /* used to move network output onto CPU */
     host_ground_truth_tensor_ptr =
         new Tensor<T>(ground_truth_tensor_ptr->get_shape(), {NONE, {}}, HOST); /* used to move ground_truth onto CPU */
@@ -161,11 +250,28 @@ magmadnn_error_t NeuralNetwork<T>::fit(Tensor<T> *x, Tensor<T> *y, metric_t &met
 
     /* main training routine */
     time(&start_time);
-    dataloader::LinearLoader<T> dataloader(x, y, this->model_params.batch_size);
-    for (unsigned int i = 0; i < this->model_params.n_epochs; i++) {
-        for (unsigned int j = 0; j < dataloader.get_num_batches(); j++) {
+    dataloader::DataLoader<T> *source_loader;
+    if (this->model_params.shuffle) {
+        /* keep the batch count of the linear loader, the batch tensors have a fixed size */
+        source_loader = new dataloader::ShuffleLoader<T>(x, y, this->model_params.batch_size, true);
+    } else {
+        source_loader = new dataloader::LinearLoader<T>(x, y, this->model_params.batch_size);
+    }
+    dataloader::DataLoader<T> *loader = source_loader;
+    dataloader::PrefetchLoader<T> *prefetch_loader = NULL;
+    if (this->model_params.prefetch_depth > 0) {
+        prefetch_loader = new dataloader::PrefetchLoader<T>(source_loader, this->model_params.prefetch_depth);
+        loader = prefetch_loader;
+    }
+    /* a restored checkpoint skips the epochs it already trained */
+    unsigned int first_epoch = std::min(this->resume_epoch, this->model_params.n_epochs);
+    unsigned int n_epochs_run = this->model_params.n_epochs - first_epoch;
+    this->resume_epoch = 0;
+    this->epoch = first_epoch;
+    for (unsigned int i = first_epoch; i < this->model_params.n_epochs; i++) {
+        for (unsigned int j = 0; j < loader->get_num_batches(); j++) {
             /* load next batch into x and y */
-            dataloader.next(this->network_input_tensor_ptr, this->ground_truth_tensor_ptr);
+            loader->next(this->network_input_tensor_ptr, this->ground_truth_tensor_ptr);
 
             /* forward pass */
             this->_obj->eval(true); /* forces evaluation */
@@ -174,12 +280,16 @@ magmadnn_error_t NeuralNetwork<T>::fit(Tensor<T> *x, Tensor<T> *y, metric_t &met
             this->optim->minimize(this->_obj, this->_vars);
 
             /* get the argmax of the networks output (on CPU) */
-            host_network_output_tensor_ptr->copy_from(*this->network_output_tensor_ptr);
+            host_network_output_tensor_ptr->copy_from(*this->score_tensor_ptr);
             math::argmax(host_network_output_tensor_ptr, 0, predicted);
 
-            /* get the argmax of the ground truth (on CPU) */
+            /* get the class of the ground truth (on CPU) */
             host_ground_truth_tensor_ptr->copy_from(*this->ground_truth_tensor_ptr);
-            math::argmax(host_ground_truth_tensor_ptr, 0, actual);
+            if (this->loss_func == optimizer::SPARSE_CROSS_ENTROPY) {
+                actual->copy_from(*host_ground_truth_tensor_ptr);
+            } else {
+                math::argmax(host_ground_truth_tensor_ptr, 0, actual);
+            }
 
             /* update the accuracy and loss */
             for (unsigned int j = 0; j < this->model_params.batch_size; j++) {
@@ -191,22 +301,32 @@ magmadnn_error_t NeuralNetwork<T>::fit(Tensor<T> *x, Tensor<T> *y, metric_t &met
             cumulative_loss += this->_obj_tensor_ptr->get(0);
         }
 
+        this->epoch = i + 1;
+
         if (verbose) {
             printf("Epoch (%u/%u): accuracy=%.4g loss=%.4g time=%.4g\n", i, this->model_params.n_epochs,
-                   n_correct / ((double) (i + 1) * n_samples),
-                   cumulative_loss / ((double) (i + 1) * dataloader.get_num_batches()),
+                   n_correct / ((double) (i + 1 - first_epoch) * n_samples),
+                   cumulative_loss / ((double) (i + 1 - first_epoch) * loader->get_num_batches()),
                    (double) time(NULL) - start_time);
         }
 
+        if (this->model_params.checkpoint_every != 0 && this->epoch % this->model_params.checkpoint_every == 0) {
+            this->save_checkpoint(this->model_params.checkpoint_path);
+        }
+
         /* resets dataloader for next epoch */
-        dataloader.reset();
+        loader->reset();
     }
     time(&end_time);
 
     /* update metrics */
-    metric_out.accuracy = ((double) n_correct) / ((double) this->model_params.n_epochs * n_samples);
-    metric_out.loss =
-        ((double) cumulative_loss) / ((double) this->model_params.n_epochs * dataloader.get_num_batches());
+    if (n_epochs_run != 0) {
+        metric_out.accuracy = ((double) n_correct) / ((double) n_epochs_run * n_samples);
+        metric_out.loss = ((double) cumulative_loss) / ((double) n_epochs_run * loader->get_num_batches());
+    } else {
+        metric_out.accuracy = 0.0;
+        metric_out.loss = 0.0;
+    }
     metric_out.training_time = (double) (end_time - start_time);
 
     if (verbose) {
@@ -215,6 +335,8 @@ magmadnn_error_t NeuralNetwork<T>::fit(Tensor<T> *x, Tensor<T> *y, metric_t &met
     }
 
     /* free up any memory we used here */
+    if (prefetch_loader != NULL) delete prefetch_loader;
+    delete source_loader;
     delete predicted;
     delete actual;
     delete host_network_output_tensor_ptr;
@@ -253,6 +375,140 @@ unsigned int NeuralNetwork<T>::predict_class(Tensor<T> *sample) {
     return argmax_tensor.get(0);
 }
 
+template <typename T>
+magmadnn_error_t NeuralNetwork<T>::predict_batch(Tensor<T> *x, Tensor<T> *out) {
+    unsigned int batch_size = this->network_input_tensor_ptr->get_shape(0);
+    unsigned int n_samples = x->get_shape(0);
+    unsigned int sample_size = this->network_input_tensor_ptr->get_size() / batch_size;
+    unsigned int output_size = this->network_output_tensor_ptr->get_size() / batch_size;
+    bool classes = (out->get_shape().size() == 1 && output_size > 1);
+
+    if (x->get_memory_type() != HOST || out->get_memory_type() != HOST) {
+        std::fprintf(stderr, "predict_batch needs x and out on HOST.\n");
+        return (magmadnn_error_t) 1;
+    }
+    if (x->get_size() != n_samples * sample_size || out->get_shape(0) != n_samples ||
+        out->get_size() != n_samples * (classes ? 1 : output_size)) {
+        std::fprintf(stderr, "predict_batch: x or out do not fit the network.\n");
+        return (magmadnn_error_t) 1;
+    }
+    if (n_samples == 0) return (magmadnn_error_t) 0;
+
+    /* the argmax of the logits is that of the softmax, so classes skip a softmax fused into the loss */
+    op::Operation<T> *eval_op = classes ? this->score_op_ptr : this->network_output_op_ptr;
+    Tensor<T> *eval_tensor = eval_op->get_output_tensor();
+    unsigned int n_batches = (n_samples + batch_size - 1) / batch_size;
+
+    /* two host slots each for the inputs and the outputs; batch b uses slot b % 2 */
+    Tensor<T> *staged_x[2], *staged_out[2];
+    for (unsigned int i = 0; i < 2; i++) {
+        staged_x[i] = new Tensor<T>(this->network_input_tensor_ptr->get_shape(), {ZERO, {}}, HOST);
+        staged_out[i] = new Tensor<T>(eval_tensor->get_shape(), {NONE, {}}, HOST);
+    }
+
+    /* copies batch b of x into its slot; the rows after the last sample stay zero */
+    auto gather = [&](unsigned int b) {
+        unsigned int first = b * batch_size;
+        unsigned int n_rows = std::min(batch_size, n_samples - first);
+        T *dst = staged_x[b % 2]->get_ptr();
+        std::memcpy(dst, x->get_ptr() + (std::size_t) first * sample_size, sizeof(T) * n_rows * sample_size);
+        if (n_rows < batch_size) std::fill(dst + n_rows * sample_size, dst + batch_size * sample_size, (T) 0);
+    };
+    /* writes the rows of batch b that are samples from its slot into out */
+    auto scatter = [&](unsigned int b) {
+        unsigned int first = b * batch_size;
+        unsigned int n_rows = std::min(batch_size, n_samples - first);
+        const T *src = staged_out[b % 2]->get_ptr();
+        unsigned int cols = staged_out[b % 2]->get_size() / batch_size;
+        if (!classes) {
+            std::memcpy(out->get_ptr() + (std::size_t) first * cols, src, sizeof(T) * n_rows * cols);
+            return;
+        }
+        for (unsigned int r = 0; r < n_rows; r++) {
+            unsigned int best = 0;
+            for (unsigned int c = 1; c < cols; c++) {
+                if (src[r * cols + c] > src[r * cols + best]) best = c;
+            }
+            out->get_ptr()[first + r] = (T) best;
+        }
+    };
+
+    /* while batch b is evaluated, the worker scatters batch b-1 and gathers batch b+1 */
+    std::mutex mutex;
+    std::condition_variable cv;
+    long requested = -1, finished = -1;
+    bool stopping = false;
+    std::thread worker([&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [&]() { return stopping || requested > finished; });
+            if (requested == finished) break;
+            long b = requested;
+            lock.unlock();
+            if (b > 0) scatter(b - 1);
+            if (b + 1 < (long) n_batches) gather(b + 1);
+            lock.lock();
+            finished = b;
+            cv.notify_all();
+        }
+    });
+
+    /* dropout and batch normalization run in inference mode; each is put back in the mode it was in after */
+    std::vector<op::DropoutOp<T> *> dropout_ops;
+    std::vector<op::BatchNormOp<T> *> batchnorm_ops;
+    std::vector<bool> dropout_modes, batchnorm_modes;
+    for (unsigned int i = 0; i < this->layers.size(); i++) {
+        op::DropoutOp<T> *dropout = dynamic_cast<op::DropoutOp<T> *>(this->layers[i]->out());
+        op::BatchNormOp<T> *batchnorm = dynamic_cast<op::BatchNormOp<T> *>(this->layers[i]->out());
+        if (dropout != NULL) {
+            dropout_ops.push_back(dropout);
+            dropout_modes.push_back(dropout->is_training());
+            dropout->set_training(false);
+        }
+        if (batchnorm != NULL) {
+            batchnorm_ops.push_back(batchnorm);
+            batchnorm_modes.push_back(batchnorm->is_training());
+            batchnorm->set_training(false);
+        }
+    }
+
+    gather(0);
+    for (unsigned int b = 0; b < n_batches; b++) {
+        this->network_input_tensor_ptr->copy_from(*staged_x[b % 2]);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requested = b;
+        }
+        cv.notify_all();
+
+        eval_op->eval(true);
+
+        /* the worker has to be done with slot b % 2 of the outputs (batch b-2) */
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return finished == (long) b; });
+        }
+        staged_out[b % 2]->copy_from(*eval_tensor);
+    }
+    scatter(n_batches - 1);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+
+    for (unsigned int i = 0; i < dropout_ops.size(); i++) dropout_ops[i]->set_training(dropout_modes[i]);
+    for (unsigned int i = 0; i < batchnorm_ops.size(); i++) batchnorm_ops[i]->set_training(batchnorm_modes[i]);
+
+    for (unsigned int i = 0; i < 2; i++) {
+        delete staged_x[i];
+        delete staged_out[i];
+    }
+    return (magmadnn_error_t) 0;
+}
+
 template <typename T>
 void NeuralNetwork<T>::summary() {
     unsigned int name_w = 20, shape_w = 20, params_w = 16;
@@ -283,6 +539,235 @@ void NeuralNetwork<T>::summary() {
     }
 }
 
+template <typename T>
+std::vector<Tensor<T> *> NeuralNetwork<T>::get_checkpoint_tensors() {
+    std::vector<Tensor<T> *> tensors;
+    for (unsigned int i = 0; i < this->_vars.size(); i++) {
+        tensors.push_back(this->_vars[i]->get_output_tensor());
+    }
+    std::vector<Tensor<T> *> state = this->optim->get_state_tensors(this->_vars);
+    tensors.insert(tensors.end(), state.begin(), state.end());
+    return tensors;
+}
+
+template <typename T>
+void NeuralNetwork<T>::init_flat_buffers() {
+    std::vector<Tensor<T> *> params;
+    for (unsigned int i = 0; i < this->_vars.size(); i++) {
+        params.push_back(this->_vars[i]->get_output_tensor());
+    }
+    if (this->flat_params.bind(params) != 0) return;
+
+    /* like the MemoryPlanner, the gradient tensors are created here and handed to the operations before the first
+       backward pass, so that it writes straight into the buffer: the consumer's gradient w.r.t. a weight with one
+       consumer, and the weight's accumulator of the partial gradients otherwise */
+    std::vector<Tensor<T> *> grads;
+    for (unsigned int i = 0; i < this->_vars.size(); i++) {
+        op::Operation<T> *var = this->_vars[i];
+        std::vector<op::Operation<T> *> consumers = var->get_consumers();
+        if (consumers.empty()) {
+            /* the weight is not used; it has no gradient */
+            this->flat_params.unbind();
+            return;
+        }
+
+        op::Operation<T> *owner = (consumers.size() == 1) ? consumers[0] : var;
+        Tensor<T> *grad = new Tensor<T>(params[i]->get_shape(), {NONE, {}}, params[i]->get_memory_type());
+#if defined(MAGMADNN_HAVE_CUDA)
+        grad->set_custream(owner->get_custream());
+        grad->set_cublas_handle(owner->get_cublas_handle());
+#endif
+
+        if (consumers.size() == 1) {
+            /* NULL unless a backward pass already cached a gradient, which the new one replaces */
+            Tensor<T> *current = owner->get_grad_tensor(var);
+            if (current != NULL) owner->release_grad_tensor(var, current);
+            owner->set_grad_tensor(var, grad);
+        } else {
+            owner->set_grad_accumulator(grad);
+        }
+        grads.push_back(grad);
+    }
+    if (this->flat_grads.bind(grads) != 0) {
+        this->flat_params.unbind();
+        return;
+    }
+
+    if (this->optim != NULL) {
+        this->optim->set_flat_buffers(this->_vars, this->flat_params.get_tensor(), this->flat_grads.get_tensor());
+    }
+}
+
+template <typename T>
+bool NeuralNetwork<T>::weights_are_flat() {
+    if (!this->flat_params.is_bound()) return false;
+    for (unsigned int i = 0; i < this->_vars.size(); i++) {
+        if (!this->flat_params.is_view(i, this->_vars[i]->get_output_tensor())) return false;
+    }
+    return true;
+}
+
+template <typename T>
+magmadnn_error_t NeuralNetwork<T>::save_checkpoint(const std::string &file_name, bool blocking) {
+    if (this->optim == NULL) return (magmadnn_error_t) 1;
+
+    /* the buffer is reused, so the previous write has to finish first */
+    this->wait_for_checkpoint();
+
+    std::vector<Tensor<T> *> tensors = this->get_checkpoint_tensors();
+    std::vector<double> scalars = this->optim->get_state_scalars();
+
+    checkpoint_header_t header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, checkpoint_magic, sizeof(header.magic));
+    header.version = checkpoint_version;
+    header.byte_order_mark = checkpoint_byte_order_mark;
+    header.dtype = io::get_tensor_dtype<T>();
+    header.n_tensors = tensors.size();
+    header.n_scalars = scalars.size();
+    header.epoch = this->epoch;
+    std::strncpy(header.optimizer_name, this->optim->get_name().c_str(), sizeof(header.optimizer_name) - 1);
+
+    std::vector<uint64_t> sizes(tensors.size());
+    std::size_t file_size = checkpoint_data_offset(header.n_tensors, header.n_scalars);
+    for (unsigned int i = 0; i < tensors.size(); i++) {
+        sizes[i] = tensors[i]->get_size();
+        file_size = align_checkpoint_offset(file_size + sizes[i] * sizeof(T));
+    }
+
+    this->checkpoint_buffer.resize(file_size);
+    char *buffer = this->checkpoint_buffer.data();
+    std::memset(buffer, 0, checkpoint_data_offset(header.n_tensors, header.n_scalars));
+    std::memcpy(buffer, &header, sizeof(header));
+    std::memcpy(buffer + sizeof(header), sizes.data(), sizes.size() * sizeof(uint64_t));
+    std::memcpy(buffer + sizeof(header) + sizes.size() * sizeof(uint64_t), scalars.data(),
+                scalars.size() * sizeof(double));
+
+    /* snapshot the tensors now; training may change them while the file is written */
+    std::size_t offset = checkpoint_data_offset(header.n_tensors, header.n_scalars);
+    unsigned int first = 0;
+    if (this->weights_are_flat()) {
+        /* the weights are laid out in the flat buffer as in the file, so they are one copy */
+        Tensor<T> snapshot(reinterpret_cast<T *>(buffer + offset), {this->flat_params.get_size()}, HOST);
+        snapshot.copy_from(*this->flat_params.get_tensor());
+        offset += this->flat_params.get_size() * sizeof(T);
+        first = this->_vars.size();
+    }
+    for (unsigned int i = first; i < tensors.size(); i++) {
+        Tensor<T> snapshot(reinterpret_cast<T *>(buffer + offset), {tensors[i]->get_size()}, HOST);
+        snapshot.copy_from(*tensors[i], 0, tensors[i]->get_size());
+        offset = align_checkpoint_offset(offset + sizes[i] * sizeof(T));
+    }
+
+    if (blocking) {
+        return write_checkpoint_file(file_name, this->checkpoint_buffer);
+    }
+
+    this->checkpoint_error = (magmadnn_error_t) 0;
+    this->checkpoint_thread = std::thread(
+        [this, file_name]() { this->checkpoint_error = write_checkpoint_file(file_name, this->checkpoint_buffer); });
+    return (magmadnn_error_t) 0;
+}
+
+template <typename T>
+magmadnn_error_t NeuralNetwork<T>::wait_for_checkpoint() {
+    if (this->checkpoint_thread.joinable()) {
+        this->checkpoint_thread.join();
+    }
+    return this->checkpoint_error;
+}
+
+template <typename T>
+magmadnn_error_t NeuralNetwork<T>::load_checkpoint(const std::string &file_name) {
+    if (this->optim == NULL) return (magmadnn_error_t) 1;
+
+    /* do not read a file that is still being written */
+    this->wait_for_checkpoint();
+
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::fprintf(stderr, "Could not open checkpoint %s.\n", file_name.c_str());
+        return (magmadnn_error_t) 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (std::size_t) st.st_size < sizeof(checkpoint_header_t)) {
+        std::fprintf(stderr, "%s is not a checkpoint.\n", file_name.c_str());
+        close(fd);
+        return (magmadnn_error_t) 1;
+    }
+    std::size_t file_size = st.st_size;
+    void *base = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        std::fprintf(stderr, "Could not map checkpoint %s.\n", file_name.c_str());
+        return (magmadnn_error_t) 1;
+    }
+    const char *data = static_cast<const char *>(base);
+    madvise(base, file_size, MADV_SEQUENTIAL);
+
+    checkpoint_header_t header;
+    std::memcpy(&header, data, sizeof(header));
+
+    std::vector<Tensor<T> *> tensors = this->get_checkpoint_tensors();
+    magmadnn_error_t err = (magmadnn_error_t) 0;
+    if (std::memcmp(header.magic, checkpoint_magic, sizeof(header.magic)) != 0 ||
+        header.version != checkpoint_version || header.byte_order_mark != checkpoint_byte_order_mark ||
+        file_size < checkpoint_data_offset(header.n_tensors, header.n_scalars)) {
+        std::fprintf(stderr, "%s is not a checkpoint.\n", file_name.c_str());
+        err = (magmadnn_error_t) 1;
+    } else if (header.dtype != (uint32_t) io::get_tensor_dtype<T>() || header.n_tensors != tensors.size() ||
+               std::strncmp(header.optimizer_name, this->optim->get_name().c_str(), sizeof(header.optimizer_name)) !=
+                   0) {
+        std::fprintf(stderr, "Checkpoint %s was saved from a different network or optimizer.\n", file_name.c_str());
+        err = (magmadnn_error_t) 2;
+    }
+
+    /* check every size before changing anything */
+    std::vector<std::size_t> offsets;
+    if (err == 0) {
+        std::size_t offset = checkpoint_data_offset(header.n_tensors, header.n_scalars);
+        for (unsigned int i = 0; i < tensors.size(); i++) {
+            uint64_t size;
+            std::memcpy(&size, data + sizeof(header) + i * sizeof(uint64_t), sizeof(size));
+            if (size != tensors[i]->get_size() || offset + size * sizeof(T) > file_size) {
+                std::fprintf(stderr, "Checkpoint %s was saved from a different network or optimizer.\n",
+                             file_name.c_str());
+                err = (magmadnn_error_t) 2;
+                break;
+            }
+            offsets.push_back(offset);
+            offset = align_checkpoint_offset(offset + size * sizeof(T));
+        }
+    }
+
+    if (err == 0) {
+        unsigned int first = 0;
+        if (this->weights_are_flat() && offsets[0] + this->flat_params.get_size() * sizeof(T) <= file_size) {
+            Tensor<T> saved(reinterpret_cast<T *>(const_cast<char *>(data + offsets[0])),
+                            {this->flat_params.get_size()}, HOST);
+            this->flat_params.get_tensor()->copy_from(saved);
+            first = this->_vars.size();
+        }
+        for (unsigned int i = first; i < tensors.size(); i++) {
+            /* the tensor only reads the mapping */
+            Tensor<T> saved(reinterpret_cast<T *>(const_cast<char *>(data + offsets[i])),
+                            {tensors[i]->get_size()}, HOST);
+            tensors[i]->copy_from(saved, 0, saved.get_size());
+        }
+
+        std::vector<double> scalars(header.n_scalars);
+        std::memcpy(scalars.data(), data + sizeof(header) + header.n_tensors * sizeof(uint64_t),
+                    scalars.size() * sizeof(double));
+        this->optim->set_state_scalars(scalars);
+
+        this->epoch = header.epoch;
+        this->resume_epoch = header.epoch;
+    }
+
+    munmap(base, file_size);
+    return err;
+}
+
 template class NeuralNetwork<int>;
 template class NeuralNetwork<float>;
 template class NeuralNetwork<double>;
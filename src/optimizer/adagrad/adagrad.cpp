@@ -15,6 +15,8 @@ template <typename T>
 AdaGrad<T>::AdaGrad(T learning_rate) : Optimizer<T>::Optimizer(), learning_rate(learning_rate) {
     /* set the name of this Optimizer */
     this->_name = "AdaGradOptimizer";
+    /* only the gradients of wrt are read back, so the intermediate ones are freed during the backward pass */
+    this->table.get_executor().set_release_buffers(true);
 }
 
 template <typename T>
@@ -49,6 +51,15 @@ void AdaGrad<T>::update(op::Operation<T> *var, Tensor<T> *grad) {
     math::adagrad(this->learning_rate, this->scaling_tensors[var], grad, var_tensor);
 }
 
+template <typename T>
+std::vector<Tensor<T> *> AdaGrad<T>::get_state_tensors(const std::vector<op::Operation<T> *> &wrt) {
+    std::vector<Tensor<T> *> tensors;
+    for (unsigned int i = 0; i < wrt.size(); i++) {
+        tensors.push_back(this->get_state_tensor(this->scaling_tensors, wrt[i]));
+    }
+    return tensors;
+}
+
 template class AdaGrad<int>;
 template class AdaGrad<float>;
 template class AdaGrad<double>;
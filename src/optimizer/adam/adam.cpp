@@ -21,6 +21,8 @@ Adam<T>::Adam(T learning_rate, T beta1, T beta2)
       running_beta2(beta2) {
     /* set the name of this Optimizer */
     this->_name = "AdamOptimizer";
+    /* only the gradients of wrt are read back, so the intermediate ones are freed during the backward pass */
+    this->table.get_executor().set_release_buffers(true);
 }
 
 template <typename T>
@@ -65,6 +67,28 @@ void Adam<T>::update(op::Operation<T> *var, Tensor<T> *grad) {
                this->first_moment[var], this->second_moment[var], grad, var_tensor);
 }
 
+template <typename T>
+std::vector<Tensor<T> *> Adam<T>::get_state_tensors(const std::vector<op::Operation<T> *> &wrt) {
+    std::vector<Tensor<T> *> tensors;
+    for (unsigned int i = 0; i < wrt.size(); i++) {
+        tensors.push_back(this->get_state_tensor(this->first_moment, wrt[i]));
+        tensors.push_back(this->get_state_tensor(this->second_moment, wrt[i]));
+    }
+    return tensors;
+}
+
+template <typename T>
+std::vector<double> Adam<T>::get_state_scalars() {
+    return {(double) this->running_beta1, (double) this->running_beta2};
+}
+
+template <typename T>
+void Adam<T>::set_state_scalars(const std::vector<double> &scalars) {
+    if (scalars.size() != 2) return;
+    this->running_beta1 = (T) scalars[0];
+    this->running_beta2 = (T) scalars[1];
+}
+
 template class Adam<int>;
 template class Adam<float>;
 template class Adam<double>;
@@ -21,6 +21,8 @@ template <typename T>
 DistMomentumSGD<T>::DistMomentumSGD(T learning_rate, T momentum)
     : Optimizer<T>::Optimizer(), learning_rate(learning_rate), momentum(momentum) {
     this->_name = "DistMomentumSGD";
+    /* only the gradients of wrt are read back, so the intermediate ones are freed during the backward pass */
+    this->table.get_executor().set_release_buffers(true);
 }
 
 template <typename T>
@@ -60,6 +62,15 @@ void DistMomentumSGD<T>::update(op::Operation<T> *var, Tensor<T> *grad) {
     math::sgd_momentum(this->learning_rate, this->momentum, momentum_table[var], grad, var_tensor);
 }
 
+template <typename T>
+std::vector<Tensor<T> *> DistMomentumSGD<T>::get_state_tensors(const std::vector<op::Operation<T> *> &wrt) {
+    std::vector<Tensor<T> *> tensors;
+    for (unsigned int i = 0; i < wrt.size(); i++) {
+        tensors.push_back(this->get_state_tensor(this->momentum_table, wrt[i]));
+    }
+    return tensors;
+}
+
 template class DistMomentumSGD<int>;
 template class DistMomentumSGD<float>;
 template class DistMomentumSGD<double>;
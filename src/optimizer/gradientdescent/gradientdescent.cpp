@@ -14,9 +14,15 @@ namespace optimizer {
 
 template <typename T>
 GradientDescent<T>::GradientDescent(T learning_rate, T momentum)
-    : Optimizer<T>::Optimizer(), learning_rate(learning_rate), momentum(momentum) {
+    : Optimizer<T>::Optimizer(),
+      learning_rate(learning_rate),
+      momentum(momentum),
+      flat_params(NULL),
+      flat_grads(NULL) {
     /* set the name of this Optimizer */
     this->_name = "GradientDescentOptimizer";
+    /* only the gradients of wrt are read back, so the intermediate ones are freed during the backward pass */
+    this->table.get_executor().set_release_buffers(true);
 }
 
 template <typename T>
@@ -32,6 +38,13 @@ void GradientDescent<T>::minimize(op::Operation<T> *obj_func, const std::vector<
     this->table.clear();
     op::get_grad_table(wrt, this->_obj_func, this->table);
 
+    /* all variables at once */
+    if (this->flat_step_applies(wrt)) {
+        math::sgd_momentum(this->learning_rate, this->momentum, this->flat_momentum.get_tensor(), this->flat_grads,
+                           this->flat_params);
+        return;
+    }
+
     /* now update each one */
     for (vit = wrt.begin(); vit != wrt.end(); vit++) {
         this->update((*vit), table.get(*vit));
@@ -52,6 +65,55 @@ void GradientDescent<T>::update(op::Operation<T> *var, Tensor<T> *grad) {
     math::sgd_momentum(this->learning_rate, this->momentum, momentum_table[var], grad, var_tensor);
 }
 
+template <typename T>
+std::vector<Tensor<T> *> GradientDescent<T>::get_state_tensors(const std::vector<op::Operation<T> *> &wrt) {
+    std::vector<Tensor<T> *> tensors;
+    for (unsigned int i = 0; i < wrt.size(); i++) {
+        tensors.push_back(this->get_state_tensor(this->momentum_table, wrt[i]));
+    }
+    return tensors;
+}
+
+template <typename T>
+bool GradientDescent<T>::set_flat_buffers(const std::vector<op::Operation<T> *> &wrt, Tensor<T> *params,
+                                          Tensor<T> *grads) {
+    this->flat_momentum.unbind();
+    this->flat_wrt.clear();
+    this->flat_params = NULL;
+    this->flat_grads = NULL;
+    if (params == NULL || grads == NULL) return false;
+
+    if (this->flat_momentum.bind(this->get_state_tensors(wrt)) != 0 ||
+        this->flat_momentum.get_size() != params->get_size() || grads->get_size() != params->get_size()) {
+        this->flat_momentum.unbind();
+        return false;
+    }
+    for (unsigned int i = 0; i < wrt.size(); i++) {
+        if (wrt[i]->get_output_tensor()->get_ptr() != params->get_ptr() + this->flat_momentum.get_offset(i)) {
+            this->flat_momentum.unbind();
+            return false;
+        }
+    }
+
+    this->flat_wrt = wrt;
+    this->flat_params = params;
+    this->flat_grads = grads;
+    return true;
+}
+
+template <typename T>
+bool GradientDescent<T>::flat_step_applies(const std::vector<op::Operation<T> *> &wrt) {
+    if (this->flat_params == NULL || wrt != this->flat_wrt) return false;
+
+    for (unsigned int i = 0; i < wrt.size(); i++) {
+        Tensor<T> *grad = this->table.get(wrt[i]);
+        if (grad == NULL || grad->get_ptr() != this->flat_grads->get_ptr() + this->flat_momentum.get_offset(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 template class GradientDescent<int>;
 template class GradientDescent<float>;
 template class GradientDescent<double>;
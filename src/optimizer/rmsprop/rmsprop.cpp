@@ -16,6 +16,8 @@ RMSProp<T>::RMSProp(T learning_rate, T decaying_factor)
     : Optimizer<T>::Optimizer(), learning_rate(learning_rate), decaying_factor(decaying_factor) {
     /* set the name of this Optimizer */
     this->_name = "RMSPropOptimizer";
+    /* only the gradients of wrt are read back, so the intermediate ones are freed during the backward pass */
+    this->table.get_executor().set_release_buffers(true);
 }
 
 template <typename T>
@@ -50,6 +52,15 @@ void RMSProp<T>::update(op::Operation<T> *var, Tensor<T> *grad) {
     math::rmsprop(this->learning_rate, this->decaying_factor, this->decaying_squares_average[var], grad, var_tensor);
 }
 
+template <typename T>
+std::vector<Tensor<T> *> RMSProp<T>::get_state_tensors(const std::vector<op::Operation<T> *> &wrt) {
+    std::vector<Tensor<T> *> tensors;
+    for (unsigned int i = 0; i < wrt.size(); i++) {
+        tensors.push_back(this->get_state_tensor(this->decaying_squares_average, wrt[i]));
+    }
+    return tensors;
+}
+
 template class RMSProp<int>;
 template class RMSProp<float>;
 template class RMSProp<double>;
@@ -0,0 +1,63 @@
+/**
+ * @file parallel.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "magmadnn/parallel.h"
+
+#include <cstdlib>
+
+#include "magmadnn/types.h"
+
+namespace magmadnn {
+
+namespace {
+
+int default_num_threads() {
+    const char *env = std::getenv("MAGMADNN_NUM_THREADS");
+    if (env != NULL && std::atoi(env) > 0) return std::atoi(env);
+
+#if defined(MAGMADNN_HAVE_OMP)
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+}  // namespace
+
+void magmadnn_set_num_threads(int n_threads) {
+    if (internal::MAGMADNN_SETTINGS == NULL) return;
+
+#if defined(MAGMADNN_HAVE_OMP)
+    internal::MAGMADNN_SETTINGS->n_threads = (n_threads > 0) ? n_threads : default_num_threads();
+#else
+    internal::MAGMADNN_SETTINGS->n_threads = 1;
+#endif
+}
+
+int magmadnn_get_num_threads() {
+    if (internal::MAGMADNN_SETTINGS == NULL) return default_num_threads();
+    return internal::MAGMADNN_SETTINGS->n_threads;
+}
+
+namespace internal {
+
+int parallel_num_threads(std::size_t work, std::size_t grain) {
+#if defined(MAGMADNN_HAVE_OMP)
+    if (omp_in_parallel()) return 1;
+
+    std::size_t max_threads = magmadnn_get_num_threads();
+    std::size_t by_grain = work / std::max(grain, (std::size_t) 1);
+    return (int) std::max((std::size_t) 1, std::min(max_threads, by_grain));
+#else
+    (void) work;
+    (void) grain;
+    return 1;
+#endif
+}
+
+}  // namespace internal
+}  // namespace magmadnn
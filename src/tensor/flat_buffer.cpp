@@ -0,0 +1,100 @@
+/**
+ * @file flat_buffer.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "tensor/flat_buffer.h"
+
+#include <cstdio>
+
+namespace magmadnn {
+
+template <typename T>
+FlatBuffer<T>::FlatBuffer() : buffer(NULL) {}
+
+template <typename T>
+FlatBuffer<T>::~FlatBuffer() {
+    this->unbind();
+}
+
+template <typename T>
+unsigned int FlatBuffer<T>::get_layout(const std::vector<unsigned int> &sizes, std::vector<unsigned int> *offsets) {
+    const unsigned int alignment = (FLAT_BUFFER_ALIGNMENT >= sizeof(T)) ? FLAT_BUFFER_ALIGNMENT / sizeof(T) : 1;
+    unsigned int size = 0;
+
+    if (offsets != NULL) offsets->clear();
+    for (unsigned int i = 0; i < sizes.size(); i++) {
+        if (offsets != NULL) offsets->push_back(size);
+        size = (size + sizes[i] + alignment - 1) / alignment * alignment;
+    }
+    return size;
+}
+
+template <typename T>
+magmadnn_error_t FlatBuffer<T>::bind(const std::vector<Tensor<T> *> &tensors) {
+    this->unbind();
+    if (tensors.empty()) return (magmadnn_error_t) 0;
+
+    memory_t mem_type = tensors[0]->get_memory_type();
+    std::vector<unsigned int> sizes;
+    for (unsigned int i = 0; i < tensors.size(); i++) {
+        if (tensors[i]->get_memory_type() != mem_type || !tensors[i]->get_memory_manager()->owns_memory()) {
+            std::fprintf(stderr, "FlatBuffer: tensors need one memory type and their own memory.\n");
+            return (magmadnn_error_t) 1;
+        }
+        for (unsigned int j = 0; j < i; j++) {
+            if (tensors[j] == tensors[i]) {
+                std::fprintf(stderr, "FlatBuffer: a tensor is given twice.\n");
+                return (magmadnn_error_t) 1;
+            }
+        }
+        sizes.push_back(tensors[i]->get_size());
+    }
+#if defined(MAGMADNN_HAVE_CUDA)
+    if (mem_type == CUDA_MANAGED) {
+        std::fprintf(stderr, "FlatBuffer does not support CUDA_MANAGED memory.\n");
+        return (magmadnn_error_t) 1;
+    }
+#endif
+
+    unsigned int size = get_layout(sizes, &this->offsets);
+    this->buffer = new Tensor<T>({size}, {ZERO, {}}, mem_type);
+
+    T *base = this->buffer->get_ptr();
+    for (unsigned int i = 0; i < tensors.size(); i++) {
+        if (tensors[i]->use_external_memory(base + this->offsets[i]) != 0) {
+            this->unbind();
+            return (magmadnn_error_t) 1;
+        }
+        this->tensors.push_back(tensors[i]);
+    }
+    return (magmadnn_error_t) 0;
+}
+
+template <typename T>
+void FlatBuffer<T>::unbind() {
+    if (this->buffer == NULL) return;
+
+    for (unsigned int i = 0; i < this->tensors.size(); i++) {
+        this->tensors[i]->use_external_memory(NULL);
+    }
+    this->tensors.clear();
+    this->offsets.clear();
+
+    delete this->buffer;
+    this->buffer = NULL;
+}
+
+template <typename T>
+bool FlatBuffer<T>::is_view(unsigned int i, Tensor<T> *tensor) const {
+    if (this->buffer == NULL || i >= this->offsets.size() || tensor == NULL) return false;
+    return tensor->get_ptr() == this->buffer->get_ptr() + this->offsets[i];
+}
+
+template class FlatBuffer<int>;
+template class FlatBuffer<float>;
+template class FlatBuffer<double>;
+
+}  // namespace magmadnn
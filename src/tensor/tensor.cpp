@@ -47,6 +47,11 @@ Tensor<T>::Tensor(std::vector<unsigned int> shape, tensor_filler_t<T> filler, me
     init(shape, filler, mem_type, device_id);
 }
 
+template <typename T>
+Tensor<T>::Tensor(T* ptr, std::vector<unsigned int> shape, memory_t mem_type, device_t device_id) {
+    init(shape, {NONE, {}}, mem_type, device_id, ptr);
+}
+
 template <typename T>
 Tensor<T>::~Tensor() {
     delete mem_manager;
@@ -58,7 +63,7 @@ Tensor<T>::~Tensor() {
 
 template <typename T>
 void Tensor<T>::init(std::vector<unsigned int>& shape, tensor_filler_t<T> filler, memory_t mem_type,
-                     device_t device_id) {
+                     device_t device_id, T* external_ptr) {
     // tensor must have at least 1 axis
     assert(shape.size() != 0);
 
@@ -83,7 +88,11 @@ void Tensor<T>::init(std::vector<unsigned int>& shape, tensor_filler_t<T> filler
     // std::cout << "Tensor<T>::init, tensor mem (MB) = "
     //           << (float) (( (float) this->size * sizeof(T) ) / ((float) 1024.0*1024.0) ) << std::endl;
     // create memory manager
-    this->mem_manager = new MemoryManager<T>(size, mem_type, device_id);
+    if (external_ptr != NULL) {
+        this->mem_manager = new MemoryManager<T>(size, mem_type, device_id, external_ptr);
+    } else {
+        this->mem_manager = new MemoryManager<T>(size, mem_type, device_id);
+    }
 
 #if defined(MAGMADNN_HAVE_CUDA)
     this->set_custream(nullptr);
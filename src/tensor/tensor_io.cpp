@@ -8,52 +8,170 @@
  */
 #include "tensor/tensor_io.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "magmadnn/parallel.h"
+
 namespace magmadnn {
 namespace io {
 
+namespace {
+
+/* csv chunks that are parsed in parallel; each starts right after a separator */
+const std::size_t CSV_CHUNK_BYTES = 1 << 20;
+
+inline bool parse_value(const char* str, char** end, int& val) {
+    errno = 0;
+    long l = std::strtol(str, end, 10);
+    val = (int) l;
+    return errno == 0 && l >= INT_MIN && l <= INT_MAX;
+}
+
+inline bool parse_value(const char* str, char** end, float& val) {
+    val = std::strtof(str, end);
+    return true;
+}
+
+inline bool parse_value(const char* str, char** end, double& val) {
+    val = std::strtod(str, end);
+    return true;
+}
+
+/* Parses the values in [begin, end) into out. With out NULL it only counts them, without parsing. Returns false on
+   a malformed or empty value. */
 template <typename T>
-magmadnn_error_t read_csv_to_tensor(Tensor<T>& t, const std::string& file_name, char delim) {
-    magmadnn_error_t err = (magmadnn_error_t) 0;
+bool parse_csv_chunk(const char* begin, const char* end, char delim, T* out, std::size_t& count) {
+    auto is_blank = [delim](char c) { return c != delim && (c == ' ' || c == '\t' || c == '\r'); };
+    const char* p = begin;
 
-    std::ifstream file_stream(file_name);
+    count = 0;
+    while (p < end) {
+        while (p < end && is_blank(*p)) p++;
+        if (p == end) break;
 
-    if (!file_stream.is_open()) {
+        /* nothing after a trailing delimiter, or an empty line */
+        if (*p == '\n') {
+            p++;
+            continue;
+        }
+        if (*p == delim) return false;
+
+        if (out == NULL) {
+            while (p < end && *p != delim && *p != '\n') p++;
+            if (p < end) p++;
+            count++;
+            continue;
+        }
+
+        char* value_end;
+        T val;
+        if (!parse_value(p, &value_end, val) || value_end == p) return false;
+
+        p = value_end;
+        while (p < end && is_blank(*p)) p++;
+        if (p < end) {
+            if (*p != delim && *p != '\n') return false;
+            p++;
+        }
+
+        out[count] = val;
+        count++;
+    }
+    return true;
+}
+
+}  // namespace
+
+template <typename T>
+magmadnn_error_t read_csv_to_tensor(Tensor<T>& t, const std::string& file_name, char delim) {
+    std::FILE* file = std::fopen(file_name.c_str(), "rb");
+
+    if (file == NULL) {
         /* error on opening file */
         return (magmadnn_error_t) 1;
     }
 
-    std::stringstream ss;
-    std::string line, token;
-    T val;
-    int cur_idx = 0;
+    /* the whole file, NUL terminated so that the number parsers stop at its end */
+    std::vector<char> text;
+    bool read_ok = std::fseek(file, 0, SEEK_END) == 0;
+    long file_size = read_ok ? std::ftell(file) : -1;
+    if (file_size >= 0 && std::fseek(file, 0, SEEK_SET) == 0) {
+        text.resize(file_size + 1);
+        read_ok = std::fread(text.data(), 1, file_size, file) == (std::size_t) file_size;
+        text[file_size] = '\0';
+    } else {
+        read_ok = false;
+    }
+    std::fclose(file);
+    if (!read_ok) return (magmadnn_error_t) 1;
 
-    unsigned int axes = t.get_shape().size();
-    std::vector<unsigned int> indices(axes, 0);
+    /* split into chunks that start after a separator, so that no value spans two */
+    const char* data = text.data();
+    std::size_t n_bytes = file_size;
+    std::vector<std::size_t> chunk_begin;
+    for (std::size_t pos = 0; pos < n_bytes;) {
+        chunk_begin.push_back(pos);
+        pos = std::min(pos + CSV_CHUNK_BYTES, n_bytes);
+        while (pos < n_bytes && data[pos - 1] != delim && data[pos - 1] != '\n') pos++;
+    }
+    chunk_begin.push_back(n_bytes);
+    std::size_t n_chunks = chunk_begin.size() - 1;
 
-    /* read in every line of the file */
-    while (std::getline(file_stream, line)) {
-        /* used to process the current line */
-        ss.str(line);
+    /* count every chunk's values, then parse each straight to its offset; only the second pass parses numbers */
+    std::vector<std::size_t> chunk_count(n_chunks + 1, 0);
+    std::vector<char> chunk_ok(n_chunks, 1);
 
-        /* read in each item separated by delim into num */
-        while (std::getline(ss, token, delim)) {
-            /* use iss's stream operator to correctly read value into val */
-            if (!(std::istringstream(token) >> val)) {
-                /* could not read into val */
-                return (magmadnn_error_t) 2;
-            }
+    ::magmadnn::internal::parallel_for(n_chunks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; c++) {
+            chunk_ok[c] = parse_csv_chunk<T>(data + chunk_begin[c], data + chunk_begin[c + 1], delim, NULL,
+                                             chunk_count[c + 1]);
+        }
+    });
+    for (std::size_t c = 0; c < n_chunks; c++) {
+        if (!chunk_ok[c]) return (magmadnn_error_t) 2;
+        chunk_count[c + 1] += chunk_count[c];
+    }
 
-            /* use tensor's built in flattened index set method */
-            t.set(cur_idx, val);
+    std::size_t n_values = chunk_count[n_chunks];
+    if (n_values > t.get_size()) return (magmadnn_error_t) 3;
+    if (n_values == 0) return (magmadnn_error_t) 0;
+
+    /* non-HOST tensors are filled with one copy */
+    Tensor<T>* staging = NULL;
+    T* out;
+    if (t.get_memory_type() == HOST) {
+        out = t.get_ptr();
+    } else {
+        staging = new Tensor<T>({(unsigned int) n_values}, {NONE, {}}, HOST);
+        out = staging->get_ptr();
+    }
 
-            cur_idx++;
+    ::magmadnn::internal::parallel_for(n_chunks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; c++) {
+            std::size_t count;
+            chunk_ok[c] = parse_csv_chunk<T>(data + chunk_begin[c], data + chunk_begin[c + 1], delim,
+                                             out + chunk_count[c], count);
         }
+    });
 
-        ss.clear();
+    bool parsed = std::find(chunk_ok.begin(), chunk_ok.end(), 0) == chunk_ok.end();
+    if (staging != NULL) {
+        if (parsed) t.copy_from(*staging, 0, n_values);
+        delete staging;
     }
-    file_stream.close();
+    if (!parsed) return (magmadnn_error_t) 2;
 
-    return err;
+    return (magmadnn_error_t) 0;
 }
 template magmadnn_error_t read_csv_to_tensor(Tensor<int>&, const std::string&, char);
 template magmadnn_error_t read_csv_to_tensor(Tensor<float>&, const std::string&, char);
@@ -63,6 +181,11 @@ template <typename T>
 magmadnn_error_t write_tensor_to_csv(const Tensor<T>& t, const std::string& file_name, char delim, bool create) {
     magmadnn_error_t err = (magmadnn_error_t) 0;
 
+    if (!create && access(file_name.c_str(), F_OK) != 0) {
+        /* file does not exist and may not be created */
+        return (magmadnn_error_t) 1;
+    }
+
     std::ofstream file_stream(file_name);
     if (!file_stream.is_open()) {
         /* failed to open file */
@@ -89,5 +212,241 @@ template magmadnn_error_t write_tensor_to_csv(const Tensor<int>&, const std::str
 template magmadnn_error_t write_tensor_to_csv(const Tensor<float>&, const std::string&, char, bool);
 template magmadnn_error_t write_tensor_to_csv(const Tensor<double>&, const std::string&, char, bool);
 
+////////////////////////////////////////////////////////////
+// binary tensor files
+
+namespace {
+
+const char tensor_file_magic[8] = {'M', 'D', 'N', 'N', 'T', 'E', 'N', 'S'};
+const uint32_t tensor_file_version = 1;
+const uint32_t tensor_file_byte_order_mark = 0x01020304;
+
+/* elements moved through host memory per piece when the tensor is elsewhere */
+const unsigned int TENSOR_FILE_CHUNK = 1 << 20;
+
+inline uint64_t tensor_file_data_offset(uint32_t n_dims) {
+    return (sizeof(tensor_file_header_t) + n_dims * sizeof(uint64_t) + 63) & ~((uint64_t) 63);
+}
+
+/* reads and checks the header and shape at the start of a mapped file; every size is checked for overflow, since the
+   file may come from anywhere */
+template <typename T>
+bool read_tensor_file_header(const unsigned char* contents, std::size_t n_bytes, tensor_file_header_t& header,
+                             std::vector<unsigned int>& shape) {
+    if (n_bytes < sizeof(header)) return false;
+    std::memcpy(&header, contents, sizeof(header));
+
+    if (std::memcmp(header.magic, tensor_file_magic, sizeof(tensor_file_magic)) != 0 ||
+        header.version != tensor_file_version || header.byte_order_mark != tensor_file_byte_order_mark ||
+        header.dtype != (uint32_t) get_tensor_dtype<T>() || header.layout != TENSOR_ROW_MAJOR) {
+        return false;
+    }
+
+    /* the shape and the elements lie within the file, and the elements start at a multiple of 64 */
+    if (header.n_dims == 0 || header.n_dims > (n_bytes - sizeof(header)) / sizeof(uint64_t) ||
+        header.data_offset % 64 != 0 || header.data_offset < tensor_file_data_offset(header.n_dims) ||
+        header.data_offset > n_bytes || header.n_elements > (n_bytes - header.data_offset) / sizeof(T) ||
+        header.n_elements > UINT_MAX) {
+        return false;
+    }
+
+    uint64_t n_elements = 1;
+    shape.resize(header.n_dims);
+    for (uint32_t i = 0; i < header.n_dims; i++) {
+        uint64_t dim;
+        std::memcpy(&dim, contents + sizeof(header) + i * sizeof(uint64_t), sizeof(dim));
+        if (dim == 0 || n_elements > header.n_elements / dim) return false;
+        shape[i] = (unsigned int) dim;
+        n_elements *= dim;
+    }
+    return n_elements == header.n_elements;
+}
+
+}  // namespace
+
+template <>
+tensor_dtype_t get_tensor_dtype<int>() {
+    return TENSOR_INT32;
+}
+template <>
+tensor_dtype_t get_tensor_dtype<float>() {
+    return TENSOR_FLOAT32;
+}
+template <>
+tensor_dtype_t get_tensor_dtype<double>() {
+    return TENSOR_FLOAT64;
+}
+
+template <typename T>
+TensorFileWriter<T>::TensorFileWriter(const std::string& file_name, const std::vector<unsigned int>& shape)
+    : file(NULL), n_elements(1), n_written(0), failed(false) {
+    tensor_file_header_t header;
+    std::vector<uint64_t> dims(shape.begin(), shape.end());
+
+    for (unsigned int i = 0; i < shape.size(); i++) this->n_elements *= shape[i];
+
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, tensor_file_magic, sizeof(header.magic));
+    header.version = tensor_file_version;
+    header.byte_order_mark = tensor_file_byte_order_mark;
+    header.dtype = get_tensor_dtype<T>();
+    header.layout = TENSOR_ROW_MAJOR;
+    header.n_dims = shape.size();
+    header.n_elements = this->n_elements;
+    header.data_offset = tensor_file_data_offset(header.n_dims);
+
+    this->file = std::fopen(file_name.c_str(), "wb");
+    if (this->file == NULL) {
+        std::fprintf(stderr, "Error: TensorFileWriter: cannot open %s.\n", file_name.c_str());
+        return;
+    }
+
+    std::vector<char> padding(header.data_offset - sizeof(header) - dims.size() * sizeof(uint64_t), 0);
+    if (std::fwrite(&header, sizeof(header), 1, this->file) != 1 ||
+        std::fwrite(dims.data(), sizeof(uint64_t), dims.size(), this->file) != dims.size() ||
+        std::fwrite(padding.data(), 1, padding.size(), this->file) != padding.size()) {
+        this->failed = true;
+    }
+}
+
+template <typename T>
+TensorFileWriter<T>::~TensorFileWriter() {
+    if (this->file != NULL) std::fclose(this->file);
+}
+
+template <typename T>
+magmadnn_error_t TensorFileWriter<T>::write(const T* values, std::size_t count) {
+    if (this->file == NULL || this->failed || this->n_written + count > this->n_elements) {
+        this->failed = true;
+        return (magmadnn_error_t) 1;
+    }
+    if (std::fwrite(values, sizeof(T), count, this->file) != count) {
+        this->failed = true;
+        return (magmadnn_error_t) 1;
+    }
+    this->n_written += count;
+    return (magmadnn_error_t) 0;
+}
+
+template <typename T>
+magmadnn_error_t TensorFileWriter<T>::write(const Tensor<T>& t) {
+    if (t.get_memory_type() == HOST) {
+        return this->write(t.get_memory_manager()->get_host_ptr(), t.get_size());
+    }
+
+    /* download and write in pieces */
+    unsigned int size = t.get_size();
+    Tensor<T> staging({std::min(size, TENSOR_FILE_CHUNK)}, {NONE, {}}, HOST);
+    for (unsigned int begin = 0; begin < size; begin += TENSOR_FILE_CHUNK) {
+        unsigned int count = std::min(size - begin, TENSOR_FILE_CHUNK);
+        staging.copy_from(t, begin, count);
+        magmadnn_error_t err = this->write(staging.get_ptr(), count);
+        if (err != 0) return err;
+    }
+    return (magmadnn_error_t) 0;
+}
+
+template <typename T>
+magmadnn_error_t TensorFileWriter<T>::close() {
+    if (this->file == NULL) return (magmadnn_error_t) 1;
+
+    bool ok = !this->failed && this->n_written == this->n_elements;
+    if (std::fclose(this->file) != 0) ok = false;
+    this->file = NULL;
+
+    return (magmadnn_error_t)(ok ? 0 : 1);
+}
+
+template class TensorFileWriter<int>;
+template class TensorFileWriter<float>;
+template class TensorFileWriter<double>;
+
+template <typename T>
+magmadnn_error_t write_tensor_to_binary(const Tensor<T>& t, const std::string& file_name) {
+    TensorFileWriter<T> writer(file_name, t.get_shape());
+
+    if (!writer.is_open()) return (magmadnn_error_t) 1;
+    writer.write(t);
+    return writer.close();
+}
+template magmadnn_error_t write_tensor_to_binary(const Tensor<int>&, const std::string&);
+template magmadnn_error_t write_tensor_to_binary(const Tensor<float>&, const std::string&);
+template magmadnn_error_t write_tensor_to_binary(const Tensor<double>&, const std::string&);
+
+template <typename T>
+magmadnn_error_t read_binary_to_tensor(Tensor<T>& t, const std::string& file_name) {
+    MappedTensorFile<T> mapped(file_name);
+
+    if (mapped.get_tensor() == NULL) return (magmadnn_error_t) 1;
+    if (mapped.get_tensor()->get_size() != t.get_size()) return (magmadnn_error_t) 2;
+
+    /* one copy out of the mapping, wherever t lives */
+    return t.copy_from(*mapped.get_tensor());
+}
+template magmadnn_error_t read_binary_to_tensor(Tensor<int>&, const std::string&);
+template magmadnn_error_t read_binary_to_tensor(Tensor<float>&, const std::string&);
+template magmadnn_error_t read_binary_to_tensor(Tensor<double>&, const std::string&);
+
+template <typename T>
+Tensor<T>* read_binary_tensor(const std::string& file_name, memory_t mem) {
+    MappedTensorFile<T> mapped(file_name);
+
+    if (mapped.get_tensor() == NULL) return NULL;
+
+    Tensor<T>* t = new Tensor<T>(mapped.get_tensor()->get_shape(), {NONE, {}}, mem);
+    t->copy_from(*mapped.get_tensor());
+    return t;
+}
+template Tensor<int>* read_binary_tensor(const std::string&, memory_t);
+template Tensor<float>* read_binary_tensor(const std::string&, memory_t);
+template Tensor<double>* read_binary_tensor(const std::string&, memory_t);
+
+template <typename T>
+MappedTensorFile<T>::MappedTensorFile(const std::string& file_name, bool writable)
+    : base(NULL), mapped_bytes(0), tensor(NULL) {
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::fprintf(stderr, "Error: MappedTensorFile: cannot open %s.\n", file_name.c_str());
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return;
+    }
+
+    /* the mapping outlives the descriptor */
+    void* mapped = mmap(NULL, st.st_size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::fprintf(stderr, "Error: MappedTensorFile: cannot map %s.\n", file_name.c_str());
+        return;
+    }
+    this->base = mapped;
+    this->mapped_bytes = st.st_size;
+
+    tensor_file_header_t header;
+    std::vector<unsigned int> shape;
+    if (!read_tensor_file_header<T>(static_cast<const unsigned char*>(mapped), this->mapped_bytes, header, shape) ||
+        header.n_elements == 0) {
+        std::fprintf(stderr, "Error: MappedTensorFile: %s is not a tensor file of this type.\n", file_name.c_str());
+        return;
+    }
+
+    this->tensor = new Tensor<T>(reinterpret_cast<T*>(static_cast<unsigned char*>(mapped) + header.data_offset), shape,
+                                 HOST);
+}
+
+template <typename T>
+MappedTensorFile<T>::~MappedTensorFile() {
+    if (this->tensor != NULL) delete this->tensor;
+    if (this->base != NULL) munmap(this->base, this->mapped_bytes);
+}
+
+template class MappedTensorFile<int>;
+template class MappedTensorFile<float>;
+template class MappedTensorFile<double>;
+
 }  // namespace io
-}  // namespace magmadnn
\ No newline at end of file
+}  // namespace magmadnn
@@ -6,6 +6,7 @@
  *
  * @copyright Copyright (c) 2019
  */
+#include <cmath>
 #include "magmadnn.h"
 #include "utilities.h"
 
@@ -26,7 +27,9 @@ void test_tanh(memory_t mem_type, unsigned int size);
 void test_conv2d(memory_t mem_type, unsigned int size);
 void test_pooling(memory_t mem_type, unsigned int size);
 void test_batchnorm(memory_t mem_type, unsigned int size);
+void test_fused_dense(memory_t mem_type, unsigned int size);
 void test_crossentropy(memory_t mem_type, unsigned int size);
+void test_softmax_crossentropy(memory_t mem_type, unsigned int size);
 void test_meansquarederror(memory_t mem_type, unsigned int size);
 
 int main(int argc, char **argv) {
@@ -46,21 +49,15 @@ int main(int argc, char **argv) {
     test_for_all_mem_types(test_sigmoid, 50);
     test_for_all_mem_types(test_tanh, 50);
 
-#if defined(MAGMADNN_HAVE_CUDA)
-    test_conv2d(DEVICE, 30);
-    test_conv2d(MANAGED, 30);
-    test_conv2d(CUDA_MANAGED, 30);
-
-    test_pooling(DEVICE, 30);
-    test_pooling(MANAGED, 30);
-    test_pooling(CUDA_MANAGED, 30);
-
-    test_batchnorm(DEVICE, 30);
-    test_batchnorm(MANAGED, 30);
-    test_batchnorm(CUDA_MANAGED, 30);
-#endif
+    test_for_all_mem_types(test_conv2d, 30);
+    test_for_all_mem_types(test_pooling, 30);
+    test_for_all_mem_types(test_batchnorm, 30);
+    /* HOST only */
+    test_fused_dense(HOST, 20);
 
     test_for_all_mem_types(test_crossentropy, 10);
+    /* HOST only */
+    test_softmax_crossentropy(HOST, 10);
     // test_meansquarederror(HOST, 10);
     test_for_all_mem_types(test_meansquarederror, 10);
 
@@ -710,3 +707,144 @@ void test_meansquarederror(memory_t mem_type, unsigned int size) {
 
     show_success();
 }
+
+void test_fused_dense(memory_t mem_type, unsigned int size) {
+    unsigned int batch = size;
+    unsigned int n_in = size + 3;
+    unsigned int n_out = size + 7;
+
+    printf("Testing %s fused dense...  ", get_memory_type_name(mem_type));
+
+    op::Operation<float> *x = op::var<float>("x", {batch, n_in}, {UNIFORM, {-1.0f, 1.0f}}, mem_type);
+    op::Operation<float> *w = op::var<float>("w", {n_in, n_out}, {UNIFORM, {-1.0f, 1.0f}}, mem_type);
+    op::Operation<float> *b = op::var<float>("b", {batch}, {UNIFORM, {-1.0f, 1.0f}}, mem_type);
+    op::Operation<float> *target = op::var<float>("target", {batch, n_out}, {UNIFORM, {0.0f, 1.0f}}, mem_type);
+
+    /* same values and gradients as the separate operations */
+    math::fused_activation_t activations[] = {math::FUSED_RELU, math::FUSED_SIGMOID, math::FUSED_TANH};
+    for (unsigned int a = 0; a < 3; a++) {
+        op::Operation<float> *linear = op::linearforward(x, w, b);
+        op::Operation<float> *unfused;
+        if (activations[a] == math::FUSED_RELU) {
+            unfused = op::relu(linear);
+        } else if (activations[a] == math::FUSED_SIGMOID) {
+            unfused = op::sigmoid(linear);
+        } else {
+            unfused = op::tanh(linear);
+        }
+        op::Operation<float> *fused = op::fuseddense(x, w, b, activations[a]);
+
+        op::Operation<float> *unfused_loss = op::meansquarederror(target, unfused);
+        op::Operation<float> *fused_loss = op::meansquarederror(target, fused);
+
+        unfused_loss->eval();
+        fused_loss->eval();
+
+        Tensor<float> *expected = unfused->eval(false);
+        Tensor<float> *actual = fused->eval(false);
+        for (unsigned int i = 0; i < expected->get_size(); i++) {
+            MAGMADNN_TEST_ASSERT_FEQUAL(actual->get(i), expected->get(i), 1E-6, true, "%g != %g", actual->get(i),
+                                        expected->get(i));
+        }
+
+        op::GradTable<float> unfused_table, fused_table;
+        op::get_grad_table({x, w, b}, unfused_loss, unfused_table);
+        op::get_grad_table({x, w, b}, fused_loss, fused_table);
+
+        op::Operation<float> *wrt[] = {x, w, b};
+        for (unsigned int v = 0; v < 3; v++) {
+            Tensor<float> *expected_grad = unfused_table.get(wrt[v]);
+            Tensor<float> *actual_grad = fused_table.get(wrt[v]);
+            MAGMADNN_TEST_ASSERT_DEFAULT(actual_grad->get_size() == expected_grad->get_size(), "grad shape mismatch");
+            for (unsigned int i = 0; i < expected_grad->get_size(); i++) {
+                MAGMADNN_TEST_ASSERT_FEQUAL(actual_grad->get(i), expected_grad->get(i), 1E-6, true, "%g != %g",
+                                            actual_grad->get(i), expected_grad->get(i));
+            }
+        }
+    }
+
+    /* the identity without bias is a plain matmul */
+    Tensor<float> *identity_out = op::fuseddense<float>(x, w, NULL, math::FUSED_IDENTITY)->eval();
+    Tensor<float> *matmul_ref = op::matmul(x, w)->eval();
+    for (unsigned int i = 0; i < matmul_ref->get_size(); i++) {
+        MAGMADNN_TEST_ASSERT_FEQUAL(identity_out->get(i), matmul_ref->get(i), 1E-5, true, "%g != %g",
+                                    identity_out->get(i), matmul_ref->get(i));
+    }
+
+    /* the layers rewrite a fully connected layer followed by an activation */
+    auto input = layer::input<float>(op::var<float>("in", {batch, n_in}, {UNIFORM, {-1.0f, 1.0f}}, mem_type));
+    auto fc = layer::fullyconnected<float>(input->out(), n_out);
+    auto act = layer::activation<float>(fc->out(), layer::RELU);
+    MAGMADNN_TEST_ASSERT_DEFAULT(act->out()->get_name() == "FusedDense", "activation layer was not fused");
+    MAGMADNN_TEST_ASSERT_DEFAULT(fc->get_weight()->get_consumers().size() == 1, "linear op still consumes weights");
+    MAGMADNN_TEST_ASSERT_DEFAULT(act->out()->eval() == fc->out()->get_output_tensor(), "output tensor not reused");
+
+    show_success();
+}
+
+void test_softmax_crossentropy(memory_t mem_type, unsigned int size) {
+    unsigned int n_samples = size;
+    unsigned int n_classes = size + 2;
+
+    printf("Testing %s softmax crossentropy...  ", get_memory_type_name(mem_type));
+
+    Tensor<float> *logits_tensor = new Tensor<float>({n_samples, n_classes}, {UNIFORM, {-3.0f, 3.0f}}, mem_type);
+    Tensor<float> *labels_tensor = new Tensor<float>({n_samples}, {NONE, {}}, mem_type);
+    Tensor<float> *one_hot_tensor = new Tensor<float>({n_samples, n_classes}, {ZERO, {}}, mem_type);
+    for (unsigned int i = 0; i < n_samples; i++) {
+        labels_tensor->set(i, (float) ((i * 7) % n_classes));
+        one_hot_tensor->set({i, (i * 7) % n_classes}, 1.0f);
+    }
+
+    op::Operation<float> *logits = op::var("logits", logits_tensor);
+    op::Operation<float> *labels = op::var("labels", labels_tensor);
+    op::Operation<float> *one_hot = op::var("one_hot", one_hot_tensor);
+
+    /* same loss and gradient as crossentropy of the softmax, with indices or one-hot rows */
+    op::Operation<float> *reference = op::crossentropy(one_hot, op::softmax(logits));
+    op::Operation<float> *sparse = op::softmax_crossentropy(labels, logits);
+    op::Operation<float> *dense = op::softmax_crossentropy(one_hot, logits);
+
+    float expected = reference->eval()->get(0);
+    MAGMADNN_TEST_ASSERT_FEQUAL(sparse->eval()->get(0), expected, 1E-5, true, "%g != %g", sparse->eval()->get(0),
+                                expected);
+    MAGMADNN_TEST_ASSERT_FEQUAL(dense->eval()->get(0), expected, 1E-5, true, "%g != %g", dense->eval()->get(0),
+                                expected);
+
+    op::GradTable<float> reference_table, sparse_table;
+    op::get_grad_table({logits}, reference, reference_table);
+    op::get_grad_table({logits}, sparse, sparse_table);
+    Tensor<float> *expected_grad = reference_table.get(logits);
+    Tensor<float> *actual_grad = sparse_table.get(logits);
+    for (unsigned int i = 0; i < expected_grad->get_size(); i++) {
+        MAGMADNN_TEST_ASSERT_FEQUAL(actual_grad->get(i), expected_grad->get(i), 1E-5, true, "%g != %g",
+                                    actual_grad->get(i), expected_grad->get(i));
+    }
+
+    /* logits far beyond exp's range: the loss is the margin to the largest logit */
+    logits_tensor->fill_memory({CONSTANT, {1000.0f}});
+    logits_tensor->set({0u, 0u}, 1010.0f);
+    labels_tensor->set(0, 1.0f);
+    float loss = sparse->eval()->get(0);
+    MAGMADNN_TEST_ASSERT_DEFAULT(std::isfinite(loss), "loss is not finite");
+    float sample_0_loss = 10.0f + std::log(1.0f + (n_classes - 1) * std::exp(-10.0f));
+    float other_loss = std::log((float) n_classes) * (n_samples - 1);
+    MAGMADNN_TEST_ASSERT_FEQUAL(loss, (sample_0_loss + other_loss) / n_samples, 1E-3, true, "%g != %g", loss,
+                                (sample_0_loss + other_loss) / n_samples);
+
+    /* a label that is not a class index is an error, not a sample without loss */
+    labels_tensor->set(0, (float) n_classes);
+    bool thrown = false;
+    try {
+        sparse->eval();
+    } catch (const ::magmadnn::Error &) {
+        thrown = true;
+    }
+    MAGMADNN_TEST_ASSERT_DEFAULT(thrown, "out of range label accepted");
+
+    delete logits_tensor;
+    delete labels_tensor;
+    delete one_hot_tensor;
+
+    show_success();
+}
@@ -6,17 +6,27 @@
  *
  * @copyright Copyright (c) 2019
  */
+#include <cstring>
+
 #include "magmadnn.h"
 #include "utilities.h"
 
 using namespace magmadnn;
 
 void test_linear(memory_t mem_type, unsigned int size);
+void test_prefetch(memory_t mem_type, unsigned int size);
+void test_shuffle(memory_t mem_type, unsigned int size);
+void test_binary(memory_t mem_type, unsigned int size);
+void test_image_readers();
 
 int main(int argc, char **argv) {
     magmadnn_init();
 
     test_for_all_mem_types(test_linear, 50);
+    test_for_all_mem_types(test_prefetch, 50);
+    test_for_all_mem_types(test_shuffle, 50);
+    test_for_all_mem_types(test_binary, 50);
+    test_image_readers();
 
     magmadnn_finalize();
     return 0;
@@ -48,4 +58,276 @@ void test_linear(memory_t mem_type, unsigned int size) {
     }
 
     show_success();
-}
\ No newline at end of file
+}
+
+void test_prefetch(memory_t mem_type, unsigned int size) {
+    printf("Testing %s prefetch loader...  ", get_memory_type_name(mem_type));
+
+    Tensor<float> *x = new Tensor<float>({size, size}, {UNIFORM, {-1.0f, 1.0f}}, mem_type);
+    Tensor<float> *y = new Tensor<float>({size}, {UNIFORM, {-1.0f, 1.0f}}, mem_type);
+    unsigned int batch_size = size / 4;
+    dataloader::LinearLoader<float> *linear = new dataloader::LinearLoader<float>(x, y, batch_size);
+    dataloader::PrefetchLoader<float> *data = new dataloader::PrefetchLoader<float>(linear, 3);
+
+    Tensor<float> *x_batch = new Tensor<float>({batch_size, size}, mem_type);
+    Tensor<float> *y_batch = new Tensor<float>({batch_size, 1}, mem_type);
+
+    MAGMADNN_TEST_ASSERT_DEFAULT(data->get_num_batches() == linear->get_num_batches(),
+                                 "\"data->get_num_batches() == linear->get_num_batches()\" failed");
+
+    /* same batches in the same order as the wrapped loader, across epochs */
+    for (unsigned int epoch = 0; epoch < 3; epoch++) {
+        for (unsigned int i = 0; i < data->get_num_batches(); i++) {
+            data->next(x_batch, y_batch);
+            for (unsigned int j = 0; j < batch_size; j++) {
+                for (unsigned int k = 0; k < size; k++) {
+                    MAGMADNN_TEST_ASSERT_DEFAULT(x_batch->get({j, k}) == x->get({i * batch_size + j, k}),
+                                                 "\"x_batch->get({j, k}) == x->get({i * batch_size + j, k})\" failed");
+                }
+                MAGMADNN_TEST_ASSERT_DEFAULT(y_batch->get(j) == y->get(i * batch_size + j),
+                                             "\"y_batch->get(j) == y->get(i * batch_size + j)\" failed");
+            }
+        }
+        data->reset();
+    }
+
+    dataloader::prefetch_stats_t stats = data->get_stats();
+    MAGMADNN_TEST_ASSERT_DEFAULT(stats.n_batches == 3 * data->get_num_batches(), "\"stats.n_batches\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(stats.n_swapped == 2 * stats.n_batches, "\"stats.n_swapped\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(stats.n_stalls <= stats.n_batches, "\"stats.n_stalls\" failed");
+
+    delete data;
+    delete linear;
+    delete x_batch;
+    delete y_batch;
+    delete x;
+    delete y;
+
+    show_success();
+}
+
+void test_shuffle(memory_t mem_type, unsigned int size) {
+    printf("Testing %s shuffle loader...  ", get_memory_type_name(mem_type));
+
+    /* sample i has every feature equal to i, so a batch row tells which sample it is */
+    unsigned int n_samples = size + 3, n_features = 7, batch_size = size / 4;
+    Tensor<float> *x = new Tensor<float>({n_samples, n_features}, {NONE, {}}, mem_type);
+    Tensor<float> *y = new Tensor<float>({n_samples}, {NONE, {}}, mem_type);
+    for (unsigned int i = 0; i < n_samples; i++) {
+        for (unsigned int k = 0; k < n_features; k++) x->set({i, k}, (float) i);
+        y->set(i, (float) i);
+    }
+
+    dataloader::ShuffleLoader<float> *data = new dataloader::ShuffleLoader<float>(x, y, batch_size, 42u);
+    dataloader::ShuffleLoader<float> *same = new dataloader::ShuffleLoader<float>(x, y, batch_size, 42u);
+    Tensor<float> *x_batch = new Tensor<float>({batch_size, n_features}, mem_type);
+    Tensor<float> *y_batch = new Tensor<float>({batch_size, 1}, mem_type);
+
+    /* the last, partial batch is kept */
+    MAGMADNN_TEST_ASSERT_DEFAULT(data->get_num_batches() == (n_samples + batch_size - 1) / batch_size,
+                                 "\"get_num_batches() == ceil(n_samples / batch_size)\" failed");
+
+    std::vector<unsigned int> first_epoch;
+    for (unsigned int epoch = 0; epoch < 2; epoch++) {
+        std::vector<unsigned int> seen(n_samples, 0);
+        std::vector<unsigned int> order;
+
+        for (unsigned int i = 0; i < data->get_num_batches(); i++) {
+            data->next(x_batch, y_batch);
+            for (unsigned int j = 0; j < data->get_last_batch_count(); j++) {
+                unsigned int sample = (unsigned int) y_batch->get(j);
+                for (unsigned int k = 0; k < n_features; k++) {
+                    MAGMADNN_TEST_ASSERT_DEFAULT(x_batch->get({j, k}) == (float) sample,
+                                                 "\"x_batch->get({j, k}) == sample\" failed");
+                }
+                seen[sample]++;
+                order.push_back(sample);
+            }
+        }
+
+        /* every sample exactly once per epoch */
+        for (unsigned int i = 0; i < n_samples; i++) {
+            MAGMADNN_TEST_ASSERT_DEFAULT(seen[i] == 1, "\"seen[i] == 1\" failed");
+        }
+
+        if (epoch == 0) {
+            first_epoch = order;
+        } else {
+            MAGMADNN_TEST_ASSERT_DEFAULT(order != first_epoch, "\"order != first_epoch\" failed");
+        }
+        data->reset();
+    }
+
+    /* the same seed reproduces the same order */
+    MAGMADNN_TEST_ASSERT_DEFAULT(std::vector<unsigned int>(same->get_permutation()) == first_epoch,
+                                 "\"same->get_permutation() == first_epoch\" failed");
+
+    delete data;
+    delete same;
+    delete x_batch;
+    delete y_batch;
+    delete x;
+    delete y;
+
+    show_success();
+}
+
+void test_binary(memory_t mem_type, unsigned int size) {
+    printf("Testing %s binary dataset...  ", get_memory_type_name(mem_type));
+
+    /* feature k of sample i is i + k / 4, which uint8 with scale 1/4, fp16 and fp32 all store exactly */
+    unsigned int n_samples = size + 3, n_features = 6, n_classes = 3, batch_size = size / 4;
+    Tensor<float> *x = new Tensor<float>({n_samples, n_features}, {NONE, {}}, mem_type);
+    Tensor<float> *y = new Tensor<float>({n_samples, n_classes}, {ZERO, {}}, mem_type);
+    for (unsigned int i = 0; i < n_samples; i++) {
+        for (unsigned int k = 0; k < n_features; k++) x->set({i, k}, i + k / 4.0f);
+        y->set({i, i % n_classes}, 1.0f);
+    }
+
+    Tensor<float> *x_batch = new Tensor<float>({batch_size, n_features}, mem_type);
+    Tensor<float> *y_batch = new Tensor<float>({batch_size, n_classes}, mem_type);
+    const data::binary_dtype_t dtypes[] = {data::BINARY_UINT8, data::BINARY_FLOAT16, data::BINARY_FLOAT32};
+    const char *file_name = "testing_binary_dataset.bin";
+
+    for (data::binary_dtype_t dtype : dtypes) {
+        float scale = (dtype == data::BINARY_UINT8) ? 0.25f : 1.0f;
+        MAGMADNN_TEST_ASSERT_DEFAULT(data::write_binary_dataset(file_name, x, y, dtype, scale) == 0,
+                                     "\"write_binary_dataset(...) == 0\" failed");
+
+        data::BinaryDataset<float> dataset(file_name);
+        MAGMADNN_TEST_ASSERT_DEFAULT(dataset.is_open(), "\"dataset.is_open()\" failed");
+        MAGMADNN_TEST_ASSERT_DEFAULT(dataset.n_samples() == n_samples && dataset.sample_size() == n_features &&
+                                         dataset.n_classes() == n_classes,
+                                     "\"dataset header\" failed");
+
+        /* shuffled, every sample comes back exactly once per epoch, with its features and label */
+        dataloader::BinaryLoader<float> loader(&dataset, batch_size);
+        loader.set_seed(7u);
+        std::vector<unsigned int> seen(n_samples, 0);
+        for (unsigned int b = 0; b < loader.get_num_batches(); b++) {
+            loader.next(x_batch, y_batch);
+            for (unsigned int j = 0; j < batch_size; j++) {
+                unsigned int sample = (unsigned int) x_batch->get({j, 0u});
+                for (unsigned int k = 0; k < n_features; k++) {
+                    MAGMADNN_TEST_ASSERT_DEFAULT(x_batch->get({j, k}) == sample + k / 4.0f,
+                                                 "\"x_batch->get({j, k}) == sample + k / 4\" failed");
+                }
+                for (unsigned int c = 0; c < n_classes; c++) {
+                    MAGMADNN_TEST_ASSERT_DEFAULT(y_batch->get({j, c}) == ((c == sample % n_classes) ? 1.0f : 0.0f),
+                                                 "\"y_batch is one hot\" failed");
+                }
+                seen[sample]++;
+            }
+        }
+        for (unsigned int i = 0; i < loader.get_num_batches() * batch_size; i++) {
+            MAGMADNN_TEST_ASSERT_DEFAULT(seen[i] <= 1, "\"seen[i] <= 1\" failed");
+        }
+
+        /* only float32 files are viewed in place */
+        Tensor<float> *view = dataset.view(2, batch_size);
+        MAGMADNN_TEST_ASSERT_DEFAULT((view != NULL) == (dtype == data::BINARY_FLOAT32), "\"view\" failed");
+        if (view != NULL) {
+            MAGMADNN_TEST_ASSERT_DEFAULT(view->get_shape() == x_batch->get_shape(), "\"view shape\" failed");
+            MAGMADNN_TEST_ASSERT_DEFAULT(view->get({1, 2}) == x->get({3, 2}), "\"view->get({1, 2})\" failed");
+            MAGMADNN_TEST_ASSERT_DEFAULT(!view->get_memory_manager()->owns_memory(), "\"view owns no memory\" failed");
+            delete view;
+        }
+
+        /* labels that do not fit the target are refused rather than written past its end */
+        Tensor<float> *y_short = new Tensor<float>({batch_size - 1}, mem_type);
+        MAGMADNN_TEST_ASSERT_DEFAULT(dataset.load_range(0, batch_size, x_batch, y_short) != 0,
+                                     "\"load_range(..., y_short) != 0\" failed");
+        delete y_short;
+    }
+
+    /* a header whose sizes only fit the file because they overflow is rejected */
+    data::binary_dataset_header_t header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "MDNNDATA", sizeof(header.magic));
+    header.version = 1;
+    header.dtype = data::BINARY_FLOAT32;
+    header.n_samples = (uint64_t) 1 << 62;
+    header.n_dims = 1;
+    header.shape[0] = 4;
+    header.data_offset = 64;
+    header.labels_offset = 64;
+    const char padding[64] = {0};
+    FILE *file = std::fopen(file_name, "wb");
+    std::fwrite(&header, 1, sizeof(header), file);
+    std::fwrite(padding, 1, sizeof(padding), file);
+    std::fclose(file);
+    {
+        data::BinaryDataset<float> dataset(file_name);
+        MAGMADNN_TEST_ASSERT_DEFAULT(!dataset.is_open(), "\"!dataset.is_open()\" failed");
+    }
+    std::remove(file_name);
+
+    delete x_batch;
+    delete y_batch;
+    delete x;
+    delete y;
+
+    show_success();
+}
+
+void test_image_readers() {
+    printf("Testing image readers...  ");
+
+    /* an MNIST idx file of 3 images of 2 x 3 pixels, and its labels */
+    const uint8_t images_header[16] = {0, 0, 8, 3, 0, 0, 0, 3, 0, 0, 0, 2, 0, 0, 0, 3};
+    const uint8_t labels_header[8] = {0, 0, 8, 1, 0, 0, 0, 3};
+    const uint8_t labels[3] = {4, 0, 9};
+    uint8_t pixels[18];
+    for (unsigned int i = 0; i < 18; i++) pixels[i] = (uint8_t)(i * 15);
+
+    FILE *file = std::fopen("testing_mnist_images", "wb");
+    std::fwrite(images_header, 1, sizeof(images_header), file);
+    std::fwrite(pixels, 1, sizeof(pixels), file);
+    std::fclose(file);
+    file = std::fopen("testing_mnist_labels", "wb");
+    std::fwrite(labels_header, 1, sizeof(labels_header), file);
+    std::fwrite(labels, 1, sizeof(labels), file);
+    std::fclose(file);
+
+    uint32_t n_images, n_rows, n_cols, n_labels;
+    Tensor<float> *x = data::read_mnist_images("testing_mnist_images", n_images, n_rows, n_cols);
+    Tensor<float> *y = data::read_mnist_labels("testing_mnist_labels", n_labels, 10);
+    Tensor<float> *x_std = data::read_mnist_images("testing_mnist_images", n_images, n_rows, n_cols,
+                                                   data::pixel_normalization_t({33.0f}, {2.0f}));
+    std::remove("testing_mnist_images");
+    std::remove("testing_mnist_labels");
+
+    MAGMADNN_TEST_ASSERT_DEFAULT(x != NULL && y != NULL && x_std != NULL, "\"read_mnist_*(...) != NULL\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(n_images == 3 && n_rows == 2 && n_cols == 3 && n_labels == 3,
+                                 "\"mnist header\" failed");
+
+    /* by default pixels map to pixel / 128 - 1 */
+    for (unsigned int i = 0; i < 18; i++) {
+        MAGMADNN_TEST_ASSERT_DEFAULT(x->get(i) == pixels[i] / 128.0f - 1.0f, "\"x->get(i) == pixel / 128 - 1\" failed");
+        MAGMADNN_TEST_ASSERT_DEFAULT(x_std->get(i) == (pixels[i] - 33.0f) / 2.0f,
+                                     "\"x_std->get(i) == (pixel - mean) / std\" failed");
+    }
+    for (unsigned int i = 0; i < 3; i++) {
+        for (unsigned int c = 0; c < 10; c++) {
+            MAGMADNN_TEST_ASSERT_DEFAULT(y->get({i, c}) == ((c == labels[i]) ? 1.0f : 0.0f),
+                                         "\"y is one hot\" failed");
+        }
+    }
+
+    /* per channel statistics, reading images that are 1 byte apart as in CIFAR records */
+    uint8_t records[2 * 5] = {7, 10, 20, 30, 40, 8, 50, 60, 70, 80};
+    float out[2 * 4];
+    MAGMADNN_TEST_ASSERT_DEFAULT(data::normalize_pixels(records + 1, 5, out, 2, 2, 2,
+                                                        data::pixel_normalization_t({10.0f, 20.0f}, {5.0f, 4.0f})) == 0,
+                                 "\"normalize_pixels(...) == 0\" failed");
+    const float expected[8] = {0.0f, 2.0f, 2.5f, 5.0f, 8.0f, 10.0f, 12.5f, 15.0f};
+    for (unsigned int i = 0; i < 8; i++) {
+        MAGMADNN_TEST_ASSERT_DEFAULT(out[i] == expected[i], "\"out[i] == expected[i]\" failed");
+    }
+
+    delete x;
+    delete y;
+    delete x_std;
+
+    show_success();
+}
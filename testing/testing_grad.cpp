@@ -17,6 +17,11 @@ using namespace magmadnn;
 void test_simple_grad(memory_t mem, unsigned int size);
 void test_full_grad(memory_t mem, unsigned int size);
 void test_optimize(memory_t mem, unsigned int size);
+void test_multi_consumer_grad(memory_t mem, unsigned int size);
+void test_backward_executor(memory_t mem, unsigned int size);
+void test_pruned_grad(memory_t mem, unsigned int size);
+void test_memory_planner(memory_t mem, unsigned int size);
+void test_grad_ready_callback(memory_t mem, unsigned int size);
 
 int main(int argc, char **argv) {
     magmadnn_init();
@@ -24,6 +29,11 @@ int main(int argc, char **argv) {
     test_for_all_mem_types(test_simple_grad, 20);
     test_for_all_mem_types(test_full_grad, 10);
     test_for_all_mem_types(test_optimize, 20);
+    test_for_all_mem_types(test_multi_consumer_grad, 10);
+    test_for_all_mem_types(test_backward_executor, 10);
+    test_for_all_mem_types(test_pruned_grad, 10);
+    test_for_all_mem_types(test_memory_planner, 10);
+    test_for_all_mem_types(test_grad_ready_callback, 10);
 
     magmadnn_finalize();
     return 0;
@@ -133,3 +143,275 @@ void test_optimize(memory_t mem, unsigned int size) {
 
     show_success();
 }
+
+void test_multi_consumer_grad(memory_t mem, unsigned int size) {
+    printf("Testing multi-consumer grad on %s...  ", get_memory_type_name(mem));
+
+    /* x feeds five operations: d/dx (x^2 - x + (x + x) + 3x) = 2x + 4. The adds pass their gradient straight
+       through, so the partial gradients alias other entries of the grad table. */
+    float val = 3.0f;
+
+    op::Operation<float> *x = op::var<float>("x", {size, size}, {CONSTANT, {val}}, mem);
+    op::Operation<float> *inner = op::add(x, x);
+    op::Operation<float> *expr =
+        op::add(op::add(op::add(op::pow(x, 2), op::negative(x)), inner), op::scalarproduct(3.0f, x));
+
+    Tensor<float> *forward = expr->eval();
+    sync(forward);
+
+    for (unsigned int iter = 0; iter < 2; iter++) {
+        op::GradTable<float> table;
+        magmadnn_error_t err = op::get_grad_table({x}, expr, table);
+
+        MAGMADNN_TEST_ASSERT_DEFAULT(err == 0, "\"err == 0\" failed");
+
+        Tensor<float> *d_expr_wrt_x = table.get(x);
+        Tensor<float> *d_expr_wrt_inner = table.get(inner);
+        MAGMADNN_TEST_ASSERT_DEFAULT(d_expr_wrt_x != NULL, "\"d_expr_wrt_x != NULL\" failed");
+        MAGMADNN_TEST_ASSERT_DEFAULT(d_expr_wrt_x->get_size() == size * size, "\"size == size * size\" failed");
+
+        sync(d_expr_wrt_x);
+
+        for (unsigned int i = 0; i < d_expr_wrt_x->get_size(); i++) {
+            MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(d_expr_wrt_x->get(i), 2.0f * val + 4.0f);
+        }
+        /* inner's gradient is the scalar loss gradient passed through the head add */
+        MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(d_expr_wrt_inner->get(0), 1.0f);
+    }
+
+    /* x has several consumers, so deleting expr would free it more than once */
+
+    show_success();
+}
+
+void test_backward_executor(memory_t mem, unsigned int size) {
+    printf("Testing backward executor on %s...  ", get_memory_type_name(mem));
+
+    /* d/dx of x negated depth times is (-1)^depth */
+    unsigned int depth = 101;
+    float expected = -1.0f;
+
+    op::Operation<float> *x = op::var<float>("x", {size, size}, {CONSTANT, {2.0f}}, mem);
+    op::Operation<float> *expr = x;
+    for (unsigned int i = 0; i < depth; i++) expr = op::negative(expr);
+
+    expr->eval();
+
+    op::GradTable<float> table;
+    table.get_executor().set_release_buffers(true);
+    for (unsigned int iter = 0; iter < 2; iter++) {
+        table.clear();
+        magmadnn_error_t err = op::get_grad_table({x}, expr, table);
+
+        MAGMADNN_TEST_ASSERT_DEFAULT(err == 0, "\"err == 0\" failed");
+        MAGMADNN_TEST_ASSERT_DEFAULT(table.get_executor().get_order().size() == depth + 1,
+                                     "\"order.size() == depth + 1\" failed");
+
+        /* only the head and x are left, every intermediate gradient was freed after its single reader ran */
+        MAGMADNN_TEST_ASSERT_DEFAULT(table.get_size() == 2, "\"table.get_size() == 2\" failed");
+        MAGMADNN_TEST_ASSERT_DEFAULT(table.get_executor().get_num_released() == depth - 1,
+                                     "\"get_num_released() == depth - 1\" failed");
+
+        Tensor<float> *d_expr_wrt_x = table.get(x);
+        sync(d_expr_wrt_x);
+
+        for (unsigned int i = 0; i < d_expr_wrt_x->get_size(); i++) {
+            MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(d_expr_wrt_x->get(i), expected);
+        }
+    }
+
+    /* by default nothing is released, every gradient stays in the table */
+    op::GradTable<float> keep_table;
+    MAGMADNN_TEST_ASSERT_DEFAULT(!keep_table.get_executor().get_release_buffers(),
+                                 "\"!get_release_buffers()\" failed");
+    op::get_grad_table({x}, expr, keep_table);
+    MAGMADNN_TEST_ASSERT_DEFAULT(keep_table.get_size() == depth + 1, "\"keep_table.get_size() == depth + 1\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(keep_table.get_executor().get_num_released() == 0,
+                                 "\"get_num_released() == 0\" failed");
+    MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(keep_table.get(x)->get(0), expected);
+
+    delete expr;
+
+    show_success();
+}
+
+void test_pruned_grad(memory_t mem, unsigned int size) {
+    printf("Testing pruned grad on %s...  ", get_memory_type_name(mem));
+
+    /* loss = -(w * -frozen) = w * frozen, so its gradient wrt w is frozen. The side branch -(w) does not lead to the
+       loss. Only w, the product and the head are scheduled, -frozen does not depend on w. */
+    float w_val = 2.0f, f_val = 3.0f;
+
+    op::Operation<float> *w = op::var<float>("w", {size}, {CONSTANT, {w_val}}, mem);
+    op::Operation<float> *frozen = op::var<float>("frozen", {size}, {CONSTANT, {f_val}}, mem);
+    op::Operation<float> *prod = op::product(w, op::negative(frozen));
+    op::Operation<float> *loss = op::negative(prod);
+    op::Operation<float> *side = op::negative(w);
+
+    loss->eval();
+
+    op::GradTable<float> table;
+    magmadnn_error_t err = op::get_grad_table({w}, loss, table);
+
+    MAGMADNN_TEST_ASSERT_DEFAULT(err == 0, "\"err == 0\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(table.get_executor().get_order().size() == 3, "\"order.size() == 3\" failed");
+
+    Tensor<float> *d_loss_wrt_w = table.get(w);
+    sync(d_loss_wrt_w);
+
+    for (unsigned int i = 0; i < d_loss_wrt_w->get_size(); i++) {
+        MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(d_loss_wrt_w->get(i), f_val);
+    }
+
+    /* the loss does not depend on side */
+    err = op::get_grad_table({side}, loss, table);
+    MAGMADNN_TEST_ASSERT_DEFAULT(err == 2, "\"err == 2\" failed");
+
+    /* w is shared with side, so the graphs are not deleted */
+
+    show_success();
+}
+
+void test_memory_planner(memory_t mem, unsigned int size) {
+    printf("Testing memory planner on %s...  ", get_memory_type_name(mem));
+
+    /* h = -(w * h) repeated, so each activation is dead once the next layer has read it and w feeds every layer */
+    unsigned int depth = 8;
+    float x_val = 2.0f, w_val = 0.5f;
+
+    op::Operation<float> *x = op::var<float>("x", {size, size}, {CONSTANT, {x_val}}, mem);
+    op::Operation<float> *w = op::var<float>("w", {size, size}, {CONSTANT, {w_val}}, mem);
+    op::Operation<float> *h = x;
+    for (unsigned int i = 0; i < depth; i++) h = op::negative(op::product(w, h));
+
+    /* reference values without a plan */
+    Tensor<float> *out = h->eval();
+    sync(out);
+    float out_val = out->get(0);
+
+    op::GradTable<float> table;
+    op::get_grad_table({x, w}, h, table);
+    sync(table.get(x));
+    float dx_val = table.get(x)->get(0), dw_val = table.get(w)->get(0);
+
+    op::MemoryPlanner<float> planner;
+    magmadnn_error_t err = planner.plan(h, {x, w});
+
+#if defined(MAGMADNN_HAVE_CUDA)
+    /* managed memory cannot be planned */
+    if (mem == MANAGED) {
+        MAGMADNN_TEST_ASSERT_DEFAULT(err != 0, "\"err != 0\" failed");
+        show_success();
+        return;
+    }
+#endif
+
+    MAGMADNN_TEST_ASSERT_DEFAULT(err == 0, "\"err == 0\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(planner.get_num_buffers() > 0, "\"get_num_buffers() > 0\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(planner.get_planned_bytes() < planner.get_naive_bytes(),
+                                 "\"get_planned_bytes() < get_naive_bytes()\" failed");
+
+    err = planner.bind();
+    MAGMADNN_TEST_ASSERT_DEFAULT(err == 0 && planner.is_bound(), "\"bind\" failed");
+
+    for (unsigned int iter = 0; iter < 2; iter++) {
+        out = h->eval(true);
+        table.clear();
+        err = op::get_grad_table({x, w}, h, table);
+        MAGMADNN_TEST_ASSERT_DEFAULT(err == 0, "\"err == 0\" failed");
+
+        sync(out);
+        sync(table.get(x));
+        sync(table.get(w));
+
+        for (unsigned int i = 0; i < out->get_size(); i++) {
+            MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(out->get(i), out_val);
+            MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(table.get(x)->get(i), dx_val);
+            MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(table.get(w)->get(i), dw_val);
+        }
+    }
+
+    /* the tensors get their own memory back with their contents */
+    planner.unbind();
+    MAGMADNN_TEST_ASSERT_DEFAULT(!planner.is_bound(), "\"!is_bound()\" failed");
+    MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(h->get_output_tensor()->get(0), out_val);
+    MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(table.get(x)->get(0), dx_val);
+
+    /* w has several consumers, so the graph is not deleted */
+
+    /* a graph can also be planned before its first backward pass, when no gradient is cached yet */
+    op::Operation<float> *u = op::var<float>("u", {size, size}, {CONSTANT, {x_val}}, mem);
+    op::Operation<float> *g = op::negative(op::negative(u));
+    MAGMADNN_TEST_ASSERT_DEFAULT(g->get_grad_tensor(u) == NULL, "\"get_grad_tensor(u) == NULL\" failed");
+
+    op::MemoryPlanner<float> fresh;
+    MAGMADNN_TEST_ASSERT_DEFAULT(fresh.plan(g, {u}) == 0, "\"fresh.plan(g, {u}) == 0\" failed");
+    err = fresh.bind();
+    MAGMADNN_TEST_ASSERT_DEFAULT(err == 0, "\"bind\" failed");
+
+    g->eval(true);
+    op::GradTable<float> fresh_table;
+    err = op::get_grad_table({u}, g, fresh_table);
+    MAGMADNN_TEST_ASSERT_DEFAULT(err == 0, "\"err == 0\" failed");
+
+    sync(fresh_table.get(u));
+    MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(fresh_table.get(u)->get(0), 1.0f);
+    fresh.unbind();
+    delete g;
+
+    show_success();
+}
+
+void test_grad_ready_callback(memory_t mem, unsigned int size) {
+    printf("Testing grad ready callback on %s...  ", get_memory_type_name(mem));
+
+    /* loss = -(a + -(-b)), so both gradients are -1. The gradient of a is done before the two negations of b run,
+       even though b is requested first. */
+    op::Operation<float> *a = op::var<float>("a", {size}, {CONSTANT, {1.0f}}, mem);
+    op::Operation<float> *b = op::var<float>("b", {size}, {CONSTANT, {2.0f}}, mem);
+    op::Operation<float> *loss = op::negative(op::add(a, op::negative(op::negative(b))));
+
+    loss->eval();
+
+    std::vector<op::Operation<float> *> ready_vars;
+    std::vector<Tensor<float> *> ready_grads;
+    std::vector<float> ready_values;
+
+    op::GradTable<float> table;
+    table.get_executor().set_grad_ready_callback([&](op::Operation<float> *var, Tensor<float> *grad) {
+        sync(grad);
+        ready_vars.push_back(var);
+        ready_grads.push_back(grad);
+        ready_values.push_back(grad->get(grad->get_size() - 1));
+    });
+
+    for (unsigned int iter = 0; iter < 2; iter++) {
+        ready_vars.clear();
+        ready_grads.clear();
+        ready_values.clear();
+
+        table.clear();
+        magmadnn_error_t err = op::get_grad_table({b, a}, loss, table);
+
+        MAGMADNN_TEST_ASSERT_DEFAULT(err == 0, "\"err == 0\" failed");
+        MAGMADNN_TEST_ASSERT_DEFAULT(ready_vars.size() == 2, "\"ready_vars.size() == 2\" failed");
+        MAGMADNN_TEST_ASSERT_DEFAULT(ready_vars[0] == a && ready_vars[1] == b, "\"ready order is a, b\" failed");
+
+        for (unsigned int i = 0; i < ready_vars.size(); i++) {
+            MAGMADNN_TEST_ASSERT_DEFAULT(ready_grads[i] == table.get(ready_vars[i]),
+                                         "\"ready_grads[i] == table.get(ready_vars[i])\" failed");
+            MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(ready_values[i], -1.0f);
+        }
+    }
+
+    /* an empty callback turns it off */
+    ready_vars.clear();
+    table.get_executor().set_grad_ready_callback(std::function<void(op::Operation<float> *, Tensor<float> *)>());
+    table.clear();
+    op::get_grad_table({b, a}, loss, table);
+    MAGMADNN_TEST_ASSERT_DEFAULT(ready_vars.empty(), "\"ready_vars.empty()\" failed");
+
+    delete loss;
+
+    show_success();
+}
@@ -163,6 +163,18 @@ void test_activation(memory_t mem, unsigned int size) {
                                      "\"fabs(output_tensor->get(i) - tanh(val)) <= 1E-8\" failed");
     }
 
+    /* a fully connected layer feeding the activation is fused with it on HOST, unless fusion is turned off */
+    if (mem == HOST) {
+        layer::FullyConnectedLayer<float> *fc = layer::fullyconnected<float>(data, size);
+        layer::ActivationLayer<float> *fused = layer::activation(fc->out(), layer::RELU);
+        MAGMADNN_TEST_ASSERT_DEFAULT(fused->out()->get_name() == "FusedDense", "\"fused\" failed");
+
+        layer::FullyConnectedLayer<float> *fc_unfused = layer::fullyconnected<float>(data, size);
+        layer::ActivationLayer<float> *unfused = layer::activation(fc_unfused->out(), layer::RELU, false);
+        MAGMADNN_TEST_ASSERT_DEFAULT(unfused->out()->get_name() != "FusedDense", "\"!fused\" failed");
+        MAGMADNN_TEST_ASSERT_DEFAULT(unfused->out()->get_inputs()[0] == fc_unfused->out(), "\"unfused input\" failed");
+    }
+
     show_success();
 }
 
@@ -8,7 +8,10 @@
  *
  */
 
+#include <cmath>
+
 #include "magmadnn.h"
+#include "math/half.h"
 #include "utilities.h"
 
 using namespace magmadnn;
@@ -23,6 +26,11 @@ void test_bias_add(memory_t mem, unsigned int size);
 void test_sum(memory_t mem, unsigned int size);
 void test_concat(memory_t mem, unsigned int size);
 void test_tile(memory_t mem, unsigned int size);
+void test_conv2d(memory_t mem, unsigned int size);
+void test_pooling(memory_t mem, unsigned int size);
+void test_batchnorm(memory_t mem, unsigned int size);
+void test_parallel_reductions(memory_t mem, unsigned int size);
+void test_half_conversions(memory_t mem, unsigned int size);
 
 int main(int argc, char **argv) {
     magmadnn_init();
@@ -41,6 +49,12 @@ int main(int argc, char **argv) {
     test_for_all_mem_types(test_concat, 4);
     test_for_all_mem_types(test_tile, 4);
 
+    test_conv2d(HOST, 7);
+    test_pooling(HOST, 9);
+    test_batchnorm(HOST, 6);
+    test_parallel_reductions(HOST, 300000);
+    test_half_conversions(HOST, 0);
+
     magmadnn_finalize();
 }
 
@@ -314,3 +328,372 @@ void test_tile(memory_t mem, unsigned int size) {
 
     show_success();
 }
+
+/* reference convolution, out[n,k,p,q] = sum_{c,r,s} x[n,c,p*u-pad_h+r*dil_h,q*v-pad_w+s*dil_w] * w[k,c,r,s] */
+static void conv2d_reference(Tensor<double> &x, Tensor<double> &w, Tensor<double> &out,
+                             const math::conv2d_cpu_settings &s) {
+    unsigned int kh = w.get_shape(2), kw = w.get_shape(3);
+    for (unsigned int n = 0; n < out.get_shape(0); n++)
+        for (unsigned int k = 0; k < out.get_shape(1); k++)
+            for (unsigned int p = 0; p < out.get_shape(2); p++)
+                for (unsigned int q = 0; q < out.get_shape(3); q++) {
+                    double acc = 0.0;
+                    for (unsigned int c = 0; c < x.get_shape(1); c++)
+                        for (unsigned int r = 0; r < kh; r++)
+                            for (unsigned int t = 0; t < kw; t++) {
+                                int iy = p * s.vertical_stride - s.pad_h + r * s.dilation_h;
+                                int ix = q * s.horizontal_stride - s.pad_w + t * s.dilation_w;
+                                if (iy < 0 || ix < 0 || iy >= (int) x.get_shape(2) || ix >= (int) x.get_shape(3))
+                                    continue;
+                                unsigned int wr = (s.use_cross_correlation) ? r : kh - 1 - r;
+                                unsigned int wt = (s.use_cross_correlation) ? t : kw - 1 - t;
+                                acc += x.get({n, c, (unsigned int) iy, (unsigned int) ix}) * w.get({k, c, wr, wt});
+                            }
+                    out.set({n, k, p, q}, acc);
+                }
+}
+
+static void test_conv2d_config(unsigned int size, unsigned int channels, unsigned int out_channels, unsigned int kh,
+                               unsigned int kw, int pad, int stride, int dilation, bool cross_correlation,
+                               math::conv2d_cpu_algo_t expected_algo) {
+    unsigned int batch_size = 3;
+    unsigned int oh = 1 + (size + 2 * pad - ((kh - 1) * dilation + 1)) / stride;
+    unsigned int ow = 1 + (size + 2 * pad - ((kw - 1) * dilation + 1)) / stride;
+
+    math::conv2d_cpu_settings s;
+    s.pad_h = s.pad_w = pad;
+    s.vertical_stride = s.horizontal_stride = stride;
+    s.dilation_h = s.dilation_w = dilation;
+    s.use_cross_correlation = cross_correlation;
+
+    Tensor<double> x({batch_size, channels, size, size}, {UNIFORM, {-1.0, 1.0}}, HOST);
+    Tensor<double> w({out_channels, channels, kh, kw}, {UNIFORM, {-1.0, 1.0}}, HOST);
+    Tensor<double> y({batch_size, out_channels, oh, ow}, {NONE, {}}, HOST);
+    Tensor<double> y_ref({batch_size, out_channels, oh, ow}, {NONE, {}}, HOST);
+    Tensor<double> dy({batch_size, out_channels, oh, ow}, {UNIFORM, {-1.0, 1.0}}, HOST);
+    Tensor<double> dx({batch_size, channels, size, size}, {NONE, {}}, HOST);
+    Tensor<double> dw({out_channels, channels, kh, kw}, {NONE, {}}, HOST);
+
+    math::conv2d_cpu_init_settings<double>(x.get_shape(), w.get_shape(), y.get_shape(), s);
+    MAGMADNN_TEST_ASSERT_DEFAULT(s.algo == expected_algo, "\"s.algo == expected_algo\" failed");
+    std::vector<double> workspace(s.workspace_size / sizeof(double) + 1);
+    s.workspace = workspace.data();
+
+    math::conv2d(&x, &w, &y, s);
+    conv2d_reference(x, w, y_ref, s);
+    for (unsigned int i = 0; i < y.get_size(); i++) {
+        MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(y.get(i), y_ref.get(i));
+    }
+
+    /* <dy, conv(x, w)> is linear in x and w, so the gradients are checked against the forward reference */
+    math::conv2d_grad_data(&w, &dy, &dx, s);
+    math::conv2d_grad_filter(&x, &dy, &dw, s);
+
+    double dot_ref = 0.0, dot_dx = 0.0, dot_dw = 0.0;
+    for (unsigned int i = 0; i < y.get_size(); i++) dot_ref += dy.get(i) * y_ref.get(i);
+    for (unsigned int i = 0; i < x.get_size(); i++) dot_dx += dx.get(i) * x.get(i);
+    for (unsigned int i = 0; i < w.get_size(); i++) dot_dw += dw.get(i) * w.get(i);
+    MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(dot_dx, dot_ref);
+    MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(dot_dw, dot_ref);
+
+    /* check individual gradient entries with unit perturbations */
+    for (unsigned int i = 0; i < x.get_size(); i += 5) {
+        double saved = x.get(i);
+        x.set(i, saved + 1.0);
+        conv2d_reference(x, w, y_ref, s);
+        double dot_plus = 0.0;
+        for (unsigned int j = 0; j < y.get_size(); j++) dot_plus += dy.get(j) * y_ref.get(j);
+        x.set(i, saved);
+        MAGMADNN_TEST_ASSERT_FEQUAL(dx.get(i), dot_plus - dot_ref, 1E-8, true, "%g != %g", dx.get(i),
+                                    dot_plus - dot_ref);
+    }
+    for (unsigned int i = 0; i < w.get_size(); i += 3) {
+        double saved = w.get(i);
+        w.set(i, saved + 1.0);
+        conv2d_reference(x, w, y_ref, s);
+        double dot_plus = 0.0;
+        for (unsigned int j = 0; j < y.get_size(); j++) dot_plus += dy.get(j) * y_ref.get(j);
+        w.set(i, saved);
+        MAGMADNN_TEST_ASSERT_FEQUAL(dw.get(i), dot_plus - dot_ref, 1E-8, true, "%g != %g", dw.get(i),
+                                    dot_plus - dot_ref);
+    }
+}
+
+void test_conv2d(memory_t mem, unsigned int size) {
+    printf("Testing %s conv2d...  ", get_memory_type_name(mem));
+
+    /* direct 3x3 */
+    test_conv2d_config(size, 3, 4, 3, 3, 1, 1, 1, true, math::CONV2D_CPU_ALGO_DIRECT_3X3);
+    test_conv2d_config(size, 2, 3, 3, 3, 0, 1, 1, false, math::CONV2D_CPU_ALGO_DIRECT_3X3);
+    /* 1x1 */
+    test_conv2d_config(size, 5, 4, 1, 1, 0, 1, 1, true, math::CONV2D_CPU_ALGO_GEMM_1X1);
+    /* im2col */
+    test_conv2d_config(size, 8, 4, 3, 3, 1, 1, 1, true, math::CONV2D_CPU_ALGO_IM2COL_GEMM);
+    test_conv2d_config(size, 3, 2, 3, 3, 1, 2, 1, true, math::CONV2D_CPU_ALGO_IM2COL_GEMM);
+    test_conv2d_config(size, 2, 3, 2, 3, 2, 1, 2, false, math::CONV2D_CPU_ALGO_IM2COL_GEMM);
+    test_conv2d_config(size, 4, 2, 1, 1, 0, 2, 1, true, math::CONV2D_CPU_ALGO_IM2COL_GEMM);
+
+    show_success();
+}
+
+static void test_pooling_config(unsigned int size, int filter, int pad, int stride, pooling_mode mode) {
+    unsigned int batch_size = 2, channels = 3;
+    unsigned int out_size = 1 + (size + 2 * pad - filter) / stride;
+
+    Tensor<double> x({batch_size, channels, size, size}, {UNIFORM, {-1.0, 1.0}}, HOST);
+    Tensor<double> y({batch_size, channels, out_size, out_size}, {NONE, {}}, HOST);
+    Tensor<double> dy({batch_size, channels, out_size, out_size}, {UNIFORM, {-1.0, 1.0}}, HOST);
+    Tensor<double> dx({batch_size, channels, size, size}, {NONE, {}}, HOST);
+    Tensor<double> dx_ref({batch_size, channels, size, size}, {ZERO, {}}, HOST);
+    std::vector<int> argmax(y.get_size());
+
+    math::pooling_cpu_settings s;
+    s.filter_h = s.filter_w = filter;
+    s.pad_h = s.pad_w = pad;
+    s.vertical_stride = s.horizontal_stride = stride;
+    s.mode = mode;
+    s.propagate_nan = false;
+    s.argmax = argmax.data();
+
+    math::pooling(&x, &y, s);
+    math::pooling_grad(&x, &y, &dy, &dx, s);
+
+    for (unsigned int n = 0; n < batch_size; n++)
+        for (unsigned int c = 0; c < channels; c++)
+            for (unsigned int p = 0; p < out_size; p++)
+                for (unsigned int q = 0; q < out_size; q++) {
+                    double best = 0.0, sum = 0.0;
+                    unsigned int best_y = 0, best_x = 0, count = 0;
+                    for (int r = 0; r < filter; r++)
+                        for (int t = 0; t < filter; t++) {
+                            int iy = p * stride - pad + r, ix = q * stride - pad + t;
+                            if (iy < 0 || ix < 0 || iy >= (int) size || ix >= (int) size) continue;
+                            double v = x.get({n, c, (unsigned int) iy, (unsigned int) ix});
+                            if (count == 0 || v > best) {
+                                best = v;
+                                best_y = iy;
+                                best_x = ix;
+                            }
+                            sum += v;
+                            count++;
+                        }
+                    double g = dy.get({n, c, p, q});
+                    if (mode == MAX_POOL) {
+                        MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(y.get({n, c, p, q}), best);
+                        dx_ref.set({n, c, best_y, best_x}, dx_ref.get({n, c, best_y, best_x}) + g);
+                    } else {
+                        MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(y.get({n, c, p, q}), sum / count);
+                        for (int r = 0; r < filter; r++)
+                            for (int t = 0; t < filter; t++) {
+                                int iy = p * stride - pad + r, ix = q * stride - pad + t;
+                                if (iy < 0 || ix < 0 || iy >= (int) size || ix >= (int) size) continue;
+                                std::vector<unsigned int> idx = {n, c, (unsigned int) iy, (unsigned int) ix};
+                                dx_ref.set(idx, dx_ref.get(idx) + g / count);
+                            }
+                    }
+                }
+
+    for (unsigned int i = 0; i < dx.get_size(); i++) {
+        MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(dx.get(i), dx_ref.get(i));
+    }
+
+    /* without cached indices the backward pass rescans the input and must agree */
+    if (mode == MAX_POOL) {
+        s.argmax = NULL;
+        math::pooling_grad(&x, &y, &dy, &dx, s);
+        for (unsigned int i = 0; i < dx.get_size(); i++) {
+            MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(dx.get(i), dx_ref.get(i));
+        }
+    }
+}
+
+void test_pooling(memory_t mem, unsigned int size) {
+    printf("Testing %s pooling...  ", get_memory_type_name(mem));
+
+    test_pooling_config(size, 2, 0, 2, MAX_POOL);
+    test_pooling_config(size, 2, 1, 2, MAX_POOL);
+    test_pooling_config(size, 3, 1, 1, MAX_POOL);
+    test_pooling_config(size, 3, 0, 2, AVERAGE_POOL);
+    test_pooling_config(size, 3, 1, 2, AVERAGE_POOL);
+    test_pooling_config(size, 2, 1, 1, AVERAGE_POOL);
+
+    show_success();
+}
+
+static void test_batchnorm_config(const std::vector<unsigned int> &shape, math::batchnorm_cpu_mode_t mode) {
+    math::batchnorm_cpu_settings settings;
+    settings.mode = mode;
+    settings.epsilon = 1E-8;
+
+    std::vector<unsigned int> bn_shape = shape;
+    bn_shape[0] = 1;
+    if (mode == math::BATCHNORM_CPU_SPATIAL) {
+        for (unsigned int i = 2; i < bn_shape.size(); i++) bn_shape[i] = 1;
+    }
+
+    Tensor<double> x(shape, {UNIFORM, {3.0, 6.0}}, HOST);
+    Tensor<double> y(shape, {NONE, {}}, HOST);
+    Tensor<double> dy(shape, {UNIFORM, {-1.0, 1.0}}, HOST);
+    Tensor<double> dx(shape, {NONE, {}}, HOST);
+    Tensor<double> scale(bn_shape, {UNIFORM, {0.5, 1.5}}, HOST);
+    Tensor<double> bias(bn_shape, {UNIFORM, {-1.0, 1.0}}, HOST);
+    Tensor<double> scale_diff(bn_shape, {NONE, {}}, HOST);
+    Tensor<double> bias_diff(bn_shape, {NONE, {}}, HOST);
+    Tensor<double> running_mean(bn_shape, {ZERO, {}}, HOST);
+    Tensor<double> running_variance(bn_shape, {ZERO, {}}, HOST);
+    Tensor<double> saved_mean(bn_shape, {ZERO, {}}, HOST);
+    Tensor<double> saved_inv_std(bn_shape, {ZERO, {}}, HOST);
+    unsigned int num_calls = 0;
+
+    unsigned int channels = scale.get_size();
+    unsigned int inner = (mode == math::BATCHNORM_CPU_SPATIAL) ? x.get_size() / (shape[0] * channels) : 1;
+    unsigned int m = shape[0] * inner;
+
+    math::batchnorm(&x, &y, &scale, &bias, &running_mean, &running_variance, &saved_mean, &saved_inv_std, num_calls,
+                    settings);
+    MAGMADNN_TEST_ASSERT_DEFAULT(num_calls == 1, "\"num_calls == 1\" failed");
+
+    /* two-pass reference statistics */
+    for (unsigned int c = 0; c < channels; c++) {
+        double mean = 0.0, var = 0.0;
+        for (unsigned int n = 0; n < shape[0]; n++)
+            for (unsigned int i = 0; i < inner; i++) mean += x.get((n * channels + c) * inner + i);
+        mean /= m;
+        for (unsigned int n = 0; n < shape[0]; n++)
+            for (unsigned int i = 0; i < inner; i++) {
+                double d = x.get((n * channels + c) * inner + i) - mean;
+                var += d * d;
+            }
+        var /= m;
+
+        MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(saved_mean.get(c), mean);
+        MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(saved_inv_std.get(c), 1.0 / std::sqrt(var + settings.epsilon));
+        /* first call uses factor 1/2, like the cuDNN path */
+        MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(running_mean.get(c), 0.5 * mean);
+        MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(running_variance.get(c), 0.5 * var * m / (m - 1));
+
+        for (unsigned int n = 0; n < shape[0]; n++)
+            for (unsigned int i = 0; i < inner; i++) {
+                unsigned int idx = (n * channels + c) * inner + i;
+                double expected = scale.get(c) * (x.get(idx) - mean) / std::sqrt(var + settings.epsilon) + bias.get(c);
+                MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(y.get(idx), expected);
+            }
+    }
+
+    /* gradients against central differences of <dy, y> */
+    math::batchnorm_grad(&x, &dy, &dx, &scale, &scale_diff, &bias_diff, &saved_mean, &saved_inv_std, settings);
+
+    Tensor<double> rm(bn_shape, {ZERO, {}}, HOST), rv(bn_shape, {ZERO, {}}, HOST);
+    Tensor<double> sm(bn_shape, {ZERO, {}}, HOST), sv(bn_shape, {ZERO, {}}, HOST);
+    auto objective = [&]() {
+        unsigned int calls = 0;
+        math::batchnorm(&x, &y, &scale, &bias, &rm, &rv, &sm, &sv, calls, settings);
+        double acc = 0.0;
+        for (unsigned int i = 0; i < y.get_size(); i++) acc += dy.get(i) * y.get(i);
+        return acc;
+    };
+    const double h = 1E-5;
+    for (unsigned int i = 0; i < x.get_size(); i += 7) {
+        double saved = x.get(i);
+        x.set(i, saved + h);
+        double plus = objective();
+        x.set(i, saved - h);
+        double minus = objective();
+        x.set(i, saved);
+        MAGMADNN_TEST_ASSERT_FEQUAL(dx.get(i), (plus - minus) / (2 * h), 1E-6, true, "%g != %g", dx.get(i),
+                                    (plus - minus) / (2 * h));
+    }
+    for (unsigned int c = 0; c < channels; c++) {
+        double saved = scale.get(c);
+        scale.set(c, saved + h);
+        double plus = objective();
+        scale.set(c, saved - h);
+        double minus = objective();
+        scale.set(c, saved);
+        MAGMADNN_TEST_ASSERT_FEQUAL(scale_diff.get(c), (plus - minus) / (2 * h), 1E-6, true, "%g != %g",
+                                    scale_diff.get(c), (plus - minus) / (2 * h));
+
+        double sum_dy = 0.0;
+        for (unsigned int n = 0; n < shape[0]; n++)
+            for (unsigned int i = 0; i < inner; i++) sum_dy += dy.get((n * channels + c) * inner + i);
+        MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(bias_diff.get(c), sum_dy);
+    }
+
+    /* inference uses the running statistics */
+    math::batchnorm_inference(&x, &y, &scale, &bias, &running_mean, &running_variance, settings);
+    for (unsigned int i = 0; i < x.get_size(); i++) {
+        unsigned int c = (i / inner) % channels;
+        double expected = scale.get(c) * (x.get(i) - running_mean.get(c)) /
+                              std::sqrt(running_variance.get(c) + settings.epsilon) +
+                          bias.get(c);
+        MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(y.get(i), expected);
+    }
+}
+
+void test_batchnorm(memory_t mem, unsigned int size) {
+    printf("Testing %s batchnorm...  ", get_memory_type_name(mem));
+
+    test_batchnorm_config({4, 3, size, size}, math::BATCHNORM_CPU_SPATIAL);
+    test_batchnorm_config({8, 70}, math::BATCHNORM_CPU_PER_ACTIVATION);
+
+    show_success();
+}
+
+void test_parallel_reductions(memory_t mem, unsigned int size) {
+    printf("Testing %s parallel reductions...  ", get_memory_type_name(mem));
+
+    int n_threads = magmadnn_get_num_threads();
+
+    Tensor<float> x({size}, {UNIFORM, {-1.0f, 1.0f}}, mem);
+    Tensor<float> ones({size}, {ONE, {}}, mem);
+    Tensor<float> predicted({size / 10, 10}, {UNIFORM, {0.0f, 1.0f}}, mem);
+    Tensor<float> ground_truth({size / 10, 10}, {UNIFORM, {0.0f, 1.0f}}, mem);
+    Tensor<float> serial({1}, {NONE, {}}, mem), parallel({1}, {NONE, {}}, mem);
+
+    /* results must not depend on the number of threads */
+    magmadnn_set_num_threads(1);
+    math::reduce_sum(&x, 0, &ones, &serial);
+    magmadnn_set_num_threads(4);
+    math::reduce_sum(&x, 0, &ones, &parallel);
+    MAGMADNN_TEST_ASSERT_DEFAULT(serial.get(0) == parallel.get(0), "\"serial.get(0) == parallel.get(0)\" failed");
+
+    magmadnn_set_num_threads(1);
+    math::crossentropy(&predicted, &ground_truth, &serial);
+    magmadnn_set_num_threads(4);
+    math::crossentropy(&predicted, &ground_truth, &parallel);
+    MAGMADNN_TEST_ASSERT_DEFAULT(serial.get(0) == parallel.get(0), "\"serial.get(0) == parallel.get(0)\" failed");
+
+    magmadnn_set_num_threads(n_threads);
+
+    show_success();
+}
+
+void test_half_conversions(memory_t mem, unsigned int size) {
+    printf("Testing %s half conversions...  ", get_memory_type_name(mem));
+
+    /* exact values survive both formats */
+    float exact[] = {0.0f, 1.0f, -2.5f, 0.15625f, 1024.0f};
+    for (float v : exact) {
+        MAGMADNN_TEST_ASSERT_DEFAULT(math::half_to_float(math::float_to_half(v)) == v, "\"half round trip\" failed");
+        MAGMADNN_TEST_ASSERT_DEFAULT(math::bfloat16_to_float(math::float_to_bfloat16(v)) == v,
+                                     "\"bfloat16 round trip\" failed");
+    }
+
+    /* half saturates, bfloat16 keeps the range of float */
+    MAGMADNN_TEST_ASSERT_DEFAULT(math::half_to_float(math::float_to_half(65504.0f)) == 65504.0f,
+                                 "\"half max\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(std::isinf(math::half_to_float(math::float_to_half(1e6f))), "\"half inf\" failed");
+    MAGMADNN_TEST_ASSERT_FEQUAL(math::bfloat16_to_float(math::float_to_bfloat16(3e38f)), 3e38f, 3e36f, true,
+                                "\"bfloat16 range\" failed");
+
+    /* bfloat16 has 7 mantissa bits and rounds halfway cases to even */
+    MAGMADNN_TEST_ASSERT_DEFAULT(math::float_to_bfloat16(1.0f) == 0x3f80, "\"1.0f\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(math::float_to_bfloat16(1.0f + std::ldexp(1.0f, -8)) == 0x3f80,
+                                 "\"halfway rounds down to even\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(math::float_to_bfloat16(1.0f + 3 * std::ldexp(1.0f, -8)) == 0x3f82,
+                                 "\"halfway rounds up to even\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(std::isnan(math::bfloat16_to_float(math::float_to_bfloat16(std::nanf("")))),
+                                 "\"bfloat16 nan\" failed");
+
+    show_success();
+}
@@ -56,6 +56,43 @@ void test_copy(memory_t src_mem, memory_t dst_mem, int size, bool verbose) {
     if (verbose) show_success();
 }
 
+void test_caching_allocator(memory_t mem, int size, bool verbose) {
+    if (verbose) printf("Testing %s caching allocator...  ", get_memory_type_name(mem));
+
+    memory::trim_allocator_cache();
+    memory::allocator_stats_t before = memory::get_allocator_stats(mem);
+    MAGMADNN_TEST_ASSERT_DEFAULT(before.bytes_cached == 0, "\"bytes_cached == 0\" failed");
+
+    /* the first allocation goes to the system, the ones after it reuse the freed block */
+    for (int iter = 0; iter < 10; iter++) {
+        MemoryManager<float> *mm = new MemoryManager<float>(size, mem, (device_t) 0);
+        mm->set(size - 1, (float) iter);
+        MAGMADNN_TEST_ASSERT_DEFAULT(mm->get(size - 1) == (float) iter, "\"mm->get(size - 1) == iter\" failed");
+
+        memory::allocator_stats_t in_use = memory::get_allocator_stats(mem);
+        MAGMADNN_TEST_ASSERT_DEFAULT(in_use.bytes_in_use >= before.bytes_in_use + size * sizeof(float),
+                                     "\"bytes_in_use grew\" failed");
+
+        delete mm;
+    }
+
+    memory::allocator_stats_t after = memory::get_allocator_stats(mem);
+    MAGMADNN_TEST_ASSERT_DEFAULT(after.n_system_allocs == before.n_system_allocs + 1,
+                                 "\"n_system_allocs == before + 1\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(after.bytes_in_use == before.bytes_in_use, "\"bytes_in_use unchanged\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(after.bytes_cached >= size * sizeof(float), "\"bytes_cached >= size\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(after.peak_bytes_in_use >= before.bytes_in_use + size * sizeof(float),
+                                 "\"peak_bytes_in_use\" failed");
+
+    memory::trim_allocator_cache();
+    after = memory::get_allocator_stats(mem);
+    MAGMADNN_TEST_ASSERT_DEFAULT(after.bytes_cached == 0, "\"bytes_cached == 0\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(after.n_system_frees == before.n_system_frees + 1,
+                                 "\"n_system_frees == before + 1\" failed");
+
+    if (verbose) show_success();
+}
+
 int main(int argc, char **argv) {
     magmadnn_init();
 
@@ -99,6 +136,12 @@ int main(int argc, char **argv) {
     test_copy(CUDA_MANAGED, CUDA_MANAGED, test_size, true);
 #endif
 
+    // caching allocator
+    test_caching_allocator(HOST, test_size, true);
+#if defined(MAGMADNN_HAVE_CUDA)
+    test_caching_allocator(DEVICE, test_size, true);
+#endif
+
     magmadnn_finalize();
     return 0;
 }
@@ -7,7 +7,9 @@
  * @copyright Copyright (c) 2019
  */
 
+#include <cmath>
 #include <cstdio>
+#include <string>
 #include <vector>
 #include "magmadnn.h"
 #include "utilities.h"
@@ -15,11 +17,22 @@
 using namespace magmadnn;
 
 void test_model_MLP(memory_t mem, unsigned int size);
+void test_model_checkpoint(memory_t mem, unsigned int size);
+void test_model_sparse_labels(memory_t mem, unsigned int size);
+void test_inference_session(memory_t mem, unsigned int size);
+void test_predict_batch(memory_t mem, unsigned int size);
+void test_model_flat_buffers(memory_t mem, unsigned int size);
 
 int main(int argc, char **argv) {
     magmadnn_init();
 
     test_for_all_mem_types(test_model_MLP, 50);
+    test_for_all_mem_types(test_model_checkpoint, 50);
+    /* the fused softmax cross entropy is HOST only */
+    test_model_sparse_labels(HOST, 50);
+    test_for_all_mem_types(test_inference_session, 50);
+    test_for_all_mem_types(test_predict_batch, 50);
+    test_for_all_mem_types(test_model_flat_buffers, 50);
 
     magmadnn_finalize();
     return 0;
@@ -62,4 +75,415 @@ void test_model_MLP(memory_t mem, unsigned int size) {
     delete y;
 
     show_success();
-}
\ No newline at end of file
+}
+
+/* host copies of tensors, to compare them after they change */
+static std::vector<Tensor<float> *> host_copies(const std::vector<Tensor<float> *> &tensors) {
+    std::vector<Tensor<float> *> copies;
+    for (unsigned int i = 0; i < tensors.size(); i++) {
+        Tensor<float> *copy = new Tensor<float>(tensors[i]->get_shape(), {NONE, {}}, HOST);
+        copy->copy_from(*tensors[i]);
+        copies.push_back(copy);
+    }
+    return copies;
+}
+
+void test_model_checkpoint(memory_t mem, unsigned int size) {
+    unsigned int n_features = 6;
+    unsigned int n_classes = 10;
+    unsigned int n_samples = 10;
+    unsigned int batch_size = 2;
+    std::string checkpoint_path = "testing_model_checkpoint.mdnn";
+    model::metric_t metrics;
+
+    printf("testing %s checkpoint...  ", get_memory_type_name(mem));
+
+    Tensor<float> *x = new Tensor<float>({n_samples, n_features}, {UNIFORM, {-1.0f, 1.0f}}, mem);
+    auto var = op::var<float>("x", {batch_size, n_features}, {NONE, {}}, mem);
+
+    Tensor<float> *y = new Tensor<float>({n_samples, n_classes}, {IDENTITY, {}}, mem);
+
+    auto input = layer::input<float>(var);
+    auto fc1 = layer::fullyconnected<float>(input->out(), 10);
+    auto act1 = layer::activation<float>(fc1->out(), layer::SIGMOID);
+    auto fc2 = layer::fullyconnected<float>(act1->out(), n_classes);
+    auto act2 = layer::activation<float>(fc2->out(), layer::SIGMOID);
+    auto output = layer::output<float>(act2->out());
+
+    std::vector<layer::Layer<float> *> layers = {input, fc1, act1, fc2, act2, output};
+
+    std::vector<op::Operation<float> *> weights;
+    for (unsigned int i = 0; i < layers.size(); i++) {
+        std::vector<op::Operation<float> *> layer_weights = layers[i]->get_weights();
+        weights.insert(weights.end(), layer_weights.begin(), layer_weights.end());
+    }
+
+    model::nn_params_t p;
+    p.n_epochs = 4;
+    p.batch_size = batch_size;
+    p.checkpoint_every = 2;
+    p.checkpoint_path = checkpoint_path;
+    optimizer::Adam<float> *adam = new optimizer::Adam<float>(0.01f, 0.9f, 0.999f);
+    model::NeuralNetwork<float> model(layers, optimizer::CROSS_ENTROPY, adam, p);
+
+    /* checkpoints after epochs 2 and 4 */
+    model.fit(x, y, metrics);
+    MAGMADNN_TEST_ASSERT_DEFAULT(model.wait_for_checkpoint() == 0, "checkpoint was not written");
+    MAGMADNN_TEST_ASSERT_DEFAULT(model.get_epoch() == 4, "trained %u epochs instead of 4", model.get_epoch());
+
+    std::vector<Tensor<float> *> tensors;
+    for (unsigned int i = 0; i < weights.size(); i++) tensors.push_back(weights[i]->get_output_tensor());
+    std::vector<Tensor<float> *> state = adam->get_state_tensors(weights);
+    tensors.insert(tensors.end(), state.begin(), state.end());
+
+    std::vector<Tensor<float> *> saved = host_copies(tensors);
+    std::vector<double> saved_scalars = adam->get_state_scalars();
+    MAGMADNN_TEST_ASSERT_DEFAULT(model.save_checkpoint(checkpoint_path + ".old", true) == 0, "blocking save failed");
+
+    /* trains on and overwrites the background checkpoint */
+    model.fit(x, y, metrics);
+    MAGMADNN_TEST_ASSERT_DEFAULT(model.wait_for_checkpoint() == 0, "checkpoint was not written");
+    std::vector<Tensor<float> *> latest = host_copies(tensors);
+    MAGMADNN_TEST_ASSERT_DEFAULT(model.load_checkpoint(checkpoint_path + ".missing") != 0, "loaded a missing file");
+
+    /* restores the weights, the optimizer state and the epoch */
+    MAGMADNN_TEST_ASSERT_DEFAULT(model.load_checkpoint(checkpoint_path + ".old") == 0, "could not load checkpoint");
+    MAGMADNN_TEST_ASSERT_DEFAULT(model.get_epoch() == 4, "restored epoch %u instead of 4", model.get_epoch());
+    std::vector<double> restored_scalars = adam->get_state_scalars();
+    MAGMADNN_TEST_ASSERT_DEFAULT(restored_scalars.size() == saved_scalars.size(), "lost optimizer scalars");
+    for (unsigned int i = 0; i < restored_scalars.size(); i++) {
+        MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(restored_scalars[i], saved_scalars[i]);
+    }
+
+    /* resuming at the last epoch leaves nothing to train */
+    model.fit(x, y, metrics);
+    MAGMADNN_TEST_ASSERT_DEFAULT(model.get_epoch() == 4, "resumed at epoch %u instead of 4", model.get_epoch());
+    std::vector<Tensor<float> *> restored = host_copies(tensors);
+    for (unsigned int i = 0; i < restored.size(); i++) {
+        for (unsigned int j = 0; j < restored[i]->get_size(); j++) {
+            MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(restored[i]->get(j), saved[i]->get(j));
+        }
+    }
+
+    /* the background checkpoint holds the end of the second fit */
+    MAGMADNN_TEST_ASSERT_DEFAULT(model.load_checkpoint(checkpoint_path) == 0, "could not load checkpoint");
+    std::vector<Tensor<float> *> reloaded = host_copies(tensors);
+    for (unsigned int i = 0; i < reloaded.size(); i++) {
+        for (unsigned int j = 0; j < reloaded[i]->get_size(); j++) {
+            MAGMADNN_TEST_ASSERT_FEQUAL_DEFAULT(reloaded[i]->get(j), latest[i]->get(j));
+        }
+    }
+
+    std::remove(checkpoint_path.c_str());
+    std::remove((checkpoint_path + ".old").c_str());
+    for (unsigned int i = 0; i < tensors.size(); i++) {
+        delete saved[i];
+        delete latest[i];
+        delete restored[i];
+        delete reloaded[i];
+    }
+    delete x;
+    delete y;
+
+    show_success();
+}
+
+void test_model_sparse_labels(memory_t mem, unsigned int size) {
+    unsigned int n_features = 6;
+    unsigned int n_classes = 4;
+    unsigned int n_samples = 40;
+    unsigned int batch_size = 4;
+    model::metric_t metrics;
+
+    printf("testing %s sparse labels...  ", get_memory_type_name(mem));
+
+    /* the class is the largest of the first n_classes features */
+    Tensor<float> *x = new Tensor<float>({n_samples, n_features}, {UNIFORM, {0.0f, 1.0f}}, mem);
+    Tensor<float> *y = new Tensor<float>({n_samples}, {NONE, {}}, mem);
+    for (unsigned int i = 0; i < n_samples; i++) {
+        unsigned int label = i % n_classes;
+        x->set({i, label}, 2.0f);
+        y->set(i, (float) label);
+    }
+
+    auto var = op::var<float>("x", {batch_size, n_features}, {NONE, {}}, mem);
+    auto input = layer::input<float>(var);
+    auto fc1 = layer::fullyconnected<float>(input->out(), n_classes);
+    auto act1 = layer::activation<float>(fc1->out(), layer::SOFTMAX);
+    auto output = layer::output<float>(act1->out());
+
+    std::vector<layer::Layer<float> *> layers = {input, fc1, act1, output};
+
+    model::nn_params_t p;
+    p.n_epochs = 20;
+    p.batch_size = batch_size;
+    p.learning_rate = 0.5;
+    model::NeuralNetwork<float> model(layers, optimizer::SPARSE_CROSS_ENTROPY, optimizer::SGD, p);
+
+    MAGMADNN_TEST_ASSERT_DEFAULT(model.fit(x, y, metrics) == 0, "fit failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(std::isfinite(metrics.loss), "loss is not finite");
+    MAGMADNN_TEST_ASSERT_DEFAULT(metrics.accuracy > 0.5, "accuracy %g after training", metrics.accuracy);
+
+    /* predictions still go through the softmax */
+    Tensor<float> *probabilities = model.predict(x);
+    float row_sum = 0.0f;
+    for (unsigned int j = 0; j < n_classes; j++) row_sum += probabilities->get({0u, j});
+    MAGMADNN_TEST_ASSERT_FEQUAL(row_sum, 1.0f, 1E-5, true, "%g != 1", row_sum);
+
+    delete x;
+    delete y;
+
+    show_success();
+}
+
+void test_inference_session(memory_t mem, unsigned int size) {
+    unsigned int n_features = 6;
+    unsigned int n_classes = 3;
+    unsigned int batch_size = 4;
+
+    printf("testing %s inference session...  ", get_memory_type_name(mem));
+
+    auto var = op::var<float>("x", {batch_size, n_features}, {NONE, {}}, mem);
+    auto input = layer::input<float>(var);
+    auto fc1 = layer::fullyconnected<float>(input->out(), 8);
+    auto act1 = layer::activation<float>(fc1->out(), layer::RELU);
+    auto drop1 = layer::dropout<float>(act1->out(), 0.5);
+    auto fc2 = layer::fullyconnected<float>(drop1->out(), n_classes);
+    auto act2 = layer::activation<float>(fc2->out(), layer::SOFTMAX);
+    auto output = layer::output<float>(act2->out());
+
+    std::vector<layer::Layer<float> *> layers = {input, fc1, act1, drop1, fc2, act2, output};
+
+    model::nn_params_t p;
+    p.n_epochs = 1;
+    p.batch_size = batch_size;
+    p.learning_rate = 0.1;
+    model::NeuralNetwork<float> model(layers, optimizer::CROSS_ENTROPY, optimizer::SGD, p);
+
+    /* non-zero biases, so that using the wrong bias rows shows */
+    for (unsigned int i = 0; i < model.weights().size(); i++) {
+        Tensor<float> *w = model.weights()[i]->get_output_tensor();
+        Tensor<float> host_w(w->get_shape(), {UNIFORM, {-1.0f, 1.0f}}, HOST);
+        w->copy_from(host_w);
+    }
+
+    Tensor<float> samples({batch_size, n_features}, {UNIFORM, {-1.0f, 1.0f}}, mem);
+
+    /* reference: the training graph with dropout switched off */
+    op::DropoutOp<float> *dropout_op = dynamic_cast<op::DropoutOp<float> *>(drop1->out());
+    dropout_op->set_training(false);
+    Tensor<float> expected({batch_size, n_classes}, {NONE, {}}, HOST);
+    expected.copy_from(*model.predict(&samples));
+    dropout_op->set_training(true);
+
+    /* the whole batch */
+    model::InferenceSession<float> batch_session(&model, batch_size);
+    MAGMADNN_TEST_ASSERT_DEFAULT(batch_session.is_compiled() == (mem == HOST), "unexpected session mode");
+    Tensor<float> batch_out({batch_size, n_classes}, {NONE, {}}, HOST);
+    batch_out.copy_from(*batch_session.predict(&samples));
+    for (unsigned int i = 0; i < batch_size * n_classes; i++) {
+        MAGMADNN_TEST_ASSERT_FEQUAL(batch_out.get(i), expected.get(i), 1E-5, true, "%g != %g at %u", batch_out.get(i),
+                                    expected.get(i), i);
+    }
+    MAGMADNN_TEST_ASSERT_DEFAULT(dropout_op->is_training(), "session left dropout in inference mode");
+
+    /* batch normalization is not compiled: the session runs the graph, and leaves it in the mode it was in */
+    auto bn_var = op::var<float>("bn_x", {batch_size, n_features}, {NONE, {}}, mem);
+    auto bn_input = layer::input<float>(bn_var);
+    auto bn_fc = layer::fullyconnected<float>(bn_input->out(), n_classes);
+    auto bn = layer::batchnorm<float>(bn_fc->out());
+    auto bn_output = layer::output<float>(bn->out());
+    std::vector<layer::Layer<float> *> bn_layers = {bn_input, bn_fc, bn, bn_output};
+    model::NeuralNetwork<float> bn_model(bn_layers, optimizer::MSE, optimizer::SGD, p);
+
+    op::BatchNormOp<float> *bn_op = dynamic_cast<op::BatchNormOp<float> *>(bn->out());
+    model::InferenceSession<float> graph_session(&bn_model, batch_size);
+    MAGMADNN_TEST_ASSERT_DEFAULT(!graph_session.is_compiled(), "session compiled batch normalization");
+    bn_op->set_training(false);
+    graph_session.predict(&samples);
+    MAGMADNN_TEST_ASSERT_DEFAULT(!bn_op->is_training(), "session switched batchnorm to training mode");
+    bn_op->set_training(true);
+    graph_session.predict(&samples);
+    MAGMADNN_TEST_ASSERT_DEFAULT(bn_op->is_training(), "session left batchnorm in inference mode");
+
+    /* a single sample, the first of the batch */
+    model::InferenceSession<float> sample_session(&model);
+    Tensor<float> sample({n_features}, {NONE, {}}, mem);
+    sample.copy_from(samples, 0, n_features);
+
+    Tensor<float> *sample_out = sample_session.predict(&sample);
+    unsigned int expected_class = 0;
+    for (unsigned int j = 0; j < n_classes; j++) {
+        if (expected.get({0u, j}) > expected.get({0u, expected_class})) expected_class = j;
+        if (mem == HOST) {
+            MAGMADNN_TEST_ASSERT_FEQUAL(sample_out->get({0u, j}), expected.get({0u, j}), 1E-5, true, "%g != %g",
+                                        sample_out->get({0u, j}), expected.get({0u, j}));
+        }
+    }
+    MAGMADNN_TEST_ASSERT_DEFAULT(sample_session.predict_class(&sample) == expected_class, "wrong class");
+
+    show_success();
+}
+
+void test_predict_batch(memory_t mem, unsigned int size) {
+    unsigned int n_features = 5;
+    unsigned int n_classes = 3;
+    unsigned int batch_size = 4;
+    unsigned int n_samples = 4 * batch_size + 3; /* the last batch is padded */
+
+    printf("testing %s predict_batch...  ", get_memory_type_name(mem));
+
+    auto var = op::var<float>("x", {batch_size, n_features}, {NONE, {}}, mem);
+    auto input = layer::input<float>(var);
+    auto fc1 = layer::fullyconnected<float>(input->out(), 8, false);
+    auto act1 = layer::activation<float>(fc1->out(), layer::TANH);
+    auto drop1 = layer::dropout<float>(act1->out(), 0.5);
+    auto fc2 = layer::fullyconnected<float>(drop1->out(), n_classes, false);
+    auto act2 = layer::activation<float>(fc2->out(), layer::SOFTMAX);
+    auto output = layer::output<float>(act2->out());
+
+    std::vector<layer::Layer<float> *> layers = {input, fc1, act1, drop1, fc2, act2, output};
+
+    model::nn_params_t p;
+    p.n_epochs = 1;
+    p.batch_size = batch_size;
+    p.learning_rate = 0.1;
+    model::NeuralNetwork<float> model(layers, optimizer::CROSS_ENTROPY, optimizer::SGD, p);
+
+    Tensor<float> x({n_samples, n_features}, {UNIFORM, {-1.0f, 1.0f}}, HOST);
+    Tensor<float> outputs({n_samples, n_classes}, {NONE, {}}, HOST);
+    Tensor<float> classes({n_samples}, {NONE, {}}, HOST);
+
+    MAGMADNN_TEST_ASSERT_DEFAULT(model.predict_batch(&x, &outputs) == 0, "predict_batch failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(model.predict_batch(&x, &classes) == 0, "predict_batch failed");
+
+    /* predict_batch runs dropout in inference mode and then puts it back in training mode */
+    op::DropoutOp<float> *dropout_op = dynamic_cast<op::DropoutOp<float> *>(drop1->out());
+    MAGMADNN_TEST_ASSERT_DEFAULT(dropout_op->is_training(), "predict_batch left dropout in inference mode");
+    dropout_op->set_training(false);
+
+    /* without bias the rows are independent, so each sample can be checked alone */
+    Tensor<float> sample({n_features}, {NONE, {}}, HOST);
+    Tensor<float> expected({batch_size, n_classes}, {NONE, {}}, HOST);
+    for (unsigned int i = 0; i < n_samples; i++) {
+        sample.copy_from(x, i * n_features, n_features);
+        expected.copy_from(*model.predict(&sample));
+
+        unsigned int expected_class = 0;
+        for (unsigned int j = 0; j < n_classes; j++) {
+            MAGMADNN_TEST_ASSERT_FEQUAL(outputs.get({i, j}), expected.get({0u, j}), 1E-5, true,
+                                        "sample %u: %g != %g", i, outputs.get({i, j}), expected.get({0u, j}));
+            if (expected.get({0u, j}) > expected.get({0u, expected_class})) expected_class = j;
+        }
+        MAGMADNN_TEST_ASSERT_DEFAULT((unsigned int) classes.get(i) == expected_class, "sample %u: class %g != %u", i,
+                                     classes.get(i), expected_class);
+    }
+
+    dropout_op->set_training(true);
+
+    Tensor<float> wrong_out({n_samples - 1}, {NONE, {}}, HOST);
+    MAGMADNN_TEST_ASSERT_DEFAULT(model.predict_batch(&x, &wrong_out) != 0, "accepted an output of the wrong size");
+
+    show_success();
+}
+
+void test_model_flat_buffers(memory_t mem, unsigned int size) {
+    unsigned int n_features = 6;
+    unsigned int n_classes = 3;
+    unsigned int n_samples = 24;
+    unsigned int batch_size = 4;
+    model::metric_t metrics;
+    std::string file_name = "testing_model_flat.ckpt";
+
+    printf("testing %s flat buffers...  ", get_memory_type_name(mem));
+
+    Tensor<float> x({n_samples, n_features}, {UNIFORM, {-1.0f, 1.0f}}, mem);
+    Tensor<float> y({n_samples, n_classes}, {ZERO, {}}, mem);
+    for (unsigned int i = 0; i < n_samples; i++) y.set({i, i % n_classes}, 1.0f);
+
+    model::nn_params_t p;
+    p.n_epochs = 3;
+    p.batch_size = batch_size;
+    p.learning_rate = 0.1;
+
+    /* the same network twice, one of them with flat buffers */
+    std::vector<model::NeuralNetwork<float> *> models;
+    for (unsigned int m = 0; m < 2; m++) {
+        auto var = op::var<float>("x", {batch_size, n_features}, {NONE, {}}, mem);
+        auto input = layer::input<float>(var);
+        auto fc1 = layer::fullyconnected<float>(input->out(), 5);
+        auto act1 = layer::activation<float>(fc1->out(), layer::RELU);
+        auto fc2 = layer::fullyconnected<float>(act1->out(), n_classes);
+        auto act2 = layer::activation<float>(fc2->out(), layer::SOFTMAX);
+        auto output = layer::output<float>(act2->out());
+
+        p.flat_buffers = (m == 1);
+        models.push_back(new model::NeuralNetwork<float>({input, fc1, act1, fc2, act2, output},
+                                                         optimizer::CROSS_ENTROPY, optimizer::SGD, p));
+    }
+    model::NeuralNetwork<float> &plain = *models[0];
+    model::NeuralNetwork<float> &flat = *models[1];
+
+    MAGMADNN_TEST_ASSERT_DEFAULT(plain.flat_weights() == NULL, "flat buffers without the option");
+    MAGMADNN_TEST_ASSERT_DEFAULT(flat.flat_weights() != NULL && flat.flat_gradients() != NULL, "no flat buffers");
+    MAGMADNN_TEST_ASSERT_DEFAULT(flat.flat_weights()->get_size() == flat.flat_gradients()->get_size(),
+                                 "layouts differ");
+
+    /* the weights are views of the flat buffer, in order */
+    std::vector<op::Operation<float> *> &weights = flat.weights();
+    float *next = flat.flat_weights()->get_ptr();
+    for (unsigned int i = 0; i < weights.size(); i++) {
+        float *ptr = weights[i]->get_output_tensor()->get_ptr();
+        MAGMADNN_TEST_ASSERT_DEFAULT(ptr >= next, "weight %u is not in order", i);
+        MAGMADNN_TEST_ASSERT_DEFAULT((std::size_t)(ptr - flat.flat_weights()->get_ptr()) % 16 == 0,
+                                     "weight %u is not aligned", i);
+        next = ptr + weights[i]->get_output_tensor()->get_size();
+    }
+    MAGMADNN_TEST_ASSERT_DEFAULT(next <= flat.flat_weights()->get_ptr() + flat.flat_weights()->get_size(),
+                                 "weights exceed the buffer");
+
+    /* same start, same training */
+    for (unsigned int i = 0; i < weights.size(); i++) {
+        weights[i]->get_output_tensor()->copy_from(*plain.weights()[i]->get_output_tensor());
+    }
+    MAGMADNN_TEST_ASSERT_DEFAULT(plain.fit(&x, &y, metrics) == 0, "fit failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(flat.fit(&x, &y, metrics) == 0, "fit failed");
+
+    for (unsigned int i = 0; i < weights.size(); i++) {
+        Tensor<float> a(weights[i]->get_output_tensor()->get_shape(), {NONE, {}}, HOST);
+        Tensor<float> b(weights[i]->get_output_tensor()->get_shape(), {NONE, {}}, HOST);
+        a.copy_from(*weights[i]->get_output_tensor());
+        b.copy_from(*plain.weights()[i]->get_output_tensor());
+        for (unsigned int j = 0; j < a.get_size(); j++) {
+            MAGMADNN_TEST_ASSERT_FEQUAL(a.get(j), b.get(j), 1E-5, true, "weight %u[%u]: %g != %g", i, j, a.get(j),
+                                        b.get(j));
+        }
+    }
+
+    /* a flat checkpoint restores into a plain network and back */
+    MAGMADNN_TEST_ASSERT_DEFAULT(flat.save_checkpoint(file_name, true) == 0, "save failed");
+    Tensor<float> saved({flat.flat_weights()->get_size()}, {NONE, {}}, HOST);
+    saved.copy_from(*flat.flat_weights());
+    MAGMADNN_TEST_ASSERT_DEFAULT(flat.fit(&x, &y, metrics) == 0, "fit failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(flat.load_checkpoint(file_name) == 0, "load failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(plain.load_checkpoint(file_name) == 0, "load into the plain network failed");
+
+    Tensor<float> restored({flat.flat_weights()->get_size()}, {NONE, {}}, HOST);
+    restored.copy_from(*flat.flat_weights());
+    for (unsigned int j = 0; j < saved.get_size(); j++) {
+        MAGMADNN_TEST_ASSERT_FEQUAL(restored.get(j), saved.get(j), 1E-8, true, "%g != %g at %u", restored.get(j),
+                                    saved.get(j), j);
+    }
+    Tensor<float> plain_weight(plain.weights()[0]->get_output_tensor()->get_shape(), {NONE, {}}, HOST);
+    plain_weight.copy_from(*plain.weights()[0]->get_output_tensor());
+    for (unsigned int j = 0; j < plain_weight.get_size(); j++) {
+        MAGMADNN_TEST_ASSERT_FEQUAL(plain_weight.get(j), saved.get(j), 1E-8, true, "%g != %g at %u",
+                                    plain_weight.get(j), saved.get(j), j);
+    }
+    std::remove(file_name.c_str());
+
+    delete models[0];
+    delete models[1];
+
+    show_success();
+}
@@ -0,0 +1,519 @@
+/**
+ * @file testing_mpi.cpp
+ * @version 1.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ */
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "magmadnn.h"
+#include "utilities.h"
+
+#if defined(MAGMADNN_HAVE_MPI)
+#include "magmadnn/optimizer/DistMomentumSGD.h"
+#include "magmadnn/optimizer/GradBucketReducer.h"
+#include "magmadnn/optimizer/GradCompressor.h"
+#include "magmadnn/optimizer/ShardedOptimizer.h"
+#endif
+
+using namespace magmadnn;
+
+#if defined(MAGMADNN_HAVE_MPI)
+
+void test_grad_bucket_reducer(memory_t mem, unsigned int size);
+void test_half_compressor(memory_t mem, unsigned int size, solver::HalfCompressor<float> &fp16);
+void test_topk_compressor(memory_t mem, unsigned int size);
+void test_model_average(memory_t mem, unsigned int size);
+void test_local_sgd(memory_t mem, unsigned int size);
+void test_sharded_optimizer(memory_t mem, unsigned int size);
+void test_sharded_training(memory_t mem, unsigned int size);
+
+int main(int argc, char **argv) {
+    /* before MPI_Init, which HalfCompressor does not need until its first allreduce */
+    solver::HalfCompressor<float> fp16(solver::HALF_FP16);
+
+    MPI_Init(&argc, &argv);
+    magmadnn_init();
+
+    test_grad_bucket_reducer(HOST, 16);
+    test_half_compressor(HOST, 16, fp16);
+    test_topk_compressor(HOST, 16);
+    test_model_average(HOST, 16);
+    test_local_sgd(HOST, 16);
+    test_sharded_optimizer(HOST, 16);
+    test_sharded_training(HOST, 16);
+
+    magmadnn_finalize();
+    MPI_Finalize();
+    return 0;
+}
+
+/* only process 0 reports */
+bool is_root() {
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    return rank == 0;
+}
+
+/* an MLP with size inputs whose samples differ on each process, and the weights of process 0 everywhere */
+model::NeuralNetwork<float> *build_mlp(memory_t mem, unsigned int size, bool flat_buffers) {
+    unsigned int batch_size = 8;
+    unsigned int n_classes = 4;
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    auto var = op::var<float>("x", {batch_size, size}, {CONSTANT, {0.1f * (rank + 1)}}, mem);
+    auto input = layer::input<float>(var);
+    auto fc1 = layer::fullyconnected<float>(input->out(), 2 * size);
+    auto act1 = layer::activation<float>(fc1->out(), layer::RELU);
+    auto fc2 = layer::fullyconnected<float>(act1->out(), n_classes);
+    auto act2 = layer::activation<float>(fc2->out(), layer::SIGMOID);
+    auto output = layer::output<float>(act2->out());
+
+    std::vector<layer::Layer<float> *> layers = {input, fc1, act1, fc2, act2, output};
+
+    model::nn_params_t p;
+    p.batch_size = batch_size;
+    p.flat_buffers = flat_buffers;
+    model::NeuralNetwork<float> *model =
+        new model::NeuralNetwork<float>(layers, optimizer::CROSS_ENTROPY, optimizer::SGD, p);
+    model->ground_truth_tensor()->fill_memory({IDENTITY, {}});
+
+    for (unsigned int i = 0; i < model->weights().size(); i++) {
+        Tensor<float> *w = model->weights()[i]->get_output_tensor();
+        MPI_Bcast(w->get_ptr(), w->get_size(), MPI_FLOAT, 0, MPI_COMM_WORLD);
+    }
+    return model;
+}
+
+/* the values of t summed over the processes with a plain MPI_Allreduce, which the reducers are checked against */
+std::vector<float> allreduce_copy(Tensor<float> *t) {
+    std::vector<float> values(t->get_ptr(), t->get_ptr() + t->get_size());
+    MPI_Allreduce(MPI_IN_PLACE, values.data(), values.size(), MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
+    return values;
+}
+
+void test_grad_bucket_reducer(memory_t mem, unsigned int size) {
+    if (is_root()) printf("Testing %s grad bucket reducer...  ", get_memory_type_name(mem));
+
+    /* one bucket per gradient, a few buckets, and the whole model in one; with and without flat buffers */
+    std::vector<std::size_t> bucket_sizes = {0, 4 * size * sizeof(float), 1 << 30};
+    for (unsigned int flat = 0; flat < 2; flat++) {
+        for (unsigned int s = 0; s < bucket_sizes.size(); s++) {
+            model::NeuralNetwork<float> *model = build_mlp(mem, size, flat == 1);
+            std::vector<op::Operation<float> *> &weights = model->weights();
+            op::Operation<float> *loss = model->lossfun();
+
+            loss->eval(true);
+            op::GradTable<float> table;
+            op::get_grad_table(weights, loss, table);
+
+            solver::GradBucketReducer<float> reducer(bucket_sizes[s]);
+            MAGMADNN_TEST_ASSERT_DEFAULT(reducer.attach(*model, table) == 0, "attach failed");
+            if (s == 1) {
+                MAGMADNN_TEST_ASSERT_DEFAULT(reducer.get_num_buckets() > 1, "%u buckets", reducer.get_num_buckets());
+            }
+
+            /* twice, so that the second iteration reuses the buckets */
+            for (unsigned int it = 0; it < 2; it++) {
+                reducer.start();
+                table.clear();
+                op::get_grad_table(weights, loss, table);
+                reducer.finish();
+            }
+            std::vector<std::vector<float>> reduced;
+            for (unsigned int i = 0; i < weights.size(); i++) {
+                Tensor<float> *grad = table.get(weights[i]);
+                reduced.push_back(std::vector<float>(grad->get_ptr(), grad->get_ptr() + grad->get_size()));
+            }
+
+            /* a weight without a gradient in the table contributes zeros, the others are still summed */
+            std::vector<op::Operation<float> *> partial(weights.begin() + 1, weights.end());
+            reducer.start();
+            table.clear();
+            op::get_grad_table(partial, loss, table);
+            reducer.finish();
+            MAGMADNN_TEST_ASSERT_DEFAULT(table.get(weights[0]) == NULL, "\"table.get(weights[0]) == NULL\" failed");
+            for (unsigned int i = 1; i < weights.size(); i++) {
+                Tensor<float> *grad = table.get(weights[i]);
+                for (unsigned int j = 0; j < grad->get_size(); j++) {
+                    MAGMADNN_TEST_ASSERT_FEQUAL(grad->get(j), reduced[i][j], 1E-4 * (1.0 + std::fabs(reduced[i][j])),
+                                                true, "partial, flat %u, bucket size %zu, weight %u", flat,
+                                                bucket_sizes[s], i);
+                }
+            }
+
+            reducer.detach();
+            table.clear();
+            op::get_grad_table(weights, loss, table);
+            for (unsigned int i = 0; i < weights.size(); i++) {
+                std::vector<float> expected = allreduce_copy(table.get(weights[i]));
+                for (unsigned int j = 0; j < expected.size(); j++) {
+                    MAGMADNN_TEST_ASSERT_FEQUAL(reduced[i][j], expected[j], 1E-4 * (1.0 + std::fabs(expected[j])), true,
+                                                "flat %u, bucket size %zu, weight %u: %g != %g", flat, bucket_sizes[s],
+                                                i, reduced[i][j], expected[j]);
+                }
+            }
+
+            delete model;
+        }
+    }
+
+    if (is_root()) show_success();
+}
+
+/* the gradients of the loss of model on this process */
+std::vector<std::vector<float>> local_grads(model::NeuralNetwork<float> *model) {
+    std::vector<op::Operation<float> *> &weights = model->weights();
+    model->lossfun()->eval(true);
+    op::GradTable<float> table;
+    op::get_grad_table(weights, model->lossfun(), table);
+
+    std::vector<std::vector<float>> grads;
+    for (unsigned int i = 0; i < weights.size(); i++) {
+        Tensor<float> *grad = table.get(weights[i]);
+        grads.push_back(std::vector<float>(grad->get_ptr(), grad->get_ptr() + grad->get_size()));
+    }
+    return grads;
+}
+
+/* ||a - b|| / ||b|| */
+double relative_error(const std::vector<float> &a, const std::vector<float> &b) {
+    double err = 0.0, norm = 0.0;
+    for (unsigned int i = 0; i < b.size(); i++) {
+        err += ((double) a[i] - b[i]) * ((double) a[i] - b[i]);
+        norm += (double) b[i] * b[i];
+    }
+    return (norm > 0.0) ? std::sqrt(err / norm) : std::sqrt(err);
+}
+
+/* whether every process holds the values of process 0 */
+bool same_on_all(const std::vector<float> &values) {
+    std::vector<float> root = values;
+    MPI_Bcast(root.data(), root.size(), MPI_FLOAT, 0, MPI_COMM_WORLD);
+    int differs = (root != values);
+    MPI_Allreduce(MPI_IN_PLACE, &differs, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    return differs == 0;
+}
+
+/* the sum of the gradients over the processes through compressor, checked against a plain allreduce */
+void check_compressor(solver::GradCompressor<float> &compressor, model::NeuralNetwork<float> *model, double tolerance) {
+    std::vector<std::vector<float>> grads = local_grads(model);
+    for (unsigned int i = 0; i < grads.size(); i++) {
+        std::vector<float> expected = grads[i];
+        MPI_Allreduce(MPI_IN_PLACE, expected.data(), expected.size(), MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
+
+        compressor.allreduce(grads[i].data(), grads[i].size(), i, MPI_COMM_WORLD);
+        double err = relative_error(grads[i], expected);
+        MAGMADNN_TEST_ASSERT_DEFAULT(err <= tolerance, "%s, weight %u: relative error %g", compressor.name(), i, err);
+        MAGMADNN_TEST_ASSERT_DEFAULT(same_on_all(grads[i]), "%s, weight %u: processes differ", compressor.name(), i);
+    }
+}
+
+void test_half_compressor(memory_t mem, unsigned int size, solver::HalfCompressor<float> &fp16) {
+    if (is_root()) printf("Testing %s half compressor...  ", get_memory_type_name(mem));
+
+    model::NeuralNetwork<float> *model = build_mlp(mem, size, false);
+
+    solver::NoCompressor<float> none;
+    check_compressor(none, model, 1E-6);
+
+    /* 11 and 8 significant bits */
+    check_compressor(fp16, model, 5E-3);
+    solver::HalfCompressor<float> bf16(solver::HALF_BF16);
+    check_compressor(bf16, model, 2E-2);
+    MAGMADNN_TEST_ASSERT_FEQUAL(bf16.ratio(), 2.0, 1E-9, true, "bf16 ratio %g != 2", bf16.ratio());
+
+    delete model;
+
+    if (is_root()) show_success();
+}
+
+void test_topk_compressor(memory_t mem, unsigned int size) {
+    if (is_root()) printf("Testing %s top-k compressor...  ", get_memory_type_name(mem));
+
+    model::NeuralNetwork<float> *model = build_mlp(mem, size, false);
+
+    /* everything sent: exact */
+    solver::TopKCompressor<float> all(1.0);
+    check_compressor(all, model, 1E-5);
+
+    /* with error feedback, what was not sent yet stays in the residuals: over the iterations, the sums received plus
+       the residuals of all processes are the sums of the gradients put in */
+    solver::TopKCompressor<float> topk(0.1, true);
+    std::vector<std::vector<float>> grads = local_grads(model);
+    unsigned int n_iterations = 5;
+    for (unsigned int i = 0; i < grads.size(); i++) {
+        std::vector<float> received(grads[i].size(), 0.0f);
+        for (unsigned int it = 0; it < n_iterations; it++) {
+            std::vector<float> values = grads[i];
+            topk.allreduce(values.data(), values.size(), i, MPI_COMM_WORLD);
+            MAGMADNN_TEST_ASSERT_DEFAULT(same_on_all(values), "weight %u: processes differ", i);
+            for (unsigned int j = 0; j < values.size(); j++) received[j] += values[j];
+        }
+
+        std::vector<float> put_in = grads[i];
+        for (unsigned int j = 0; j < put_in.size(); j++) put_in[j] *= n_iterations;
+        MPI_Allreduce(MPI_IN_PLACE, put_in.data(), put_in.size(), MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
+
+        std::vector<float> residual = topk.residual(i);
+        MAGMADNN_TEST_ASSERT_DEFAULT(residual.size() == put_in.size(), "weight %u: no residual", i);
+        MPI_Allreduce(MPI_IN_PLACE, residual.data(), residual.size(), MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
+        for (unsigned int j = 0; j < put_in.size(); j++) received[j] += residual[j];
+
+        double err = relative_error(received, put_in);
+        MAGMADNN_TEST_ASSERT_DEFAULT(err <= 1E-5, "weight %u: gradient mass lost, relative error %g", i, err);
+    }
+    MAGMADNN_TEST_ASSERT_DEFAULT(topk.ratio() > 1.0, "top-k ratio %g", topk.ratio());
+
+    delete model;
+
+    if (is_root()) show_success();
+}
+
+/* the weights of model, one after the other */
+std::vector<float> model_params(model::NeuralNetwork<float> *model) {
+    std::vector<float> params;
+    for (unsigned int i = 0; i < model->weights().size(); i++) {
+        Tensor<float> *w = model->weights()[i]->get_output_tensor();
+        params.insert(params.end(), w->get_ptr(), w->get_ptr() + w->get_size());
+    }
+    return params;
+}
+
+void test_model_average(memory_t mem, unsigned int size) {
+    if (is_root()) printf("Testing %s local SGD model average...  ", get_memory_type_name(mem));
+
+    int rank = 0, nnodes = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nnodes);
+
+    /* in place in the flat buffer, and packed, with the momentum along or not */
+    for (unsigned int flat = 0; flat < 2; flat++) {
+        for (unsigned int momentum = 0; momentum < 2; momentum++) {
+            model::NeuralNetwork<float> *model = build_mlp(mem, size, flat == 1);
+
+            /* different parameters on every process */
+            for (unsigned int i = 0; i < model->weights().size(); i++) {
+                Tensor<float> *w = model->weights()[i]->get_output_tensor();
+                for (unsigned int j = 0; j < w->get_size(); j++) w->set(j, std::sin(0.1f * j + rank + i));
+            }
+            std::vector<float> expected = model_params(model);
+            MPI_Allreduce(MPI_IN_PLACE, expected.data(), expected.size(), MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
+            for (unsigned int j = 0; j < expected.size(); j++) expected[j] /= nnodes;
+
+            solver::DistMomentumSGD<float> solver(0.1f, 0.9f);
+            solver.set_local_steps(4, true);
+            solver.set_average_momentum(momentum == 1);
+            float loss = (float) rank;
+            solver.model_average(*model, loss);
+
+            std::vector<float> params = model_params(model);
+            for (unsigned int j = 0; j < expected.size(); j++) {
+                MAGMADNN_TEST_ASSERT_FEQUAL(params[j], expected[j], 1E-5, true, "flat %u, momentum %u: %g != %g", flat,
+                                            momentum, params[j], expected[j]);
+            }
+            float expected_loss = (nnodes - 1) / 2.0f;
+            MAGMADNN_TEST_ASSERT_FEQUAL(loss, expected_loss, 1E-5, true, "loss %g != %g", loss, expected_loss);
+
+            /* a second round reuses the packed views, and averaging the average changes nothing */
+            solver.model_average(*model, loss);
+            params = model_params(model);
+            for (unsigned int j = 0; j < expected.size(); j++) {
+                MAGMADNN_TEST_ASSERT_FEQUAL(params[j], expected[j], 1E-5, true, "second round, flat %u, momentum %u",
+                                            flat, momentum);
+            }
+            MAGMADNN_TEST_ASSERT_FEQUAL(loss, expected_loss, 1E-5, true, "second round loss %g", loss);
+
+            delete model;
+        }
+    }
+
+    if (is_root()) show_success();
+}
+
+/* trains a fresh MLP with solver and returns its parameters. Every sample is the same, so every process computes
+   the same gradients whatever order it draws the samples in, and local SGD takes the same steps as synchronous SGD */
+std::vector<float> train(solver::DistMomentumSGD<float> &solver, memory_t mem, unsigned int size, int n_iterations) {
+    unsigned int n_samples = 64;
+    unsigned int n_classes = 4;
+    model::NeuralNetwork<float> *model = build_mlp(mem, size, false);
+
+    Tensor<float> x({n_samples, size}, {NONE, {}}, HOST);
+    Tensor<float> y({n_samples, n_classes}, {ZERO, {}}, HOST);
+    for (unsigned int i = 0; i < n_samples; i++) {
+        for (unsigned int j = 0; j < size; j++) x.set({i, j}, std::cos(0.5f * j));
+        y.set({i, 1u}, 1.0f);
+    }
+
+    /* min reports on every process */
+    std::vector<solver::TrainStats<float>> stats;
+    std::cout.setstate(std::ios::failbit);
+    solver.min(*model, x, y, model->network_input_tensor()->get_shape(0), false, n_iterations, 0.0, stats);
+    std::cout.clear();
+
+    std::vector<float> params = model_params(model);
+    MAGMADNN_TEST_ASSERT_DEFAULT(same_on_all(params), "the models of the processes differ");
+
+    delete model;
+    return params;
+}
+
+void test_local_sgd(memory_t mem, unsigned int size) {
+    if (is_root()) printf("Testing %s local SGD...  ", get_memory_type_name(mem));
+
+    int n_iterations = 50;
+
+    /* reference: the gradients summed with an allreduce at every step */
+    solver::DistMomentumSGD<float> sync(0.05f, 0.9f);
+    std::vector<float> expected = train(sync, mem, size, n_iterations);
+
+    /* 50 steps in rounds of 4, the last one of 2 */
+    solver::DistMomentumSGD<float> local(0.05f, 0.9f);
+    local.set_local_steps(4);
+    std::vector<float> params = train(local, mem, size, n_iterations);
+    MAGMADNN_TEST_ASSERT_DEFAULT(local.num_averaging_rounds() == 13, "%u averages", local.num_averaging_rounds());
+    for (unsigned int j = 0; j < expected.size(); j++) {
+        MAGMADNN_TEST_ASSERT_FEQUAL(params[j], expected[j], 1E-4, true, "%g != %g", params[j], expected[j]);
+    }
+
+    /* adaptive: rounds get shorter as the loss goes down */
+    solver::DistMomentumSGD<float> adaptive(0.05f, 0.9f);
+    adaptive.set_local_steps(8, true);
+    params = train(adaptive, mem, size, n_iterations);
+    MAGMADNN_TEST_ASSERT_DEFAULT(adaptive.local_steps() >= 1 && adaptive.local_steps() < 8, "%u local steps",
+                                 adaptive.local_steps());
+    MAGMADNN_TEST_ASSERT_DEFAULT(adaptive.num_averaging_rounds() > 50 / 8 + 1, "%u averages",
+                                 adaptive.num_averaging_rounds());
+    for (unsigned int j = 0; j < expected.size(); j++) {
+        MAGMADNN_TEST_ASSERT_FEQUAL(params[j], expected[j], 1E-4, true, "%g != %g", params[j], expected[j]);
+    }
+
+    if (is_root()) show_success();
+}
+
+void test_sharded_optimizer(memory_t mem, unsigned int size) {
+    if (is_root()) printf("Testing %s sharded optimizer...  ", get_memory_type_name(mem));
+
+    int nnodes = 1;
+    MPI_Comm_size(MPI_COMM_WORLD, &nnodes);
+    float learning_rate = 0.01f, momentum = 0.9f, beta1 = 0.9f, beta2 = 0.999f, decaying_factor = 0.9f;
+
+    /* every update rule, with the gradients in the flat buffer and staged */
+    std::vector<solver::sharded_update_t> updates = {solver::SHARDED_MOMENTUM_SGD, solver::SHARDED_ADAM,
+                                                     solver::SHARDED_ADAGRAD, solver::SHARDED_RMSPROP};
+    for (unsigned int u = 0; u < updates.size(); u++) {
+        for (unsigned int flat = 0; flat < 2; flat++) {
+            model::NeuralNetwork<float> *model = build_mlp(mem, size, flat == 1);
+            std::vector<op::Operation<float> *> &weights = model->weights();
+
+            /* reference: the full update on every process with the mean of the allreduced gradients */
+            std::vector<Tensor<float> *> params, first_state, second_state;
+            for (unsigned int i = 0; i < weights.size(); i++) {
+                Tensor<float> *w = weights[i]->get_output_tensor();
+                params.push_back(new Tensor<float>(w->get_shape(), {NONE, {}}, HOST));
+                params.back()->copy_from(*w);
+                first_state.push_back(new Tensor<float>(w->get_shape(), {ZERO, {}}, HOST));
+                second_state.push_back(new Tensor<float>(w->get_shape(), {ZERO, {}}, HOST));
+            }
+            float running_beta1 = beta1, running_beta2 = beta2;
+
+            solver::ShardedOptimizer<float> sharded(updates[u], learning_rate);
+            MAGMADNN_TEST_ASSERT_DEFAULT(sharded.attach(*model) == 0, "attach failed");
+            unsigned int n_state = (updates[u] == solver::SHARDED_ADAM) ? 2 : 1;
+            MAGMADNN_TEST_ASSERT_DEFAULT(sharded.state_bytes() == (n_state + 1) * sharded.shard_size() * sizeof(float) +
+                                                                      sharded.staging_bytes(),
+                                         "%zu bytes of state", sharded.state_bytes());
+            MAGMADNN_TEST_ASSERT_DEFAULT(sharded.shard_size() <= (sharded.size() + nnodes - 1) / nnodes,
+                                         "shard of %u of %u", sharded.shard_size(), sharded.size());
+
+            op::GradTable<float> table;
+            for (unsigned int it = 0; it < 5; it++) {
+                model->lossfun()->eval(true);
+                table.clear();
+                op::get_grad_table(weights, model->lossfun(), table);
+
+                for (unsigned int i = 0; i < weights.size(); i++) {
+                    std::vector<float> sum = allreduce_copy(table.get(weights[i]));
+                    Tensor<float> grad({(unsigned int) sum.size()}, {NONE, {}}, HOST);
+                    for (unsigned int j = 0; j < sum.size(); j++) grad.set(j, sum[j] / nnodes);
+                    Tensor<float> param({params[i]->get_size()}, {NONE, {}}, HOST);
+                    param.copy_from(*params[i]);
+
+                    switch (updates[u]) {
+                        case solver::SHARDED_MOMENTUM_SGD:
+                            math::sgd_momentum(learning_rate, momentum, first_state[i], &grad, &param);
+                            break;
+                        case solver::SHARDED_ADAM:
+                            math::adam(learning_rate, beta1, beta2, running_beta1, running_beta2, first_state[i],
+                                       second_state[i], &grad, &param);
+                            break;
+                        case solver::SHARDED_ADAGRAD:
+                            math::adagrad(learning_rate, first_state[i], &grad, &param);
+                            break;
+                        case solver::SHARDED_RMSPROP:
+                            math::rmsprop(learning_rate, decaying_factor, first_state[i], &grad, &param);
+                            break;
+                    }
+                    params[i]->copy_from(param);
+                }
+                running_beta1 *= beta1;
+                running_beta2 *= beta2;
+
+                sharded.step(*model, table, 1.0f / nnodes);
+            }
+
+            /* without flat buffers, the staged parameters and gradients are counted */
+            std::size_t staging = (flat == 1) ? 0 : 2 * sharded.size() * sizeof(float);
+            MAGMADNN_TEST_ASSERT_DEFAULT(sharded.staging_bytes() == staging, "%zu bytes of staging, not %zu",
+                                         sharded.staging_bytes(), staging);
+
+            for (unsigned int i = 0; i < weights.size(); i++) {
+                Tensor<float> *w = weights[i]->get_output_tensor();
+                for (unsigned int j = 0; j < w->get_size(); j++) {
+                    MAGMADNN_TEST_ASSERT_FEQUAL(w->get(j), params[i]->get(j), 1E-5, true,
+                                                "update %u, flat %u, weight %u: %g != %g", u, flat, i, w->get(j),
+                                                params[i]->get(j));
+                }
+                delete params[i];
+                delete first_state[i];
+                delete second_state[i];
+            }
+
+            delete model;
+        }
+    }
+
+    if (is_root()) show_success();
+}
+
+void test_sharded_training(memory_t mem, unsigned int size) {
+    if (is_root()) printf("Testing %s sharded training...  ", get_memory_type_name(mem));
+
+    int n_iterations = 20;
+
+    /* reference: the gradients summed with an allreduce and the full momentum on every process */
+    solver::DistMomentumSGD<float> sync(0.05f, 0.9f);
+    std::vector<float> expected = train(sync, mem, size, n_iterations);
+
+    solver::DistMomentumSGD<float> sharded(0.05f, 0.9f);
+    sharded.set_sharded(true);
+    std::vector<float> params = train(sharded, mem, size, n_iterations);
+    for (unsigned int j = 0; j < expected.size(); j++) {
+        MAGMADNN_TEST_ASSERT_FEQUAL(params[j], expected[j], 1E-4, true, "%g != %g", params[j], expected[j]);
+    }
+
+    if (is_root()) show_success();
+}
+
+#else
+
+int main(int argc, char **argv) {
+    printf("MPI is not enabled; nothing to test.\n");
+    return 0;
+}
+
+#endif
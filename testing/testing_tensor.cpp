@@ -6,6 +6,7 @@ using namespace magmadnn;
 void test_indexing(memory_t mem, bool verbose);
 void test_fill(tensor_filler_t<float> filler, memory_t mem, bool verbose);
 void test_copy(memory_t mem, bool verbose);
+void test_io(memory_t mem, bool verbose);
 
 int main(int argc, char **argv) {
     magmadnn_init();
@@ -33,6 +34,14 @@ int main(int argc, char **argv) {
     test_copy(CUDA_MANAGED, true);
 #endif
 
+    // test reading and writing files
+    test_io(HOST, true);
+#if defined(MAGMADNN_HAVE_CUDA)
+    test_io(DEVICE, true);
+    test_io(MANAGED, true);
+    test_io(CUDA_MANAGED, true);
+#endif
+
     magmadnn_finalize();
     return 0;
 }
@@ -126,3 +135,106 @@ void test_copy(memory_t mem, bool verbose) {
 
     if (verbose) show_success();
 }
+
+void test_io(memory_t mem, bool verbose) {
+    if (verbose) printf("Testing file io on device %s...  ", get_memory_type_name(mem));
+
+    /* csv: blanks, empty lines and a trailing delimiter are fine */
+    FILE *file = std::fopen("testing_tensor.csv", "w");
+    std::fprintf(file, "1.5, 2,3\r\n\n-4e1 ,5,\n6\n");
+    std::fclose(file);
+
+    Tensor<float> *t = new Tensor<float>({2, 4}, {ZERO, {}}, mem);
+    MAGMADNN_TEST_ASSERT_DEFAULT(io::read_csv_to_tensor(*t, "testing_tensor.csv") == 0,
+                                 "\"read_csv_to_tensor(...) == 0\" failed");
+    const float expected[8] = {1.5f, 2.0f, 3.0f, -40.0f, 5.0f, 6.0f, 0.0f, 0.0f};
+    for (unsigned int i = 0; i < 8; i++) {
+        MAGMADNN_TEST_ASSERT_DEFAULT(t->get(i) == expected[i], "\"t->get(i) == expected[i]\" failed");
+    }
+
+    /* malformed values and too many values are errors */
+    file = std::fopen("testing_tensor.csv", "w");
+    std::fprintf(file, "1,,2\n");
+    std::fclose(file);
+    MAGMADNN_TEST_ASSERT_DEFAULT(io::read_csv_to_tensor(*t, "testing_tensor.csv") == 2,
+                                 "\"read_csv_to_tensor(empty value) == 2\" failed");
+    Tensor<float> *small = new Tensor<float>({1}, {ZERO, {}}, mem);
+    file = std::fopen("testing_tensor.csv", "w");
+    std::fprintf(file, "1,2\n");
+    std::fclose(file);
+    MAGMADNN_TEST_ASSERT_DEFAULT(io::read_csv_to_tensor(*small, "testing_tensor.csv") == 3,
+                                 "\"read_csv_to_tensor(too many values) == 3\" failed");
+
+    /* a csv long enough to be parsed in several chunks, written by write_tensor_to_csv */
+    unsigned int n_values = 400000;
+    Tensor<int> *big = new Tensor<int>({n_values}, {NONE, {}}, HOST);
+    for (unsigned int i = 0; i < n_values; i++) big->set(i, (int) (i * 7) - 1000);
+    Tensor<int> *big_read = new Tensor<int>({n_values}, {ZERO, {}}, mem);
+    io::write_tensor_to_csv(*big, "testing_tensor.csv");
+    MAGMADNN_TEST_ASSERT_DEFAULT(io::read_csv_to_tensor(*big_read, "testing_tensor.csv") == 0,
+                                 "\"read_csv_to_tensor(big) == 0\" failed");
+    for (unsigned int i = 0; i < n_values; i += 997) {
+        MAGMADNN_TEST_ASSERT_DEFAULT(big_read->get(i) == big->get(i), "\"big_read->get(i) == big->get(i)\" failed");
+    }
+    MAGMADNN_TEST_ASSERT_DEFAULT(big_read->get(n_values - 1) == big->get(n_values - 1),
+                                 "\"big_read->get(n_values - 1) == big->get(n_values - 1)\" failed");
+    std::remove("testing_tensor.csv");
+    MAGMADNN_TEST_ASSERT_DEFAULT(io::write_tensor_to_csv(*big, "testing_tensor.csv", ',', false) != 0,
+                                 "\"write_tensor_to_csv(missing file, create = false) != 0\" failed");
+
+    /* binary files keep the shape */
+    MAGMADNN_TEST_ASSERT_DEFAULT(io::write_tensor_to_binary(*t, "testing_tensor.bin") == 0,
+                                 "\"write_tensor_to_binary(...) == 0\" failed");
+    Tensor<float> *t_read = io::read_binary_tensor<float>("testing_tensor.bin", mem);
+    MAGMADNN_TEST_ASSERT_DEFAULT(t_read != NULL && t_read->get_shape() == t->get_shape(),
+                                 "\"read_binary_tensor(...) shape\" failed");
+    for (unsigned int i = 0; i < 8; i++) {
+        MAGMADNN_TEST_ASSERT_DEFAULT(t_read->get(i) == expected[i], "\"t_read->get(i) == expected[i]\" failed");
+    }
+    MAGMADNN_TEST_ASSERT_DEFAULT(io::read_binary_to_tensor(*small, "testing_tensor.bin") == 2,
+                                 "\"read_binary_to_tensor(wrong size) == 2\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(io::read_binary_tensor<double>("testing_tensor.bin") == NULL,
+                                 "\"read_binary_tensor<double>(float file) == NULL\" failed");
+
+    /* a mapped file is used in place, and a streamed file reads back whole */
+    {
+        io::MappedTensorFile<float> mapped("testing_tensor.bin");
+        MAGMADNN_TEST_ASSERT_DEFAULT(mapped.get_tensor() != NULL && mapped.get_tensor()->get({1, 0}) == 5.0f,
+                                     "\"mapped.get_tensor()->get({1, 0}) == 5\" failed");
+        MAGMADNN_TEST_ASSERT_DEFAULT(!mapped.get_tensor()->get_memory_manager()->owns_memory(),
+                                     "\"mapped tensor owns no memory\" failed");
+    }
+    {
+        /* a header claiming more axes than the file holds is rejected rather than read past the mapping */
+        io::tensor_file_header_t header;
+        FILE *bin = std::fopen("testing_tensor.bin", "rb");
+        MAGMADNN_TEST_ASSERT_DEFAULT(std::fread(&header, sizeof(header), 1, bin) == 1, "\"fread\" failed");
+        std::fclose(bin);
+        header.n_dims = 1u << 30;
+        bin = std::fopen("testing_tensor_bad.bin", "wb");
+        std::fwrite(&header, sizeof(header), 1, bin);
+        std::fclose(bin);
+        io::MappedTensorFile<float> bad("testing_tensor_bad.bin");
+        MAGMADNN_TEST_ASSERT_DEFAULT(bad.get_tensor() == NULL, "\"bad.get_tensor() == NULL\" failed");
+        std::remove("testing_tensor_bad.bin");
+    }
+    {
+        io::TensorFileWriter<float> writer("testing_tensor.bin", {3, 2, 4});
+        for (unsigned int i = 0; i < 3; i++) writer.write(*t);
+        MAGMADNN_TEST_ASSERT_DEFAULT(writer.close() == 0, "\"writer.close() == 0\" failed");
+    }
+    Tensor<float> *streamed = new Tensor<float>({3, 2, 4}, {ZERO, {}}, mem);
+    MAGMADNN_TEST_ASSERT_DEFAULT(io::read_binary_to_tensor(*streamed, "testing_tensor.bin") == 0,
+                                 "\"read_binary_to_tensor(streamed) == 0\" failed");
+    MAGMADNN_TEST_ASSERT_DEFAULT(streamed->get({2, 0, 3}) == -40.0f, "\"streamed->get({2, 0, 3}) == -40\" failed");
+    std::remove("testing_tensor.bin");
+
+    delete t;
+    delete small;
+    delete big;
+    delete big_read;
+    delete t_read;
+    delete streamed;
+
+    if (verbose) show_success();
+}